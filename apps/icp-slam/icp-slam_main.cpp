@@ -24,6 +24,7 @@
 #include <mrpt/opengl/stock_objects.h>
 #include <mrpt/utils/CConfigFile.h>
 #include <mrpt/utils/CFileGZInputStream.h>
+#include <mrpt/obs/CRawlogPrefetchReader.h>
 #include <mrpt/utils/CFileGZOutputStream.h>
 #include <mrpt/system/os.h>
 #include <mrpt/system/threads.h>
@@ -191,7 +192,7 @@ void MapBuilding_ICP(const string &INI_FILENAME, const string &override_rawlog_f
 	COccupancyGridMap2D::TEntropyInfo	entropy;
 
 	size_t						rawlogEntry = 0;
-	CFileGZInputStream					rawlogFile( RAWLOG_FILE.c_str() );
+	CRawlogPrefetchReader				rawlogFile( RAWLOG_FILE );
 
 
 	// Prepare output directory:
@@ -238,7 +239,7 @@ void MapBuilding_ICP(const string &INI_FILENAME, const string &override_rawlog_f
 
 		// Load action/observation pair from the rawlog:
 		// --------------------------------------------------
-		if (! CRawlog::getActionObservationPairOrObservation( rawlogFile, action, observations, observation, rawlogEntry) )
+		if (! rawlogFile.getActionObservationPairOrObservation( action, observations, observation, rawlogEntry) )
 			break; // file EOF
 
 		const bool isObsBasedRawlog = observation.present();
@@ -147,6 +147,7 @@ double grid_test_8(int a1, int a2)
 	scan1.loadFromVectors( sizeof(SCAN_RANGES_1)/sizeof(SCAN_RANGES_1[0]), SCAN_RANGES_1,SCAN_VALID_1 );
 
 	COccupancyGridMap2D		gridmap(-20,20,-20,20, 0.05f);
+	gridmap.likelihoodOptions.LF_useDistanceTransform = (a1!=0);
 
 	// test 8: Likelihood computation
 	const long N = 5000;
@@ -167,6 +168,44 @@ double grid_test_8(int a1, int a2)
 	return tictac.Tac()/N;
 }
 
+// a1: number of poses evaluated in each batch
+double grid_test_8_batch(int a1, int a2)
+{
+	randomGenerator.randomize(333);
+
+	// prepare the laser scan:
+	CObservation2DRangeScan	scan1;
+	scan1.aperture = M_PIf;
+	scan1.rightToLeft = true;
+	scan1.loadFromVectors( sizeof(SCAN_RANGES_1)/sizeof(SCAN_RANGES_1[0]), SCAN_RANGES_1,SCAN_VALID_1 );
+
+	COccupancyGridMap2D		gridmap(-20,20,-20,20, 0.05f);
+
+	// test 8b: Likelihood computation, many poses at once
+	const long N = 5000;
+
+	CPose3D pose3D(0,0,0);
+	gridmap.insertObservation( &scan1, &pose3D );
+
+	std::vector<mrpt::math::TPose3D> poses(a1);
+	for (int i=0;i<a1;i++)
+		poses[i] = mrpt::math::TPose3D(
+			randomGenerator.drawUniform(-1.0,1.0),
+			randomGenerator.drawUniform(-1.0,1.0),
+			0,
+			randomGenerator.drawUniform(-M_PI,M_PI), 0,0 );
+	std::vector<double> liks;
+
+	double R = 0;
+	CTicTac tictac;
+	for (long i=0;i<N;i+=a1)
+	{
+		gridmap.computeObservationLikelihoods(&scan1,poses,liks);
+		R+=liks[0];
+	}
+	return tictac.Tac()/N;
+}
+
 double grid_test_9(int a1, int a2)
 {
 	// test 9: computeMatchingWith2D
@@ -222,6 +261,9 @@ void register_tests_grids()
 	lstTests.push_back( TestData("gridmap2D: insert scan with widening",grid_test_5_6, 1) );
 	lstTests.push_back( TestData("gridmap2D: resize",grid_test_7) );
 	lstTests.push_back( TestData("gridmap2D: computeLikelihood",grid_test_8) );
+	lstTests.push_back( TestData("gridmap2D: computeLikelihood (distance transform)",grid_test_8, 1) );
+	lstTests.push_back( TestData("gridmap2D: computeLikelihoods (batch of 100 poses)",grid_test_8_batch, 100) );
+	lstTests.push_back( TestData("gridmap2D: computeLikelihoods (batch of 1000 poses)",grid_test_8_batch, 1000) );
 	lstTests.push_back( TestData("gridmap2D: determineMatching2D",grid_test_9, 5000 ) );
 }
 
@@ -20,6 +20,9 @@
 #include <mrpt/utils/stl_serialization.h>
 
 #include "common.h"
+#include "perf_stats.h"
+#include <memory>
+#include <regex>
 
 using namespace mrpt;
 using namespace mrpt::system;
@@ -72,6 +75,35 @@ void getTestImage(unsigned int img_index, mrpt::utils::CImage &out_img )
 }
 
 
+// Macros to create strings with the compiler version:
+#define ___STR2__(x) #x
+#define ___STR1__(x) ___STR2__(x)
+#define COMP_VER(NAME,MAJ,MIN,PATCH)  NAME ___STR1__(MAJ) ___STR1__(MIN)  ___STR1__(PATCH)
+
+const char* getCompilerName()
+{
+#if defined(_MSC_VER)
+#	if _MSC_VER==1700
+	return "MSVC2012";
+#	elif _MSC_VER==1800
+	return "MSVC2013";
+#	elif _MSC_VER==1900
+	return "MSVC2015";
+#	elif _MSC_VER==1910
+	return "MSVC2017";
+#	else
+	return "MSVC";
+#	endif
+#elif defined(__clang__)
+	return COMP_VER("CLANG",__clang_major__,__clang_minor__,__clang_patchlevel__);
+#elif defined(__GNUC__)
+	return COMP_VER("GCC",__GNUC__,__GNUC_MINOR__ ,__GNUC_PATCHLEVEL__);
+#else
+	return "unknowncompiler";
+#endif
+}
+
+
 #include "run_build_tables.h"
 
 
@@ -85,6 +117,14 @@ int main(int argc, char **argv)
 		TCLAP::CmdLine cmd("mrpt-performance", ' ', MRPT_getVersion().c_str());
 
 		TCLAP::ValueArg<std::string> arg_contains("c","match-contains","Run only the tests containing the given substring",false,"NAME","NAME",cmd);
+		TCLAP::ValueArg<std::string> arg_filter("f","filter","Run only the tests whose name matches the given regular expression (ECMAScript syntax, partial match)",false,"","REGEX",cmd);
+		TCLAP::ValueArg<unsigned int> arg_repetitions("n","repetitions","Number of measured runs of each test (Default: 5)",false,5,"N",cmd);
+		TCLAP::ValueArg<unsigned int> arg_warmup("w","warmup","Number of runs of each test before measuring, to warm up caches, allocators, lazy initialization, etc. (Default: 1)",false,1,"N",cmd);
+		TCLAP::ValueArg<double> arg_max_time("","max-time","Stop repeating a test once its measured runs took more than this time, in seconds, with at least one run (Default: 0=no limit)",false,0,"SECONDS",cmd);
+		TCLAP::ValueArg<std::string> arg_json("j","json","Save the statistics of all tests to this JSON file",false,"","FILE.json",cmd);
+		TCLAP::ValueArg<std::string> arg_baseline("b","baseline","Compare the median times against those in this JSON file, saved in a previous run with --json. The program returns 2 if any test is slower than the threshold",false,"","FILE.json",cmd);
+		TCLAP::ValueArg<double> arg_threshold("","threshold","Relative increase of the median time over the baseline to report as a regression, in percent (Default: 10)",false,10.0,"PERCENT",cmd);
+		TCLAP::SwitchArg arg_list("l","list","Only list the names of the tests which would be run",cmd,false);
 
 		TCLAP::SwitchArg arg_build_tables("t","tables","Don't run any test, instead build the tables of compared performances in SOURCE_DIR/doc/",cmd,false);
 		TCLAP::SwitchArg arg_release("r","release","Don't use the postfix 'dev' in the performance stats file",cmd,false);
@@ -101,12 +141,30 @@ int main(int argc, char **argv)
 		std::string  match_contains;
 		if (arg_contains.isSet())
 		{
-			cout << "Using match filter: " << match_contains << endl;
 			match_contains = arg_contains.getValue();
+			cout << "Using match filter: " << match_contains << endl;
+		}
+		std::unique_ptr<std::regex> filter_regex; // Only built if used
+		if (arg_filter.isSet())
+		{
+			filter_regex.reset(new std::regex(arg_filter.getValue(), std::regex::ECMAScript));
+			cout << "Using regex filter: " << arg_filter.getValue() << endl;
 		}
 
+		const unsigned int nRepetitions = std::max(1u, arg_repetitions.getValue());
+		const unsigned int nWarmup = arg_warmup.getValue();
+		const double max_time = arg_max_time.getValue();
+
+		std::map<std::string,double> baseline;
+		if (arg_baseline.isSet())
+		{
+			loadPerfBaselineJSON(arg_baseline.getValue(), baseline);
+			cout << "Comparing against baseline: " << arg_baseline.getValue() << " (" << baseline.size() << " tests, threshold: " << arg_threshold.getValue() << "%)" << endl;
+		}
+		const double threshold = 0.01*arg_threshold.getValue();
 
-		bool  doLog = true;
+
+		bool  doLog = !arg_list.isSet();
 		bool  HAVE_PERF_DATA_DIR = !PERF_DATA_DIR.empty() && mrpt::system::directoryExists(PERF_DATA_DIR);
 		if (HAVE_PERF_DATA_DIR)
 			cout << "Using perf-data dir: " << PERF_DATA_DIR << endl;
@@ -116,11 +174,14 @@ int main(int argc, char **argv)
 		globalTime.Tic();
 
 		CFileOutputStream fo;
-		doLog = fo.open(filName);
 		if (doLog)
-			cout << "Saving log to: " << filName << endl;
-		else
-			cout << "Cannot save log, error opening " << filName << " for writing..." << endl;
+		{
+			doLog = fo.open(filName);
+			if (doLog)
+				cout << "Saving log to: " << filName << endl;
+			else
+				cout << "Cannot save log, error opening " << filName << " for writing..." << endl;
+		}
 
 		cout << endl;
 
@@ -155,26 +216,76 @@ int main(int argc, char **argv)
 			fo.printf("<div align=\"center\"><h3>Results</h3></div><br>");
 			fo.printf("<div align=\"center\"><table border=\"1\">\n");
 			fo.printf("<tr> <td align=\"center\"><b>Test description</b></td> "
-					  "<td align=\"center\"><b>Execution time</b></td>"
-					  "<td align=\"center\"><b>Execution rate (Hz)</b></td> </tr>\n");
+					  "<td align=\"center\"><b>Execution time (median)</b></td>"
+					  "<td align=\"center\"><b>Execution rate (Hz)</b></td>"
+					  "<td align=\"center\"><b>Min / p90 / Max</b></td> </tr>\n");
 		}
 
+		if (!arg_list.isSet())
+			cout << "Running " << nWarmup << " warm-up + " << nRepetitions << " measured runs of each test." << endl << endl;
+
+		std::vector<TPerfStats> all_stats;
+		size_t nRegressions = 0;
+
 		for (std::list<TestData>::const_iterator it=lstTests.begin();it!=lstTests.end();it++)
 		{
 			// Filter tests?
 			if (!match_contains.empty())
 				if (string::npos==string(it->name).find(match_contains))
 					continue; // doesn't have the substring
+			if (filter_regex && !std::regex_search(it->name, *filter_regex))
+				continue;
+
+			if (arg_list.isSet())
+			{
+				cout << it->name << endl;
+				continue;
+			}
 
 			printf("%-60s",it->name); cout.flush();
 
 			try
 			{
-				const double t = it->func(it->arg1,it->arg2); // Run it.
+				for (unsigned int i=0;i<nWarmup;i++)
+					it->func(it->arg1,it->arg2);
+
+				// Each run returns the time of one execution of the tested code:
+				std::vector<double> samples;
+				CTicTac tictac;
+				tictac.Tic();
+				for (unsigned int i=0;i<nRepetitions;i++)
+				{
+					samples.push_back( it->func(it->arg1,it->arg2) );
+					if (max_time>0 && tictac.Tac()>max_time)
+						break;
+				}
+
+				TPerfStats st;
+				st.name = it->name;
+				computePerfStats(samples, st);
+				all_stats.push_back(st);
+				const double t = st.median;
 
 				mrpt::system::setConsoleColor(CONCOL_GREEN);
 				cout << mrpt::system::intervalFormat(t);
 				mrpt::system::setConsoleColor(CONCOL_NORMAL);
+				if (st.repetitions>1)
+					cout << mrpt::format(" (p10: %s p90: %s cv: %.01f%% n=%u)",
+						mrpt::system::intervalFormat(st.p10).c_str(),
+						mrpt::system::intervalFormat(st.p90).c_str(),
+						st.mean>0 ? 100.0*st.stddev/st.mean : 0.0,
+						static_cast<unsigned int>(st.repetitions));
+
+				std::map<std::string,double>::const_iterator itBase = baseline.find(st.name);
+				if (itBase!=baseline.end() && itBase->second>0)
+				{
+					const double change = t/itBase->second - 1.0;
+					const bool is_regression = change>threshold;
+					if (is_regression) nRegressions++;
+					mrpt::system::setConsoleColor(is_regression ? CONCOL_RED : (change < -threshold ? CONCOL_GREEN : CONCOL_NORMAL));
+					cout << mrpt::format(" [%+.01f%% vs baseline]", 100.0*change);
+					mrpt::system::setConsoleColor(CONCOL_NORMAL);
+				}
 				cout << endl;
 
 				// Make list of all data:
@@ -182,10 +293,13 @@ int main(int argc, char **argv)
 
 				if (doLog)
 				{
-					fo.printf("<tr> <td>%s</td> <td align=\"right\">%s</td> <td align=\"right\">%sHz</td>  </tr>\n",
+					fo.printf("<tr> <td>%s</td> <td align=\"right\">%s</td> <td align=\"right\">%sHz</td> <td align=\"right\">%s / %s / %s</td> </tr>\n",
 						it->name,
 						mrpt::system::intervalFormat(t).c_str(),
-						mrpt::system::unitsFormat(1.0/t).c_str());
+						mrpt::system::unitsFormat(st.rate()).c_str(),
+						mrpt::system::intervalFormat(st.min).c_str(),
+						mrpt::system::intervalFormat(st.p90).c_str(),
+						mrpt::system::intervalFormat(st.max).c_str());
 				}
 			}
 			catch (std::exception &e)
@@ -194,6 +308,9 @@ int main(int argc, char **argv)
 			}
 		}
 
+		if (arg_list.isSet())
+			return 0;
+
 		// Finish log:
 		if (doLog)
 		{
@@ -229,36 +346,25 @@ int main(int argc, char **argv)
 			cout << endl << "Checkout the logfile: " << filName << endl;
 		}
 
+		if (arg_json.isSet())
+		{
+			std::vector<std::pair<std::string,std::string> > context;
+			context.push_back(std::make_pair("date", "\""+mrpt::system::dateTimeLocalToString(now())+"\""));
+			context.push_back(std::make_pair("mrpt_version", "\""+MRPT_getVersion()+"\""));
+			context.push_back(std::make_pair("compiler", std::string("\"")+getCompilerName()+"\""));
+			context.push_back(std::make_pair("word_size", mrpt::format("%i",int(MRPT_WORD_SIZE))));
+			context.push_back(std::make_pair("repetitions", mrpt::format("%u",nRepetitions)));
+			context.push_back(std::make_pair("warmup", mrpt::format("%u",nWarmup)));
+			if (savePerfStatsJSON(arg_json.getValue(), context, all_stats))
+				cout << "Saved statistics to: " << arg_json.getValue() << endl;
+			else cerr << "Error saving statistics to: " << arg_json.getValue() << endl;
+		}
+
 		// Save to perf-data dir?
 		if (HAVE_PERF_DATA_DIR)
 		{
 			const char* version_postfix = arg_release.isSet() ? "":"dev";
 
-			// Macros to create strings with the compiler version:
-#define ___STR2__(x) #x
-#define ___STR1__(x) ___STR2__(x)
-#define COMP_VER(NAME,MAJ,MIN,PATCH)  NAME ___STR1__(MAJ) ___STR1__(MIN)  ___STR1__(PATCH)
-
-#if defined(_MSC_VER)
-#		if _MSC_VER==1700
-			const char* compiler_name = "MSVC2012";
-#		elif _MSC_VER==1800
-			const char* compiler_name = "MSVC2013";
-#		elif _MSC_VER==1900
-			const char* compiler_name = "MSVC2015";
-#		elif _MSC_VER==1910
-			const char* compiler_name = "MSVC2017";
-#		else
-			const char* compiler_name = "MSVC";
-#		endif
-#elif defined(__clang__)
-			const char* compiler_name = COMP_VER("CLANG",__clang_major__,__clang_minor__,__clang_patchlevel__);
-#elif defined(__GNUC__)
-			const char* compiler_name = COMP_VER("GCC",__GNUC__,__GNUC_MINOR__ ,__GNUC_PATCHLEVEL__);
-#else
-			const char* compiler_name = "unknowncompiler";
-#endif
-
 			const string fil_name =
 				PERF_DATA_DIR +
 				mrpt::format("/perf-results-%i.%i.%i%s-%s-%ibit.dat",
@@ -266,13 +372,25 @@ int main(int argc, char **argv)
 					int( (MRPT_VERSION >> 4) & 0x0F ),
 					int( (MRPT_VERSION >> 0) & 0x0F ),
 					version_postfix,
-					compiler_name,
+					getCompilerName(),
 					int(MRPT_WORD_SIZE) );
 			cout << "Saving perf-data to: " << fil_name << endl;
 			CFileOutputStream f( fil_name );
 			f << all_perf_data;
 		}
 
+		if (!baseline.empty())
+		{
+			if (nRegressions)
+			{
+				setConsoleColor(CONCOL_RED,true);
+				std::cerr << nRegressions << " test(s) slower than the baseline by more than " << arg_threshold.getValue() << "%" << std::endl;
+				setConsoleColor(CONCOL_NORMAL,true);
+				return 2;
+			}
+			cout << "No regressions over the baseline." << endl;
+		}
+
 		return 0;
 	}
 	catch (std::exception &e)
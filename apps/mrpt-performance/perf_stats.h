@@ -0,0 +1,265 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#ifndef MRPTPERFAPP_PERF_STATS_H
+#define MRPTPERFAPP_PERF_STATS_H
+
+#include <mrpt/utils/CFileOutputStream.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/** Statistics of the repeated runs of one test. All times in seconds. */
+struct TPerfStats
+{
+	TPerfStats() : repetitions(0), min(0), max(0), mean(0), stddev(0), median(0), p10(0), p90(0) { }
+
+	std::string name;
+	size_t repetitions;
+	double min, max, mean, stddev;
+	double median, p10, p90;
+
+	/** Number of executions per second, from the median time */
+	double rate() const { return median>0 ? 1.0/median : 0.0; }
+};
+
+/** Percentile (0-100) of an already sorted, non-empty vector, with linear interpolation between samples */
+inline double perf_percentile(const std::vector<double> &sorted, double pct)
+{
+	const double pos = 0.01*pct*(sorted.size()-1);
+	const size_t i0 = static_cast<size_t>(std::floor(pos));
+	const size_t i1 = std::min(i0+1, sorted.size()-1);
+	return sorted[i0] + (pos-i0)*(sorted[i1]-sorted[i0]);
+}
+
+inline void computePerfStats(std::vector<double> samples, TPerfStats &s)
+{
+	s.repetitions = samples.size();
+	if (samples.empty()) return;
+	std::sort(samples.begin(), samples.end());
+	s.min = samples.front();
+	s.max = samples.back();
+	s.median = perf_percentile(samples, 50);
+	s.p10 = perf_percentile(samples, 10);
+	s.p90 = perf_percentile(samples, 90);
+	double sum=0, sum2=0;
+	for (size_t i=0;i<samples.size();i++) { sum+=samples[i]; sum2+=samples[i]*samples[i]; }
+	s.mean = sum/samples.size();
+	s.stddev = samples.size()>1 ? std::sqrt(std::max(0.0, (sum2-sum*s.mean)/(samples.size()-1))) : 0.0;
+}
+
+inline std::string perf_json_escape(const std::string &s)
+{
+	std::string r;
+	for (size_t i=0;i<s.size();i++)
+	{
+		const char c = s[i];
+		if (c=='"' || c=='\\') { r+='\\'; r+=c; }
+		else if (static_cast<unsigned char>(c)<0x20) r+=mrpt::format("\\u%04x", static_cast<int>(c));
+		else r+=c;
+	}
+	return r;
+}
+
+/** Saves the results as a JSON file: a "context" object with the description of the run (a list of key-value pairs,
+  * values are written verbatim so strings must come already quoted) and a "benchmarks" array, one test per line.
+  * \return false on any error opening the file */
+inline bool savePerfStatsJSON(
+	const std::string &fil,
+	const std::vector<std::pair<std::string,std::string> > &context,
+	const std::vector<TPerfStats> &stats)
+{
+	mrpt::utils::CFileOutputStream f;
+	if (!f.open(fil)) return false;
+
+	f.printf("{\n  \"context\": {\n");
+	for (size_t i=0;i<context.size();i++)
+		f.printf("    \"%s\": %s%s\n", context[i].first.c_str(), context[i].second.c_str(), i+1<context.size() ? ",":"");
+	f.printf("  },\n  \"benchmarks\": [\n");
+	for (size_t i=0;i<stats.size();i++)
+	{
+		const TPerfStats &s = stats[i];
+		f.printf("    {\"name\": \"%s\", \"repetitions\": %u, \"time_unit\": \"s\", \"median\": %.9g, \"mean\": %.9g, \"stddev\": %.9g, "
+			"\"min\": %.9g, \"max\": %.9g, \"p10\": %.9g, \"p90\": %.9g, \"rate_hz\": %.9g}%s\n",
+			perf_json_escape(s.name).c_str(), static_cast<unsigned int>(s.repetitions),
+			s.median, s.mean, s.stddev, s.min, s.max, s.p10, s.p90, s.rate(),
+			i+1<stats.size() ? ",":"");
+	}
+	f.printf("  ]\n}\n");
+	return true;
+}
+
+/** A minimal JSON reader, enough for loadPerfBaselineJSON(): values which are not needed are parsed and skipped. */
+class CPerfJSONReader
+{
+public:
+	CPerfJSONReader(const std::string &text) : m_txt(text), m_pos(0) { }
+
+	/** Reads the "benchmarks" array of the top-level object: test name => median time (seconds) */
+	void readBenchmarks(std::map<std::string,double> &out_medians)
+	{
+		bool found = false;
+		expect('{');
+		if (!tryConsume('}'))
+		{
+			do
+			{
+				const std::string key = readString();
+				expect(':');
+				if (key!="benchmarks") { skipValue(); continue; }
+				found = true;
+				expect('[');
+				if (!tryConsume(']'))
+				{
+					do readBenchmark(out_medians); while (tryConsume(','));
+					expect(']');
+				}
+			} while (tryConsume(','));
+			expect('}');
+		}
+		skipSpaces();
+		if (m_pos!=m_txt.size()) error("unexpected data after the top-level object");
+		if (!found) error("no \"benchmarks\" array");
+	}
+
+private:
+	const std::string &m_txt;
+	size_t m_pos;
+
+	void error(const std::string &msg) const
+	{
+		throw std::runtime_error(mrpt::format("JSON error at offset %u: %s", static_cast<unsigned int>(m_pos), msg.c_str()));
+	}
+	void skipSpaces() { while (m_pos<m_txt.size() && std::isspace(static_cast<unsigned char>(m_txt[m_pos]))) m_pos++; }
+	bool tryConsume(char c)
+	{
+		skipSpaces();
+		if (m_pos<m_txt.size() && m_txt[m_pos]==c) { m_pos++; return true; }
+		return false;
+	}
+	void expect(char c) { if (!tryConsume(c)) error(mrpt::format("expected '%c'", c)); }
+
+	std::string readString()
+	{
+		expect('"');
+		std::string r;
+		for (;;)
+		{
+			if (m_pos>=m_txt.size()) error("unterminated string");
+			const char c = m_txt[m_pos++];
+			if (c=='"') return r;
+			if (c!='\\') { r+=c; continue; }
+			if (m_pos>=m_txt.size()) error("unterminated string");
+			const char e = m_txt[m_pos++];
+			switch (e)
+			{
+			case 'b': r+='\b'; break;
+			case 'f': r+='\f'; break;
+			case 'n': r+='\n'; break;
+			case 'r': r+='\r'; break;
+			case 't': r+='\t'; break;
+			case 'u':
+				if (m_pos+4>m_txt.size()) error("bad \\u escape");
+				r+=static_cast<char>(std::strtol(m_txt.substr(m_pos,4).c_str(),NULL,16)); // Test names are ASCII
+				m_pos+=4;
+				break;
+			default: r+=e;
+			};
+		}
+	}
+	double readNumber()
+	{
+		skipSpaces();
+		const char *start = m_txt.c_str()+m_pos;
+		char *end = NULL;
+		const double v = std::strtod(start, &end);
+		if (end==start) error("expected a number");
+		m_pos += end-start;
+		return v;
+	}
+	void skipValue()
+	{
+		skipSpaces();
+		if (m_pos>=m_txt.size()) error("unexpected end of file");
+		const char c = m_txt[m_pos];
+		if (c=='"') readString();
+		else if (c=='{')
+		{
+			m_pos++;
+			if (!tryConsume('}')) { do { readString(); expect(':'); skipValue(); } while (tryConsume(',')); expect('}'); }
+		}
+		else if (c=='[')
+		{
+			m_pos++;
+			if (!tryConsume(']')) { do skipValue(); while (tryConsume(',')); expect(']'); }
+		}
+		else if (m_txt.compare(m_pos,4,"true")==0 || m_txt.compare(m_pos,4,"null")==0) m_pos+=4;
+		else if (m_txt.compare(m_pos,5,"false")==0) m_pos+=5;
+		else readNumber();
+	}
+	void readBenchmark(std::map<std::string,double> &out_medians)
+	{
+		std::string name, time_unit="s";
+		double median = 0;
+		bool has_name=false, has_median=false;
+		expect('{');
+		if (!tryConsume('}'))
+		{
+			do
+			{
+				const std::string key = readString();
+				expect(':');
+				if (key=="name") { name = readString(); has_name=true; }
+				else if (key=="median") { median = readNumber(); has_median=true; }
+				else if (key=="time_unit") time_unit = readString();
+				else skipValue();
+			} while (tryConsume(','));
+			expect('}');
+		}
+		if (!has_name || !has_median) error("benchmark entry without \"name\" or \"median\"");
+
+		if (time_unit=="ms") median*=1e-3;
+		else if (time_unit=="us") median*=1e-6;
+		else if (time_unit=="ns") median*=1e-9;
+		else if (time_unit!="s") error("unknown time_unit: "+time_unit);
+		out_medians[name] = median;
+	}
+};
+
+/** Loads the median time of each test from the "benchmarks" array of a JSON file, as saved by savePerfStatsJSON()
+  * (each entry must have, at least, "name" and "median"; "time_unit" may be "s" (default), "ms", "us" or "ns").
+  * \exception std::runtime_error If the file can not be read, is not valid JSON or has no results */
+inline void loadPerfBaselineJSON(const std::string &fil, std::map<std::string,double> &out_medians)
+{
+	out_medians.clear();
+	std::ifstream f(fil.c_str());
+	if (!f.is_open())
+		throw std::runtime_error(mrpt::format("Cannot open baseline file: %s", fil.c_str()));
+	const std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+	try
+	{
+		CPerfJSONReader(text).readBenchmarks(out_medians);
+	}
+	catch (std::exception &e)
+	{
+		throw std::runtime_error(mrpt::format("Error loading baseline results from %s: %s", fil.c_str(), e.what()));
+	}
+	if (out_medians.empty())
+		throw std::runtime_error(mrpt::format("Baseline file has an empty \"benchmarks\" array: %s", fil.c_str()));
+}
+
+#endif
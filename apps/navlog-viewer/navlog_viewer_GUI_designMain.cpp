@@ -816,7 +816,7 @@ void navlog_viewer_GUI_designDialog::OnslidLogCmdScroll(wxScrollEvent& event)
 			std::stringstream ss;
 			ss << "Performance: ";
 			for (size_t i=0;i<log.infoPerPTG.size();i++)
-				ss << "PTG#" << i << mrpt::format(" TPObs:%ss HoloNav:%ss |", mrpt::system::unitsFormat(log.infoPerPTG[i].timeForTPObsTransformation).c_str(),mrpt::system::unitsFormat(log.infoPerPTG[i].timeForHolonomicMethod).c_str());
+				ss << "PTG#" << i << mrpt::format(" TPObs:%ss HoloNav:%ss Total:%ss |", mrpt::system::unitsFormat(log.infoPerPTG[i].timeForTPObsTransformation).c_str(),mrpt::system::unitsFormat(log.infoPerPTG[i].timeForHolonomicMethod).c_str(),mrpt::system::unitsFormat(log.infoPerPTG[i].timeForPTGEvaluation).c_str());
 			ADD_WIN_TEXTMSG(ss.str());
 		}
 
@@ -29,6 +29,7 @@
 #include <mrpt/obs/CActionRobotMovement2D.h>
 #include <mrpt/obs/CActionCollection.h>
 #include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CRawlogPrefetchReader.h>
 #include <mrpt/maps/CSimpleMap.h>
 #include <mrpt/maps/COccupancyGridMap2D.h>
 #include <mrpt/maps/CMultiMetricMap.h>
@@ -337,7 +338,7 @@ void do_pf_localization(const std::string &ini_fil, const std::string &cmdline_r
 			// Load the rawlog:
 			// --------------------------
 			printf("Opening the rawlog file...");
-			CFileGZInputStream rawlog_in_stream(RAWLOG_FILE);
+			CRawlogPrefetchReader rawlog_in_stream(RAWLOG_FILE);
 			printf("OK\n");
 
 			// The experiment directory is:
@@ -448,8 +449,7 @@ void do_pf_localization(const std::string &ini_fil, const std::string &cmdline_r
 				CSensoryFramePtr     observations;
 				CObservationPtr 	 obs;
 
-				if (!CRawlog::getActionObservationPairOrObservation(
-					rawlog_in_stream,      // In stream
+				if (!rawlog_in_stream.getActionObservationPairOrObservation(
 					action,	observations,  // Out pair <action,SF>, or:
 					obs,                   // Out single observation
 					rawlogEntry            // In/Out index counter.
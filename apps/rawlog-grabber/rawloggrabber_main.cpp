@@ -17,15 +17,17 @@
   -----------------------------------------------------------------------------*/
 
 #include <mrpt/hwdrivers/CGenericSensor.h>
+#include <mrpt/hwdrivers/CObservationsMerger.h>
 #include <mrpt/utils/CConfigFile.h>
-#include <mrpt/utils/CFileGZOutputStream.h>
 #include <mrpt/utils/CImage.h>
 #include <mrpt/utils/round.h>
 #include <mrpt/obs/CActionCollection.h>
 #include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/obs/CRawlogAsyncWriter.h>
 #include <mrpt/obs/CObservationOdometry.h>
 #include <mrpt/obs/CObservationGPS.h>
 #include <mrpt/obs/CObservationIMU.h>
+#include <mrpt/obs/CObservation3DRangeScan.h>
 #include <mrpt/obs/CActionRobotMovement2D.h>
 #include <mrpt/system/os.h>
 #include <mrpt/system/filesystem.h>
@@ -51,19 +53,33 @@ struct TThreadParams
 {
 	CConfigFile		*cfgFile;
 	string			sensor_label;
+	CObservationsChannel	*channel;  //!< Where the sensor thread sends its observations
 };
 
 void SensorThread(TThreadParams params);
 
 
 
-CGenericSensor::TListObservations		global_list_obs;
-synch::CCriticalSection					cs_global_list_obs;
+// Observations from all sensor threads, merged in timestamp order:
+CObservationsMerger						global_obs_merger;
 
 bool									allThreadsMustExit = false;
 
 string 		rawlog_ext_imgs_dir;		// Directory where to save externally stored images, only for CCameraSensor's.
 
+void dumpSensorQueuesStats()
+{
+	std::vector<CObservationsMerger::TChannelStats> stats;
+	global_obs_merger.getStats(stats);
+	for (size_t i=0;i<stats.size();i++)
+		cout << format("  [%s] queued: %u dropped: %u late: %u latency (mean/max): %.03f/%.03f ms\n",
+			stats[i].label.c_str(),
+			static_cast<unsigned int>(stats[i].queue.num_pushed),
+			static_cast<unsigned int>(stats[i].queue.num_dropped),
+			static_cast<unsigned int>(stats[i].num_late),
+			1e3*stats[i].queue.latency_mean, 1e3*stats[i].queue.latency_max);
+}
+
 // ------------------------------------------------------
 //					MAIN THREAD
 // ------------------------------------------------------
@@ -97,6 +113,10 @@ int main(int argc, char **argv)
 		bool			use_sensoryframes = false;
 		int				GRABBER_PERIOD_MS = 1000;
 		int 			rawlog_GZ_compress_level  = 1;  // 0: No compress, 1-9: compress level
+		int 			rawlog_GZ_compress_threads = 1; // 0: All CPU cores, 1: Sequential compression, >1: Parallel compression threads
+		int				sensor_queue_len = 1024;         // Capacity of the queue between each sensor thread and the main thread
+		string			sensor_queue_overflow_policy = "block"; // "block": the sensor thread waits for room in the queue; "drop": discard new observations
+		double			merge_max_delay = 1.0;           // Seconds: maximum time to wait for observations from slow sensors to sort them by timestamp
 
 		MRPT_LOAD_CONFIG_VAR( rawlog_prefix, string, iniFile, GLOBAL_SECTION_NAME );
 		MRPT_LOAD_CONFIG_VAR( time_between_launches, int, iniFile, GLOBAL_SECTION_NAME );
@@ -105,6 +125,18 @@ int main(int argc, char **argv)
 		MRPT_LOAD_CONFIG_VAR( GRABBER_PERIOD_MS, int, iniFile, GLOBAL_SECTION_NAME );
 
 		MRPT_LOAD_CONFIG_VAR( rawlog_GZ_compress_level, int, iniFile, GLOBAL_SECTION_NAME );
+		MRPT_LOAD_CONFIG_VAR( rawlog_GZ_compress_threads, int, iniFile, GLOBAL_SECTION_NAME );
+		MRPT_LOAD_CONFIG_VAR( sensor_queue_len, int, iniFile, GLOBAL_SECTION_NAME );
+		MRPT_LOAD_CONFIG_VAR( sensor_queue_overflow_policy, string, iniFile, GLOBAL_SECTION_NAME );
+		MRPT_LOAD_CONFIG_VAR( merge_max_delay, double, iniFile, GLOBAL_SECTION_NAME );
+
+		ASSERTMSG_(sensor_queue_overflow_policy=="block" || sensor_queue_overflow_policy=="drop", "sensor_queue_overflow_policy must be either 'block' or 'drop'")
+		ASSERT_(sensor_queue_len>0)
+		global_obs_merger.setMaxDelay(merge_max_delay);
+
+		// Compact serialization of 3D range scans (see CObservation3DRangeScan::COMPACT_RANGE_UNITS):
+		CObservation3DRangeScan::COMPACT_RANGE_UNITS = iniFile.read_float(GLOBAL_SECTION_NAME,"rawlog_3D_range_units",0);
+		CObservation3DRangeScan::COMPACT_SKIP_POINTS3D = iniFile.read_bool(GLOBAL_SECTION_NAME,"rawlog_3D_skip_points",false);
 
 		// Build full rawlog file name:
 		string	rawlog_postfix = "_";
@@ -154,6 +186,8 @@ int main(int argc, char **argv)
 			TThreadParams	threParms;
 			threParms.cfgFile		= &iniFile;
 			threParms.sensor_label	= *it;
+			threParms.channel		= global_obs_merger.addChannel(*it, sensor_queue_len,
+				sensor_queue_overflow_policy=="block" ? CObservationsChannel::opBlock : CObservationsChannel::opDrop );
 
 			TThreadHandle	thre = createThread(SensorThread, threParms);
 
@@ -164,29 +198,37 @@ int main(int argc, char **argv)
 		// ----------------------------------------------
 		// Run:
 		// ----------------------------------------------
-		CFileGZOutputStream	out_file;
+		// Objects are serialized and compressed in a background thread, so this loop is not delayed by the disk I/O:
+		CRawlogAsyncWriter	out_file;
 
-		out_file.open( rawlog_filename, rawlog_GZ_compress_level );
+		if (!out_file.open( rawlog_filename, rawlog_GZ_compress_level, 64 /*queue length*/, std::max(0,rawlog_GZ_compress_threads) ))
+			THROW_EXCEPTION_FMT("Error creating output rawlog file: '%s'", rawlog_filename.c_str())
 
 		CSensoryFrame						curSF;
 		CGenericSensor::TListObservations	copy_of_global_list_obs;
 
 		cout << endl << "Press any key to exit program" << endl;
-		while (!os::kbhit() && !allThreadsMustExit)
+		bool last_pass = false;
+		for (;;)
 		{
-			// See if we have observations and process them:
+			if (os::kbhit() || allThreadsMustExit)
 			{
-				synch::CCriticalSectionLocker	lock (&cs_global_list_obs);
-				copy_of_global_list_obs.clear();
-
-				if (!global_list_obs.empty())
-				{
-					CGenericSensor::TListObservations::iterator itEnd = global_list_obs.begin();
-					std::advance( itEnd, global_list_obs.size() / 2 );
-					copy_of_global_list_obs.insert(global_list_obs.begin(),itEnd );
-					global_list_obs.erase(global_list_obs.begin(), itEnd);
+				if (allThreadsMustExit) {
+					cerr << "[main thread] Ended due to other thread signal to exit application." << endl;
 				}
-			}	// End of cs lock
+
+				// Wait all threads, so their last observations are saved below:
+				// ----------------------------
+				allThreadsMustExit = true;
+				mrpt::system::sleep(300);
+				cout << endl << "Waiting for all threads to close..." << endl;
+				for (vector<TThreadHandle>::iterator th=lstThreads.begin();th!=lstThreads.end();++th)
+					joinThread( *th );
+				last_pass = true;
+			}
+
+			// See if we have observations and process them, sorted by timestamp (all the pending ones in the last pass):
+			global_obs_merger.merge(copy_of_global_list_obs, last_pass);
 
 			if (use_sensoryframes)
 			{
@@ -314,7 +356,7 @@ int main(int argc, char **argv)
 
 				for (CGenericSensor::TListObservations::iterator it=copy_of_global_list_obs.begin();it!=copy_of_global_list_obs.end();++it)
 				{
-					out_file << *(it->second);
+					out_file << it->second;
 
 					// Show GPS mode:
 					if (hwdrivers_verbose)
@@ -346,23 +388,18 @@ int main(int argc, char **argv)
 					cout << "[" << dateTimeToString(now()) << "] Saved " << copy_of_global_list_obs.size() << " objects." << endl;
 				}
 			}
+			if (last_pass)
+				break;
+			if (hwdrivers_verbose)
+				dumpSensorQueuesStats();
 			sleep(GRABBER_PERIOD_MS);
 		}
 
-		if (allThreadsMustExit) {
-			cerr << "[main thread] Ended due to other thread signal to exit application." << endl;
-		}
-
 		// Flush file to disk:
 		out_file.close();
 
-		// Wait all threads:
-		// ----------------------------
-		allThreadsMustExit = true;
-		mrpt::system::sleep(300);
-		cout << endl << "Waiting for all threads to close..." << endl;
-		for (vector<TThreadHandle>::iterator th=lstThreads.begin();th!=lstThreads.end();++th)
-			joinThread( *th );
+		cout << "Sensor queues statistics:\n";
+		dumpSensorQueuesStats();
 
 		return 0;
 	} catch (std::exception &e)
@@ -422,10 +459,8 @@ void SensorThread(TThreadParams params)
 			CGenericSensor::TListObservations	lstObjs;
 			sensor->getObservations( lstObjs );
 
-			{
-				synch::CCriticalSectionLocker	lock (&cs_global_list_obs);
-				global_list_obs.insert( lstObjs.begin(), lstObjs.end() );
-			}
+			for (CGenericSensor::TListObservations::const_iterator it=lstObjs.begin();it!=lstObjs.end();++it)
+				params.channel->push(it->first, it->second);
 
 			lstObjs.clear();
 
@@ -437,8 +472,10 @@ void SensorThread(TThreadParams params)
 				sleep(At_rem_ms);
 		}
 
+		CObservationsChannel::TStats sensor_queue_stats;
+		sensor->getObservationsQueueStats(sensor_queue_stats);
 		sensor.clear();
-		cout << format("[thread_%s] Closing...",params.sensor_label.c_str()) << endl;
+		cout << format("[thread_%s] Closing... (%u objects dropped in the sensor queue)",params.sensor_label.c_str(), static_cast<unsigned int>(sensor_queue_stats.num_dropped)) << endl;
 	}
 	catch (std::exception &e)
 	{
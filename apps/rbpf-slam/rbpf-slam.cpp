@@ -22,6 +22,7 @@
 #include <mrpt/obs/CActionRobotMovement3D.h>
 #include <mrpt/obs/CRawlog.h>
 #include <mrpt/utils/CFileGZInputStream.h>
+#include <mrpt/obs/CRawlogPrefetchReader.h>
 #include <mrpt/utils/CFileGZOutputStream.h>
 #include <mrpt/utils/CConfigFile.h>
 #include <mrpt/gui/CDisplayWindow3D.h>
@@ -190,7 +191,7 @@ void MapBuilding_RBPF()
 	char								strFil[1000];
 
 	size_t								rawlogEntry = 0;
-	CFileGZInputStream					rawlogFile( RAWLOG_FILE );
+	CRawlogPrefetchReader				rawlogFile( RAWLOG_FILE );
 
 	// ---------------------------------
 	//		MapPDF opts
@@ -320,7 +321,7 @@ void MapBuilding_RBPF()
 
 		// Load action/observation pair from the rawlog:
 		// --------------------------------------------------
-		if (! CRawlog::readActionObservationPair( rawlogFile, action, observations, rawlogEntry) )
+		if (! rawlogFile.readActionObservationPair( action, observations, rawlogEntry) )
 			break; // file EOF
 
 		if (rawlogEntry>=rawlog_offset)
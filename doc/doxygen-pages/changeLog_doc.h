@@ -23,6 +23,12 @@
 			- New menu operation: "Edit" -> "Rename selected observation"
 			- mrpt::obs::CObservation3DRangeScan pointclouds are now shown in local coordinates wrt to the vehicle/robot, not to the sensor.
 		- [rawlog-edit](http://www.mrpt.org/list-of-mrpt-apps/application-rawlog-edit/): New flag: `--txt-externals`
+		- [rawlog-grabber](http://www.mrpt.org/list-of-mrpt-apps/application-rawlog-grabber/):
+			- Observations are written to disk by mrpt::obs::CRawlogAsyncWriter in a background thread, optionally with parallel gzip compression (new option `rawlog_GZ_compress_threads`).
+			- Each sensor thread queues its observations in a lock-free mrpt::hwdrivers::CObservationsChannel, merged in timestamp order by mrpt::hwdrivers::CObservationsMerger. New `[global]` options: `sensor_queue_len`, `sensor_queue_overflow_policy` and `merge_max_delay`. Per-sensor queue statistics are printed at exit.
+			- New options `rawlog_3D_range_units` and `rawlog_3D_skip_points` for the compact serialization of mrpt::obs::CObservation3DRangeScan.
+		- icp-slam, rbpf-slam and pf-localization read the rawlog with mrpt::obs::CRawlogPrefetchReader, which decompresses and deserializes it in a background thread.
+		- mrpt-performance: Each test is now run several times after some warm-up runs, reporting median and percentiles. New flags to filter tests with a regular expression, save the results to JSON and compare them against a baseline.
 	- Changes in libraries:
 		- \ref mrpt_base_grp
 			- New API to interface ZeroMQ: \ref noncstream_serialization_zmq
@@ -33,6 +39,7 @@
 			- New template method: mrpt::utils::CStream::ReadAsAndCastTo
 			- Added missing method mrpt::poses::CPose2D::inverseComposePoint() for consistency with CPose3D
 			- New class mrpt::synch::CCriticalSectionRecursive
+			- New namespace mrpt::system::cpu for runtime detection of CPU features (SSE*, AVX*, NEON) and selection of SIMD kernels with mrpt::system::cpu::CSimdKernel. The SSE2/SSSE3 versions of mrpt::utils::CImage methods and the point cloud kernels in mrpt::math (e.g. mrpt::math::transformPoints()) are now built always and chosen at runtime, including new AVX versions.
 			- New class mrpt::utils::COutputLogger replaces the classes mrpt::utils::CDebugOutputCapable (deprecated) and mrpt::utils::CLog (removed).
 			- New macros for much more versatily logging:
 				- MRPT_LOG_DEBUG(), MRPT_LOG_INFO(), MRPT_LOG_WARN(), MRPT_LOG_ERROR()
@@ -64,9 +71,22 @@
 			- mrpt::utils::CConfigFile and mrpt::utils::CConfigFileMemory now can parse config files with end-of-line backslash to split long strings into several lines.
 			- New class mrpt::poses::FrameTransformer
 			- mrpt::poses classes now have all their constructors from mrpt::math types marked as explicit, to avoid potential ambiguities and unnoticed conversions.
+			- New class mrpt::system::CWorkerThreadsPool, a pool of worker threads to split index ranges into chunks processed in parallel.
+			- New vectorized (SSE2/AVX) point cloud kernels over structure-of-arrays clouds in `<mrpt/math/point_cloud_kernels.h>`: mrpt::math::transformPoints(), mrpt::math::boundingBox(), mrpt::math::squaredDistancesToPoint(), mrpt::math::squaredDistances()
+			- mrpt::math::KDTreeCapable:
+				- New option mrpt::math::KDTreeCapable::TKDTreeSearchParams::incremental to update the KD-tree index as points are appended instead of rebuilding it from scratch.
+				- Queries are now safe to call from several threads at once. New methods kdTreeEnsureIndexBuilt2D() and kdTreeEnsureIndexBuilt3D() to build the index in advance.
+			- mrpt::math::CSparseMatrix::CholeskyDecomp keeps the sparsity pattern of the factorized matrix: new method hasSameStructure(), and update() now checks the whole pattern.
+			- New class mrpt::utils::CMemoryMappedFile for read-only, memory-mapped access to files.
+			- Zero-copy deserialization: new method mrpt::utils::CStream::ReadBufferZeroCopy() and class mrpt::utils::TMemoryBlockOwner. mrpt::utils::CMemoryStream::assignMemorySharedOwner() enables it for memory streams, and mrpt::utils::CImage reads uncompressed images without copying their pixels (see CImage::isSharingData() and CImage::makeSureImageIsWritable()).
+			- mrpt::utils::CFileGZOutputStream::open() can compress in parallel, as independent blocks which are still standard gzip members (new params `num_threads` and `block_size`). mrpt::utils::CFileGZInputStream decompresses such files in parallel.
+			- mrpt::utils::CTimeLogger:
+				- Sections can be registered once with CTimeLogger::registerSection() and timed with the new enter()/leave() overloads for section handles, which take no lock and do no string look-ups.
+				- New methods enableTracing(), saveTraceToChromeJSON() (for `chrome://tracing`), saveTraceToFoldedStacks() (for flamegraph.pl) and clearTrace().
 		- \ref mrpt_bayes_grp
 			- [API change] `verbose` is no longer a field of mrpt::bayes::CParticleFilter::TParticleFilterOptions. Use the setVerbosityLevel() method of the CParticleFilter class itself.
 			- [API change] mrpt::bayes::CProbabilityParticle (which affects all PF-based classes in MRPT) has been greatly simplified via usage of the new mrpt::utils::copy_ptr<> pointee-copy-semantics smart pointer.
+			- New option mrpt::bayes::CParticleFilter::TParticleFilterOptions::numThreads to evaluate the particle likelihoods in parallel. Results do not depend on the number of threads.
 		- \ref mrpt_graphs_grp
 			- New class mrpt::graphs::ScalarFactorGraph, a simple but extensible linear GMRF solver. Refactored from mrpt::maps::CGasConcentrationGridMap2D, etc.
 		- \ref mrpt_gui_grp
@@ -85,6 +105,14 @@
 			- mrpt::maps::CPointsMap `liblas` import/export methods are now in a separate header. See \ref mrpt_maps_liblas_grp and \ref dep-liblas
 			- New class mrpt::maps::CRandomFieldGridMap3D
 			- New class mrpt::maps::CPointCloudFilterByDistance
+			- mrpt::maps::COccupancyGridMap2D:
+				- New overload of computeLikelihoodField_Thrun() to evaluate a points map for many poses at once, with SSE2/AVX2 kernels.
+				- The likelihood field can use a cached, incrementally updated Euclidean distance transform of the grid (new option `LF_useDistanceTransform`, and methods updateDistanceTransform(), invalidateDistanceTransform() and getDistanceTransformValue()). It is also serialized along the map.
+			- mrpt::maps::CPointsMap:
+				- New method getPointsSpan() to use the point cloud kernels of mrpt::math, which are now used in the bulk operations of all point maps (transformations, bounding box, matching, clipping...).
+				- fuseWith() now runs in linear time with the number of correspondences.
+				- New methods getLocalGeometry2D() and getLocalGeometry3D() for the (cached) normals and covariances of the points.
+				- New overload mark_as_modified(size_t) to update the KD-tree incrementally.
 		- \ref mrpt_obs_grp
 			- [ABI change] mrpt::obs::CObservation2DRangeScan
 				- range scan vectors are now protected for safety.
@@ -94,15 +122,28 @@
 				- Now uses more SSE2 optimized code
 				- Depth filters are now available for mrpt::obs::CObservation3DRangeScan::project3DPointsFromDepthImageInto() and  mrpt::obs::CObservation3DRangeScan::convertTo2DScan()
 				- New switch mrpt::obs::CObservation3DRangeScan::EXTERNALS_AS_TEXT for runtime selection of externals format.
+				- Serialization version 9: optional compact storage of range images (mrpt::obs::CObservation3DRangeScan::COMPACT_RANGE_UNITS) and point clouds (mrpt::obs::CObservation3DRangeScan::COMPACT_SKIP_POINTS3D).
+				- Projection look-up tables are kept in a cache shared by all observations, see mrpt::obs::CObservation3DRangeScan::get3DProjLUT(). New parameter mrpt::obs::T3DPointsProjectionParams::decimation.
+				- [API change] The public static member `m_3dproj_lut` has been removed: it was shared by all observations and rebuilt each time the camera parameters changed, which was not thread-safe. The projection tables are now kept in a thread-safe cache, one per camera and image size, and read with mrpt::obs::CObservation3DRangeScan::get3DProjLUT().
 			- mrpt::obs::CObservation2DRangeScan now has an optional field for intensity.
 			- mrpt::obs::CRawLog can now holds objects of arbitrary type, not only actions/observations. This may be useful for richer logs aimed at debugging.
 			- mrpt::obs::CObservationVelodyneScan::generatePointCloud() can now generate the microseconds-precise timestamp for each individual point (new param `generatePerPointTimestamp`).
+			- mrpt::obs::CObservationVelodyneScan::generatePointCloud() can decode the packets in parallel (new field `threads` of TGeneratePointCloudParameters).
+			- New class mrpt::obs::CRawlogIndexed for random, memory-mapped access to the entries of a rawlog file through an index file, including search by timestamp and zero-copy deserialization.
+			- New classes mrpt::obs::CRawlogPrefetchReader and mrpt::obs::CRawlogAsyncWriter, to read and write rawlogs in a background thread.
+			- New method mrpt::maps::CMetricMap::computeObservationLikelihoods() to evaluate the likelihood of an observation for many poses at once.
 		- \ref mrpt_opengl_grp
 			- [ABI change] mrpt::opengl::CAxis now has many new options exposed to configure its look.
 			- mrpt::opengl::CSetOfLines can now optionally show vertices as dots.
 		- \ref mrpt_slam_grp
 			- [API change] mrpt::slam::CMetricMapBuilder::TOptions does not have a `verbose` field anymore. It's supersedded now by the verbosity level of the CMetricMapBuilder class itself.
 			- [API change] getCurrentMetricMapEstimation() renamed mrpt::slam::CMultiMetricMapPDF::getAveragedMetricMapEstimation() to avoid confusions.
+			- mrpt::slam::CICP:
+				- New algorithms mrpt::slam::icpPointToPlane and mrpt::slam::icpGeneralized (Generalized-ICP), in 2D and 3D.
+				- The closest-point searches of the new methods run in parallel (new options `numThreads` and `normals_num_neighbors`).
+			- New grid alignment method mrpt::slam::CGridMapAligner::amBranchAndBound: a multi-resolution branch-and-bound correlative scan matcher (options `bb_*`).
+			- Particle filters in mrpt::slam::PF_implementation evaluate the likelihood of all particles in one batch (see PF_SLAM_computeObservationLikelihoodForParticles()), in parallel if enabled, and the Monte Carlo localization classes pass the batch to the map.
+			- mrpt::slam::CMetricMapBuilderICP uses incremental KD-tree updates for its point maps.
 		- \ref mrpt_hwdrivers_grp
 			- mrpt::hwdrivers::CGenericSensor: external image format is now `png` by default instead of `jpg` to avoid losses.
 			- [ABI change] mrpt::hwdrivers::COpenNI2Generic:
@@ -114,6 +155,8 @@
 				- mrpt::hwdrivers::CBoardDLMS
 				- mrpt::hwdrivers::CPtuHokuyo
 			- mrpt::hwdrivers::CHokuyoURG no longer as a "verbose" field. It's superseded now by the COutputLogger interface.
+			- New classes mrpt::hwdrivers::CObservationsChannel, a bounded lock-free multi-producer queue of observations, and mrpt::hwdrivers::CObservationsMerger, to merge several of them in timestamp order.
+			- mrpt::hwdrivers::CGenericSensor keeps its observations in a CObservationsChannel: `max_queue_len` is now enforced by dropping new observations when the queue is full. New method getObservationsQueueStats().
 		- \ref mrpt_maps_grp
 			- mrpt::maps::CMultiMetricMapPDF added method CMultiMetricMapPDF::prediction_and_update_pfAuxiliaryPFStandard().
 		- \ref mrpt_nav_grp
@@ -125,12 +168,19 @@
 				- Parameters are no longer passed via a mrpt::utils::TParameters class, but via a mrpt::utils::CConfigFileBase which makes parameter passing to PTGs much more maintainable and consistent.
 				- PTGs now have a score_priority field to manually set hints about preferences for path planning.
 				- PTGs are now mrpt::utils::CLoadableOptions classes
+			- mrpt::nav::CAbstractPTGBasedReactive can evaluate the PTGs in parallel in each navigation step (see new parameter `ptg_eval_threads`). Log records now include the total time to evaluate each PTG (mrpt::nav::CLogFileRecord::TInfoPerPTG::timeForPTGEvaluation).
+			- New method mrpt::nav::CParameterizedTrajectoryGenerator::updateTPObstacleBatch() to update the TP-Obstacles with a whole set of points at once. Reactive navigators use it for much faster processing of dense point clouds with collision grid-based PTGs.
+			- [ABI change] Collision grids of mrpt::nav::CPTG_DiffDrive_CollisionGridBased are now stored in a compact (CSR) layout, and cache files (now non-compressed, `*.dat` instead of `*.dat.gz`) are memory-mapped: loading them is nearly instantaneous and the memory is shared between all the processes using them. Cache files are discarded if the robot shape or any PTG parameter changes.
+			- mrpt::nav::PlannerRRT_SE2_TPS: nearest-node queries use a bucket grid index in mrpt::nav::TMoveTree (new methods `getNodesWithinXYDistance()` and `changeParent()`), obstacles are clipped with the KD-tree of the map, the PTGs can be evaluated in parallel (new parameter `ptg_eval_threads`), and the new RRT* mode (parameter `rewiringRadius`) keeps improving the best path while planning, which can be followed by overriding `onNewBestSolution()`.
+			- New incremental grid planner mrpt::nav::PlannerDStarLite2D (D* Lite), which keeps its search between calls and only repairs it around changed cells or the new robot position. It uses 8-connected moves, a clearance layer around obstacles and an optional bounded-memory mode for large maps.
 			- \ref mrpt_graphslam_grp
 				 - Extend mrpt-graphslam lib to execute simulated/real-time graphSLAM.
 				 	 mrpt-graphslam supports 2D/3D execution of graphSLAM, utilizing
 				 	 LaserScans, odometry information.
 				 - Develop application `graphslam-engine` that executes graphSLAM via
 				 	 the mrpt-graphslam lib
+				 - New incremental (iSAM-style) optimizer mrpt::graphslam::optimizers::CIncrementalGSO, which only relinearizes and refactorizes the part of the graph affected by new edges. It can be selected in `graphslam-engine` as `CIncrementalGSO`.
+				 - mrpt::graphslam::optimize_graph_spa_levmarq() can reuse the symbolic Cholesky analysis between calls (new optional argument mrpt::graphslam::TSpaLevMarqSolverCache) and computes the Jacobians in parallel (new parameter `num_threads`, also available in mrpt::graphslam::optimizers::CLevMarqGSO).
 			- New classes:
 				- mrpt::nav::CMultiObjectiveMotionOptimizerBase
 	- Changes in build system:
@@ -109,6 +109,13 @@ namespace mrpt
 				bool pfAuxFilterStandard_FirstStageWeightsMonteCarlo;
 
 				bool pfAuxFilterOptimal_MLE; //!< (Default=false) In the algorithm "CParticleFilter::pfAuxiliaryPFOptimal", if set to true, do not perform rejection sampling, but just the most-likely (ML) particle found in the preliminary weight-determination stage.
+
+				/** (Default=1) Number of threads used to evaluate the observation likelihood of particles (1=single-threaded, 0=as many as CPU cores).
+				  *  Likelihoods are stored per particle and reduced in a fixed order, so results do not depend on this number.
+				  *  Values other than 1 require the metric maps to be safe for concurrent likelihood evaluation (e.g. COccupancyGridMap2D requires `likelihoodOptions.enableLikelihoodCache=false`).
+				  * \note (New in MRPT 1.5.0)
+				  */
+				unsigned int numThreads;
 			};
 
 			/** Statistics for being returned from the "execute" method. */
@@ -363,6 +363,7 @@ namespace mrpt
 				css * m_symbolic_structure;
 				csn * m_numeric_structure;
 				const CSparseMatrix *m_originalSM;  //!< A const reference to the original matrix used to build this decomposition.
+				std::vector<int> m_pattern_p, m_pattern_i; //!< A copy of the sparsity pattern (column pointers and row indices) of the decomposed matrix, to validate update()
 
 			public:
 				/** Constructor from a square definite-positive sparse matrix A, which can be use to solve Ax=b
@@ -393,9 +394,16 @@ namespace mrpt
 				void backsub(const double *b, double *result, const size_t N) const;
 
 				/** Update the Cholesky factorization from an updated vesion of the original input, square definite-positive sparse matrix.
+				  *  Only the numeric factorization is recomputed: the symbolic analysis (AMD fill-reducing ordering and elimination tree) done in the constructor is reused.
 				  *  NOTE: This new matrix MUST HAVE exactly the same sparse structure than the original one.
+				  * \exception std::exception If the sparse structure is not the same, see hasSameStructure()
+				  * \exception mrpt::math::CExceptionNotDefPos On non-definite-positive matrix as input.
 				  */
 				void update(const CSparseMatrix &new_SM);
+
+				/** Returns true if the column-compressed matrix \a SM has exactly the same size and sparse structure than the one used to build this decomposition, hence it can be passed to update().
+				  * \note (New in MRPT 1.5.0) */
+				bool hasSameStructure(const CSparseMatrix &SM) const;
 			};
 
 
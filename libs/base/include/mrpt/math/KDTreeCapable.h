@@ -14,11 +14,21 @@
 // nanoflann library:
 #include <mrpt/otherlibs/nanoflann/nanoflann.hpp>
 #include <mrpt/math/lightweight_geom_data.h>
+#include <algorithm>
 
 namespace mrpt
 {
 	namespace math
 	{
+		namespace detail
+		{
+			/** Gives the type of a nanoflann metric \a METRIC for another dataset class \a DATASET. */
+			template <class METRIC, class DATASET> struct kdtree_rebind_metric;
+			template <class T, class DS, typename DT, class DATASET> struct kdtree_rebind_metric<nanoflann::L1_Adaptor<T,DS,DT>,DATASET> { typedef nanoflann::L1_Adaptor<T,DATASET,DT> type; };
+			template <class T, class DS, typename DT, class DATASET> struct kdtree_rebind_metric<nanoflann::L2_Adaptor<T,DS,DT>,DATASET> { typedef nanoflann::L2_Adaptor<T,DATASET,DT> type; };
+			template <class T, class DS, typename DT, class DATASET> struct kdtree_rebind_metric<nanoflann::L2_Simple_Adaptor<T,DS,DT>,DATASET> { typedef nanoflann::L2_Simple_Adaptor<T,DATASET,DT> type; };
+		}
+
 		/** \addtogroup kdtree_grp KD-Trees
 		  *  \ingroup mrpt_base_grp
 		  *  @{ */
@@ -60,6 +70,13 @@ namespace mrpt
 		 *  to group all the calls for a given dimensionality together or build different class instances for
 		 *  queries of each dimensionality, etc.
 		 *
+		 *  <b>Incremental updates:</b> If TKDTreeSearchParams::incremental is enabled, the index is kept as a "forest" of static
+		 *  KD-trees, each one for a contiguous range of point indices, whose sizes decrease geometrically, so there are O(log N) of them.
+		 *  Derived classes that only append (or remove) points at the end of their data calling `kdtree_mark_as_outdated(first_modified_idx)`,
+		 *  instead of `kdtree_mark_as_outdated()`, then only pay for building a tree for the new points, and merging it with the smallest
+		 *  ones (Bentley-Saxe logarithmic method), instead of rebuilding the whole index. Queries are the same, at the cost of searching
+		 *  all the trees in the forest.
+		 *
 		 *  \sa See some of the derived classes for example implementations. See also the documentation of nanoflann
 		 * \ingroup mrpt_base_grp
 		 */
@@ -72,7 +89,7 @@ namespace mrpt
 			// ---------------------
 
 			/// Constructor
-			inline KDTreeCapable() : m_kdtree_is_uptodate(false)  { }
+			inline KDTreeCapable() { }
 
 			/// Destructor (nothing needed to do here)
 			inline ~KDTreeCapable() { }
@@ -85,10 +102,12 @@ namespace mrpt
 			struct TKDTreeSearchParams
 			{
 				TKDTreeSearchParams() :
-					leaf_max_size(10)
+					leaf_max_size(10),
+					incremental(false)
 				{
 				}
 				size_t leaf_max_size; //!< Max points per leaf
+				bool   incremental;   //!< Keep the index as a forest of KD-trees which is updated incrementally as points are appended, instead of rebuilding it from scratch (default=false). See KDTreeCapable. (New in MRPT 1.5.0)
 			};
 
 			TKDTreeSearchParams  kdtree_search_params; //!< Parameters to tune the ANN searches
@@ -96,6 +115,12 @@ namespace mrpt
 			/** @name Public utility methods to query the KD-tree
 				@{ */
 
+			/** Builds (or updates) the 2D KD-tree now, if it is outdated. Query methods do it automatically, but only this step
+			  * is not thread-safe: call this before issuing concurrent queries from several threads. (New in MRPT 1.5.0) */
+			inline void kdTreeEnsureIndexBuilt2D() const { rebuild_kdTree_2D(); }
+			/** Like kdTreeEnsureIndexBuilt2D(), for the 3D KD-tree. (New in MRPT 1.5.0) */
+			inline void kdTreeEnsureIndexBuilt3D() const { rebuild_kdTree_3D(); }
+
 			/** KD Tree-based search for the closest point (only ONE) to some given 2D coordinates.
 			  *  This method automatically build the "m_kdtree_data" structure when:
 			  *		- It is called for the first time
@@ -128,9 +153,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_index, &out_dist_sqr );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				m_kdtree2d_data.findNeighbors(resultSet, &query_point[0]);
 
 				// Copy output to user vars:
 				out_x = derived().kdtree_get_pt(ret_index,0);
@@ -155,9 +179,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_index, &out_dist_sqr );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				m_kdtree2d_data.findNeighbors(resultSet, &query_point[0]);
 
 				return ret_index;
 				MRPT_END
@@ -224,9 +247,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_indexes[0], &ret_sqdist[0] );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				m_kdtree2d_data.findNeighbors(resultSet, &query_point[0]);
 
 				// Copy output to user vars:
 				out_x1 = derived().kdtree_get_pt(ret_indexes[0],0);
@@ -288,9 +310,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_indexes[0], &out_dist_sqr[0] );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				m_kdtree2d_data.findNeighbors(resultSet, &query_point[0]);
 
 				for (size_t i=0;i<knn;i++)
 				{
@@ -342,9 +363,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&out_idx[0], &out_dist_sqr[0] );
 
-				m_kdtree2d_data.query_point[0] = x0;
-				m_kdtree2d_data.query_point[1] = y0;
-		        m_kdtree2d_data.index->findNeighbors(resultSet, &m_kdtree2d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[2] = {x0,y0};
+				m_kdtree2d_data.findNeighbors(resultSet, &query_point[0]);
 				MRPT_END
 			}
 
@@ -388,10 +408,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_index, &out_dist_sqr );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-		        m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				m_kdtree3d_data.findNeighbors(resultSet, &query_point[0]);
 
 				// Copy output to user vars:
 				out_x = derived().kdtree_get_pt(ret_index,0);
@@ -419,10 +437,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_index, &out_dist_sqr );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-		        m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				m_kdtree3d_data.findNeighbors(resultSet, &query_point[0]);
 
 				return ret_index;
 				MRPT_END
@@ -478,10 +494,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&ret_indexes[0], &out_dist_sqr[0] );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-				m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				m_kdtree3d_data.findNeighbors(resultSet, &query_point[0]);
 
 				for (size_t i=0;i<knn;i++)
 				{
@@ -534,10 +548,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&out_idx[0], &out_dist_sqr[0] );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-				m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				m_kdtree3d_data.findNeighbors(resultSet, &query_point[0]);
 
 				for (size_t i=0;i<knn;i++)
 				{
@@ -585,7 +597,7 @@ namespace mrpt
 				if ( m_kdtree3d_data.m_num_points!=0 )
 				{
 					const num_t xyz[3] = {x0,y0,z0};
-					m_kdtree3d_data.index->radiusSearch(&xyz[0], maxRadiusSqr, out_indices_dist, nanoflann::SearchParams() );
+					m_kdtree3d_data.radiusSearch(&xyz[0], maxRadiusSqr, out_indices_dist);
 				}
 				return out_indices_dist.size();
 				MRPT_END
@@ -616,7 +628,7 @@ namespace mrpt
 				if ( m_kdtree2d_data.m_num_points!=0 )
 				{
 					const num_t xyz[2] = {x0,y0};
-					m_kdtree2d_data.index->radiusSearch(&xyz[0], maxRadiusSqr, out_indices_dist, nanoflann::SearchParams() );
+					m_kdtree2d_data.radiusSearch(&xyz[0], maxRadiusSqr, out_indices_dist);
 				}
 				return out_indices_dist.size();
 				MRPT_END
@@ -654,10 +666,8 @@ namespace mrpt
 				nanoflann::KNNResultSet<num_t> resultSet(knn);
 				resultSet.init(&out_idx[0], &out_dist_sqr[0] );
 
-				m_kdtree3d_data.query_point[0] = x0;
-				m_kdtree3d_data.query_point[1] = y0;
-				m_kdtree3d_data.query_point[2] = z0;
-				m_kdtree3d_data.index->findNeighbors(resultSet, &m_kdtree3d_data.query_point[0], nanoflann::SearchParams());
+				const num_t query_point[3] = {x0,y0,z0};
+				m_kdtree3d_data.findNeighbors(resultSet, &query_point[0]);
 				MRPT_END
 			}
 
@@ -669,18 +679,82 @@ namespace mrpt
 
 		protected:
 			/** To be called by child classes when KD tree data changes. */
-			inline void kdtree_mark_as_outdated() const { m_kdtree_is_uptodate = false; }
+			inline void kdtree_mark_as_outdated() const { kdtree_mark_as_outdated(0); }
+
+			/** To be called by child classes when only the data points with indices `>= first_modified_idx` have changed, e.g.
+			  * after appending points at the end. With TKDTreeSearchParams::incremental enabled, the part of the index for the points
+			  * before that one is kept. Otherwise, it is equivalent to kdtree_mark_as_outdated(). (New in MRPT 1.5.0) */
+			inline void kdtree_mark_as_outdated(size_t first_modified_idx) const
+			{
+				if (!kdtree_search_params.incremental) first_modified_idx = 0;
+				m_kdtree2d_data.invalidate_from(first_modified_idx);
+				m_kdtree3d_data.invalidate_from(first_modified_idx);
+			}
 
 		private:
+			/** A view of the contiguous range of points `[first,first+count)` of the derived class, as a nanoflann dataset. */
+			struct TPointsRangeDataset
+			{
+				TPointsRangeDataset(const Derived &d, size_t first_, size_t count_) : data(d), first(first_), count(count_) { }
+
+				const Derived &data;
+				size_t first, count;
+
+				inline size_t kdtree_get_point_count() const { return count; }
+				inline num_t kdtree_get_pt(const size_t idx, int dim) const { return data.kdtree_get_pt(first+idx,dim); }
+				inline num_t kdtree_distance(const num_t *p1, const size_t idx_p2, size_t size) const { return data.kdtree_distance(p1,first+idx_p2,size); }
+				template <class BBOX>
+				bool kdtree_get_bbox(BBOX &bb) const {
+					// The derived class may only provide the bbox of all the points:
+					return (first==0 && count==data.kdtree_get_point_count()) ? data.kdtree_get_bbox(bb) : false;
+				}
+			private:
+				TPointsRangeDataset & operator =(const TPointsRangeDataset &);
+			};
+
+			/** Adds an offset to the indices of points reported by a sub-tree of the forest before passing them to the actual result set. */
+			template <class RESULTSET>
+			struct TOffsetResultSet
+			{
+				TOffsetResultSet(RESULTSET &rs_, size_t offset_) : rs(rs_), offset(offset_) { }
+				RESULTSET &rs;
+				const size_t offset;
+
+				inline size_t size() const { return rs.size(); }
+				inline bool full() const { return rs.full(); }
+				inline void addPoint(num_t dist, size_t index) { rs.addPoint(dist,index+offset); }
+				inline num_t worstDist() const { return rs.worstDist(); }
+			private:
+				TOffsetResultSet & operator =(const TOffsetResultSet &);
+			};
+
 			/** Internal structure with the KD-tree representation (mainly used to avoid copying pointers with the = operator) */
 			template <int _DIM = -1>
 			struct TKDTreeDataHolder
 			{
-				/** Init the pointer to NULL. */
-				inline TKDTreeDataHolder() : index(NULL),m_dim(_DIM), m_num_points(0) { }
+				typedef typename detail::kdtree_rebind_metric<metric_t,TPointsRangeDataset>::type  subtree_metric_t;
+				typedef nanoflann::KDTreeSingleIndexAdaptor<subtree_metric_t,TPointsRangeDataset,_DIM> kdtree_index_t;
+
+				/** One tree of the forest, indexing a contiguous range of points */
+				struct TSubTree
+				{
+					TSubTree(const Derived &d, size_t first, size_t count, size_t leaf_max_size) :
+						dataset(d,first,count),
+						index(_DIM>0 ? _DIM : -1, dataset, nanoflann::KDTreeSingleIndexAdaptorParams(leaf_max_size))
+					{
+						index.buildIndex();
+					}
+					inline size_t end() const { return dataset.first+dataset.count; }
+
+					TPointsRangeDataset dataset;
+					kdtree_index_t      index;
+				};
+
+				/** Init an empty forest. */
+				inline TKDTreeDataHolder() : m_dim(_DIM), m_num_points(0), m_uptodate(false) { }
 
 				/** Copy constructor: It actually does NOT copy the kd-tree, a new object will be created if required!   */
-				inline TKDTreeDataHolder(const TKDTreeDataHolder &)  : index(NULL),m_dim(_DIM), m_num_points(0) { }
+				inline TKDTreeDataHolder(const TKDTreeDataHolder &)  : m_dim(_DIM), m_num_points(0), m_uptodate(false) { }
 
 				/** Copy operator: It actually does NOT copy the kd-tree, a new object will be created if required!  */
 				inline TKDTreeDataHolder& operator =(const TKDTreeDataHolder &o) {
@@ -692,70 +766,84 @@ namespace mrpt
 				inline ~TKDTreeDataHolder() { clear(); }
 
 				/** Free memory (if allocated)  */
-				inline void clear()	{ mrpt::utils::delete_safe( index ); }
+				inline void clear()	{
+					for (size_t i=0;i<forest.size();i++) delete forest[i];
+					forest.clear();
+					m_num_points = 0;
+					m_uptodate = false;
+				}
+
+				/** Drops the trees with any point with index `>=first_idx` */
+				inline void invalidate_from(size_t first_idx) {
+					while (!forest.empty() && forest.back()->end()>first_idx) {
+						delete forest.back();
+						forest.pop_back();
+					}
+					m_uptodate = false;
+				}
 
-				typedef nanoflann::KDTreeSingleIndexAdaptor<metric_t,Derived, _DIM> kdtree_index_t;
+				/** Indexes all the points not in the forest yet, merging the last trees while they are not, at least, twice as large as the next one. */
+				void update(const Derived &d, size_t leaf_max_size, bool incremental)
+				{
+					const size_t N = d.kdtree_get_point_count();
+					size_t nIndexed = forest.empty() ? 0 : forest.back()->end();
+					if (nIndexed>N) { clear(); nIndexed = 0; }  // Points were removed without notifying it. Just in case.
+					if (nIndexed<N)
+					{
+						size_t first = nIndexed;
+						while (!forest.empty() && (!incremental || forest.back()->dataset.count <= 2*(N-first)) )
+						{
+							first = forest.back()->dataset.first;
+							delete forest.back();
+							forest.pop_back();
+						}
+						forest.push_back( new TSubTree(d,first,N-first,leaf_max_size) );
+					}
+					m_num_points = N;
+					m_uptodate = true;
+				}
+
+				/** Searches in all the trees, with one common result set */
+				template <class RESULTSET>
+				inline void findNeighbors(RESULTSET &result, const num_t *vec) const
+				{
+					for (size_t i=0;i<forest.size();i++)
+					{
+						TOffsetResultSet<RESULTSET> subtree_result(result,forest[i]->dataset.first);
+						forest[i]->index.findNeighbors(subtree_result, vec, nanoflann::SearchParams());
+					}
+				}
+
+				/** Like nanoflann::KDTreeSingleIndexAdaptor::radiusSearch(), for all the trees: the output is sorted by ascending distances. */
+				inline void radiusSearch(const num_t *vec, const num_t radius, std::vector<std::pair<size_t,num_t> >& indices_dists) const
+				{
+					nanoflann::RadiusResultSet<num_t,size_t> result(radius,indices_dists);
+					findNeighbors(result,vec);
+					std::sort(indices_dists.begin(),indices_dists.end(), nanoflann::IndexDist_Sorter() );
+				}
 
-				kdtree_index_t *index;  //!< NULL or the up-to-date index
+				std::vector<TSubTree*> forest;  //!< The trees, sorted by their range of point indices, which are consecutive.
 
-				std::vector<num_t> query_point;
 				size_t           m_dim;         //!< Dimensionality. typ: 2,3
 				size_t           m_num_points;
+				bool             m_uptodate;    //!< Whether all the points are indexed
 			};
 
 			mutable TKDTreeDataHolder<2>  m_kdtree2d_data;
 			mutable TKDTreeDataHolder<3>  m_kdtree3d_data;
-			mutable TKDTreeDataHolder<>   m_kdtreeNd_data;
-			mutable bool                  m_kdtree_is_uptodate; //!< whether the KD tree needs to be rebuilt or not.
 
 			/// Rebuild, if needed the KD-tree for 2D (nDims=2), 3D (nDims=3), ... asking the child class for the data points.
 			void rebuild_kdTree_2D() const
 			{
-				typedef typename TKDTreeDataHolder<2>::kdtree_index_t  tree2d_t;
-
-				if (!m_kdtree_is_uptodate) { m_kdtree2d_data.clear(); m_kdtree3d_data.clear(); m_kdtreeNd_data.clear(); }
-
-				if (!m_kdtree2d_data.index)
-				{
-					// Erase previous tree:
-					m_kdtree2d_data.clear();
-					// And build new index:
-					const size_t N = derived().kdtree_get_point_count();
-					m_kdtree2d_data.m_num_points = N;
-					m_kdtree2d_data.m_dim        = 2;
-					m_kdtree2d_data.query_point.resize(2);
-					if (N)
-					{
-						m_kdtree2d_data.index = new tree2d_t(2, derived(),  nanoflann::KDTreeSingleIndexAdaptorParams(kdtree_search_params.leaf_max_size) );
-						m_kdtree2d_data.index->buildIndex();
-					}
-					m_kdtree_is_uptodate = true;
-				}
+				if (!m_kdtree2d_data.m_uptodate)
+					m_kdtree2d_data.update(derived(), kdtree_search_params.leaf_max_size, kdtree_search_params.incremental);
 			}
 
 			/// Rebuild, if needed the KD-tree for 2D (nDims=2), 3D (nDims=3), ... asking the child class for the data points.
 			void rebuild_kdTree_3D() const
 			{
-				typedef typename TKDTreeDataHolder<3>::kdtree_index_t  tree3d_t;
-
-				if (!m_kdtree_is_uptodate) { m_kdtree2d_data.clear(); m_kdtree3d_data.clear(); m_kdtreeNd_data.clear(); }
-
-				if (!m_kdtree3d_data.index)
-				{
-					// Erase previous tree:
-					m_kdtree3d_data.clear();
-					// And build new index:
-					const size_t N = derived().kdtree_get_point_count();
-					m_kdtree3d_data.m_num_points = N;
-					m_kdtree3d_data.m_dim        = 3;
-					m_kdtree3d_data.query_point.resize(3);
-					if (N)
-					{
-						m_kdtree3d_data.index = new tree3d_t(3, derived(),  nanoflann::KDTreeSingleIndexAdaptorParams(kdtree_search_params.leaf_max_size) );
-						m_kdtree3d_data.index->buildIndex();
-					}
-					m_kdtree_is_uptodate = true;
-				}
+				if (!m_kdtree3d_data.m_uptodate)
+					m_kdtree3d_data.update(derived(), kdtree_search_params.leaf_max_size, kdtree_search_params.incremental);
 			}
 
 		};  // end of KDTreeCapable
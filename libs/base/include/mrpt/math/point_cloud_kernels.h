@@ -0,0 +1,78 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/math/lightweight_geom_data.h>
+#include <mrpt/poses/poses_frwds.h>
+#include <mrpt/base/link_pragmas.h>
+#include <cstddef>
+
+namespace mrpt
+{
+	namespace math
+	{
+		/** \addtogroup geometry_grp
+		  *  @{ */
+
+		/** @name Vectorized kernels for point clouds stored as structure-of-arrays
+		  *  These functions process whole arrays of point coordinates with SSE2/AVX instructions, if supported by the CPU running the program (see mrpt::system::cpu), and
+		  *  are the building blocks of the bulk operations of mrpt::maps::CPointsMap and its derived classes.
+		  *  They accept non-owning views of the coordinate arrays, so they can be used with any container, e.g. with
+		  *  mrpt::maps::CPointsMap::getPointsSpan(). Buffers need not be aligned.
+		    @{ */
+
+		/** A non-owning, read-only view of `size` points stored as three arrays of coordinates.
+		  * \note (New in MRPT 1.5.0) */
+		struct BASE_IMPEXP TConstPointCloudSpan
+		{
+			const float *x, *y, *z;  //!< Coordinate arrays. `z` can be NULL in 2D clouds, where supported (see each function).
+			size_t size;             //!< Number of points
+
+			TConstPointCloudSpan() : x(NULL), y(NULL), z(NULL), size(0) {}
+			TConstPointCloudSpan(const float *x_, const float *y_, const float *z_, size_t size_) : x(x_), y(y_), z(z_), size(size_) {}
+		};
+
+		/** A non-owning, writable view of `size` points stored as three arrays of coordinates.
+		  * \note (New in MRPT 1.5.0) */
+		struct BASE_IMPEXP TPointCloudSpan
+		{
+			float *x, *y, *z;  //!< Coordinate arrays
+			size_t size;       //!< Number of points
+
+			TPointCloudSpan() : x(NULL), y(NULL), z(NULL), size(0) {}
+			TPointCloudSpan(float *x_, float *y_, float *z_, size_t size_) : x(x_), y(y_), z(z_), size(size_) {}
+			operator TConstPointCloudSpan() const { return TConstPointCloudSpan(x,y,z,size); }
+		};
+
+		/** Applies a rigid transformation to all the points: `out[i] = pose (+) in[i]`.
+		  * Both spans must have the same size. `out` may be the same buffers than `in` (in-place transformation), but they must not partially overlap.
+		  * \note Computations are done in single precision, unlike mrpt::poses::CPose3D::composePoint().
+		  * \note (New in MRPT 1.5.0) */
+		void BASE_IMPEXP transformPoints(const mrpt::poses::CPose3D &pose, const TConstPointCloudSpan &in, const TPointCloudSpan &out);
+		/** \overload For 2D poses, the z coordinates are copied unmodified. */
+		void BASE_IMPEXP transformPoints(const mrpt::poses::CPose2D &pose, const TConstPointCloudSpan &in, const TPointCloudSpan &out);
+
+		/** Computes the bounding box of all the points. For an empty cloud, it returns `bbMin=+FLT_MAX` and `bbMax=-FLT_MAX`.
+		  * \note (New in MRPT 1.5.0) */
+		void BASE_IMPEXP boundingBox(const TConstPointCloudSpan &pts, TPoint3Df &bbMin, TPoint3Df &bbMax);
+
+		/** Computes the squared distances of all the points to a given one into `out_dist2`, which must have room for `pts.size` elements.
+		  * If `pts.z` is NULL, 2D distances are computed (`p.z` is ignored).
+		  * \note (New in MRPT 1.5.0) */
+		void BASE_IMPEXP squaredDistancesToPoint(const TConstPointCloudSpan &pts, const TPoint3Df &p, float *out_dist2);
+
+		/** Computes the squared distances between the pairs of points with the same index in `a` and `b` into `out_dist2`, which must
+		  * have room for `a.size` elements. Both spans must have the same size. If any of `a.z` or `b.z` is NULL, 2D distances are computed.
+		  * \note (New in MRPT 1.5.0) */
+		void BASE_IMPEXP squaredDistances(const TConstPointCloudSpan &a, const TConstPointCloudSpan &b, float *out_dist2);
+
+		/** @} */  // end of grouping
+		/** @} */  // end of grouping
+	}
+}
@@ -12,6 +12,8 @@
 
 #include <mrpt/system/CDirectoryExplorer.h>
 #include <mrpt/system/CFileSystemWatcher.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/system/cpu.h>
 #include <mrpt/system/datetime.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/memory.h>
@@ -0,0 +1,80 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/utils/core_defs.h>
+#include <mrpt/utils/pimpl.h>
+#include <mrpt/base/link_pragmas.h>
+#include <cstddef>
+
+namespace mrpt
+{
+	namespace system
+	{
+		namespace detail { struct TWorkerThreadsPoolImpl; }
+
+		/** A fixed-size pool of worker threads to split data-parallel loops among several CPU cores.
+		  *
+		  * The pool is created with a given "degree of parallelism" `N`: it keeps `N-1` sleeping threads, and
+		  * the thread calling parallel_for() always processes one of the chunks itself. Hence, a pool of size 1 does
+		  * not spawn any thread and just runs the loop body on the caller thread.
+		  *
+		  * The range `[0,N)` passed to parallel_for() is always split into **contiguous** chunks in the same way for a
+		  * given range size and pool size, so algorithms writing each result into its own output slot and reducing them
+		  * afterwards in index order produce bit-exact results regardless of the threads scheduling.
+		  *
+		  * Example of usage:
+		  * \code
+		  *  struct MyTask : public mrpt::system::CWorkerThreadsPool::TRangeTask {
+		  *    std::vector<double> &out;
+		  *    MyTask(std::vector<double> &o) : out(o) {}
+		  *    void operator()(size_t first, size_t last) const MRPT_OVERRIDE {
+		  *      for (size_t i=first;i<last;i++) out[i] = heavy_computation(i);
+		  *    }
+		  *  };
+		  *  mrpt::system::CWorkerThreadsPool pool(4);
+		  *  std::vector<double> out(1000);
+		  *  pool.parallel_for(out.size(), MyTask(out));
+		  * \endcode
+		  *
+		  * \note Copying a pool creates a new, independent set of threads of the same size.
+		  * \note (New in MRPT 1.5.0)
+		  * \ingroup mrpt_thread
+		  */
+		class BASE_IMPEXP CWorkerThreadsPool
+		{
+		public:
+			/** The interface of tasks run by parallel_for(): process all indices in the range `[first,last)` */
+			struct BASE_IMPEXP TRangeTask
+			{
+				virtual ~TRangeTask();
+				virtual void operator()(size_t first, size_t last) const = 0;
+			};
+
+			/** Constructor: creates the pool with the given degree of parallelism (0=as many as CPU cores) */
+			explicit CWorkerThreadsPool(unsigned int num_threads = 1);
+			~CWorkerThreadsPool();
+
+			/** Changes the degree of parallelism (0=as many as CPU cores). Does nothing if the size does not change. */
+			void resize(unsigned int num_threads);
+			/** Returns the degree of parallelism (number of worker threads + 1, for the caller thread) */
+			unsigned int size() const;
+
+			/** Runs `task` over the index range `[0,N)` split into contiguous chunks of at least `min_chunk_size`
+			  * indices each, and blocks until all chunks are done.
+			  * \exception std::exception The first exception thrown from any chunk is re-thrown in the caller thread, after all other chunks finished.
+			  */
+			void parallel_for(size_t N, const TRangeTask &task, size_t min_chunk_size = 1);
+
+		private:
+			PIMPL_DECLARE_TYPE(detail::TWorkerThreadsPoolImpl, m_impl);
+		};
+
+	} // End of namespace
+} // End of namespace
@@ -0,0 +1,201 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef  MRPT_SYSTEM_CPU_H
+#define  MRPT_SYSTEM_CPU_H
+
+#include <mrpt/utils/mrpt_macros.h>
+#include <mrpt/base/link_pragmas.h>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/** \def MRPT_SIMD_DISPATCH_X86
+  * Defined to 1 if the compiler can build x86 SIMD code (SSE*, AVX*) for individual functions, tagged with the
+  * MRPT_TARGET_* macros, independently of the instruction set enabled for the rest of the code (e.g. with `-msse3` or `-mavx`).
+  * Such functions must only be called after checking mrpt::system::cpu::supports() at runtime.
+  * \note (New in MRPT 1.5.0)
+  */
+#if (defined(__i386__) || defined(__x86_64__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__*100+__GNUC_MINOR__)>=409))
+#	define MRPT_SIMD_DISPATCH_X86 1
+#	define MRPT_TARGET_SSE2    __attribute__((target("sse2")))
+#	define MRPT_TARGET_SSSE3   __attribute__((target("ssse3")))
+#	define MRPT_TARGET_SSE4_1  __attribute__((target("sse4.1")))
+#	define MRPT_TARGET_AVX     __attribute__((target("avx")))
+#	define MRPT_TARGET_AVX2    __attribute__((target("avx2,fma")))
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	// MSVC allows using any intrinsic without special compiler flags:
+#	define MRPT_SIMD_DISPATCH_X86 1
+#	define MRPT_TARGET_SSE2
+#	define MRPT_TARGET_SSSE3
+#	define MRPT_TARGET_SSE4_1
+#	define MRPT_TARGET_AVX
+#	define MRPT_TARGET_AVX2
+#else
+#	define MRPT_SIMD_DISPATCH_X86 0
+#endif
+
+namespace mrpt
+{
+	namespace system
+	{
+		/** Runtime detection of the instruction sets supported by the CPU, and selection of the best implementation of SIMD kernels.
+		  *
+		  * This allows building MRPT for the lowest common denominator of the target platform (e.g. for distribution packages)
+		  * while still using SSSE3, AVX, AVX2,... code paths in those computers which support them.
+		  * Features can be disabled, e.g. for benchmarking or testing the different implementations of a kernel, with
+		  * overrideDetectedFeature() or with the environment variable `MRPT_DISABLE_CPU_FEATURES`, a comma-separated list of
+		  * feature names as returned by featureName() (case insensitive), or `ALL`.
+		  *
+		  * \sa CSimdKernel
+		  * \note (New in MRPT 1.5.0)
+		  * \ingroup mrpt_base_grp
+		  */
+		namespace cpu
+		{
+			/** The CPU features which can be checked with supports() */
+			enum TFeature
+			{
+				fNone = 0,  //!< No special feature required: always supported
+				fSSE2,
+				fSSE3,
+				fSSSE3,
+				fSSE4_1,
+				fSSE4_2,
+				fPOPCNT,
+				fAVX,       //!< Only reported if the OS also saves the AVX registers
+				fAVX2,
+				fFMA,
+				fAVX512F,   //!< Only reported if the OS also saves the AVX-512 registers
+				fNEON,
+				FEATURE_COUNT
+			};
+
+			/** Returns true if the CPU (and OS) running the program supports the given feature, and it has not been disabled. */
+			bool BASE_IMPEXP supports(TFeature f);
+
+			/** Forces a feature to be reported as (not) available. Disabling features is useful for testing or benchmarking the
+			  * alternative implementations of SIMD kernels; enabling a feature not supported by the CPU will probably crash the program.
+			  * \sa resetDetectedFeatures */
+			void BASE_IMPEXP overrideDetectedFeature(TFeature f, bool available);
+
+			/** Restores the detected features, undoing the effect of any previous overrideDetectedFeature() or of `MRPT_DISABLE_CPU_FEATURES`. */
+			void BASE_IMPEXP resetDetectedFeatures();
+
+			/** Returns the name of a feature, e.g. "AVX2" */
+			const char BASE_IMPEXP * featureName(TFeature f);
+
+			/** Returns the list of currently supported features, separated by spaces, e.g. "SSE2 SSE3 SSSE3 AVX" */
+			std::string BASE_IMPEXP featuresAsString();
+
+			/** Base class of CSimdKernel, for listing all the kernels with getKernelsSummary() */
+			class BASE_IMPEXP CSimdKernelBase
+			{
+			public:
+				explicit CSimdKernelBase(const char *name);
+				virtual ~CSimdKernelBase();
+				const char * getName() const { return m_name; }
+				/** Name of the implementation which would be used right now */
+				virtual const char * getSelectedName() const = 0;
+				/** Names of all the implementations, in order of preference */
+				virtual std::vector<std::string> getImplementationNames() const = 0;
+			private:
+				const char *m_name;
+				CSimdKernelBase(const CSimdKernelBase &);
+				CSimdKernelBase & operator =(const CSimdKernelBase &);
+			};
+
+			/** Returns one line per existing CSimdKernel object, with the selected and all the available implementations, e.g.
+			  * `transformPoints: avx [avx sse2 generic]` */
+			std::string BASE_IMPEXP getKernelsSummary();
+
+			/** A registry of the implementations of one SIMD kernel, each one with the CPU features it requires.
+			  * Implementations are added in order of preference with add(), and get() returns the first one supported by the
+			  * CPU, so the last one should be a generic version which requires no special feature. Selection is repeated in each
+			  * call to get() (its cost is negligible) so the effect of overrideDetectedFeature() is immediate.
+			  *
+			  * Instances are normally function-local statics in the .cpp file which implements the kernel:
+			  * \code
+			  *  typedef void (*my_kernel_t)(const float *in, float *out, size_t N);
+			  *  static const CSimdKernel<my_kernel_t> & my_kernel()
+			  *  {
+			  *      static CSimdKernel<my_kernel_t> k = CSimdKernel<my_kernel_t>("my_kernel")
+			  *          .add("avx2", &my_kernel_avx2, fAVX2, fFMA)
+			  *          .add("sse2", &my_kernel_sse2, fSSE2)
+			  *          .add("generic", &my_kernel_generic);
+			  *      return k;
+			  *  }
+			  *  ...
+			  *  my_kernel().get()(in,out,N);
+			  * \endcode
+			  * \tparam FUNC A function pointer type.
+			  */
+			template <typename FUNC>
+			class CSimdKernel : public CSimdKernelBase
+			{
+			public:
+				explicit CSimdKernel(const char *name) : CSimdKernelBase(name) {}
+				CSimdKernel(const CSimdKernel &o) : CSimdKernelBase(o.getName()), m_impls(o.m_impls) {}
+
+				/** Adds an implementation, which requires the given features. Returns a reference to this object, to chain calls. */
+				CSimdKernel & add(const char *impl_name, FUNC f, TFeature req1 = fNone, TFeature req2 = fNone)
+				{
+					TImpl i;
+					i.name = impl_name;
+					i.func = f;
+					i.req1 = req1;
+					i.req2 = req2;
+					m_impls.push_back(i);
+					return *this;
+				}
+
+				/** Returns the best implementation for this CPU, or NULL if none is supported. */
+				FUNC get() const
+				{
+					const TImpl *i = select();
+					return i ? i->func : NULL;
+				}
+
+				const char * getSelectedName() const MRPT_OVERRIDE
+				{
+					const TImpl *i = select();
+					return i ? i->name : "";
+				}
+
+				std::vector<std::string> getImplementationNames() const MRPT_OVERRIDE
+				{
+					std::vector<std::string> names;
+					for (size_t k=0;k<m_impls.size();k++)
+						names.push_back(m_impls[k].name);
+					return names;
+				}
+
+			private:
+				struct TImpl
+				{
+					const char *name;
+					FUNC        func;
+					TFeature    req1, req2;
+				};
+				std::vector<TImpl> m_impls;
+
+				const TImpl * select() const
+				{
+					for (size_t k=0;k<m_impls.size();k++)
+						if (supports(m_impls[k].req1) && supports(m_impls[k].req2))
+							return &m_impls[k];
+					return NULL;
+				}
+				CSimdKernel & operator =(const CSimdKernel &);
+			};
+
+		} // End of namespace cpu
+	} // End of namespace system
+} // End of namespace mrpt
+
+#endif
@@ -24,6 +24,8 @@
 #include <mrpt/utils/CSerializable.h>
 #include <mrpt/utils/CStream.h>
 #include <mrpt/utils/CMemoryStream.h>
+#include <mrpt/utils/CMemoryMappedFile.h>
+#include <mrpt/utils/TMemoryBlockOwner.h>
 #include <mrpt/utils/CMemoryChunk.h>
 #include <mrpt/utils/CStdOutStream.h>
 #include <mrpt/utils/CFileStream.h>
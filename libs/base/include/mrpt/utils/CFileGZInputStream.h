@@ -15,8 +15,13 @@ namespace mrpt
 {
 	namespace utils
 	{
+		namespace detail { struct TGZParallelReader; }
+
 		/** Transparently opens a compressed "gz" file and reads uncompressed data from it.
 		 *   If the file is not a .gz file, it silently reads data from the file.
+		 *
+		 *  Files written by CFileGZOutputStream in parallel compression mode are decompressed in parallel by several threads
+		 *  (see \a num_threads in open()), several blocks ahead of the data actually read.
 		 *  This class requires compiling MRPT with wxWidgets. If wxWidgets is not available then the class is actually mapped to the standard CFileInputStream
 		 *
 		 * \sa CFileInputStream
@@ -30,6 +35,7 @@ namespace mrpt
 		private:
 			void		*m_f;
 			uint64_t	m_file_size;	//!< Compressed file size
+			detail::TGZParallelReader *m_parallel; //!< Only used for files written in parallel compression mode
 
 		public:
 			CFileGZInputStream(); //!< Constructor without open
@@ -44,9 +50,10 @@ namespace mrpt
 
 			 /** Opens the file for read.
 			  * \param fileName The file to be open in this stream
+			  * \param num_threads Number of threads to decompress files written in parallel compression mode (0: as many as CPU cores). Ignored for other files. (New in MRPT 1.5.0)
 			  * \return false if there's an error opening the file, true otherwise
 			  */
-			bool open(const std::string &fileName );
+			bool open(const std::string &fileName, unsigned int num_threads = 1 );
 			void close(); //!< Closes the file
 			bool fileOpenCorrectly(); //!< Returns true if the file was open without errors.
 			bool is_open() { return fileOpenCorrectly(); } //!< Returns true if the file was open without errors.
@@ -26,6 +26,8 @@ namespace mrpt
 		// We don't have wxwidgets:
 #	define CFileGZOutputStream	CFileOutputStream
 #else
+		namespace detail { struct TGZParallelWriter; }
+
 		class BASE_IMPEXP CFileGZOutputStream : public CStream, public CUncopiable
 		{
 		protected:
@@ -34,6 +36,7 @@ namespace mrpt
 			// DECLARE_UNCOPIABLE( CFileGZOutputStream )
 		private:
 			void		*m_f;
+			detail::TGZParallelWriter *m_parallel; //!< Only used in parallel compression mode
 		public:
 			 /** Constructor: opens an output file with compression level = 1 (minimum, fastest).
 			  * \param fileName The file to be open in this stream
@@ -47,12 +50,20 @@ namespace mrpt
 			CFileGZOutputStream();
 			virtual ~CFileGZOutputStream(); //!< Destructor
 
-			 /** Open a file for write, choosing the compression level
+			 /** Open a file for write, choosing the compression level and, optionally, parallel compression.
+			  *
+			  * With \a num_threads!=1, the data is split into independent blocks of \a block_size bytes which are
+			  * compressed in parallel and written as a multi-member gzip file, which can be read by any gzip reader
+			  * (at a slightly lower compression ratio). CFileGZInputStream can also decompress such files in parallel.
+			  *
 			  * \param fileName The file to be open in this stream
 			  * \param compress_level 0:no compression, 1:fastest, 9:best
+			  * \param num_threads Number of compression threads (0: as many as CPU cores; 1: standard, sequential compression)
+			  * \param block_size Size of the independent blocks, in uncompressed bytes (only for num_threads!=1)
 			  * \return true on success, false on any error.
+			  * \note Parameters num_threads and block_size are new in MRPT 1.5.0
 			  */
-			bool open(const std::string &fileName, int compress_level = 1 );
+			bool open(const std::string &fileName, int compress_level = 1, unsigned int num_threads = 1, size_t block_size = 1<<20 );
 			void close(); //!< Close the file
 			bool fileOpenCorrectly(); //!< Returns true if the file was open without errors.
 			bool is_open() { return fileOpenCorrectly(); } //!< Returns true if the file was open without errors.
@@ -15,6 +15,7 @@
 #include <mrpt/utils/CCanvas.h>
 #include <mrpt/utils/TCamera.h>
 #include <mrpt/utils/exceptions.h>
+#include <mrpt/utils/TMemoryBlockOwner.h>
 
 // Add for declaration of mexplus::from template specialization
 DECLARE_MEXPLUS_FROM( mrpt::utils::CImage )
@@ -518,9 +519,11 @@ namespace mrpt
 				makeSureImageIsLoaded();
 				return static_cast<const T*>(img);
 			}
-			/** Returns a pointer to a T* containing the image - the idea is to call like "img.getAs<IplImage>()" so we can avoid here including OpenCV's headers. */
+			/** Returns a pointer to a T* containing the image - the idea is to call like "img.getAs<IplImage>()" so we can avoid here including OpenCV's headers.
+			  * \note Since the pixels may be modified through this pointer, images sharing their data (see isSharingData()) make a private copy first (see makeSureImageIsWritable()). Use the const version for read-only access. */
 			template <typename T> inline T* getAs(){
 				makeSureImageIsLoaded();
+				makeSureImageIsWritable();
 				return static_cast<T*>(img);
 			}
 
@@ -549,6 +552,7 @@ namespace mrpt
 			/** Returns a pointer to a given pixel information.
 			 *   The coordinate origin is pixel(0,0)=top-left corner of the image.
 			 * \exception std::exception On pixel coordinates out of bounds
+			 * \note For images sharing their data (see isSharingData()), call makeSureImageIsWritable() before writing through the returned pointer.
 			 */
 			unsigned char*  operator()(unsigned int col, unsigned int row, unsigned int channel = 0) const;
 
@@ -690,6 +694,18 @@ namespace mrpt
 			  */
 			inline void forceLoad() const {  makeSureImageIsLoaded(); }
 
+			/** Returns true if the pixels of this image are not owned by this object but reference a block of memory shared with other objects,
+			  * which happens when deserializing uncompressed images from a stream which supports mrpt::utils::CStream::ReadBufferZeroCopy()
+			  * (e.g. a memory-mapped rawlog, see mrpt::obs::CRawlogIndexed::enableZeroCopy()).
+			  * Methods which modify the image in place automatically make a private copy first, see makeSureImageIsWritable().
+			  * \note (New in MRPT 1.5.0) */
+			bool isSharingData() const { return m_sharedData.present(); }
+
+			/** If the image shares its data (see isSharingData()), makes a private copy of it, so it can be safely modified.
+			  * Must be called before writing pixels through the pointers returned by get_unsafe() or operator() (the non-const getAs() already calls it).
+			  * \note (New in MRPT 1.5.0) */
+			void makeSureImageIsWritable();
+
 			/** For external storage image objects only, this method unloads the image from memory (or does nothing if already unloaded).
 			  *  It does not need to be called explicitly, unless the user wants to save memory for images that will not be used often.
 			  *  If called for an image without the flag "external storage", it is simply ignored.
@@ -919,6 +935,8 @@ namespace mrpt
 			  */
 			mutable bool	m_imgIsExternalStorage;
 			mutable std::string 	m_externalFile;		//!< The file name of a external storage image.
+			/** If not empty, "img" is just an image header whose pixels live in the memory block of this owner (see isSharingData()) */
+			TMemoryBlockOwnerPtr	m_sharedData;
 
 			/** @} */
 
@@ -933,6 +951,10 @@ namespace mrpt
 			/** Release the internal IPL image, if not NULL or read-only. */
 			void releaseIpl(bool thisIsExternalImgUnload = false) MRPT_NO_THROWS;
 
+			/** Makes the image reference the next rows of the stream with CStream::ReadBufferZeroCopy(), instead of copying them.
+			  * \return false if the stream does not support it, in which case nothing is read. */
+			bool setFromStreamZeroCopy(mrpt::utils::CStream &in, unsigned int width, unsigned int height, TImageChannels nChannels, bool originTopLeft, size_t rowStride);
+
 			/** Checks if the image is of type "external storage", and if so and not loaded yet, load it. */
 			void makeSureImageIsLoaded() const throw (std::exception,utils::CExceptionExternalImageNotFound );
 
@@ -0,0 +1,70 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef  CMemoryMappedFile_H
+#define  CMemoryMappedFile_H
+
+#include <mrpt/utils/core_defs.h>
+#include <mrpt/utils/CUncopiable.h>
+#include <mrpt/utils/TMemoryBlockOwner.h>
+#include <mrpt/base/link_pragmas.h>
+#include <string>
+
+namespace mrpt
+{
+	namespace utils
+	{
+		/** A read-only view of a whole file mapped into memory (mmap() in POSIX, CreateFileMapping() in Windows).
+		 *  Pages are loaded by the OS on demand, so opening a file is nearly instantaneous regardless of its size,
+		 *  and only the accessed parts of the file consume (shared, reclaimable) memory.
+		 *
+		 *  To parse objects from the mapped memory, use a mrpt::utils::CMemoryStream with \a assignMemoryNotOwn().
+		 *  If the object is handled through a TMemoryBlockOwnerPtr, use \a assignMemorySharedOwner() instead so deserialized
+		 *  objects may reference the mapped memory without copying it (zero-copy); the file then remains mapped until the last
+		 *  such object is destroyed.
+		 *
+		 *  The mapping is read-only: any attempt to write to the mapped memory (e.g. through a const_cast) crashes the program
+		 *  instead of silently changing data shared with other objects. Objects referencing the mapped memory must make a private
+		 *  copy before modifying it (see mrpt::utils::CImage::makeSureImageIsWritable()).
+		 *
+		 * \note (New in MRPT 1.5.0)
+		 * \sa CFileInputStream, CMemoryStream
+		 * \ingroup mrpt_base_grp
+		 */
+		class BASE_IMPEXP CMemoryMappedFile : public TMemoryBlockOwner, public CUncopiable
+		{
+		public:
+			CMemoryMappedFile(); //!< Default constructor, see open()
+
+			/** Constructor which maps the given file
+			  * \exception std::exception On error opening or mapping the file
+			  */
+			explicit CMemoryMappedFile(const std::string &fileName);
+
+			~CMemoryMappedFile();
+
+			/** Maps the given file (unmapping any previous one) \return false on any error */
+			bool open(const std::string &fileName);
+			void close(); //!< Unmaps the file, if any
+			bool isOpen() const { return m_is_open; } //!< Returns true if a file was mapped successfully
+
+			const uint8_t *data() const { return m_data; } //!< Pointer to the first byte of the file (NULL for empty files)
+			uint64_t size() const { return m_size; } //!< Size of the file, in bytes
+			const std::string & getFileName() const { return m_fileName; }
+
+		private:
+			const uint8_t *m_data;
+			uint64_t       m_size;
+			bool           m_is_open;
+			std::string    m_fileName;
+			void          *m_hFile, *m_hMapping; //!< OS handles (Windows only)
+		};
+
+	} // End of namespace
+} // end of namespace
+#endif
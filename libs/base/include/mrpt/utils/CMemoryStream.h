@@ -34,6 +34,7 @@ namespace utils
 		uint64_t         m_size, m_position, m_bytesWritten;
 		uint64_t         m_alloc_block_size;
 		bool             m_read_only;   //!< If the memory block does not belong to the object.
+		TMemoryBlockOwnerPtr m_owner;   //!< The owner of the memory block, if set with assignMemorySharedOwner()
 		void resize(uint64_t newSize); //!< Resizes the internal buffer size.
 	public:
 		CMemoryStream(); //!< Default constructor
@@ -47,6 +48,12 @@ namespace utils
 		  *  This method resets the write and read positions to the beginning. */
 		void assignMemoryNotOwn( const void *data, const uint64_t nBytesInData );
 
+		/** Like assignMemoryNotOwn(), but the memory block belongs to a reference-counted \a owner (e.g. a mrpt::utils::CMemoryMappedFile),
+		  *  which is kept alive by this object. This enables ReadBufferZeroCopy(), so objects deserialized from this stream
+		  *  may reference parts of the memory block (keeping their own reference to the owner) instead of copying them.
+		  * \note (New in MRPT 1.5.0) */
+		void assignMemorySharedOwner( const void *data, const uint64_t nBytesInData, const TMemoryBlockOwnerPtr &owner );
+
 		virtual ~CMemoryStream(); //!< Destructor
 
 		void Clear(); //!< Clears the memory buffer.
@@ -60,6 +67,9 @@ namespace utils
 		/** Method for getting the current cursor position, where 0 is the first byte and TotalBytesCount-1 the last one */
 		uint64_t getPosition() MRPT_OVERRIDE;
 
+		// See docs in base class
+		const void * ReadBufferZeroCopy(size_t Count, TMemoryBlockOwnerPtr &out_owner) MRPT_OVERRIDE;
+
 		/** Method for getting a pointer to the raw stored data. The lenght in bytes is given by getTotalBytesCount */
 		void* getRawBufferData();
 
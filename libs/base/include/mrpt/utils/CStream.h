@@ -14,6 +14,7 @@
 #include <mrpt/utils/CUncopiable.h>
 #include <mrpt/utils/exceptions.h>
 #include <mrpt/utils/bits.h> // reverseBytesInPlace()
+#include <mrpt/utils/TMemoryBlockOwner.h>
 #include <vector>
 
 namespace mrpt
@@ -106,6 +107,16 @@ namespace mrpt
 			}
 
 
+			/** Returns a pointer to the next \a Count bytes of the stream without copying them, and advances the read position, if
+			 *  the stream is backed by a block of memory with a known owner (see CMemoryStream::assignMemorySharedOwner()).
+			 *  The returned memory remains valid as long as \a out_owner (or any copy of it) is alive, even after the stream is destroyed.
+			 *  This is used by classes with large payloads (e.g. mrpt::utils::CImage) to reference the data instead of copying it while deserializing.
+			 * \return NULL if the stream does not support this operation (the default) or there are less than \a Count bytes left;
+			 *  in that case the stream position is unchanged and the caller must fall back to ReadBuffer().
+			 * \note The memory must be treated as read-only. (New in MRPT 1.5.0)
+			 */
+			virtual const void * ReadBufferZeroCopy(size_t Count, TMemoryBlockOwnerPtr &out_owner) { MRPT_UNUSED_PARAM(Count); MRPT_UNUSED_PARAM(out_owner); return NULL; }
+
 			/** Reads a block of bytes from the stream into Buffer, and returns the amound of bytes actually read, without waiting for more extra bytes to arrive (just those already enqued in the stream).
 			 *  Note that this method will fallback to ReadBuffer() in most CStream classes but in some hardware-related  classes.
 			 *	\exception std::exception On any error, or if ZERO bytes are read.
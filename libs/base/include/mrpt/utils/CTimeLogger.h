@@ -14,6 +14,7 @@
 #include <mrpt/utils/compiler_fixes.h>
 #include <mrpt/utils/mrpt_macros.h>
 #include <mrpt/utils/ts_hash_map.h>
+#include <mrpt/utils/types_simple.h>
 #include <vector>
 #include <stack>
 //#include <map>
@@ -22,6 +23,8 @@ namespace mrpt
 {
 	namespace utils
 	{
+		namespace detail { struct TTimeLoggerTraceImpl; }
+
 		/** A versatile "profiler" that logs the time spent within each pair of calls to enter(X)-leave(X), among other stats.
 		 *  The results can be dumped to cout or to Visual Studio's output panel.
 		 *  Recursive methods are supported with no problems, that is, calling "enter(X) enter(X) ... leave(X) leave(X)".
@@ -33,6 +36,25 @@ namespace mrpt
 		 * - `enter()`: average 445 ns
 		 * - `leave()`: average 316 ns
 		 *
+		 * <b>Section handles and traces:</b> For hot loops, sections can be registered once with registerSection() and then
+		 * timed with the `enter(TSectionHandle)`/`leave(TSectionHandle)` overloads, which avoid looking up the section name:
+		 * each thread appends its events to its own lock-free buffer, and the stats are only updated when they are queried
+		 * (getStats(), dumpAllStats(),...). Nested sections are supported, and if tracing is enabled with enableTracing(),
+		 * all the events are also kept (with their thread and nesting) to be exported with saveTraceToChromeJSON() (viewable
+		 * in Chrome's `chrome://tracing`) or saveTraceToFoldedStacks() (the input format of flamegraph.pl):
+		 * \code
+		 *  static const CTimeLogger::TSectionHandle hICP = CTimeLogger::registerSection("icp");
+		 *  logger.enableTracing();
+		 *  // ...
+		 *  {
+		 *    CTimeLoggerEntry tle(logger, hICP);
+		 *    // ...
+		 *  }
+		 *  // ...
+		 *  logger.saveTraceToChromeJSON("trace.json");
+		 *  logger.clearTrace();
+		 * \endcode
+		 *
 		 * \sa CTimeLoggerEntry
 		 *
 		 * \note The default behavior is dumping all the information at destruction.
@@ -57,11 +79,24 @@ namespace mrpt
 			};
 		protected:
 			typedef mrpt::utils::ts_hash_map<std::string, TCallData, 1 /* bytes hash */, 10 /* allowed hash collisions */> TDataMap; // Was: std::map<std::string,TCallData>
-			TDataMap  m_data;
+			mutable TDataMap  m_data;
 
 			void do_enter( const char *func_name );
 			double do_leave( const char *func_name );
 
+		public:
+			/** A precompiled section name, see registerSection() */
+			typedef uint32_t TSectionHandle;
+
+		protected:
+			void do_enter( const TSectionHandle section );
+			double do_leave( const TSectionHandle section );
+			/** Moves the events from all the per-thread buffers into the stats in m_data (and the trace, if enabled) */
+			void flushEventBuffers() const;
+
+		private:
+			detail::TTimeLoggerTraceImpl *m_trace;
+
 		public:
 			/** Data of each call section: # of calls, minimum, maximum, average and overall execution time (in seconds) \sa getStats */
 			struct BASE_IMPEXP TCallStats
@@ -102,6 +137,42 @@ namespace mrpt
 			inline double leave( const char *func_name ) {
 				return m_enabled ? do_leave(func_name) : 0;
 			}
+			/** @name Section handles and traces (New in MRPT 1.5.0)
+			    @{ */
+
+			/** Returns the handle of a section name, valid for all CTimeLogger objects, to be used in `enter()`/`leave()`. Thread-safe.
+			  * Registering the same name again returns the same handle, so it is normally stored in a static variable. */
+			static TSectionHandle registerSection(const std::string &section_name);
+			/** Returns the name of a section registered with registerSection() */
+			static std::string getSectionName(const TSectionHandle section);
+
+			/** Start of a registered section. Thread-safe and lock-free. \sa registerSection */
+			inline void enter( const TSectionHandle section ) {
+				if (m_enabled)
+					do_enter(section);
+			}
+			/** End of a registered section. Thread-safe and lock-free. \return The ellapsed time, in seconds or 0 if disabled. */
+			inline double leave( const TSectionHandle section ) {
+				return m_enabled ? do_leave(section) : 0;
+			}
+
+			/** Enables keeping all the events of registered sections (timestamp, duration, thread and nesting), for saveTraceToChromeJSON() and saveTraceToFoldedStacks().
+			  * \param[in] max_events If more events are recorded (and not removed with clearTrace()), the newer ones are dropped. */
+			void enableTracing(bool enable = true, size_t max_events = 1000000);
+			bool isTracingEnabled() const;
+			/** Returns the number of events in the trace (sections which have been left since tracing was enabled or the last clearTrace()) */
+			size_t getTraceEventCount() const;
+			/** Returns the number of events which did not fit in the trace, see enableTracing() */
+			size_t getTraceDroppedCount() const;
+			/** Removes all the events from the trace (and resets the count of dropped events) */
+			void clearTrace();
+			/** Saves the trace in the Chrome trace-event JSON format (load it in `chrome://tracing`) \return false on error creating the file */
+			bool saveTraceToChromeJSON(const std::string &json_file) const;
+			/** Saves the trace as "folded stacks", one line per nesting path with its exclusive time in microseconds (e.g. `slam;icp;kdtree 1234`),
+			  * the input format of the `flamegraph.pl` script. \return false on error creating the file */
+			bool saveTraceToFoldedStacks(const std::string &folded_file) const;
+			/** @} */
+
 			/** Return the mean execution time of the given "section", or 0 if it hasn't ever been called "enter" with that section name */
 			double getMeanTime(const std::string &name) const;
 			/** Return the last execution time of the given "section", or 0 if it hasn't ever been called "enter" with that section name */
@@ -127,9 +198,11 @@ namespace mrpt
 		struct BASE_IMPEXP CTimeLoggerEntry
 		{
 			CTimeLoggerEntry(CTimeLogger &logger, const char*section_name );
+			CTimeLoggerEntry(CTimeLogger &logger, const CTimeLogger::TSectionHandle section ); //!< For sections registered with CTimeLogger::registerSection() (New in MRPT 1.5.0)
 			~CTimeLoggerEntry();
 			CTimeLogger &m_logger;
 			const char *m_section_name;
+			CTimeLogger::TSectionHandle m_section;
 		};
 
 
@@ -0,0 +1,38 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef  TMemoryBlockOwner_H
+#define  TMemoryBlockOwner_H
+
+#include <mrpt/utils/core_defs.h>
+#include <mrpt/otherlibs/stlplus/smart_ptr.hpp>
+#include <mrpt/base/link_pragmas.h>
+
+namespace mrpt
+{
+	namespace utils
+	{
+		/** Base class for objects which own a block of memory that other objects may reference without copying it
+		  * (e.g. a memory-mapped file, see CMemoryMappedFile). Such objects are handled through the reference-counted
+		  * smart pointer TMemoryBlockOwnerPtr, so the memory block is only released when the last object referencing it is destroyed.
+		  *
+		  * \note (New in MRPT 1.5.0)
+		  * \sa CMemoryStream::assignMemorySharedOwner(), CStream::ReadBufferZeroCopy()
+		  * \ingroup mrpt_base_grp
+		  */
+		struct BASE_IMPEXP TMemoryBlockOwner
+		{
+			virtual ~TMemoryBlockOwner();
+		};
+
+		/** A reference-counted pointer to the owner of a shared block of memory \sa TMemoryBlockOwner */
+		typedef stlplus::smart_ptr_nocopy<TMemoryBlockOwner> TMemoryBlockOwnerPtr;
+
+	} // End of namespace
+} // end of namespace
+#endif
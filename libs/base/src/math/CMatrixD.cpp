@@ -65,9 +65,9 @@ void  CMatrixD::readFromStream(mrpt::utils::CStream &in, int version)
 
 			setSize(nRows,nCols);
 
+			// Row-major storage: read all the rows at once
 			if (nRows>0 && nCols>0)
-				for (Index i=0;i<rows();i++)
-					in.ReadBufferFixEndianness<Scalar>(&coeffRef(i,0),nCols);
+				in.ReadBufferFixEndianness<Scalar>(&coeffRef(0,0),static_cast<size_t>(nRows)*nCols);
 		} break;
 	default:
 		MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version)
@@ -10,6 +10,7 @@
 #include "base-precomp.h"  // Precompiled headers
 
 #include <mrpt/math/CSparseMatrix.h>
+#include <algorithm>
 
 using std::string;
 using std::cout;
@@ -334,6 +335,11 @@ CSparseMatrix::CholeskyDecomp::CholeskyDecomp(const CSparseMatrix &SM) :
 	ASSERT_(SM.getColCount()==SM.getRowCount())
 	ASSERT_(SM.isColumnCompressed())
 
+	// Keep a copy of the sparse structure, so update() can check it:
+	const cs &A = SM.sparse_matrix;
+	m_pattern_p.assign(A.p, A.p+A.n+1);
+	m_pattern_i.assign(A.i, A.i+A.p[A.n]);
+
 	// symbolic decomposition:
 	m_symbolic_structure = cs_schol(1 /* order */, &m_originalSM->sparse_matrix );
 
@@ -392,8 +398,7 @@ void CSparseMatrix::CholeskyDecomp::backsub(
 */
 void CSparseMatrix::CholeskyDecomp::update(const CSparseMatrix &new_SM)
 {
-	ASSERTMSG_(m_originalSM->sparse_matrix.nzmax == new_SM.sparse_matrix.nzmax, "New matrix doesn't have the same sparse structure!");
-	ASSERTMSG_(m_originalSM->sparse_matrix.n == new_SM.sparse_matrix.n, "New matrix doesn't have the same sparse structure!");
+	ASSERTMSG_(hasSameStructure(new_SM), "New matrix doesn't have the same sparse structure!");
 
 	m_originalSM = &new_SM; // Just copy the reference.
 
@@ -407,4 +412,15 @@ void CSparseMatrix::CholeskyDecomp::update(const CSparseMatrix &new_SM)
 		throw mrpt::math::CExceptionNotDefPos("CholeskyDecomp::update: Not positive definite matrix.");
 }
 
+/** Checks whether a matrix has exactly the same sparse structure than the one used to build this decomposition */
+bool CSparseMatrix::CholeskyDecomp::hasSameStructure(const CSparseMatrix &SM) const
+{
+	const cs &A = SM.sparse_matrix;
+	if (!SM.isColumnCompressed() || A.m!=A.n || size_t(A.n)+1!=m_pattern_p.size())
+		return false;
+	if (!std::equal(m_pattern_p.begin(),m_pattern_p.end(),A.p))
+		return false;
+	return size_t(A.p[A.n])==m_pattern_i.size() && std::equal(m_pattern_i.begin(),m_pattern_i.end(),A.i);
+}
+
 // ===============    END OF: CSparseMatrix::CholeskyDecomp  inner class  ==============================
@@ -0,0 +1,369 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "base-precomp.h"  // Precompiled headers
+
+#include <mrpt/math/point_cloud_kernels.h>
+#include <mrpt/poses/CPose2D.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/system/cpu.h>
+#include <limits>
+#include <algorithm>
+
+#if MRPT_SIMD_DISPATCH_X86
+#	include <immintrin.h>
+#endif
+
+using namespace mrpt;
+using namespace mrpt::math;
+using mrpt::system::cpu::CSimdKernel;
+
+// Each kernel has a generic implementation plus SSE2/AVX versions, selected at runtime depending on the CPU.
+// Vectorized versions process as many points as possible in blocks, then pass the index of the first remaining
+// point to the next narrower version. All of them do the same operations in the same order, so results are identical.
+namespace
+{
+	// ------------------ transformPoints ------------------
+	// out = R*in + t, with R a 3x3 row-major rotation matrix.
+	// All the coordinates of each point are loaded before writing its output, so in-place transformations are safe.
+	typedef void (*transform_kernel_t)(const float R[9], const float t[3], const TConstPointCloudSpan &in, const TPointCloudSpan &out, size_t i);
+
+	void transformPoints_generic(const float R[9], const float t[3], const TConstPointCloudSpan &in, const TPointCloudSpan &out, size_t i)
+	{
+		for (; i<in.size; i++)
+		{
+			const float x = in.x[i], y = in.y[i], z = in.z[i];
+			out.x[i] = t[0] + ((R[0]*x + R[1]*y) + R[2]*z);
+			out.y[i] = t[1] + ((R[3]*x + R[4]*y) + R[5]*z);
+			out.z[i] = t[2] + ((R[6]*x + R[7]*y) + R[8]*z);
+		}
+	}
+
+#if MRPT_SIMD_DISPATCH_X86
+	MRPT_TARGET_SSE2 void transformPoints_sse2(const float R[9], const float t[3], const TConstPointCloudSpan &in, const TPointCloudSpan &out, size_t i)
+	{
+		const size_t N = in.size;
+		const __m128 r00 = _mm_set1_ps(R[0]), r01 = _mm_set1_ps(R[1]), r02 = _mm_set1_ps(R[2]);
+		const __m128 r10 = _mm_set1_ps(R[3]), r11 = _mm_set1_ps(R[4]), r12 = _mm_set1_ps(R[5]);
+		const __m128 r20 = _mm_set1_ps(R[6]), r21 = _mm_set1_ps(R[7]), r22 = _mm_set1_ps(R[8]);
+		const __m128 tx = _mm_set1_ps(t[0]), ty = _mm_set1_ps(t[1]), tz = _mm_set1_ps(t[2]);
+		for (; i+4<=N; i+=4)
+		{
+			const __m128 xs = _mm_loadu_ps(in.x+i), ys = _mm_loadu_ps(in.y+i), zs = _mm_loadu_ps(in.z+i);
+			_mm_storeu_ps(out.x+i, _mm_add_ps(tx, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r00,xs),_mm_mul_ps(r01,ys)),_mm_mul_ps(r02,zs))));
+			_mm_storeu_ps(out.y+i, _mm_add_ps(ty, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r10,xs),_mm_mul_ps(r11,ys)),_mm_mul_ps(r12,zs))));
+			_mm_storeu_ps(out.z+i, _mm_add_ps(tz, _mm_add_ps(_mm_add_ps(_mm_mul_ps(r20,xs),_mm_mul_ps(r21,ys)),_mm_mul_ps(r22,zs))));
+		}
+		transformPoints_generic(R,t,in,out,i);
+	}
+
+	MRPT_TARGET_AVX void transformPoints_avx(const float R[9], const float t[3], const TConstPointCloudSpan &in, const TPointCloudSpan &out, size_t i)
+	{
+		const size_t N = in.size;
+		const __m256 r00 = _mm256_set1_ps(R[0]), r01 = _mm256_set1_ps(R[1]), r02 = _mm256_set1_ps(R[2]);
+		const __m256 r10 = _mm256_set1_ps(R[3]), r11 = _mm256_set1_ps(R[4]), r12 = _mm256_set1_ps(R[5]);
+		const __m256 r20 = _mm256_set1_ps(R[6]), r21 = _mm256_set1_ps(R[7]), r22 = _mm256_set1_ps(R[8]);
+		const __m256 tx = _mm256_set1_ps(t[0]), ty = _mm256_set1_ps(t[1]), tz = _mm256_set1_ps(t[2]);
+		for (; i+8<=N; i+=8)
+		{
+			const __m256 xs = _mm256_loadu_ps(in.x+i), ys = _mm256_loadu_ps(in.y+i), zs = _mm256_loadu_ps(in.z+i);
+			_mm256_storeu_ps(out.x+i, _mm256_add_ps(tx, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r00,xs),_mm256_mul_ps(r01,ys)),_mm256_mul_ps(r02,zs))));
+			_mm256_storeu_ps(out.y+i, _mm256_add_ps(ty, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r10,xs),_mm256_mul_ps(r11,ys)),_mm256_mul_ps(r12,zs))));
+			_mm256_storeu_ps(out.z+i, _mm256_add_ps(tz, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r20,xs),_mm256_mul_ps(r21,ys)),_mm256_mul_ps(r22,zs))));
+		}
+		transformPoints_sse2(R,t,in,out,i);
+	}
+#endif
+
+	const CSimdKernel<transform_kernel_t> & transformPoints_kernel()
+	{
+		static const CSimdKernel<transform_kernel_t> k = CSimdKernel<transform_kernel_t>("transformPoints")
+#if MRPT_SIMD_DISPATCH_X86
+			.add("avx", &transformPoints_avx, mrpt::system::cpu::fAVX)
+			.add("sse2", &transformPoints_sse2, mrpt::system::cpu::fSSE2)
+#endif
+			.add("generic", &transformPoints_generic);
+		return k;
+	}
+
+	void transformPoints_impl(const float R[9], const float t[3], const TConstPointCloudSpan &in, const TPointCloudSpan &out)
+	{
+		ASSERT_EQUAL_(in.size,out.size)
+		if (!in.size) return;
+		ASSERT_(in.x && in.y && in.z && out.x && out.y && out.z)
+		transformPoints_kernel().get()(R,t,in,out,0);
+	}
+
+	// ------------------ boundingBox ------------------
+	// Updates the min/max with the values v[i], v[i+1],... v[N-1]
+	typedef void (*minmax_kernel_t)(const float *v, size_t N, float &vmin, float &vmax, size_t i);
+
+	void minMax_generic(const float *v, size_t N, float &vmin, float &vmax, size_t i)
+	{
+		for (; i<N; i++) {
+			vmin = std::min(vmin,v[i]);
+			vmax = std::max(vmax,v[i]);
+		}
+	}
+
+#if MRPT_SIMD_DISPATCH_X86
+	MRPT_TARGET_SSE2 void minMax_sse2(const float *v, size_t N, float &vmin, float &vmax, size_t i)
+	{
+		if (i+4<=N)
+		{
+			__m128 mins = _mm_set1_ps(vmin), maxs = _mm_set1_ps(vmax);
+			for (; i+4<=N; i+=4)
+			{
+				const __m128 vs = _mm_loadu_ps(v+i);
+				mins = _mm_min_ps(mins,vs); maxs = _mm_max_ps(maxs,vs);
+			}
+			MRPT_ALIGN16 float tmp_min[4], tmp_max[4];
+			_mm_store_ps(tmp_min,mins); _mm_store_ps(tmp_max,maxs);
+			for (int j=0;j<4;j++) {
+				vmin = std::min(vmin,tmp_min[j]);
+				vmax = std::max(vmax,tmp_max[j]);
+			}
+		}
+		minMax_generic(v,N,vmin,vmax,i);
+	}
+
+	MRPT_TARGET_AVX void minMax_avx(const float *v, size_t N, float &vmin, float &vmax, size_t i)
+	{
+		if (i+8<=N)
+		{
+			__m256 mins = _mm256_set1_ps(vmin), maxs = _mm256_set1_ps(vmax);
+			for (; i+8<=N; i+=8)
+			{
+				const __m256 vs = _mm256_loadu_ps(v+i);
+				mins = _mm256_min_ps(mins,vs); maxs = _mm256_max_ps(maxs,vs);
+			}
+			MRPT_ALIGN32 float tmp_min[8], tmp_max[8];
+			_mm256_store_ps(tmp_min,mins); _mm256_store_ps(tmp_max,maxs);
+			for (int j=0;j<8;j++) {
+				vmin = std::min(vmin,tmp_min[j]);
+				vmax = std::max(vmax,tmp_max[j]);
+			}
+		}
+		minMax_sse2(v,N,vmin,vmax,i);
+	}
+#endif
+
+	const CSimdKernel<minmax_kernel_t> & minMax_kernel()
+	{
+		static const CSimdKernel<minmax_kernel_t> k = CSimdKernel<minmax_kernel_t>("boundingBox")
+#if MRPT_SIMD_DISPATCH_X86
+			.add("avx", &minMax_avx, mrpt::system::cpu::fAVX)
+			.add("sse2", &minMax_sse2, mrpt::system::cpu::fSSE2)
+#endif
+			.add("generic", &minMax_generic);
+		return k;
+	}
+
+	// ------------------ squaredDistancesToPoint ------------------
+	typedef void (*dist2point_kernel_t)(const TConstPointCloudSpan &pts, const TPoint3Df &p, float *out_dist2, bool is3D, size_t i);
+
+	void squaredDistancesToPoint_generic(const TConstPointCloudSpan &pts, const TPoint3Df &p, float *out_dist2, bool is3D, size_t i)
+	{
+		for (; i<pts.size; i++)
+		{
+			const float dx = pts.x[i]-p.x, dy = pts.y[i]-p.y;
+			float d2 = dx*dx + dy*dy;
+			if (is3D) {
+				const float dz = pts.z[i]-p.z;
+				d2 += dz*dz;
+			}
+			out_dist2[i] = d2;
+		}
+	}
+
+#if MRPT_SIMD_DISPATCH_X86
+	MRPT_TARGET_SSE2 void squaredDistancesToPoint_sse2(const TConstPointCloudSpan &pts, const TPoint3Df &p, float *out_dist2, bool is3D, size_t i)
+	{
+		const size_t N = pts.size;
+		const __m128 px = _mm_set1_ps(p.x), py = _mm_set1_ps(p.y), pz = _mm_set1_ps(p.z);
+		for (; i+4<=N; i+=4)
+		{
+			const __m128 dx = _mm_sub_ps(_mm_loadu_ps(pts.x+i),px);
+			const __m128 dy = _mm_sub_ps(_mm_loadu_ps(pts.y+i),py);
+			__m128 d2 = _mm_add_ps(_mm_mul_ps(dx,dx),_mm_mul_ps(dy,dy));
+			if (is3D) {
+				const __m128 dz = _mm_sub_ps(_mm_loadu_ps(pts.z+i),pz);
+				d2 = _mm_add_ps(d2,_mm_mul_ps(dz,dz));
+			}
+			_mm_storeu_ps(out_dist2+i,d2);
+		}
+		squaredDistancesToPoint_generic(pts,p,out_dist2,is3D,i);
+	}
+
+	MRPT_TARGET_AVX void squaredDistancesToPoint_avx(const TConstPointCloudSpan &pts, const TPoint3Df &p, float *out_dist2, bool is3D, size_t i)
+	{
+		const size_t N = pts.size;
+		const __m256 px = _mm256_set1_ps(p.x), py = _mm256_set1_ps(p.y), pz = _mm256_set1_ps(p.z);
+		for (; i+8<=N; i+=8)
+		{
+			const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(pts.x+i),px);
+			const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(pts.y+i),py);
+			__m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx,dx),_mm256_mul_ps(dy,dy));
+			if (is3D) {
+				const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(pts.z+i),pz);
+				d2 = _mm256_add_ps(d2,_mm256_mul_ps(dz,dz));
+			}
+			_mm256_storeu_ps(out_dist2+i,d2);
+		}
+		squaredDistancesToPoint_sse2(pts,p,out_dist2,is3D,i);
+	}
+#endif
+
+	const CSimdKernel<dist2point_kernel_t> & squaredDistancesToPoint_kernel()
+	{
+		static const CSimdKernel<dist2point_kernel_t> k = CSimdKernel<dist2point_kernel_t>("squaredDistancesToPoint")
+#if MRPT_SIMD_DISPATCH_X86
+			.add("avx", &squaredDistancesToPoint_avx, mrpt::system::cpu::fAVX)
+			.add("sse2", &squaredDistancesToPoint_sse2, mrpt::system::cpu::fSSE2)
+#endif
+			.add("generic", &squaredDistancesToPoint_generic);
+		return k;
+	}
+
+	// ------------------ squaredDistances ------------------
+	typedef void (*dist2_kernel_t)(const TConstPointCloudSpan &a, const TConstPointCloudSpan &b, float *out_dist2, bool is3D, size_t i);
+
+	void squaredDistances_generic(const TConstPointCloudSpan &a, const TConstPointCloudSpan &b, float *out_dist2, bool is3D, size_t i)
+	{
+		for (; i<a.size; i++)
+		{
+			const float dx = a.x[i]-b.x[i], dy = a.y[i]-b.y[i];
+			float d2 = dx*dx + dy*dy;
+			if (is3D) {
+				const float dz = a.z[i]-b.z[i];
+				d2 += dz*dz;
+			}
+			out_dist2[i] = d2;
+		}
+	}
+
+#if MRPT_SIMD_DISPATCH_X86
+	MRPT_TARGET_SSE2 void squaredDistances_sse2(const TConstPointCloudSpan &a, const TConstPointCloudSpan &b, float *out_dist2, bool is3D, size_t i)
+	{
+		const size_t N = a.size;
+		for (; i+4<=N; i+=4)
+		{
+			const __m128 dx = _mm_sub_ps(_mm_loadu_ps(a.x+i),_mm_loadu_ps(b.x+i));
+			const __m128 dy = _mm_sub_ps(_mm_loadu_ps(a.y+i),_mm_loadu_ps(b.y+i));
+			__m128 d2 = _mm_add_ps(_mm_mul_ps(dx,dx),_mm_mul_ps(dy,dy));
+			if (is3D) {
+				const __m128 dz = _mm_sub_ps(_mm_loadu_ps(a.z+i),_mm_loadu_ps(b.z+i));
+				d2 = _mm_add_ps(d2,_mm_mul_ps(dz,dz));
+			}
+			_mm_storeu_ps(out_dist2+i,d2);
+		}
+		squaredDistances_generic(a,b,out_dist2,is3D,i);
+	}
+
+	MRPT_TARGET_AVX void squaredDistances_avx(const TConstPointCloudSpan &a, const TConstPointCloudSpan &b, float *out_dist2, bool is3D, size_t i)
+	{
+		const size_t N = a.size;
+		for (; i+8<=N; i+=8)
+		{
+			const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(a.x+i),_mm256_loadu_ps(b.x+i));
+			const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(a.y+i),_mm256_loadu_ps(b.y+i));
+			__m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx,dx),_mm256_mul_ps(dy,dy));
+			if (is3D) {
+				const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(a.z+i),_mm256_loadu_ps(b.z+i));
+				d2 = _mm256_add_ps(d2,_mm256_mul_ps(dz,dz));
+			}
+			_mm256_storeu_ps(out_dist2+i,d2);
+		}
+		squaredDistances_sse2(a,b,out_dist2,is3D,i);
+	}
+#endif
+
+	const CSimdKernel<dist2_kernel_t> & squaredDistances_kernel()
+	{
+		static const CSimdKernel<dist2_kernel_t> k = CSimdKernel<dist2_kernel_t>("squaredDistances")
+#if MRPT_SIMD_DISPATCH_X86
+			.add("avx", &squaredDistances_avx, mrpt::system::cpu::fAVX)
+			.add("sse2", &squaredDistances_sse2, mrpt::system::cpu::fSSE2)
+#endif
+			.add("generic", &squaredDistances_generic);
+		return k;
+	}
+}
+
+/*---------------------------------------------------------------
+					transformPoints
+---------------------------------------------------------------*/
+void mrpt::math::transformPoints(const mrpt::poses::CPose3D &pose, const TConstPointCloudSpan &in, const TPointCloudSpan &out)
+{
+	MRPT_START
+	const CMatrixDouble33 &rot = pose.getRotationMatrix();
+	float R[9], t[3];
+	for (int r=0;r<3;r++)
+		for (int c=0;c<3;c++)
+			R[3*r+c] = static_cast<float>(rot(r,c));
+	t[0] = static_cast<float>(pose.x());
+	t[1] = static_cast<float>(pose.y());
+	t[2] = static_cast<float>(pose.z());
+	transformPoints_impl(R,t,in,out);
+	MRPT_END
+}
+
+void mrpt::math::transformPoints(const mrpt::poses::CPose2D &pose, const TConstPointCloudSpan &in, const TPointCloudSpan &out)
+{
+	MRPT_START
+	const float ccos = static_cast<float>(pose.phi_cos()), csin = static_cast<float>(pose.phi_sin());
+	const float R[9] = { ccos,-csin,0,  csin,ccos,0,  0,0,1 };
+	const float t[3] = { static_cast<float>(pose.x()), static_cast<float>(pose.y()), 0 };
+	transformPoints_impl(R,t,in,out);
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+					boundingBox
+---------------------------------------------------------------*/
+void mrpt::math::boundingBox(const TConstPointCloudSpan &pts, TPoint3Df &bbMin, TPoint3Df &bbMax)
+{
+	const size_t N = pts.size;
+	float mins[3], maxs[3];
+	for (int k=0;k<3;k++) {
+		mins[k] = std::numeric_limits<float>::max();
+		maxs[k] = -std::numeric_limits<float>::max();
+	}
+	if (N)
+	{
+		ASSERT_(pts.x && pts.y && pts.z)
+		const minmax_kernel_t minMax = minMax_kernel().get();
+		const float *coords[3] = { pts.x, pts.y, pts.z };
+		for (int k=0;k<3;k++)
+			minMax(coords[k],N,mins[k],maxs[k],0);
+	}
+	bbMin = TPoint3Df(mins[0],mins[1],mins[2]);
+	bbMax = TPoint3Df(maxs[0],maxs[1],maxs[2]);
+}
+
+/*---------------------------------------------------------------
+					squaredDistancesToPoint
+---------------------------------------------------------------*/
+void mrpt::math::squaredDistancesToPoint(const TConstPointCloudSpan &pts, const TPoint3Df &p, float *out_dist2)
+{
+	if (!pts.size) return;
+	ASSERT_(pts.x && pts.y && out_dist2)
+	squaredDistancesToPoint_kernel().get()(pts,p,out_dist2,pts.z!=NULL,0);
+}
+
+/*---------------------------------------------------------------
+					squaredDistances
+---------------------------------------------------------------*/
+void mrpt::math::squaredDistances(const TConstPointCloudSpan &a, const TConstPointCloudSpan &b, float *out_dist2)
+{
+	ASSERT_EQUAL_(a.size,b.size)
+	if (!a.size) return;
+	ASSERT_(a.x && a.y && b.x && b.y && out_dist2)
+	squaredDistances_kernel().get()(a,b,out_dist2,a.z!=NULL && b.z!=NULL,0);
+}
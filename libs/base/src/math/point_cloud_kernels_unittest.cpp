@@ -0,0 +1,169 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/math/point_cloud_kernels.h>
+#include <mrpt/poses/CPose2D.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random.h>
+#include <mrpt/system/cpu.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <algorithm>
+
+using namespace mrpt;
+using namespace mrpt::math;
+using namespace mrpt::poses;
+using namespace mrpt::utils;
+using namespace std;
+
+namespace
+{
+	// Sizes which exercise the SIMD blocks and the scalar tails:
+	const size_t TEST_SIZES[] = { 0, 1, 3, 4, 7, 8, 9, 16, 17, 31, 100 };
+
+	struct TCloud
+	{
+		vector<float> x,y,z;
+		TCloud(size_t N) : x(N), y(N), z(N)
+		{
+			for (size_t i=0;i<N;i++) {
+				x[i] = mrpt::random::randomGenerator.drawUniform(-10,10);
+				y[i] = mrpt::random::randomGenerator.drawUniform(-10,10);
+				z[i] = mrpt::random::randomGenerator.drawUniform(-10,10);
+			}
+		}
+		TPointCloudSpan span() { return x.empty() ? TPointCloudSpan() : TPointCloudSpan(&x[0],&y[0],&z[0],x.size()); }
+	};
+}
+
+TEST(point_cloud_kernels, transformPoints3D)
+{
+	const CPose3D pose(1.0,-2.0,0.5, DEG2RAD(30.0),DEG2RAD(-10.0),DEG2RAD(5.0));
+	for (size_t t=0;t<sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]);t++)
+	{
+		const size_t N = TEST_SIZES[t];
+		TCloud in(N), out(N);
+		transformPoints(pose, in.span(), out.span());
+		for (size_t i=0;i<N;i++)
+		{
+			double gx,gy,gz;
+			pose.composePoint(in.x[i],in.y[i],in.z[i], gx,gy,gz);
+			EXPECT_NEAR(out.x[i], gx, 1e-4);
+			EXPECT_NEAR(out.y[i], gy, 1e-4);
+			EXPECT_NEAR(out.z[i], gz, 1e-4);
+		}
+		// In-place:
+		transformPoints(pose, in.span(), in.span());
+		EXPECT_TRUE(in.x==out.x && in.y==out.y && in.z==out.z);
+	}
+}
+
+TEST(point_cloud_kernels, transformPoints2D)
+{
+	const CPose2D pose(-0.3,4.0,DEG2RAD(-120.0));
+	for (size_t t=0;t<sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]);t++)
+	{
+		const size_t N = TEST_SIZES[t];
+		TCloud in(N), out(N);
+		transformPoints(pose, in.span(), out.span());
+		for (size_t i=0;i<N;i++)
+		{
+			double gx,gy;
+			pose.composePoint(in.x[i],in.y[i], gx,gy);
+			EXPECT_NEAR(out.x[i], gx, 1e-4);
+			EXPECT_NEAR(out.y[i], gy, 1e-4);
+			EXPECT_EQ(out.z[i], in.z[i]);
+		}
+	}
+}
+
+TEST(point_cloud_kernels, boundingBox)
+{
+	for (size_t t=0;t<sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]);t++)
+	{
+		const size_t N = TEST_SIZES[t];
+		TCloud c(N);
+		// All positive coordinates, to detect any padding with zeros:
+		for (size_t i=0;i<N;i++) { c.x[i]+=20; c.y[i]+=20; c.z[i]+=20; }
+
+		TPoint3Df bbMin, bbMax;
+		boundingBox(c.span(), bbMin, bbMax);
+		if (!N)
+		{
+			EXPECT_GT(bbMin.x, bbMax.x);
+			continue;
+		}
+		EXPECT_EQ(bbMin.x, *std::min_element(c.x.begin(),c.x.end()));
+		EXPECT_EQ(bbMax.x, *std::max_element(c.x.begin(),c.x.end()));
+		EXPECT_EQ(bbMin.y, *std::min_element(c.y.begin(),c.y.end()));
+		EXPECT_EQ(bbMax.y, *std::max_element(c.y.begin(),c.y.end()));
+		EXPECT_EQ(bbMin.z, *std::min_element(c.z.begin(),c.z.end()));
+		EXPECT_EQ(bbMax.z, *std::max_element(c.z.begin(),c.z.end()));
+	}
+}
+
+TEST(point_cloud_kernels, squaredDistances)
+{
+	const TPoint3Df p(1.0f,2.0f,-3.0f);
+	for (size_t t=0;t<sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]);t++)
+	{
+		const size_t N = TEST_SIZES[t];
+		TCloud a(N), b(N);
+		vector<float> d3(N+1), d2(N+1), dab(N+1);
+		squaredDistancesToPoint(a.span(), p, &d3[0]);
+		const TConstPointCloudSpan a2D(N ? &a.x[0]:NULL, N ? &a.y[0]:NULL, NULL, N);
+		squaredDistancesToPoint(a2D, p, &d2[0]);
+		squaredDistances(a.span(), b.span(), &dab[0]);
+		for (size_t i=0;i<N;i++)
+		{
+			EXPECT_NEAR(d3[i], square(a.x[i]-p.x)+square(a.y[i]-p.y)+square(a.z[i]-p.z), 1e-3);
+			EXPECT_NEAR(d2[i], square(a.x[i]-p.x)+square(a.y[i]-p.y), 1e-3);
+			EXPECT_NEAR(dab[i], square(a.x[i]-b.x[i])+square(a.y[i]-b.y[i])+square(a.z[i]-b.z[i]), 1e-3);
+		}
+	}
+}
+
+// All the implementations selected at runtime (AVX, SSE2, generic) must give exactly the same results:
+TEST(point_cloud_kernels, allImplementationsIdentical)
+{
+	using namespace mrpt::system::cpu;
+	const CPose3D pose(1.0,-2.0,0.5, DEG2RAD(30.0),DEG2RAD(-10.0),DEG2RAD(5.0));
+	const TPoint3Df p(1.0f,2.0f,-3.0f);
+	const size_t N = 37;
+	TCloud in(N), b(N);
+
+	const TFeature disabled[] = { fNone, fAVX, fSSE2 };
+	vector<float> ref_x, ref_d, ref_dab;
+	TPoint3Df ref_bbMin, ref_bbMax;
+	for (size_t k=0;k<sizeof(disabled)/sizeof(disabled[0]);k++)
+	{
+		if (disabled[k]!=fNone)
+			overrideDetectedFeature(disabled[k], false);
+		TCloud out(N);
+		transformPoints(pose, in.span(), out.span());
+		vector<float> d(N), dab(N);
+		squaredDistancesToPoint(in.span(), p, &d[0]);
+		squaredDistances(in.span(), b.span(), &dab[0]);
+		TPoint3Df bbMin, bbMax;
+		boundingBox(in.span(), bbMin, bbMax);
+		if (!k)
+		{
+			ref_x = out.x; ref_d = d; ref_dab = dab;
+			ref_bbMin = bbMin; ref_bbMax = bbMax;
+			continue;
+		}
+		EXPECT_TRUE(out.x==ref_x) << "Disabled: " << featureName(disabled[k]);
+		EXPECT_TRUE(d==ref_d) << "Disabled: " << featureName(disabled[k]);
+		EXPECT_TRUE(dab==ref_dab) << "Disabled: " << featureName(disabled[k]);
+		EXPECT_TRUE(bbMin.x==ref_bbMin.x && bbMin.y==ref_bbMin.y && bbMin.z==ref_bbMin.z);
+		EXPECT_TRUE(bbMax.x==ref_bbMax.x && bbMax.y==ref_bbMax.y && bbMax.z==ref_bbMax.z);
+	}
+	EXPECT_NE(getKernelsSummary().find("transformPoints: generic"), std::string::npos);
+	resetDetectedFeatures();
+}
@@ -0,0 +1,178 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "base-precomp.h"  // Precompiled headers
+
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/system/threads.h>  // getNumberOfProcessors()
+#include <mrpt/utils/mrpt_macros.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
+#include <algorithm>
+
+namespace mrpt { namespace system { namespace detail {
+	struct TWorkerThreadsPoolImpl
+	{
+		TWorkerThreadsPoolImpl() : num_threads(1), shutdown(false), job_id(0), task(nullptr), pending(0) {}
+		~TWorkerThreadsPoolImpl() { stop(); }
+
+		// Copying a pool does not copy its threads, but creates new ones:
+		TWorkerThreadsPoolImpl & operator =(const TWorkerThreadsPoolImpl &o) {
+			if (this != &o) resize(o.num_threads);
+			return *this;
+		}
+
+		unsigned int num_threads;
+		std::vector<std::thread> threads;
+
+		std::mutex mtx;
+		std::condition_variable cv_job, cv_done;
+		bool shutdown;
+		uint64_t job_id;  //!< Incremented with each new parallel_for() call
+		const CWorkerThreadsPool::TRangeTask *task;
+		std::vector<std::pair<size_t,size_t> > chunks;
+		size_t pending;  //!< Number of chunks not finished yet
+		std::exception_ptr first_error;
+
+		void stop()
+		{
+			{
+				std::lock_guard<std::mutex> lck(mtx);
+				shutdown = true;
+			}
+			cv_job.notify_all();
+			for (auto &t : threads) t.join();
+			threads.clear();
+			std::lock_guard<std::mutex> lck(mtx);
+			shutdown = false;
+			chunks.clear();
+			task = nullptr;
+		}
+
+		void resize(unsigned int n)
+		{
+			if (!n) n = std::max(1U, mrpt::system::getNumberOfProcessors());
+			if (n == num_threads && threads.size() + 1 == n) return;
+			stop();
+			std::lock_guard<std::mutex> lck(mtx);
+			num_threads = n;
+			// New threads must only wake up for jobs started after this point:
+			for (unsigned int i = 1; i < n; i++)
+				threads.emplace_back(&TWorkerThreadsPoolImpl::worker, this, i, job_id);
+		}
+
+		void run_chunk(size_t idx)
+		{
+			try {
+				(*task)(chunks[idx].first, chunks[idx].second);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lck(mtx);
+				if (!first_error) first_error = std::current_exception();
+			}
+		}
+
+		// Worker thread #i always takes chunk #i, if it exists:
+		void worker(unsigned int my_idx, uint64_t last_job)
+		{
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lck(mtx);
+					cv_job.wait(lck, [&]() { return shutdown || job_id != last_job; });
+					if (shutdown) return;
+					last_job = job_id;
+					if (my_idx >= chunks.size()) continue;
+				}
+				run_chunk(my_idx);
+				{
+					std::lock_guard<std::mutex> lck(mtx);
+					if (--pending == 0) cv_done.notify_one();
+				}
+			}
+		}
+	};
+} } }
+
+PIMPL_IMPLEMENT(mrpt::system::detail::TWorkerThreadsPoolImpl);
+
+using namespace mrpt::system;
+
+CWorkerThreadsPool::TRangeTask::~TRangeTask()
+{
+}
+
+CWorkerThreadsPool::CWorkerThreadsPool(unsigned int num_threads)
+{
+	PIMPL_CONSTRUCT(detail::TWorkerThreadsPoolImpl, m_impl);
+	resize(num_threads);
+}
+
+CWorkerThreadsPool::~CWorkerThreadsPool()
+{
+}
+
+void CWorkerThreadsPool::resize(unsigned int num_threads)
+{
+	PIMPL_GET_REF(detail::TWorkerThreadsPoolImpl, m_impl).resize(num_threads);
+}
+
+unsigned int CWorkerThreadsPool::size() const
+{
+	return PIMPL_GET_CONSTREF(detail::TWorkerThreadsPoolImpl, m_impl).num_threads;
+}
+
+void CWorkerThreadsPool::parallel_for(size_t N, const TRangeTask &task, size_t min_chunk_size)
+{
+	detail::TWorkerThreadsPoolImpl &d = PIMPL_GET_REF(detail::TWorkerThreadsPoolImpl, m_impl);
+	if (!N) return;
+	if (!min_chunk_size) min_chunk_size = 1;
+
+	const size_t nChunks = std::max<size_t>(1, std::min<size_t>(d.num_threads, N / min_chunk_size));
+	if (nChunks == 1)
+	{
+		task(0, N);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lck(d.mtx);
+		d.chunks.resize(nChunks);
+		const size_t base = N / nChunks, extra = N % nChunks;
+		size_t first = 0;
+		for (size_t i = 0; i < nChunks; i++)
+		{
+			const size_t len = base + (i < extra ? 1 : 0);
+			d.chunks[i] = std::make_pair(first, first + len);
+			first += len;
+		}
+		d.task = &task;
+		d.pending = nChunks - 1;
+		d.first_error = nullptr;
+		d.job_id++;
+	}
+	d.cv_job.notify_all();
+
+	// The caller thread takes the first chunk:
+	d.run_chunk(0);
+
+	std::exception_ptr err;
+	{
+		std::unique_lock<std::mutex> lck(d.mtx);
+		d.cv_done.wait(lck, [&]() { return d.pending == 0; });
+		d.task = nullptr;
+		err = d.first_error;
+		d.first_error = nullptr;
+	}
+	if (err) std::rethrow_exception(err);
+}
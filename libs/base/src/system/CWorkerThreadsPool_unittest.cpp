@@ -0,0 +1,102 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/utils/mrpt_macros.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <numeric>
+#include <cmath>
+
+using namespace mrpt::system;
+
+namespace
+{
+	struct TaskSqrt : public CWorkerThreadsPool::TRangeTask
+	{
+		std::vector<double> &out;
+		TaskSqrt(std::vector<double> &o) : out(o) {}
+		void operator()(size_t first, size_t last) const MRPT_OVERRIDE {
+			for (size_t i = first; i < last; i++) out[i] = std::sqrt(double(i));
+		}
+	};
+	struct TaskThrow : public CWorkerThreadsPool::TRangeTask
+	{
+		void operator()(size_t first, size_t last) const MRPT_OVERRIDE {
+			MRPT_UNUSED_PARAM(last);
+			if (first == 0) return;
+			THROW_EXCEPTION("Intentional failure");
+		}
+	};
+}
+
+TEST(CWorkerThreadsPool, parallel_for_all_indices)
+{
+	for (unsigned int nThreads = 1; nThreads <= 5; nThreads++)
+	{
+		CWorkerThreadsPool pool(nThreads);
+		EXPECT_EQ(pool.size(), nThreads);
+		for (size_t N : {0, 1, 3, 17, 1000})
+		{
+			std::vector<double> out(N, -1.0);
+			for (int rep = 0; rep < 3; rep++)
+				pool.parallel_for(N, TaskSqrt(out));
+			for (size_t i = 0; i < N; i++)
+				EXPECT_EQ(out[i], std::sqrt(double(i)));
+		}
+	}
+}
+
+TEST(CWorkerThreadsPool, copy_and_resize)
+{
+	CWorkerThreadsPool pool(3);
+	CWorkerThreadsPool pool2(pool);
+	EXPECT_EQ(pool2.size(), 3u);
+	pool2.resize(2);
+	EXPECT_EQ(pool2.size(), 2u);
+	EXPECT_EQ(pool.size(), 3u);
+	pool.resize(0);
+	EXPECT_GE(pool.size(), 1u);
+
+	std::vector<double> out(100);
+	pool2.parallel_for(out.size(), TaskSqrt(out));
+	EXPECT_EQ(out[99], std::sqrt(99.0));
+}
+
+TEST(CWorkerThreadsPool, exceptions_are_rethrown)
+{
+	CWorkerThreadsPool pool(4);
+	EXPECT_THROW(pool.parallel_for(100, TaskThrow()), std::exception);
+	// The pool must still be usable afterwards:
+	std::vector<double> out(10);
+	pool.parallel_for(out.size(), TaskSqrt(out));
+	EXPECT_EQ(out[9], 3.0);
+}
+
+TEST(CWorkerThreadsPool, resize_after_parallel_for)
+{
+	CWorkerThreadsPool pool(2);
+	std::vector<double> out(100, -1.0);
+	pool.parallel_for(out.size(), TaskSqrt(out));
+
+	// New threads must not run chunks of previous jobs:
+	for (unsigned int n = 3; n <= 5; n++)
+	{
+		pool.resize(n);
+		std::vector<double> out2(100, -1.0);
+		pool.parallel_for(out2.size(), TaskSqrt(out2));
+		for (size_t i = 0; i < out2.size(); i++)
+			EXPECT_EQ(out2[i], std::sqrt(double(i)));
+	}
+	// Copies of a used pool, too:
+	CWorkerThreadsPool pool2(1);
+	pool2 = pool;
+	pool2.parallel_for(out.size(), TaskSqrt(out));
+	EXPECT_EQ(out[99], std::sqrt(99.0));
+}
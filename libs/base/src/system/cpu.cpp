@@ -0,0 +1,219 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "base-precomp.h"  // Precompiled headers
+
+#include <mrpt/system/cpu.h>
+#include <mrpt/system/string_utils.h>
+#include <mrpt/synch/CCriticalSection.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#	include <intrin.h>
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#	include <cpuid.h>
+#endif
+#if defined(__arm__) && defined(__linux__)
+#	include <sys/auxv.h>
+#endif
+
+using namespace mrpt::system;
+using namespace mrpt::system::cpu;
+
+namespace
+{
+	const char * FEATURE_NAMES[FEATURE_COUNT] = {
+		"NONE", "SSE2", "SSE3", "SSSE3", "SSE4_1", "SSE4_2", "POPCNT", "AVX", "AVX2", "FMA", "AVX512F", "NEON" };
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	void do_cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+	{
+		int r[4];
+		__cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+		for (int i=0;i<4;i++) regs[i] = static_cast<unsigned int>(r[i]);
+	}
+	unsigned long long do_xgetbv() { return _xgetbv(0); }
+#	define MRPT_HAS_CPUID 1
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	void do_cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+	{
+		regs[0]=regs[1]=regs[2]=regs[3]=0;
+		if (leaf > __get_cpuid_max(0, NULL)) return;
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+	}
+	unsigned long long do_xgetbv()
+	{
+		unsigned int eax, edx;
+		__asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0)); // xgetbv, for old assemblers
+		return (static_cast<unsigned long long>(edx) << 32) | eax;
+	}
+#	define MRPT_HAS_CPUID 1
+#else
+#	define MRPT_HAS_CPUID 0
+#endif
+
+	/** Detected features, plus the ones currently in use (detected minus those disabled) */
+	struct TCPUFeatures
+	{
+		bool detected[FEATURE_COUNT];
+		bool current[FEATURE_COUNT];
+
+		TCPUFeatures()
+		{
+			for (int i=0;i<FEATURE_COUNT;i++) detected[i]=false;
+			detected[fNone] = true;
+			detect();
+			reset();
+			applyEnvironmentOverrides();
+		}
+
+		void reset()
+		{
+			for (int i=0;i<FEATURE_COUNT;i++) current[i]=detected[i];
+		}
+
+		void detect()
+		{
+#if MRPT_HAS_CPUID
+			unsigned int r1[4], r7[4];
+			do_cpuid(1, 0, r1);
+			do_cpuid(7, 0, r7);
+			const unsigned int ecx1 = r1[2], edx1 = r1[3], ebx7 = r7[1];
+
+			detected[fSSE2]   = (edx1 & (1u<<26))!=0;
+			detected[fSSE3]   = (ecx1 & (1u<<0))!=0;
+			detected[fSSSE3]  = (ecx1 & (1u<<9))!=0;
+			detected[fSSE4_1] = (ecx1 & (1u<<19))!=0;
+			detected[fSSE4_2] = (ecx1 & (1u<<20))!=0;
+			detected[fPOPCNT] = (ecx1 & (1u<<23))!=0;
+
+			// AVX registers can only be used if the OS saves them in context switches:
+			const bool osxsave = (ecx1 & (1u<<27))!=0;
+			const unsigned long long xcr0 = osxsave ? do_xgetbv() : 0;
+			const bool os_avx = (xcr0 & 0x06)==0x06;
+			const bool os_avx512 = (xcr0 & 0xE6)==0xE6;
+
+			detected[fAVX]     = os_avx && (ecx1 & (1u<<28))!=0;
+			detected[fFMA]     = detected[fAVX] && (ecx1 & (1u<<12))!=0;
+			detected[fAVX2]    = detected[fAVX] && (ebx7 & (1u<<5))!=0;
+			detected[fAVX512F] = os_avx512 && (ebx7 & (1u<<16))!=0;
+#elif defined(__aarch64__)
+			detected[fNEON] = true; // Mandatory in ARMv8
+#elif defined(__arm__) && defined(__linux__)
+			detected[fNEON] = (getauxval(AT_HWCAP) & (1<<12) /*HWCAP_NEON*/)!=0;
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+			detected[fNEON] = true;
+#endif
+		}
+
+		void applyEnvironmentOverrides()
+		{
+			const char *env = ::getenv("MRPT_DISABLE_CPU_FEATURES");
+			if (!env) return;
+			std::vector<std::string> names;
+			mrpt::system::tokenize(env, ", ", names);
+			for (size_t k=0;k<names.size();k++)
+			{
+				const std::string name = mrpt::system::upperCase(names[k]);
+				for (int i=fNone+1;i<FEATURE_COUNT;i++)
+					if (name=="ALL" || name==FEATURE_NAMES[i])
+						current[i] = false;
+			}
+		}
+	};
+
+	TCPUFeatures & getFeatures()
+	{
+		static TCPUFeatures f;
+		return f;
+	}
+
+	struct TKernelsRegistry
+	{
+		mrpt::synch::CCriticalSection cs;
+		std::vector<const CSimdKernelBase*> kernels;
+	};
+	TKernelsRegistry & getKernelsRegistry()
+	{
+		static TKernelsRegistry r;
+		return r;
+	}
+}
+
+bool mrpt::system::cpu::supports(TFeature f)
+{
+	return f>=fNone && f<FEATURE_COUNT && getFeatures().current[f];
+}
+
+void mrpt::system::cpu::overrideDetectedFeature(TFeature f, bool available)
+{
+	if (f>fNone && f<FEATURE_COUNT)
+		getFeatures().current[f] = available;
+}
+
+void mrpt::system::cpu::resetDetectedFeatures()
+{
+	getFeatures().reset();
+}
+
+const char * mrpt::system::cpu::featureName(TFeature f)
+{
+	return (f>=fNone && f<FEATURE_COUNT) ? FEATURE_NAMES[f] : "";
+}
+
+std::string mrpt::system::cpu::featuresAsString()
+{
+	std::string s;
+	for (int i=fNone+1;i<FEATURE_COUNT;i++)
+	{
+		if (!supports(static_cast<TFeature>(i))) continue;
+		if (!s.empty()) s+=' ';
+		s+=FEATURE_NAMES[i];
+	}
+	return s;
+}
+
+CSimdKernelBase::CSimdKernelBase(const char *name) :
+	m_name(name)
+{
+	TKernelsRegistry &r = getKernelsRegistry();
+	mrpt::synch::CCriticalSectionLocker lock(&r.cs);
+	r.kernels.push_back(this);
+}
+
+CSimdKernelBase::~CSimdKernelBase()
+{
+	TKernelsRegistry &r = getKernelsRegistry();
+	mrpt::synch::CCriticalSectionLocker lock(&r.cs);
+	r.kernels.erase(std::remove(r.kernels.begin(), r.kernels.end(), this), r.kernels.end());
+}
+
+std::string mrpt::system::cpu::getKernelsSummary()
+{
+	TKernelsRegistry &r = getKernelsRegistry();
+	mrpt::synch::CCriticalSectionLocker lock(&r.cs);
+	std::string s;
+	for (size_t k=0;k<r.kernels.size();k++)
+	{
+		s += r.kernels[k]->getName();
+		s += ": ";
+		s += r.kernels[k]->getSelectedName();
+		s += " [";
+		const std::vector<std::string> names = r.kernels[k]->getImplementationNames();
+		for (size_t i=0;i<names.size();i++)
+		{
+			if (i) s+=' ';
+			s+=names[i];
+		}
+		s += "]\n";
+	}
+	return s;
+}
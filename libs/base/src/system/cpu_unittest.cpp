@@ -0,0 +1,64 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/system/cpu.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt::system::cpu;
+
+namespace
+{
+	typedef int (*test_kernel_t)();
+	int kernel_a() { return 1; }
+	int kernel_b() { return 2; }
+	int kernel_generic() { return 3; }
+}
+
+TEST(cpu, detectedFeatures)
+{
+	resetDetectedFeatures();
+	EXPECT_TRUE(supports(fNone));
+#if defined(__x86_64__) || defined(_M_X64)
+	EXPECT_TRUE(supports(fSSE2)); // Mandatory in x86-64
+#endif
+#if defined(__AVX2__)
+	EXPECT_TRUE(supports(fAVX2));  // This program was built for AVX2, so it must be running on such a CPU
+#endif
+	// AVX2 implies AVX:
+	if (supports(fAVX2)) {
+		EXPECT_TRUE(supports(fAVX));
+	}
+	EXPECT_STREQ(featureName(fSSE4_1), "SSE4_1");
+}
+
+TEST(cpu, overrideAndKernelSelection)
+{
+	resetDetectedFeatures();
+	overrideDetectedFeature(fAVX2, true); // Only for testing the selection: kernels above do not use AVX2
+	overrideDetectedFeature(fFMA, false);
+	overrideDetectedFeature(fSSE2, true);
+
+	const CSimdKernel<test_kernel_t> k = CSimdKernel<test_kernel_t>("cpu_unittest")
+		.add("a", &kernel_a, fAVX2, fFMA)
+		.add("b", &kernel_b, fSSE2)
+		.add("generic", &kernel_generic);
+	EXPECT_EQ(k.get()(), 2);
+	EXPECT_STREQ(k.getSelectedName(), "b");
+	EXPECT_EQ(featuresAsString().find("FMA"), std::string::npos);
+
+	overrideDetectedFeature(fFMA, true);
+	EXPECT_EQ(k.get()(), 1);
+
+	overrideDetectedFeature(fAVX2, false);
+	overrideDetectedFeature(fSSE2, false);
+	EXPECT_EQ(k.get()(), 3);
+	EXPECT_NE(getKernelsSummary().find("cpu_unittest: generic [a b generic]"), std::string::npos);
+
+	resetDetectedFeatures();
+}
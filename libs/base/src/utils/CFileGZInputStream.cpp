@@ -20,16 +20,107 @@
 
 
 #include <zlib.h>
+#include <cstdio>
+#include <cstring>
+#include "gz_blocks.h"
 
 using namespace mrpt::utils;
+using namespace mrpt::utils::internal;
 using namespace std;
 
 #define THE_GZFILE   reinterpret_cast<gzFile>(m_f)
+#define THE_FILE     reinterpret_cast<FILE*>(m_f)
+
+namespace mrpt { namespace utils { namespace detail {
+	/** Data of CFileGZInputStream for block-compressed files: members are read in batches of
+	  * a few per thread, decompressed in parallel and then served in order. */
+	struct TGZParallelReader
+	{
+		TGZParallelReader(FILE *f_, unsigned int num_threads) :
+			f(f_), threads(num_threads), cur_block(0), cur_pos(0), total_out(0), file_eof(false)
+		{ }
+
+		FILE *f;
+		mrpt::system::CWorkerThreadsPool threads;
+		std::vector<std::vector<uint8_t> > members, decoded;
+		size_t cur_block, cur_pos; //!< Next byte to be read from `decoded`
+		uint64_t total_out; //!< Total uncompressed bytes read
+		bool file_eof;
+		std::string pending_error; //!< Error found after the members of the current batch, reported once they are consumed
+
+		/** Reads and decompresses the next batch of members. \return false at EOF */
+		bool refill()
+		{
+			const size_t BLOCKS_PER_THREAD = 2;
+			const size_t nMax = BLOCKS_PER_THREAD*threads.size();
+			if (!pending_error.empty())
+				THROW_EXCEPTION(pending_error)
+			members.resize(nMax);
+			decoded.resize(nMax);
+			size_t n = 0;
+			// Errors (e.g. the last member of a crashed recording being truncated) are delayed until all the previous,
+			// valid members have been read:
+			while (n<nMax && !file_eof && pending_error.empty())
+			{
+				uint8_t hdr[GZ_BLOCK_HEADER_SIZE];
+				const size_t nRead = fread(hdr,1,GZ_BLOCK_HEADER_SIZE,f);
+				if (!nRead) { file_eof = true; break; }
+
+				uint32_t member_size;
+				if (nRead!=GZ_BLOCK_HEADER_SIZE || !gz_block_parse_header(hdr,member_size))
+				{
+					pending_error = "Unexpected data in block-compressed gzip file";
+					break;
+				}
+				std::vector<uint8_t> &m = members[n];
+				m.resize(member_size);
+				::memcpy(&m[0],hdr,GZ_BLOCK_HEADER_SIZE);
+				const size_t nRest = member_size-GZ_BLOCK_HEADER_SIZE;
+				if (fread(&m[GZ_BLOCK_HEADER_SIZE],1,nRest,f)!=nRest)
+				{
+					pending_error = "Unexpected end of block-compressed gzip file";
+					break;
+				}
+				n++;
+			}
+			if (!n && !pending_error.empty())
+				THROW_EXCEPTION(pending_error)
+			threads.parallel_for(n, TGZBlocksDecompressTask(members,decoded));
+			decoded.resize(n);
+			cur_block = 0;
+			cur_pos = 0;
+			return n>0;
+		}
+
+		size_t read(uint8_t *buf, size_t count)
+		{
+			size_t nDone = 0;
+			while (nDone<count)
+			{
+				if (cur_block>=decoded.size() && !refill())
+					break;
+				const std::vector<uint8_t> &blk = decoded[cur_block];
+				const size_t n = std::min(count-nDone, blk.size()-cur_pos);
+				if (n) ::memcpy(buf+nDone, &blk[cur_pos], n);
+				nDone+=n;
+				cur_pos+=n;
+				if (cur_pos>=blk.size()) { cur_block++; cur_pos = 0; }
+			}
+			total_out+=nDone;
+			return nDone;
+		}
+
+		bool eof() const
+		{
+			return file_eof && cur_block>=decoded.size();
+		}
+	};
+} } }
 
 /*---------------------------------------------------------------
 							Constructor
  ---------------------------------------------------------------*/
-CFileGZInputStream::CFileGZInputStream( const string &fileName ) : m_f(NULL)
+CFileGZInputStream::CFileGZInputStream( const string &fileName ) : m_f(NULL), m_parallel(NULL)
 {
 	MRPT_START
 	open(fileName);
@@ -38,24 +129,39 @@ CFileGZInputStream::CFileGZInputStream( const string &fileName ) : m_f(NULL)
 /*---------------------------------------------------------------
 							Constructor
  ---------------------------------------------------------------*/
-CFileGZInputStream::CFileGZInputStream( ) : m_f(NULL)
+CFileGZInputStream::CFileGZInputStream( ) : m_f(NULL), m_parallel(NULL)
 {
 }
 
 /*---------------------------------------------------------------
 							open
  ---------------------------------------------------------------*/
-bool CFileGZInputStream::open(const std::string &fileName )
+bool CFileGZInputStream::open(const std::string &fileName, unsigned int num_threads )
 {
 	MRPT_START
 
-	if (m_f) gzclose(THE_GZFILE);
+	close();
 
 	// Get compressed file size:
 	m_file_size = mrpt::system::getFileSize(fileName);
 	if (m_file_size==uint64_t(-1))
 		THROW_EXCEPTION_FMT("Couldn't access the file '%s'",fileName.c_str() );
 
+	// Block-compressed file (see CFileGZOutputStream)?
+	{
+		FILE *f = mrpt::system::os::fopen(fileName.c_str(),"rb");
+		uint8_t hdr[GZ_BLOCK_HEADER_SIZE];
+		uint32_t member_size;
+		if (f && fread(hdr,1,GZ_BLOCK_HEADER_SIZE,f)==GZ_BLOCK_HEADER_SIZE && gz_block_parse_header(hdr,member_size))
+		{
+			rewind(f);
+			m_f = f;
+			m_parallel = new detail::TGZParallelReader(f,num_threads);
+			return true;
+		}
+		if (f) mrpt::system::os::fclose(f);
+	}
+
 	// Open gz stream:
 	m_f = gzopen(fileName.c_str(),"rb");
 	return m_f != NULL;
@@ -68,6 +174,13 @@ bool CFileGZInputStream::open(const std::string &fileName )
  ---------------------------------------------------------------*/
 void CFileGZInputStream::close()
 {
+	if (m_parallel)
+	{
+		mrpt::system::os::fclose(THE_FILE);
+		delete m_parallel;
+		m_parallel = NULL;
+		m_f = NULL;
+	}
 	if (m_f)
 	{
 		gzclose(THE_GZFILE);
@@ -91,6 +204,8 @@ size_t  CFileGZInputStream::Read(void *Buffer, size_t Count)
 {
 	if (!m_f) { THROW_EXCEPTION("File is not open."); }
 
+	if (m_parallel)
+		return m_parallel->read(static_cast<uint8_t*>(Buffer),Count);
 	return gzread(THE_GZFILE,Buffer,Count);
 }
 
@@ -119,6 +234,7 @@ uint64_t CFileGZInputStream::getTotalBytesCount()
 uint64_t CFileGZInputStream::getPosition()
 {
 	if (!m_f) { THROW_EXCEPTION("File is not open."); }
+	if (m_parallel) return m_parallel->total_out;
 	return gztell(THE_GZFILE);
 }
 
@@ -136,5 +252,6 @@ bool  CFileGZInputStream::fileOpenCorrectly()
 bool CFileGZInputStream::checkEOF()
 {
 	if (!m_f)	return true;
+	else if (m_parallel) return m_parallel->eof();
 	else		return 0!=gzeof(THE_GZFILE);
 }
@@ -20,18 +20,73 @@
 #if MRPT_HAS_GZ_STREAMS
 
 #include <zlib.h>
+#include <cstdio>
+#include <iostream>
+#include "gz_blocks.h"
 
 #define THE_GZFILE   reinterpret_cast<gzFile>(m_f)
+#define THE_FILE     reinterpret_cast<FILE*>(m_f)
 
 using namespace mrpt::utils;
 using namespace std;
 
+namespace mrpt { namespace utils { namespace detail {
+	/** Data of CFileGZOutputStream in parallel compression mode: uncompressed blocks are accumulated until there
+	  * is one per thread, then compressed in parallel and written in order. */
+	struct TGZParallelWriter
+	{
+		TGZParallelWriter(FILE *f_, unsigned int num_threads, size_t block_size_, int level_) :
+			f(f_), threads(num_threads), block_size(block_size_), level(level_), num_full(0), total_in(0)
+		{
+			in.resize(threads.size());
+			out.resize(threads.size());
+			for (size_t i=0;i<in.size();i++) in[i].reserve(block_size);
+		}
+
+		FILE *f;
+		mrpt::system::CWorkerThreadsPool threads;
+		const size_t block_size;
+		const int level;
+		std::vector<std::vector<uint8_t> > in, out;
+		size_t num_full; //!< Number of full blocks in `in`
+		uint64_t total_in; //!< Total uncompressed bytes
+
+		void write(const uint8_t *data, size_t count)
+		{
+			total_in+=count;
+			while (count)
+			{
+				std::vector<uint8_t> &blk = in[num_full];
+				const size_t n = std::min(count, block_size-blk.size());
+				blk.insert(blk.end(), data, data+n);
+				data+=n; count-=n;
+				if (blk.size()==block_size && ++num_full==in.size())
+					flush(false);
+			}
+		}
+
+		void flush(bool include_partial)
+		{
+			const size_t nBlocks = num_full + ((include_partial && num_full<in.size() && !in[num_full].empty()) ? 1:0);
+			if (!nBlocks) return;
+			threads.parallel_for(nBlocks, mrpt::utils::internal::TGZBlocksCompressTask(in,out,level));
+			for (size_t i=0;i<nBlocks;i++)
+			{
+				if (fwrite(&out[i][0],1,out[i].size(),f)!=out[i].size())
+					THROW_EXCEPTION("Error writing to file")
+				in[i].clear();
+			}
+			num_full = 0;
+		}
+	};
+} } }
+
 
 /*---------------------------------------------------------------
 							Constructor
  ---------------------------------------------------------------*/
 CFileGZOutputStream::CFileGZOutputStream( const string	&fileName ) :
-	m_f(NULL)
+	m_f(NULL), m_parallel(NULL)
 {
 	MRPT_START
 	if (!open(fileName))
@@ -43,18 +98,28 @@ CFileGZOutputStream::CFileGZOutputStream( const string	&fileName ) :
 				Constructor
  ---------------------------------------------------------------*/
 CFileGZOutputStream::CFileGZOutputStream( ) :
-	m_f(NULL)
+	m_f(NULL), m_parallel(NULL)
 {
 }
 
 /*---------------------------------------------------------------
 							open
  ---------------------------------------------------------------*/
-bool CFileGZOutputStream::open( const string	&fileName, int compress_level )
+bool CFileGZOutputStream::open( const string	&fileName, int compress_level, unsigned int num_threads, size_t block_size )
 {
 	MRPT_START
 
-	if (m_f) gzclose(THE_GZFILE);
+	close();
+
+	if (num_threads!=1)
+	{
+		// Parallel, block compression:
+		ASSERT_(block_size>0 && block_size<(1U<<31))
+		m_f = mrpt::system::os::fopen(fileName.c_str(),"wb");
+		if (!m_f) return false;
+		m_parallel = new detail::TGZParallelWriter(THE_FILE,num_threads,block_size,compress_level);
+		return true;
+	}
 
 	// Open gz stream:
 	m_f = gzopen(fileName.c_str(),format("wb%i",compress_level).c_str() );
@@ -76,6 +141,21 @@ CFileGZOutputStream::~CFileGZOutputStream()
  ---------------------------------------------------------------*/
 void CFileGZOutputStream::close()
 {
+	if (m_parallel)
+	{
+		try
+		{
+			m_parallel->flush(true);
+		}
+		catch (std::exception &e)
+		{
+			std::cerr << "[CFileGZOutputStream::close] " << e.what() << std::endl;
+		}
+		mrpt::system::os::fclose(THE_FILE);
+		delete m_parallel;
+		m_parallel = NULL;
+		m_f = NULL;
+	}
 	if (m_f)
 	{
 		gzclose(THE_GZFILE);
@@ -100,6 +180,11 @@ size_t  CFileGZOutputStream::Read(void *Buffer, size_t Count)
 size_t  CFileGZOutputStream::Write(const void *Buffer, size_t Count)
 {
 	if (!m_f) { THROW_EXCEPTION("File is not open."); }
+	if (m_parallel)
+	{
+		m_parallel->write(static_cast<const uint8_t*>(Buffer),Count);
+		return Count;
+	}
 	return gzwrite(THE_GZFILE,const_cast<void*>(Buffer),Count);
 }
 
@@ -109,6 +194,7 @@ size_t  CFileGZOutputStream::Write(const void *Buffer, size_t Count)
 uint64_t CFileGZOutputStream::getPosition()
 {
 	if (!m_f) { THROW_EXCEPTION("File is not open."); }
+	if (m_parallel) return m_parallel->total_in;
 	return gztell(THE_GZFILE);
 }
 
@@ -0,0 +1,153 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/utils/CFileGZOutputStream.h>
+#include <mrpt/utils/CFileGZInputStream.h>
+#include <mrpt/random.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace std;
+
+// Compressible test data: random runs of repeated bytes.
+static void makeTestData(std::vector<uint8_t> &data, size_t N)
+{
+	mrpt::random::CRandomGenerator rnd(1234);
+	data.resize(N);
+	for (size_t i=0;i<N;)
+	{
+		const uint8_t v = static_cast<uint8_t>(rnd.drawUniform32bit());
+		const size_t len = 1 + rnd.drawUniform32bit()%50;
+		for (size_t k=0;k<len && i<N;k++) data[i++]=v;
+	}
+}
+
+static void writeAndReadBack(unsigned int write_threads, size_t block_size, unsigned int read_threads)
+{
+	std::vector<uint8_t> data;
+	makeTestData(data, 300000);
+	const string fil = mrpt::system::getTempFileName();
+
+	{
+		CFileGZOutputStream out;
+		ASSERT_TRUE(out.open(fil, 1, write_threads, block_size));
+		// Write in chunks of varying sizes, not aligned to the block size:
+		size_t i=0, chunk=1;
+		while (i<data.size())
+		{
+			const size_t n = std::min(chunk, data.size()-i);
+			out.WriteBuffer(&data[i], n);
+			i+=n;
+			chunk = (chunk*3)%7919 + 1;
+		}
+		EXPECT_EQ(out.getPosition(), data.size());
+	}
+
+	CFileGZInputStream in;
+	ASSERT_TRUE(in.open(fil, read_threads));
+	std::vector<uint8_t> rd(data.size()+100);
+	size_t i=0, chunk=5;
+	for (;;)
+	{
+		size_t n = 0;
+		try {
+			n = in.ReadBuffer(&rd[i], std::min(chunk, rd.size()-i));
+		}
+		catch (std::exception &) {
+			break; // EOF
+		}
+		i+=n;
+		chunk = (chunk*7)%10007 + 1;
+	}
+	ASSERT_EQ(i, data.size());
+	rd.resize(i);
+	EXPECT_TRUE(rd==data);
+	EXPECT_TRUE(in.checkEOF());
+	in.close();
+	mrpt::system::deleteFile(fil);
+}
+
+TEST(CFileGZStreams, sequential)
+{
+	writeAndReadBack(1, 0, 1);
+}
+
+TEST(CFileGZStreams, parallelCompression)
+{
+	writeAndReadBack(3, 4096, 1);
+	writeAndReadBack(3, 4096, 4);
+	writeAndReadBack(0, 100000, 2);
+	writeAndReadBack(2, 1000000, 2); // Block larger than the whole file
+}
+
+TEST(CFileGZStreams, parallelEmptyFile)
+{
+	const string fil = mrpt::system::getTempFileName();
+	{
+		CFileGZOutputStream out;
+		ASSERT_TRUE(out.open(fil, 1, 4));
+	}
+	CFileGZInputStream in(fil);
+	uint8_t b;
+	EXPECT_ANY_THROW(in.ReadBuffer(&b,1)); // EOF
+	EXPECT_TRUE(in.checkEOF());
+	in.close();
+	mrpt::system::deleteFile(fil);
+}
+
+TEST(CFileGZStreams, parallelTruncatedFile)
+{
+	std::vector<uint8_t> data;
+	makeTestData(data, 300000);
+	const string fil = mrpt::system::getTempFileName();
+	const size_t BLOCK_SIZE = 4096;
+	{
+		CFileGZOutputStream out;
+		ASSERT_TRUE(out.open(fil, 1, 2, BLOCK_SIZE));
+		out.WriteBuffer(&data[0], data.size());
+	}
+	// Simulate a crashed recording: cut the last member
+	{
+		FILE *f = fopen(fil.c_str(),"rb");
+		ASSERT_TRUE(f!=NULL);
+		std::vector<uint8_t> raw(static_cast<size_t>(mrpt::system::getFileSize(fil)));
+		ASSERT_EQ(fread(&raw[0],1,raw.size(),f), raw.size());
+		fclose(f);
+		f = fopen(fil.c_str(),"wb");
+		ASSERT_TRUE(f!=NULL);
+		fwrite(&raw[0],1,raw.size()-10,f);
+		fclose(f);
+	}
+
+	// All the complete members must be read before the error is reported:
+	CFileGZInputStream in;
+	ASSERT_TRUE(in.open(fil, 4));
+	std::vector<uint8_t> rd(data.size());
+	const size_t CHUNK = 100;
+	size_t i=0;
+	bool error = false;
+	while (i+CHUNK<=rd.size())
+	{
+		try {
+			in.ReadBuffer(&rd[i], CHUNK);
+		}
+		catch (std::exception &) {
+			error = true;
+			break;
+		}
+		i+=CHUNK;
+	}
+	EXPECT_TRUE(error);
+	EXPECT_GE(i+CHUNK, data.size() - data.size()%BLOCK_SIZE);
+	EXPECT_TRUE(std::equal(rd.begin(), rd.begin()+i, data.begin()));
+	in.close();
+	mrpt::system::deleteFile(fil);
+}
@@ -138,6 +138,7 @@ void CImage::swap(CImage &o)
 	std::swap( m_imgIsReadOnly, o.m_imgIsReadOnly );
 	std::swap( m_imgIsExternalStorage, o.m_imgIsExternalStorage );
 	std::swap( m_externalFile, o.m_externalFile );
+	std::swap( m_sharedData, o.m_sharedData );
 }
 
 /*---------------------------------------------------------------
@@ -186,8 +187,10 @@ void CImage::copyFastFrom( CImage &o )
 		m_imgIsReadOnly = o.m_imgIsReadOnly;
 		m_imgIsExternalStorage = o.m_imgIsExternalStorage;
 		m_externalFile = o.m_externalFile;
+		m_sharedData = o.m_sharedData;
 
 		o.img = NULL;
+		o.m_sharedData.clear();
 		o.m_imgIsReadOnly = false;
 		o.m_imgIsExternalStorage=false;
 	}
@@ -235,7 +238,8 @@ void  CImage::changeSize(
 
 #if MRPT_HAS_OPENCV
 	// If we're resizing to exactly the current size, do nothing and avoid wasting mem allocs/deallocs!
-	if (img)
+	// (Shared data can not be reused, since callers write into the new image)
+	if (img && !m_sharedData.present())
 	{
 		makeSureImageIsLoaded();   // For delayed loaded images stored externally
 		IplImage *ipl = static_cast<IplImage*>(img);
@@ -662,8 +666,11 @@ void  CImage::readFromStream(mrpt::utils::CStream &in, int version)
 
 			in >> width >> height >> nChannels >> originTopLeft >> imgLength;
 
-			changeSize(width, height, nChannels, originTopLeft !=0 );
-			in.ReadBuffer( ((IplImage*)img)->imageData, imgLength );
+			if (!height || imgLength%height!=0 || !setFromStreamZeroCopy(in, width, height, nChannels, originTopLeft!=0, imgLength/height))
+			{
+				changeSize(width, height, nChannels, originTopLeft !=0 );
+				in.ReadBuffer( ((IplImage*)img)->imageData, imgLength );
+			}
 		} break;
 	case 1:
 		{
@@ -711,29 +718,28 @@ void  CImage::readFromStream(mrpt::utils::CStream &in, int version)
 					int32_t		width,height,origin, imageSize;
 					in >> width >> height >> origin >> imageSize;
 
-					changeSize(width, height, 1, origin == 0 );
-					ASSERT_( imageSize == ((IplImage*)img)->imageSize );
+					// Version 2: RAW BYTES
+					// Version 3: ZIP compression!
+					bool	imageIsZIP = (version>=3);
+
+					// Version 4: Skip zip if the image size <= 16Kb
+					// Version 5: Use CImage::DISABLE_ZIP_COMPRESSION
+					if (version==4 && imageSize<=16*1024)
+						imageIsZIP = false;
 
-					if (version==2)
+					if (version>=5)
 					{
-						// RAW BYTES:
-						in.ReadBuffer( ((IplImage*)img)->imageData, imageSize );
+						// It is stored int the stream:
+						in >> imageIsZIP;
 					}
-					else
-					{
-						// Version 3: ZIP compression!
-						bool	imageIsZIP = true;
-
-						// Version 4: Skip zip if the image size <= 16Kb
-						// Version 5: Use CImage::DISABLE_ZIP_COMPRESSION
-						if (version==4 && imageSize<=16*1024)
-							imageIsZIP = false;
 
-						if (version>=5)
-						{
-							// It is stored int the stream:
-							in >> imageIsZIP;
-						}
+					// Raw bytes (with the row alignment of cvCreateImage()) may be referenced instead of copied:
+					const size_t rowStride = (static_cast<size_t>(width)+3) & ~static_cast<size_t>(3);
+					if (imageIsZIP || height<=0 || static_cast<size_t>(imageSize)!=rowStride*height ||
+						!setFromStreamZeroCopy(in, width, height, CH_GRAY, origin==0, rowStride))
+					{
+						changeSize(width, height, 1, origin == 0 );
+						ASSERT_( imageSize == ((IplImage*)img)->imageSize );
 
 						if (imageIsZIP)
 						{
@@ -782,14 +788,18 @@ void  CImage::readFromStream(mrpt::utils::CStream &in, int version)
 								const int32_t real_w = -width;
 								const int32_t real_h = -height;
 
-								this->changeSize(real_w,real_h,3,true);
-
-								const IplImage *ipl = static_cast<const IplImage*>(img);
-								const size_t bytes_per_row = ipl->width * 3;
-								for (int y=0;y<ipl->height;y++)
+								// Rows are stored without padding, as an image with a row stride of exactly width*3 bytes:
+								if (!setFromStreamZeroCopy(in, real_w, real_h, CH_RGB, true, real_w*3))
 								{
-									const size_t nRead = in.ReadBuffer( &ipl->imageData[y*ipl->widthStep], bytes_per_row);
-									if (nRead!=bytes_per_row) THROW_EXCEPTION("Error: Truncated data stream while parsing raw image?")
+									this->changeSize(real_w,real_h,3,true);
+
+									const IplImage *ipl = static_cast<const IplImage*>(img);
+									const size_t bytes_per_row = ipl->width * 3;
+									for (int y=0;y<ipl->height;y++)
+									{
+										const size_t nRead = in.ReadBuffer( &ipl->imageData[y*ipl->widthStep], bytes_per_row);
+										if (nRead!=bytes_per_row) THROW_EXCEPTION("Error: Truncated data stream while parsing raw image?")
+									}
 								}
 							}
 							else
@@ -1004,8 +1014,9 @@ IplImage *ipl_to_grayscale(const IplImage * img_src)
 	img_dest->origin = img_src->origin;
 
 	// If possible, use SSE optimized version:
-#if MRPT_HAS_SSE3
-	if (is_aligned<16>(img_src->imageData) &&
+#if MRPT_SIMD_DISPATCH_X86
+	if (mrpt::system::cpu::supports(mrpt::system::cpu::fSSSE3) &&
+		is_aligned<16>(img_src->imageData) &&
 		(img_src->width & 0xF) == 0 &&
 		img_src->widthStep==img_src->width*img_src->nChannels &&
 		img_dest->widthStep==img_dest->width*img_dest->nChannels )
@@ -1085,8 +1096,9 @@ void CImage::scaleHalf(CImage &out)const
 
 
 	// If possible, use SSE optimized version:
-#if MRPT_HAS_SSE3
+#if MRPT_SIMD_DISPATCH_X86
 	if (img_src->nChannels==3 &&
+		mrpt::system::cpu::supports(mrpt::system::cpu::fSSSE3) &&
 		is_aligned<16>(img_src->imageData) &&
 		is_aligned<16>(img_dest->imageData) &&
 		(w & 0xF) == 0 &&
@@ -1099,8 +1111,9 @@ void CImage::scaleHalf(CImage &out)const
 	}
 #endif
 
-#if MRPT_HAS_SSE2
+#if MRPT_SIMD_DISPATCH_X86
 	if (img_src->nChannels==1 &&
+		mrpt::system::cpu::supports(mrpt::system::cpu::fSSE2) &&
 		is_aligned<16>(img_src->imageData) &&
 		is_aligned<16>(img_dest->imageData) &&
 		(w & 0xF) == 0 &&
@@ -1143,8 +1156,9 @@ void CImage::scaleHalfSmooth(CImage &out)const
 
 
 	// If possible, use SSE optimized version:
-#if MRPT_HAS_SSE2
+#if MRPT_SIMD_DISPATCH_X86
 	if (img_src->nChannels==1 &&
+		mrpt::system::cpu::supports(mrpt::system::cpu::fSSE2) &&
 		is_aligned<16>(img_src->imageData) &&
 		is_aligned<16>(img_dest->imageData) &&
 		(w & 0xF) == 0 &&
@@ -1257,6 +1271,7 @@ void  CImage::setPixel(
 #endif
 
 	makeSureImageIsLoaded();   // For delayed loaded images stored externally
+	makeSureImageIsWritable();
 
 	IplImage *ipl = ((IplImage*)img);
 
@@ -1310,6 +1325,7 @@ void  CImage::line(
 #if MRPT_HAS_OPENCV
 	MRPT_UNUSED_PARAM(penStyle);
 	makeSureImageIsLoaded();   // For delayed loaded images stored externally
+	makeSureImageIsWritable();
 	IplImage *ipl = ((IplImage*)img);
 	ASSERT_(ipl);
 
@@ -1329,6 +1345,7 @@ void  CImage::drawCircle(
 {
 #if MRPT_HAS_OPENCV
 	makeSureImageIsLoaded();   // For delayed loaded images stored externally
+	makeSureImageIsWritable();
 	IplImage *ipl = ((IplImage*)img);
 	ASSERT_(ipl);
 
@@ -1344,6 +1361,7 @@ void CImage::update_patch(const CImage &patch,
 			  const unsigned int row_)
 {
 #if MRPT_HAS_OPENCV
+	makeSureImageIsWritable();
 	IplImage *ipl_int = ((IplImage*)img);
 	IplImage *ipl_ext = ((IplImage*)patch.img);
 	ASSERT_(ipl_int);
@@ -1561,6 +1579,7 @@ void  CImage::normalize()
 {
 #if MRPT_HAS_OPENCV
 	makeSureImageIsLoaded();   // For delayed loaded images stored externally
+	makeSureImageIsWritable();
     IplImage *ipl = getAs<IplImage>();	// Source Image
 	ASSERT_(ipl)
 	ASSERTMSG_( ipl->nChannels==1, "CImage::normalize() only defined for grayscale images.")
@@ -1914,13 +1933,20 @@ void CImage::unload() const MRPT_NO_THROWS
 void CImage::releaseIpl(bool thisIsExternalImgUnload) MRPT_NO_THROWS
 {
 #if MRPT_HAS_OPENCV
-	if (img && !m_imgIsReadOnly)
+	if (img && m_sharedData.present())
+	{
+		// Only the header is ours:
+		IplImage *ptr=(IplImage*)img;
+		cvReleaseImageHeader( &ptr );
+	}
+	else if (img && !m_imgIsReadOnly)
 	{
 		IplImage *ptr=(IplImage*)img;
 		cvReleaseImage( &ptr );
 	}
 	img = NULL;
 	m_imgIsReadOnly = false;
+	m_sharedData.clear();
 	if (!thisIsExternalImgUnload)
 	{
 		m_imgIsExternalStorage = false;
@@ -1929,6 +1955,45 @@ void CImage::releaseIpl(bool thisIsExternalImgUnload) MRPT_NO_THROWS
 #endif
 }
 
+/*---------------------------------------------------------------
+						makeSureImageIsWritable
+ ---------------------------------------------------------------*/
+void CImage::makeSureImageIsWritable()
+{
+#if MRPT_HAS_OPENCV
+	if (!m_sharedData.present()) return;
+	IplImage *copy = cvCloneImage( static_cast<const IplImage*>(img) );
+	releaseIpl();
+	img = copy;
+#endif
+}
+
+/*---------------------------------------------------------------
+						setFromStreamZeroCopy
+ ---------------------------------------------------------------*/
+bool CImage::setFromStreamZeroCopy(mrpt::utils::CStream &in, unsigned int width, unsigned int height, TImageChannels nChannels, bool originTopLeft, size_t rowStride)
+{
+#if MRPT_HAS_OPENCV
+	TMemoryBlockOwnerPtr owner;
+	const void *data = in.ReadBufferZeroCopy(rowStride*height, owner);
+	if (!data)
+		return false;
+
+	releaseIpl();
+	IplImage *ipl = cvCreateImageHeader( cvSize(width,height),IPL_DEPTH_8U, nChannels );
+	ipl->origin = originTopLeft ? 0:1;
+	// The pixels are never written while shared (see makeSureImageIsWritable()):
+	cvSetData( ipl, const_cast<void*>(data), static_cast<int>(rowStride) );
+	img = ipl;
+	m_sharedData = owner;
+	return true;
+#else
+	MRPT_UNUSED_PARAM(in); MRPT_UNUSED_PARAM(width); MRPT_UNUSED_PARAM(height);
+	MRPT_UNUSED_PARAM(nChannels); MRPT_UNUSED_PARAM(originTopLeft); MRPT_UNUSED_PARAM(rowStride);
+	return false;
+#endif
+}
+
 /*---------------------------------------------------------------
 				makeSureImageIsLoaded
  ---------------------------------------------------------------*/
@@ -1985,6 +2050,7 @@ void CImage::getExternalStorageFileAbsolutePath(std::string &out_path) const
 void CImage::flipVertical(bool also_swapRB )
 {
 #if MRPT_HAS_OPENCV
+	makeSureImageIsWritable();
 	IplImage *ptr=(IplImage*)img;
 	int options = CV_CVTIMG_FLIP;
 	if(also_swapRB) options |= CV_CVTIMG_SWAP_RB;
@@ -1995,6 +2061,7 @@ void CImage::flipVertical(bool also_swapRB )
 void CImage::flipHorizontal()
 {
 #if MRPT_HAS_OPENCV
+	makeSureImageIsWritable();
 	IplImage *ptr=(IplImage*)img;
 	cvFlip(ptr,nullptr,1);
 #endif
@@ -2007,6 +2074,7 @@ void CImage::swapRB()
 {
 #if MRPT_HAS_OPENCV
 	makeSureImageIsLoaded();   // For delayed loaded images stored externally
+	makeSureImageIsWritable();
     ASSERT_(img!=NULL);
 	IplImage *ptr=(IplImage*)img;
 	cvConvertImage(ptr,ptr,CV_CVTIMG_SWAP_RB);
@@ -2333,6 +2401,7 @@ bool CImage::drawChessboardCorners(
 
 	if (cornerCoords.size()!=check_size_x*check_size_y) return false;
 
+	makeSureImageIsWritable();
 	IplImage* ipl = this->getAs<IplImage>();
 
 	unsigned int x, y,i;
@@ -9,7 +9,9 @@
 
 #include "base-precomp.h"  // Precompiled headers
 
-#if MRPT_HAS_SSE2
+#include <mrpt/system/cpu.h>
+
+#if MRPT_SIMD_DISPATCH_X86
 // ---------------------------------------------------------------------------
 //   This file contains the SSE2 optimized functions for mrpt::utils::CImage
 //    See the sources and the doxygen documentation page "sse_optimizations" for more details.
@@ -20,8 +22,8 @@
 // ---------------------------------------------------------------------------
 
 #include <mrpt/utils/CImage.h>
-#include <mrpt/utils/SSE_types.h>
 #include <mrpt/utils/SSE_macros.h>
+#include <immintrin.h>
 #include "CImage_SSEx.h"
 
 /** \addtogroup sse_optimizations
@@ -37,7 +39,7 @@
   *  - <b>Requires:</b> SSE2
   *  - <b>Invoked from:</b> mrpt::utils::CImage::scaleHalf()
   */
-void image_SSE2_scale_half_1c8u(const uint8_t* in, uint8_t* out, int w, int h)
+MRPT_TARGET_SSE2 void image_SSE2_scale_half_1c8u(const uint8_t* in, uint8_t* out, int w, int h)
 {
 	MRPT_ALIGN16 const unsigned long long mask[2] = {0x00FF00FF00FF00FFull, 0x00FF00FF00FF00FFull};
 	const __m128i m = _mm_load_si128((const __m128i*)mask);
@@ -67,7 +69,7 @@ void image_SSE2_scale_half_1c8u(const uint8_t* in, uint8_t* out, int w, int h)
   *  - <b>Requires:</b> SSE2
   *  - <b>Invoked from:</b> mrpt::utils::CImage::scaleHalfSmooth()
   */
-void image_SSE2_scale_half_smooth_1c8u(const uint8_t* in, uint8_t* out, int w, int h)
+MRPT_TARGET_SSE2 void image_SSE2_scale_half_smooth_1c8u(const uint8_t* in, uint8_t* out, int w, int h)
 {
 	MRPT_ALIGN16 const unsigned long long mask[2] = {0x00FF00FF00FF00FFull, 0x00FF00FF00FF00FFull};
 	const uint8_t* nextRow = in + w;
@@ -120,4 +122,4 @@ float KLT_response_optimized();
 
 /**  @} */
 
-#endif // end if MRPT_HAS_SSE2
+#endif // end if MRPT_SIMD_DISPATCH_X86
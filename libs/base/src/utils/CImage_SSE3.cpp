@@ -9,15 +9,17 @@
 
 #include "base-precomp.h"  // Precompiled headers
 
+#include <mrpt/system/cpu.h>
+
 // ---------------------------------------------------------------------------
 //   This file contains the SSE3/SSSE3 optimized functions for mrpt::utils::CImage
 //    See the sources and the doxygen documentation page "sse_optimizations" for more details.
 // ---------------------------------------------------------------------------
-#if MRPT_HAS_SSE3
+#if MRPT_SIMD_DISPATCH_X86
 
 #include <mrpt/utils/CImage.h>
-#include <mrpt/utils/SSE_types.h>
 #include <mrpt/utils/SSE_macros.h>
+#include <immintrin.h>
 #include "CImage_SSEx.h"
 
 
@@ -34,7 +36,7 @@
   *  - <b>Requires:</b> SSSE3
   *  - <b>Invoked from:</b> mrpt::utils::CImage::scaleHalf()
   */
-void image_SSSE3_scale_half_3c8u(const uint8_t* in, uint8_t* out, int w, int h)
+MRPT_TARGET_SSSE3 void image_SSSE3_scale_half_3c8u(const uint8_t* in, uint8_t* out, int w, int h)
 {
 	MRPT_ALIGN16 const unsigned long long mask0[2] = { 0x0D0C080706020100ull, 0x808080808080800Eull }; // Long words are in inverse order due to little endianness
 	MRPT_ALIGN16 const unsigned long long mask1[2] = { 0x8080808080808080ull, 0x0E0A090804030280ull };
@@ -87,7 +89,7 @@ void image_SSSE3_scale_half_3c8u(const uint8_t* in, uint8_t* out, int w, int h)
 
 // This is the actual function behind both: image_SSSE3_rgb_to_gray_8u() and image_SSSE3_bgr_to_gray_8u():
 template <bool IS_RGB>
-void private_image_SSSE3_rgb_or_bgr_to_gray_8u(const uint8_t* in, uint8_t* out, int w, int h)
+MRPT_TARGET_SSSE3 void private_image_SSSE3_rgb_or_bgr_to_gray_8u(const uint8_t* in, uint8_t* out, int w, int h)
 {
 	// Masks:                 0  1   2  3   4  5   6  7   8 9    A  B   C  D  E  F
 	BUILD_128BIT_CONST(mask0, 80,00, 80,03, 80,06, 80,09, 80,0C, 80,0F, 80,80, 80,80) // reds[0-7] from D0
@@ -205,7 +207,7 @@ void private_image_SSSE3_rgb_or_bgr_to_gray_8u(const uint8_t* in, uint8_t* out,
   *  - <b>Requires:</b> SSSE3
   *  - <b>Invoked from:</b> mrpt::utils::CImage::grayscale(), mrpt::utils::CImage::grayscaleInPlace()
   */
-void image_SSSE3_bgr_to_gray_8u(const uint8_t* in, uint8_t* out, int w, int h)
+MRPT_TARGET_SSSE3 void image_SSSE3_bgr_to_gray_8u(const uint8_t* in, uint8_t* out, int w, int h)
 {
 	private_image_SSSE3_rgb_or_bgr_to_gray_8u<false>(in,out,w,h);
 }
@@ -218,7 +220,7 @@ void image_SSSE3_bgr_to_gray_8u(const uint8_t* in, uint8_t* out, int w, int h)
   *  - <b>Requires:</b> SSSE3
   *  - <b>Invoked from:</b> mrpt::utils::CImage::grayscale(), mrpt::utils::CImage::grayscaleInPlace()
   */
-void image_SSSE3_rgb_to_gray_8u(const uint8_t* in, uint8_t* out, int w, int h)
+MRPT_TARGET_SSSE3 void image_SSSE3_rgb_to_gray_8u(const uint8_t* in, uint8_t* out, int w, int h)
 {
 	private_image_SSSE3_rgb_or_bgr_to_gray_8u<true>(in,out,w,h);
 }
@@ -226,4 +228,4 @@ void image_SSSE3_rgb_to_gray_8u(const uint8_t* in, uint8_t* out, int w, int h)
 
 /**  @} */
 
-#endif // end of MRPT_HAS_SSE3
+#endif // end of MRPT_SIMD_DISPATCH_X86
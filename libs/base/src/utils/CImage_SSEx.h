@@ -10,14 +10,17 @@
 #define CImage_SSEx_H
 
 #include <mrpt/config.h>
+#include <mrpt/system/cpu.h>
 
 // See documentation in the .cpp files CImage_SSE*.cpp
-
-void image_SSE2_scale_half_1c8u         (const uint8_t* in, uint8_t* out, int w, int h);
-void image_SSSE3_scale_half_3c8u        (const uint8_t* in, uint8_t* out, int w, int h);
-void image_SSE2_scale_half_smooth_1c8u  (const uint8_t* in, uint8_t* out, int w, int h);
-void image_SSSE3_rgb_to_gray_8u         (const uint8_t* in, uint8_t* out, int w, int h);
-void image_SSSE3_bgr_to_gray_8u         (const uint8_t* in, uint8_t* out, int w, int h);
+// These functions are always built on x86, and must be only called if mrpt::system::cpu::supports() the required instruction set.
+#if MRPT_SIMD_DISPATCH_X86
+MRPT_TARGET_SSE2  void image_SSE2_scale_half_1c8u         (const uint8_t* in, uint8_t* out, int w, int h);
+MRPT_TARGET_SSSE3 void image_SSSE3_scale_half_3c8u        (const uint8_t* in, uint8_t* out, int w, int h);
+MRPT_TARGET_SSE2  void image_SSE2_scale_half_smooth_1c8u  (const uint8_t* in, uint8_t* out, int w, int h);
+MRPT_TARGET_SSSE3 void image_SSSE3_rgb_to_gray_8u         (const uint8_t* in, uint8_t* out, int w, int h);
+MRPT_TARGET_SSSE3 void image_SSSE3_bgr_to_gray_8u         (const uint8_t* in, uint8_t* out, int w, int h);
+#endif
 
 
 #endif
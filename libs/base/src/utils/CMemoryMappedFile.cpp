@@ -0,0 +1,116 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "base-precomp.h"  // Precompiled headers
+
+#include <mrpt/utils/CMemoryMappedFile.h>
+#include <mrpt/utils/mrpt_macros.h>
+
+#ifdef MRPT_OS_WINDOWS
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace mrpt::utils;
+
+CMemoryMappedFile::CMemoryMappedFile() :
+	m_data(NULL), m_size(0), m_is_open(false), m_hFile(NULL), m_hMapping(NULL)
+{
+}
+
+CMemoryMappedFile::CMemoryMappedFile(const std::string &fileName) :
+	m_data(NULL), m_size(0), m_is_open(false), m_hFile(NULL), m_hMapping(NULL)
+{
+	MRPT_START
+	if (!open(fileName))
+		THROW_EXCEPTION_FMT("Error mapping file: '%s'", fileName.c_str())
+	MRPT_END
+}
+
+CMemoryMappedFile::~CMemoryMappedFile()
+{
+	close();
+}
+
+bool CMemoryMappedFile::open(const std::string &fileName)
+{
+	close();
+#ifdef MRPT_OS_WINDOWS
+	HANDLE hFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (hFile==INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fs;
+	if (!GetFileSizeEx(hFile,&fs)) {
+		CloseHandle(hFile);
+		return false;
+	}
+	m_size = static_cast<uint64_t>(fs.QuadPart);
+	if (m_size) {
+		HANDLE hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (!hMap) {
+			CloseHandle(hFile);
+			return false;
+		}
+		m_data = static_cast<const uint8_t*>(MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0));
+		if (!m_data) {
+			CloseHandle(hMap);
+			CloseHandle(hFile);
+			return false;
+		}
+		m_hMapping = hMap;
+	}
+	m_hFile = hFile;
+#else
+	const int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd<0)
+		return false;
+	struct stat st;
+	if (fstat(fd,&st)!=0) {
+		::close(fd);
+		return false;
+	}
+	m_size = static_cast<uint64_t>(st.st_size);
+	if (m_size) {
+		// Read-only and shared: nothing is charged against the commit limit, so files larger than RAM+swap can be mapped
+		void *p = mmap(NULL, m_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p==MAP_FAILED) {
+			::close(fd);
+			m_size = 0;
+			return false;
+		}
+		m_data = static_cast<const uint8_t*>(p);
+	}
+	// The mapping keeps its own reference to the file:
+	::close(fd);
+#endif
+	m_fileName = fileName;
+	m_is_open = true;
+	return true;
+}
+
+void CMemoryMappedFile::close()
+{
+#ifdef MRPT_OS_WINDOWS
+	if (m_data) UnmapViewOfFile(m_data);
+	if (m_hMapping) CloseHandle(static_cast<HANDLE>(m_hMapping));
+	if (m_hFile) CloseHandle(static_cast<HANDLE>(m_hFile));
+#else
+	if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+	m_data = NULL;
+	m_size = 0;
+	m_is_open = false;
+	m_hFile = m_hMapping = NULL;
+	m_fileName.clear();
+}
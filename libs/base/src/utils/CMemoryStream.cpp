@@ -70,6 +70,15 @@ void CMemoryStream::assignMemoryNotOwn( const void *data, const uint64_t nBytesI
 	m_read_only    = true;
 }
 
+/*---------------------------------------------------------------
+				assignMemorySharedOwner
+ ---------------------------------------------------------------*/
+void CMemoryStream::assignMemorySharedOwner( const void *data, const uint64_t nBytesInData, const TMemoryBlockOwnerPtr &owner )
+{
+	assignMemoryNotOwn(data,nBytesInData);
+	m_owner = owner;
+}
+
 /*---------------------------------------------------------------
 							Destructor
  ---------------------------------------------------------------*/
@@ -130,6 +139,19 @@ size_t CMemoryStream::Read(void *Buffer, size_t Count)
 	return nToRead;
 }
 
+/*---------------------------------------------------------------
+						ReadBufferZeroCopy
+ ---------------------------------------------------------------*/
+const void * CMemoryStream::ReadBufferZeroCopy(size_t Count, TMemoryBlockOwnerPtr &out_owner)
+{
+	if (!m_owner.present() || !Count || m_position+Count>m_size)
+		return NULL;
+	const void *ptr = static_cast<const char*>(m_memory.get()) + m_position;
+	m_position+=Count;
+	out_owner = m_owner;
+	return ptr;
+}
+
 /*---------------------------------------------------------------
 							Write
 			Writes a block of bytes to the stream.
@@ -213,6 +235,7 @@ void  CMemoryStream::Clear()
 		m_position=0;
 		m_bytesWritten=0;
 		m_read_only = false;
+		m_owner.clear();
 	}
 }
 
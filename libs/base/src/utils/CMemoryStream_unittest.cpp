@@ -0,0 +1,90 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/utils/CMemoryStream.h>
+#include <mrpt/math/CMatrixD.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace std;
+
+// A memory block owner which flags its own destruction:
+struct TTestBlock : public TMemoryBlockOwner
+{
+	TTestBlock(bool &destroyed_) : destroyed(destroyed_) { destroyed=false; }
+	~TTestBlock() { destroyed=true; }
+	bool &destroyed;
+	std::vector<uint8_t> data;
+};
+
+TEST(CMemoryStream, readBufferZeroCopy)
+{
+	bool destroyed = false;
+	TTestBlock *blk = new TTestBlock(destroyed);
+	blk->data.resize(100);
+	for (size_t i=0;i<blk->data.size();i++) blk->data[i]=static_cast<uint8_t>(i);
+	const uint8_t *base = &blk->data[0];
+
+	TMemoryBlockOwnerPtr owner_ref;
+	{
+		CMemoryStream buf;
+		buf.assignMemorySharedOwner(base, 100, TMemoryBlockOwnerPtr(blk));
+
+		uint8_t b;
+		buf.ReadBuffer(&b,1);
+		EXPECT_EQ(b, 0);
+
+		const void *p = buf.ReadBufferZeroCopy(10, owner_ref);
+		EXPECT_EQ(p, static_cast<const void*>(base+1));
+		EXPECT_TRUE(owner_ref.present());
+		EXPECT_EQ(buf.getPosition(), 11u);
+
+		// Not enough bytes left: the position must not change
+		TMemoryBlockOwnerPtr dummy;
+		EXPECT_TRUE(NULL==buf.ReadBufferZeroCopy(90, dummy));
+		EXPECT_FALSE(dummy.present());
+		EXPECT_EQ(buf.getPosition(), 11u);
+		EXPECT_TRUE(NULL!=buf.ReadBufferZeroCopy(89, dummy));
+	}
+	// The stream is gone, but the block must be alive while referenced:
+	EXPECT_FALSE(destroyed);
+	owner_ref.clear();
+	EXPECT_TRUE(destroyed);
+}
+
+TEST(CMemoryStream, readBufferZeroCopyNotSupported)
+{
+	uint8_t data[16] = {0};
+	TMemoryBlockOwnerPtr owner;
+
+	CMemoryStream buf1(data,sizeof(data)); // Owns a copy
+	EXPECT_TRUE(NULL==buf1.ReadBufferZeroCopy(4, owner));
+
+	CMemoryStream buf2;
+	buf2.assignMemoryNotOwn(data,sizeof(data)); // Unknown lifetime of the memory
+	EXPECT_TRUE(NULL==buf2.ReadBufferZeroCopy(4, owner));
+	EXPECT_EQ(buf2.getPosition(), 0u);
+	EXPECT_FALSE(owner.present());
+}
+
+TEST(CMemoryStream, matrixRoundTrip)
+{
+	mrpt::math::CMatrixD M(3,5);
+	for (int r=0;r<3;r++)
+		for (int c=0;c<5;c++)
+			M(r,c) = r*10+c;
+	CMemoryStream buf;
+	buf << M;
+	buf.Seek(0);
+	mrpt::math::CMatrixD M2;
+	buf >> M2;
+	EXPECT_TRUE(M==M2);
+}
@@ -12,14 +12,173 @@
 #include <mrpt/utils/CTimeLogger.h>
 #include <mrpt/utils/CFileOutputStream.h>
 #include <mrpt/system/string_utils.h>
+#include <mrpt/synch/CCriticalSection.h>
 
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
 
 using namespace mrpt;
 using namespace mrpt::utils;
 using namespace mrpt::system;
 using namespace std;
 
+namespace mrpt
+{
+	namespace utils
+	{
+		namespace detail
+		{
+			/** One timed section, recorded when it is left. Times in nanoseconds since the creation of the CTimeLogger */
+			struct TTraceEvent
+			{
+				uint32_t section, depth;
+				uint64_t t_begin, dur;
+			};
+
+			/** Block of events in the per-thread buffers, which are linked lists of blocks written by one thread and read by another one */
+			struct TTraceEventsBlock
+			{
+				static const size_t CAPACITY = 1024;
+				TTraceEvent                       events[CAPACITY];
+				std::atomic<size_t>               count;
+				std::atomic<TTraceEventsBlock*>   next;
+				TTraceEventsBlock() : count(0), next(NULL) {}
+			};
+
+			/** The events of one thread. The writer (the thread itself) only touches `stack`, `tail` and `new_blocks`;
+			  * the reader (flushEventBuffers(), with the critical section locked) only touches `head` and `head_read`. */
+			struct TThreadTraceEvents
+			{
+				const uint32_t tid;
+				std::vector<std::pair<uint32_t,uint64_t> > stack; //!< Open sections: (section,t_begin)
+				TTraceEventsBlock *tail;
+				size_t             new_blocks;
+				TTraceEventsBlock *head;
+				size_t             head_read;
+
+				explicit TThreadTraceEvents(uint32_t tid_) : tid(tid_), tail(new TTraceEventsBlock()), new_blocks(0), head(tail), head_read(0)
+				{
+					stack.reserve(32);
+				}
+				~TThreadTraceEvents()
+				{
+					while (head) {
+						TTraceEventsBlock *n = head->next.load();
+						delete head;
+						head = n;
+					}
+				}
+				/** Appends an event. \return true if the buffer has grown enough to be worth flushing it */
+				bool push(const TTraceEvent &ev)
+				{
+					TTraceEventsBlock *b = tail;
+					size_t c = b->count.load(std::memory_order_relaxed);
+					if (c==TTraceEventsBlock::CAPACITY)
+					{
+						TTraceEventsBlock *nb = new TTraceEventsBlock();
+						b->next.store(nb, std::memory_order_release);
+						tail = b = nb;
+						c = 0;
+						new_blocks++;
+					}
+					b->events[c] = ev;
+					b->count.store(c+1, std::memory_order_release);
+					return new_blocks>=64;
+				}
+			};
+
+			struct TTimeLoggerTraceImpl
+			{
+				const uint64_t instance_id; //!< Unique among all CTimeLogger objects ever created, for the thread-local cache
+				const uint64_t t0;
+				mrpt::synch::CCriticalSection cs; //!< Protects all the fields below, and the stats in CTimeLogger::m_data
+				std::map<std::thread::id, TThreadTraceEvents*> threads;
+				bool   tracing;
+				size_t max_events, num_dropped;
+				struct TEvent { uint32_t tid; TTraceEvent ev; };
+				std::vector<TEvent> trace;
+
+				static uint64_t now_ns()
+				{
+					return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+				}
+				static uint64_t new_instance_id()
+				{
+					static std::atomic<uint64_t> next_id(1);
+					return next_id++;
+				}
+
+				TTimeLoggerTraceImpl() : instance_id(new_instance_id()), t0(now_ns()), tracing(false), max_events(0), num_dropped(0)
+				{}
+				~TTimeLoggerTraceImpl()
+				{
+					for (std::map<std::thread::id, TThreadTraceEvents*>::iterator it=threads.begin();it!=threads.end();++it)
+						delete it->second;
+				}
+
+				/** Returns the events buffer of the calling thread, creating it upon first use */
+				TThreadTraceEvents *getThreadEvents()
+				{
+					// Small thread-local cache, to avoid locking in the common case:
+					struct TCacheEntry { uint64_t instance_id; TThreadTraceEvents *events; };
+					static const unsigned int CACHE_SIZE = 4;
+					static thread_local TCacheEntry cache[CACHE_SIZE];
+					static thread_local unsigned int cache_next;
+					for (unsigned int i=0;i<CACHE_SIZE;i++)
+						if (cache[i].instance_id==instance_id)
+							return cache[i].events;
+
+					TThreadTraceEvents *te;
+					{
+						mrpt::synch::CCriticalSectionLocker lock(&cs);
+						TThreadTraceEvents *&e = threads[std::this_thread::get_id()];
+						if (!e) e = new TThreadTraceEvents(static_cast<uint32_t>(threads.size()));
+						te = e;
+					}
+					TCacheEntry &ce = cache[(cache_next++) % CACHE_SIZE];
+					ce.instance_id = instance_id;
+					ce.events = te;
+					return te;
+				}
+			};
+		}
+	}
+}
+
+namespace
+{
+	/** Process-wide registry of the section names used with handles */
+	struct TSectionsRegistry
+	{
+		mrpt::synch::CCriticalSection cs;
+		std::vector<std::string> names;
+		std::map<std::string,uint32_t> handles;
+	};
+	TSectionsRegistry & getSectionsRegistry()
+	{
+		static TSectionsRegistry reg;
+		return reg;
+	}
+
+	std::string jsonEscape(const std::string &s)
+	{
+		std::string r;
+		r.reserve(s.size());
+		for (size_t i=0;i<s.size();i++)
+		{
+			const char c = s[i];
+			if (c=='"' || c=='\\') { r+='\\'; r+=c; }
+			else if (static_cast<unsigned char>(c)<0x20) r+=mrpt::format("\\u%04x",static_cast<unsigned int>(c));
+			else r+=c;
+		}
+		return r;
+	}
+}
+
 struct MyGlobalProfiler : public mrpt::utils::CTimeLogger
 {
 	MyGlobalProfiler() : mrpt::utils::CTimeLogger("MRPT_global_profiler")
@@ -27,6 +186,7 @@ struct MyGlobalProfiler : public mrpt::utils::CTimeLogger
 
 	~MyGlobalProfiler()
 	{
+		flushEventBuffers();
 		if (!m_data.empty())
 		{
 			const std::string sFil("mrpt-global-profiler.csv");
@@ -58,7 +218,8 @@ CTimeLogger::CTimeLogger(bool enabled/*=true*/, const std::string& name/*=""*/)
 	COutputLogger("CTimeLogger"),
 	m_tictac(),
 	m_enabled(enabled),
-	m_name(name)
+	m_name(name),
+	m_trace(new detail::TTimeLoggerTraceImpl())
 {
 	m_tictac.Tic();
 }
@@ -66,22 +227,29 @@ CTimeLogger::CTimeLogger(bool enabled/*=true*/, const std::string& name/*=""*/)
 CTimeLogger::~CTimeLogger()
 {
 	// Dump all stats:
-    if (!m_data.empty()) // If logging is disabled, do nothing...
-        dumpAllStats();
+	flushEventBuffers();
+	if (!m_data.empty()) // If logging is disabled, do nothing...
+		dumpAllStats();
+	delete m_trace;
+	m_trace = NULL;
 }
 
+// Copies get the stats, but neither the trace nor the events of open sections:
 CTimeLogger::CTimeLogger(const CTimeLogger&o) :
 	COutputLogger(o),
 	m_enabled(o.m_enabled),
 	m_name(o.m_name),
-	m_data(o.m_data)
+	m_trace(new detail::TTimeLoggerTraceImpl())
 {
+	o.flushEventBuffers();
+	m_data = o.m_data;
 }
 CTimeLogger &CTimeLogger::operator =(const CTimeLogger&o)
 {
 	COutputLogger::operator=(o);
 	m_enabled = o.m_enabled;
 	m_name = o.m_name;
+	o.flushEventBuffers();
 	m_data = o.m_data;
 	return *this;
 }
@@ -90,14 +258,17 @@ CTimeLogger::CTimeLogger(CTimeLogger&&o) :
 	COutputLogger(o),
 	m_enabled(o.m_enabled),
 	m_name(o.m_name),
-	m_data(o.m_data)
+	m_trace(new detail::TTimeLoggerTraceImpl())
 {
+	o.flushEventBuffers();
+	m_data = o.m_data;
 }
 CTimeLogger &CTimeLogger::operator =(CTimeLogger&&o)
 {
 	COutputLogger::operator=(o);
 	m_enabled = o.m_enabled;
 	m_name = o.m_name;
+	o.flushEventBuffers();
 	m_data = o.m_data;
 	return *this;
 }
@@ -106,6 +277,8 @@ CTimeLogger &CTimeLogger::operator =(CTimeLogger&&o)
 
 void CTimeLogger::clear(bool deep_clear)
 {
+	flushEventBuffers(); // Discard the pending events, too
+	mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
 	if (deep_clear)
 		m_data.clear();
 	else
@@ -130,6 +303,7 @@ std::string  aux_format_string_multilines(const std::string &s, const size_t len
 
 void CTimeLogger::getStats(std::map<std::string,TCallStats> &out_stats) const
 {
+	flushEventBuffers();
 	out_stats.clear();
 	for (const auto e : m_data)
 	{
@@ -145,6 +319,7 @@ void CTimeLogger::getStats(std::map<std::string,TCallStats> &out_stats) const
 
 std::string CTimeLogger::getStatsAsText(const size_t column_width)  const
 {
+	flushEventBuffers();
 	std::string stats_text;
 	std::string name_tmp = m_name.size() ? " " + m_name + ": " : " ";
 	std::string mrpt_string = "MRPT CTimeLogger report ";
@@ -193,6 +368,7 @@ std::string CTimeLogger::getStatsAsText(const size_t column_width)  const
 
 void CTimeLogger::saveToCSVFile(const std::string &csv_file)  const
 {
+	flushEventBuffers();
 	std::string s;
 	s+="FUNCTION, #CALLS, LAST.T, MIN.T, MEAN.T, MAX.T, TOTAL.T\n";
 	for (const auto &i : m_data)
@@ -214,9 +390,12 @@ void CTimeLogger::dumpAllStats(const size_t  column_width) const
 	MRPT_LOG_INFO_STREAM("dumpAllStats:\n" << getStatsAsText(column_width));
 }
 
+// The stats of named sections are written under the same lock as flushEventBuffers(), which may be called from
+// any thread using section handles (see do_leave(TSectionHandle)):
 void CTimeLogger::do_enter(const char *func_name)
 {
 	const string  s = func_name;
+	mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
 	TCallData &d = m_data[s];
 
 	d.n_calls++;
@@ -229,6 +408,7 @@ double CTimeLogger::do_leave(const char *func_name)
 	const double tim = m_tictac.Tac();
 
 	const string  s = func_name;
+	mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
 	TCallData &d = m_data[s];
 
 	if (!d.open_calls.empty())
@@ -257,6 +437,7 @@ void CTimeLogger::registerUserMeasure(const char *event_name, const double value
 {
     if (!m_enabled) return;
 	const string  s = event_name;
+	mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
 	TCallData &d = m_data[s];
 
 	d.has_time_units = false;
@@ -286,6 +467,7 @@ CTimeLogger::TCallData::TCallData() :
 
 double CTimeLogger::getMeanTime(const std::string &name)  const
 {
+	flushEventBuffers();
 	TDataMap::const_iterator it = m_data.find(name);
 	if (it==m_data.end())
 		 return 0;
@@ -293,17 +475,275 @@ double CTimeLogger::getMeanTime(const std::string &name)  const
 }
 double CTimeLogger::getLastTime(const std::string &name) const
 {
+	flushEventBuffers();
 	TDataMap::const_iterator it = m_data.find(name);
 	if (it == m_data.end())
 		return 0;
 	else return it->second.last_t;
 }
 
-CTimeLoggerEntry::CTimeLoggerEntry(CTimeLogger &logger, const char*section_name ) : m_logger(logger),m_section_name(section_name)
+CTimeLoggerEntry::CTimeLoggerEntry(CTimeLogger &logger, const char*section_name ) : m_logger(logger),m_section_name(section_name),m_section(0)
 {
 	m_logger.enter(m_section_name);
 }
+CTimeLoggerEntry::CTimeLoggerEntry(CTimeLogger &logger, const CTimeLogger::TSectionHandle section ) : m_logger(logger),m_section_name(NULL),m_section(section)
+{
+	m_logger.enter(m_section);
+}
 CTimeLoggerEntry::~CTimeLoggerEntry()
 {
-	m_logger.leave(m_section_name);
+	if (m_section_name)
+		m_logger.leave(m_section_name);
+	else m_logger.leave(m_section);
+}
+
+CTimeLogger::TSectionHandle CTimeLogger::registerSection(const std::string &section_name)
+{
+	TSectionsRegistry &reg = getSectionsRegistry();
+	mrpt::synch::CCriticalSectionLocker lock(&reg.cs);
+	std::map<std::string,uint32_t>::const_iterator it = reg.handles.find(section_name);
+	if (it!=reg.handles.end())
+		return it->second;
+	const TSectionHandle h = static_cast<TSectionHandle>(reg.names.size());
+	reg.names.push_back(section_name);
+	reg.handles[section_name] = h;
+	return h;
+}
+
+std::string CTimeLogger::getSectionName(const TSectionHandle section)
+{
+	TSectionsRegistry &reg = getSectionsRegistry();
+	mrpt::synch::CCriticalSectionLocker lock(&reg.cs);
+	ASSERT_BELOW_(section, reg.names.size())
+	return reg.names[section];
+}
+
+void CTimeLogger::do_enter(const TSectionHandle section)
+{
+	detail::TThreadTraceEvents *te = m_trace->getThreadEvents();
+	te->stack.push_back(std::make_pair(section, detail::TTimeLoggerTraceImpl::now_ns()));
+}
+
+double CTimeLogger::do_leave(const TSectionHandle section)
+{
+	const uint64_t t = detail::TTimeLoggerTraceImpl::now_ns();
+	detail::TThreadTraceEvents *te = m_trace->getThreadEvents();
+	if (te->stack.empty() || te->stack.back().first!=section)
+		return 0; // This shouldn't happen!
+
+	detail::TTraceEvent ev;
+	ev.section = section;
+	ev.t_begin = te->stack.back().second - m_trace->t0;
+	ev.dur = t - te->stack.back().second;
+	te->stack.pop_back();
+	ev.depth = static_cast<uint32_t>(te->stack.size());
+	if (te->push(ev))
+	{
+		// Keep the memory of the buffers bounded even if nobody asks for the stats:
+		te->new_blocks = 0;
+		flushEventBuffers();
+	}
+	return ev.dur*1e-9;
+}
+
+void CTimeLogger::flushEventBuffers() const
+{
+	detail::TTimeLoggerTraceImpl &tr = *m_trace;
+	mrpt::synch::CCriticalSectionLocker lock(&tr.cs);
+
+	std::vector<std::string> names;
+	for (std::map<std::thread::id, detail::TThreadTraceEvents*>::iterator it=tr.threads.begin();it!=tr.threads.end();++it)
+	{
+		detail::TThreadTraceEvents &te = *it->second;
+		for (;;)
+		{
+			const size_t count = te.head->count.load(std::memory_order_acquire);
+			for (size_t i=te.head_read;i<count;i++)
+			{
+				const detail::TTraceEvent &ev = te.head->events[i];
+				if (ev.section>=names.size())
+				{
+					TSectionsRegistry &reg = getSectionsRegistry();
+					mrpt::synch::CCriticalSectionLocker lock_reg(&reg.cs);
+					names = reg.names;
+				}
+				// Stats:
+				TCallData &d = m_data[names[ev.section]];
+				const double At = ev.dur*1e-9;
+				d.last_t = At;
+				d.mean_t+=At;
+				if (++d.n_calls==1)
+				{
+					d.min_t= At;
+					d.max_t= At;
+				}
+				else
+				{
+					mrpt::utils::keep_min( d.min_t, At);
+					mrpt::utils::keep_max( d.max_t, At);
+				}
+				// Trace:
+				if (tr.tracing)
+				{
+					if (tr.trace.size()<tr.max_events)
+					{
+						detail::TTimeLoggerTraceImpl::TEvent e;
+						e.tid = te.tid;
+						e.ev = ev;
+						tr.trace.push_back(e);
+					}
+					else tr.num_dropped++;
+				}
+			}
+			te.head_read = count;
+			if (count<detail::TTraceEventsBlock::CAPACITY)
+				break;
+			// This block is full: move on to the next one, if the writer already created it:
+			detail::TTraceEventsBlock *next = te.head->next.load(std::memory_order_acquire);
+			if (!next)
+				break;
+			delete te.head;
+			te.head = next;
+			te.head_read = 0;
+		}
+	}
+}
+
+void CTimeLogger::enableTracing(bool enable, size_t max_events)
+{
+	flushEventBuffers(); // Events before this call are not part of the trace
+	mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
+	m_trace->tracing = enable;
+	m_trace->max_events = max_events;
+}
+
+bool CTimeLogger::isTracingEnabled() const
+{
+	return m_trace->tracing;
+}
+
+size_t CTimeLogger::getTraceEventCount() const
+{
+	flushEventBuffers();
+	mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
+	return m_trace->trace.size();
+}
+
+size_t CTimeLogger::getTraceDroppedCount() const
+{
+	flushEventBuffers();
+	mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
+	return m_trace->num_dropped;
+}
+
+void CTimeLogger::clearTrace()
+{
+	flushEventBuffers();
+	mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
+	m_trace->trace.clear();
+	m_trace->num_dropped = 0;
+}
+
+bool CTimeLogger::saveTraceToChromeJSON(const std::string &json_file) const
+{
+	flushEventBuffers();
+	CFileOutputStream f;
+	if (!f.open(json_file))
+		return false;
+
+	std::vector<std::string> names;
+	{
+		TSectionsRegistry &reg = getSectionsRegistry();
+		mrpt::synch::CCriticalSectionLocker lock_reg(&reg.cs);
+		names = reg.names;
+	}
+	for (size_t i=0;i<names.size();i++)
+		names[i] = jsonEscape(names[i]);
+	const std::string cat = jsonEscape(m_name.empty() ? std::string("mrpt") : m_name);
+
+	mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
+	f.printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (size_t i=0;i<m_trace->trace.size();i++)
+	{
+		const detail::TTimeLoggerTraceImpl::TEvent &e = m_trace->trace[i];
+		// "X": Complete event, with timestamp and duration in microseconds:
+		f.printf("%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"depth\":%u}}\n",
+			i ? ",":"",
+			names[e.ev.section].c_str(), cat.c_str(),
+			e.ev.t_begin*1e-3, e.ev.dur*1e-3,
+			static_cast<unsigned int>(e.tid), static_cast<unsigned int>(e.ev.depth));
+	}
+	f.printf("]}\n");
+	return true;
+}
+
+bool CTimeLogger::saveTraceToFoldedStacks(const std::string &folded_file) const
+{
+	flushEventBuffers();
+	CFileOutputStream f;
+	if (!f.open(folded_file))
+		return false;
+
+	std::vector<std::string> names;
+	{
+		TSectionsRegistry &reg = getSectionsRegistry();
+		mrpt::synch::CCriticalSectionLocker lock_reg(&reg.cs);
+		names = reg.names;
+	}
+
+	typedef detail::TTimeLoggerTraceImpl::TEvent TEvent;
+	std::vector<TEvent> evs;
+	{
+		mrpt::synch::CCriticalSectionLocker lock(&m_trace->cs);
+		evs = m_trace->trace;
+	}
+	// Sort by thread and start time, parents before their children:
+	std::sort(evs.begin(), evs.end(), [](const TEvent &a, const TEvent &b) {
+		if (a.tid!=b.tid) return a.tid<b.tid;
+		if (a.ev.t_begin!=b.ev.t_begin) return a.ev.t_begin<b.ev.t_begin;
+		if (a.ev.dur!=b.ev.dur) return a.ev.dur>b.ev.dur;
+		return a.ev.depth<b.ev.depth;
+	});
+
+	// Rebuild the nesting of each thread from the time intervals, and accumulate the exclusive time of each stack:
+	std::map<std::string,uint64_t> self_times;
+	struct TOpen { uint64_t t_begin, t_end, self; std::string path; };
+	std::vector<TOpen> stack;
+	for (size_t i=0;i<evs.size();i++)
+	{
+		const TEvent &e = evs[i];
+		if (i>0 && evs[i-1].tid!=e.tid)
+		{
+			while (!stack.empty()) { self_times[stack.back().path]+=stack.back().self; stack.pop_back(); }
+		}
+		const uint64_t t_end = e.ev.t_begin+e.ev.dur;
+		while (!stack.empty() && !(stack.back().t_begin<=e.ev.t_begin && t_end<=stack.back().t_end))
+		{
+			self_times[stack.back().path]+=stack.back().self;
+			stack.pop_back();
+		}
+		TOpen o;
+		o.t_begin = e.ev.t_begin;
+		o.t_end = t_end;
+		o.self = e.ev.dur;
+		o.path = names[e.ev.section];
+		std::replace(o.path.begin(), o.path.end(), ';', ':'); // ';' is the separator of the format
+		std::replace(o.path.begin(), o.path.end(), ' ', '_');
+		if (!stack.empty())
+		{
+			TOpen &parent = stack.back();
+			parent.self = parent.self>e.ev.dur ? parent.self-e.ev.dur : 0;
+			o.path = parent.path + std::string(";") + o.path;
+		}
+		stack.push_back(o);
+	}
+	while (!stack.empty()) { self_times[stack.back().path]+=stack.back().self; stack.pop_back(); }
+
+	for (std::map<std::string,uint64_t>::const_iterator it=self_times.begin();it!=self_times.end();++it)
+	{
+		const unsigned long long us = static_cast<unsigned long long>(it->second/1000);
+		if (us)
+			f.printf("%s %llu\n", it->first.c_str(), us);
+	}
+	return true;
 }
@@ -0,0 +1,159 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/utils/CTimeLogger.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/system/threads.h>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <thread>
+
+using namespace mrpt;
+using namespace mrpt::utils;
+using namespace std;
+
+static std::string readWholeFile(const std::string &fil)
+{
+	std::ifstream f(fil.c_str());
+	return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+TEST(CTimeLogger, sectionHandles)
+{
+	const CTimeLogger::TSectionHandle h1 = CTimeLogger::registerSection("CTimeLogger_test.a");
+	const CTimeLogger::TSectionHandle h2 = CTimeLogger::registerSection("CTimeLogger_test.b");
+	EXPECT_NE(h1, h2);
+	EXPECT_EQ(h1, CTimeLogger::registerSection("CTimeLogger_test.a"));
+	EXPECT_EQ(CTimeLogger::getSectionName(h2), "CTimeLogger_test.b");
+}
+
+TEST(CTimeLogger, nestedHandlesStats)
+{
+	static const CTimeLogger::TSectionHandle hOuter = CTimeLogger::registerSection("CTimeLogger_test.outer");
+	static const CTimeLogger::TSectionHandle hInner = CTimeLogger::registerSection("CTimeLogger_test.inner");
+
+	CTimeLogger tl;
+	tl.setMinLoggingLevel(mrpt::utils::LVL_ERROR); // Do not dump stats at destruction
+	for (int i=0;i<10;i++)
+	{
+		CTimeLoggerEntry tle(tl, hOuter);
+		tl.enter(hInner);
+		EXPECT_GE(tl.leave(hInner), 0.0);
+		tl.enter("CTimeLogger_test.by_name");
+		tl.leave("CTimeLogger_test.by_name");
+	}
+	EXPECT_EQ(tl.leave(hInner), 0.0); // Not entered
+
+	std::map<std::string,CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	EXPECT_EQ(stats["CTimeLogger_test.outer"].n_calls, 10u);
+	EXPECT_EQ(stats["CTimeLogger_test.inner"].n_calls, 10u);
+	EXPECT_EQ(stats["CTimeLogger_test.by_name"].n_calls, 10u);
+	EXPECT_GE(stats["CTimeLogger_test.outer"].total_t, stats["CTimeLogger_test.inner"].total_t);
+	EXPECT_GT(tl.getMeanTime("CTimeLogger_test.outer"), 0.0);
+	EXPECT_EQ(tl.getTraceEventCount(), 0u); // Tracing is disabled by default
+}
+
+TEST(CTimeLogger, multipleThreads)
+{
+	static const CTimeLogger::TSectionHandle hA = CTimeLogger::registerSection("CTimeLogger_test.thread_a");
+	static const CTimeLogger::TSectionHandle hB = CTimeLogger::registerSection("CTimeLogger_test.thread_b");
+	const size_t NTHREADS = 4, N = 100000; // Enough to fill several blocks of events in each thread
+
+	CTimeLogger tl;
+	tl.setMinLoggingLevel(mrpt::utils::LVL_ERROR);
+	tl.enableTracing(true, 1000);
+
+	std::vector<std::thread> threads;
+	for (size_t t=0;t<NTHREADS;t++)
+		threads.push_back(std::thread([&tl,N]() {
+			for (size_t i=0;i<N;i++)
+			{
+				tl.enter(hA);
+				tl.enter(hB);
+				tl.leave(hB);
+				tl.leave(hA);
+			}
+		}));
+	for (size_t t=0;t<NTHREADS;t++) threads[t].join();
+
+	std::map<std::string,CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	EXPECT_EQ(stats["CTimeLogger_test.thread_a"].n_calls, NTHREADS*N);
+	EXPECT_EQ(stats["CTimeLogger_test.thread_b"].n_calls, NTHREADS*N);
+	EXPECT_EQ(tl.getTraceEventCount(), 1000u);
+	EXPECT_EQ(tl.getTraceDroppedCount(), 2*NTHREADS*N-1000);
+	tl.clearTrace();
+	EXPECT_EQ(tl.getTraceEventCount(), 0u);
+	EXPECT_EQ(tl.getTraceDroppedCount(), 0u);
+}
+
+TEST(CTimeLogger, handlesAndNamesFromSeveralThreads)
+{
+	static const CTimeLogger::TSectionHandle hW = CTimeLogger::registerSection("CTimeLogger_test.worker");
+	const size_t NTHREADS = 3, N = 200000; // Enough for the workers to flush their buffers while the main thread runs
+
+	CTimeLogger tl;
+	tl.setMinLoggingLevel(mrpt::utils::LVL_ERROR);
+
+	std::vector<std::thread> threads;
+	for (size_t t=0;t<NTHREADS;t++)
+		threads.push_back(std::thread([&tl,N]() {
+			for (size_t i=0;i<N;i++)
+			{
+				tl.enter(hW);
+				tl.leave(hW);
+			}
+		}));
+	// Named sections in the owner thread, meanwhile:
+	for (size_t i=0;i<N;i++)
+	{
+		tl.enter(i%2 ? "CTimeLogger_test.main_a" : "CTimeLogger_test.main_b");
+		tl.leave(i%2 ? "CTimeLogger_test.main_a" : "CTimeLogger_test.main_b");
+	}
+	for (size_t t=0;t<NTHREADS;t++) threads[t].join();
+
+	std::map<std::string,CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	EXPECT_EQ(stats["CTimeLogger_test.worker"].n_calls, NTHREADS*N);
+	EXPECT_EQ(stats["CTimeLogger_test.main_a"].n_calls, N/2);
+	EXPECT_EQ(stats["CTimeLogger_test.main_b"].n_calls, N/2);
+}
+
+TEST(CTimeLogger, traceExport)
+{
+	static const CTimeLogger::TSectionHandle hOuter = CTimeLogger::registerSection("CTimeLogger_test.trace_outer");
+	static const CTimeLogger::TSectionHandle hInner = CTimeLogger::registerSection("CTimeLogger_test.trace_inner");
+
+	CTimeLogger tl(true, "test");
+	tl.setMinLoggingLevel(mrpt::utils::LVL_ERROR);
+	tl.enableTracing();
+	EXPECT_TRUE(tl.isTracingEnabled());
+	for (int i=0;i<3;i++)
+	{
+		CTimeLoggerEntry tle(tl, hOuter);
+		mrpt::system::sleep(2);
+		CTimeLoggerEntry tle2(tl, hInner);
+		mrpt::system::sleep(2);
+	}
+	EXPECT_EQ(tl.getTraceEventCount(), 6u);
+
+	const std::string fil = mrpt::system::getTempFileName();
+	ASSERT_TRUE(tl.saveTraceToChromeJSON(fil));
+	const std::string json = readWholeFile(fil);
+	EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+	EXPECT_NE(json.find("\"name\":\"CTimeLogger_test.trace_inner\",\"cat\":\"test\",\"ph\":\"X\""), std::string::npos);
+	EXPECT_NE(json.find("\"args\":{\"depth\":1}"), std::string::npos);
+
+	ASSERT_TRUE(tl.saveTraceToFoldedStacks(fil));
+	const std::string folded = readWholeFile(fil);
+	EXPECT_EQ(folded.find("CTimeLogger_test.trace_outer "), 0u);
+	EXPECT_NE(folded.find("\nCTimeLogger_test.trace_outer;CTimeLogger_test.trace_inner "), std::string::npos);
+	mrpt::system::deleteFile(fil);
+}
@@ -0,0 +1,112 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "base-precomp.h"  // Precompiled headers
+
+#include "gz_blocks.h"
+#include <mrpt/utils/mrpt_macros.h>
+#include <zlib.h>
+
+using namespace mrpt::utils;
+using namespace mrpt::utils::internal;
+
+namespace
+{
+	void put_uint32_le(uint8_t *p, uint32_t v)
+	{
+		p[0]=uint8_t(v); p[1]=uint8_t(v>>8); p[2]=uint8_t(v>>16); p[3]=uint8_t(v>>24);
+	}
+	uint32_t get_uint32_le(const uint8_t *p)
+	{
+		return uint32_t(p[0]) | (uint32_t(p[1])<<8) | (uint32_t(p[2])<<16) | (uint32_t(p[3])<<24);
+	}
+}
+
+void mrpt::utils::internal::gz_block_compress(const uint8_t *data, size_t len, int compress_level, std::vector<uint8_t> &out)
+{
+	z_stream s;
+	s.zalloc = Z_NULL; s.zfree = Z_NULL; s.opaque = Z_NULL;
+	// Negative window bits: raw deflate data, since we write our own gzip header and trailer:
+	if (deflateInit2(&s, compress_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY)!=Z_OK)
+		THROW_EXCEPTION("deflateInit2() failed")
+
+	out.resize(GZ_BLOCK_HEADER_SIZE + deflateBound(&s,static_cast<uLong>(len)) + GZ_BLOCK_TRAILER_SIZE);
+	s.next_in   = const_cast<Bytef*>(data);
+	s.avail_in  = static_cast<uInt>(len);
+	s.next_out  = &out[GZ_BLOCK_HEADER_SIZE];
+	s.avail_out = static_cast<uInt>(out.size()-GZ_BLOCK_HEADER_SIZE-GZ_BLOCK_TRAILER_SIZE);
+	const int ret = deflate(&s, Z_FINISH);
+	const size_t nCompr = s.total_out;
+	deflateEnd(&s);
+	if (ret!=Z_STREAM_END)
+		THROW_EXCEPTION("deflate() failed")
+
+	const size_t member_size = GZ_BLOCK_HEADER_SIZE + nCompr + GZ_BLOCK_TRAILER_SIZE;
+	out.resize(member_size);
+
+	// gzip header (RFC 1952) with the FEXTRA flag:
+	uint8_t *h = &out[0];
+	h[0]=0x1f; h[1]=0x8b; h[2]=8 /*deflate*/; h[3]=4 /*FEXTRA*/;
+	put_uint32_le(h+4, 0); // MTIME
+	h[8]=0; h[9]=255; // XFL, OS=unknown
+	h[10]=8; h[11]=0; // XLEN
+	h[12]='M'; h[13]='P'; h[14]=4; h[15]=0; // Subfield id and length
+	put_uint32_le(h+16, static_cast<uint32_t>(member_size));
+
+	// Trailer:
+	uint8_t *t = &out[member_size-GZ_BLOCK_TRAILER_SIZE];
+	put_uint32_le(t,   static_cast<uint32_t>(crc32(crc32(0L,Z_NULL,0), data, static_cast<uInt>(len))));
+	put_uint32_le(t+4, static_cast<uint32_t>(len));
+}
+
+bool mrpt::utils::internal::gz_block_parse_header(const uint8_t *h, uint32_t &out_member_size)
+{
+	if (h[0]!=0x1f || h[1]!=0x8b || h[2]!=8 || h[3]!=4 || h[10]!=8 || h[11]!=0 ||
+		h[12]!='M' || h[13]!='P' || h[14]!=4 || h[15]!=0)
+		return false;
+	out_member_size = get_uint32_le(h+16);
+	return out_member_size>=GZ_BLOCK_HEADER_SIZE+GZ_BLOCK_TRAILER_SIZE;
+}
+
+void mrpt::utils::internal::gz_block_decompress(const uint8_t *member, size_t member_size, std::vector<uint8_t> &out)
+{
+	ASSERT_(member_size>=GZ_BLOCK_HEADER_SIZE+GZ_BLOCK_TRAILER_SIZE)
+	const uint8_t *t = member+member_size-GZ_BLOCK_TRAILER_SIZE;
+	const uint32_t crc = get_uint32_le(t), len = get_uint32_le(t+4);
+	out.resize(len);
+
+	z_stream s;
+	s.zalloc = Z_NULL; s.zfree = Z_NULL; s.opaque = Z_NULL;
+	s.next_in  = const_cast<Bytef*>(member+GZ_BLOCK_HEADER_SIZE);
+	s.avail_in = static_cast<uInt>(member_size-GZ_BLOCK_HEADER_SIZE-GZ_BLOCK_TRAILER_SIZE);
+	if (inflateInit2(&s, -MAX_WBITS)!=Z_OK)
+		THROW_EXCEPTION("inflateInit2() failed")
+	uint8_t dummy;
+	s.next_out  = len ? &out[0] : &dummy;
+	s.avail_out = len;
+	const int ret = inflate(&s, Z_FINISH);
+	const bool ok = (ret==Z_STREAM_END && s.total_out==len);
+	inflateEnd(&s);
+	if (!ok)
+		THROW_EXCEPTION("Corrupted data in gzip block")
+	if (crc!=static_cast<uint32_t>(crc32(crc32(0L,Z_NULL,0), len ? &out[0] : &dummy, len)))
+		THROW_EXCEPTION("CRC error in gzip block")
+}
+
+void TGZBlocksCompressTask::operator()(size_t first, size_t last) const
+{
+	for (size_t i=first;i<last;i++)
+		gz_block_compress(in[i].empty() ? NULL : &in[i][0], in[i].size(), level, out[i]);
+}
+
+void TGZBlocksDecompressTask::operator()(size_t first, size_t last) const
+{
+	for (size_t i=first;i<last;i++)
+		gz_block_decompress(&in[i][0], in[i].size(), out[i]);
+}
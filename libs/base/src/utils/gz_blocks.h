@@ -0,0 +1,61 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef  gz_blocks_H
+#define  gz_blocks_H
+
+#include <mrpt/utils/types_simple.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <vector>
+
+namespace mrpt
+{
+	namespace utils
+	{
+		namespace internal
+		{
+			/** Block-compressed gzip files, as written by CFileGZOutputStream with several threads:
+			  * a sequence of independent, standard gzip members (so any gzip reader can decompress the file), each one
+			  * with an "extra field" (subfield id 'M','P') holding the total size of the member, so a reader can find the
+			  * boundaries between members without decompressing them, and decompress them in parallel.
+			  */
+			const size_t GZ_BLOCK_HEADER_SIZE = 20;
+			const size_t GZ_BLOCK_TRAILER_SIZE = 8;
+
+			/** Compresses a block of data into one gzip member (header, raw deflate data and trailer) */
+			void gz_block_compress(const uint8_t *data, size_t len, int compress_level, std::vector<uint8_t> &out_member);
+			/** Parses the header of a gzip member: returns false if it is not a block written by gz_block_compress() */
+			bool gz_block_parse_header(const uint8_t *header, uint32_t &out_member_size);
+			/** Decompresses a whole gzip member written by gz_block_compress() \exception std::exception On corrupted data */
+			void gz_block_decompress(const uint8_t *member, size_t member_size, std::vector<uint8_t> &out_data);
+
+			/** Compresses `in[i]` into `out[i]` for all i in `[first,last)` */
+			struct TGZBlocksCompressTask : public mrpt::system::CWorkerThreadsPool::TRangeTask
+			{
+				TGZBlocksCompressTask(const std::vector<std::vector<uint8_t> > &in_, std::vector<std::vector<uint8_t> > &out_, int level_) :
+					in(in_), out(out_), level(level_) {}
+				const std::vector<std::vector<uint8_t> > &in;
+				std::vector<std::vector<uint8_t> > &out;
+				const int level;
+				void operator()(size_t first, size_t last) const MRPT_OVERRIDE;
+			};
+
+			/** Decompresses `in[i]` into `out[i]` for all i in `[first,last)` */
+			struct TGZBlocksDecompressTask : public mrpt::system::CWorkerThreadsPool::TRangeTask
+			{
+				TGZBlocksDecompressTask(const std::vector<std::vector<uint8_t> > &in_, std::vector<std::vector<uint8_t> > &out_) :
+					in(in_), out(out_) {}
+				const std::vector<std::vector<uint8_t> > &in;
+				std::vector<std::vector<uint8_t> > &out;
+				void operator()(size_t first, size_t last) const MRPT_OVERRIDE;
+			};
+		}
+	} // End of namespace
+} // End of namespace
+
+#endif
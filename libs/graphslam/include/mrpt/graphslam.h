@@ -36,6 +36,7 @@
 // GraphSlamOptimizers
 #include "graphslam/GSO/CEmptyGSO.h"
 #include "graphslam/GSO/CLevMarqGSO.h"
+#include "graphslam/GSO/CIncrementalGSO.h"
 
 // Graph SLAM Engine - Relevant headers
 #include "graphslam/misc/CRangeScanOps.h"
@@ -734,7 +734,9 @@ class CGraphSlamEngine : public mrpt::utils::COutputLogger {
 				std::string class_name="Class");
 		/**\brief Wrapper around the GRAPH_T::dijkstra_nodes_estimate
 		 *
-		 * Update the global position of the nodes
+		 * Update the global position of the nodes. Not called if the optimizer
+		 * maintains the node estimates itself (see
+		 * CGraphSlamOptimizer::maintainsNodeEstimates)
 		 */
 		void execDijkstraNodesEstimation();
 
@@ -611,6 +611,10 @@ bool CGraphSlamEngine<GRAPH_T>::_execGraphSlamStep(
 		mrpt::synch::CCriticalSectionLocker m_graph_lock(&m_graph_section);
 
 		m_time_logger.enter("optimizer");
+		m_optimizer->notifyOfNewEdges(m_node_reg->getInsertedEdges());
+		m_optimizer->notifyOfNewEdges(m_edge_reg->getInsertedEdges());
+		m_node_reg->clearInsertedEdges();
+		m_edge_reg->clearInsertedEdges();
 		m_optimizer->updateState(
 				action,
 				observations,
@@ -656,7 +660,10 @@ bool CGraphSlamEngine<GRAPH_T>::_execGraphSlamStep(
 
 	if (registered_new_node) {
 
-		this->execDijkstraNodesEstimation();
+		// Would overwrite the estimates of an incremental optimizer:
+		if (!m_optimizer->maintainsNodeEstimates()) {
+			this->execDijkstraNodesEstimation();
+		}
 
 		// keep track of the laser scans so that I can later visualize the map
 		m_nodes_to_laser_scans2D[m_nodeID_max] = m_last_laser_scan2D;
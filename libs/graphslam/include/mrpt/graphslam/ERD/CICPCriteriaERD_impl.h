@@ -288,7 +288,7 @@ void CICPCriteriaERD<GRAPH_T>::registerNewEdge(
 	using namespace mrpt::utils;
 	parent_t::registerNewEdge(from, to, rel_edge);
 
-	this->m_graph->insertEdge(from,  to, rel_edge);
+	this->insertEdgeInGraph(from,  to, rel_edge);
 
 }
 
@@ -1596,7 +1596,7 @@ void CLoopCloserERD<GRAPH_T>::registerNewEdge(
 	}
 
 	//  actuall registration
-	this->m_graph->insertEdge(from, to, rel_edge);
+	this->insertEdgeInGraph(from, to, rel_edge);
 
 	MRPT_END;
 }
@@ -0,0 +1,256 @@
+/* +---------------------------------------------------------------------------+
+	 |                     Mobile Robot Programming Toolkit (MRPT)               |
+	 |                          http://www.mrpt.org/                             |
+	 |                                                                           |
+	 | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+	 | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+	 | Released under BSD License. See details in http://www.mrpt.org/License    |
+	 +---------------------------------------------------------------------------+ */
+
+#ifndef CINCREMENTALGSO_H
+#define CINCREMENTALGSO_H
+
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/utils/CLoadableOptions.h>
+#include <mrpt/utils/CConfigFile.h>
+#include <mrpt/utils/CConfigFileBase.h>
+#include <mrpt/utils/CStream.h>
+#include <mrpt/utils/types_simple.h>
+
+#include <mrpt/graphslam/types.h>
+#include <mrpt/graphslam/levmarq_impl.h>
+#include <mrpt/graphslam/interfaces/CGraphSlamOptimizer.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+namespace mrpt { namespace graphslam { namespace optimizers {
+
+/**\brief Incremental (iSAM-style) non-linear graph slam optimization scheme.
+ *
+ * ## Description
+ *
+ * Instead of re-optimizing the whole graph (or a window of it) from scratch
+ * as CLevMarqGSO does, this optimizer keeps the Cholesky factor \f$ L \f$ of
+ * the information matrix of the linearized problem, and updates it as new
+ * nodes and edges are registered by CGraphSlamEngine:
+ *
+ * - Each free node is a variable, with its own linearization point and
+ *   current increment (on the manifold) with respect to it. Variables are
+ *   ordered by their registration time.
+ * - New edges are linearized once and added to the information matrix and
+ *   gradient. Only the columns of \f$ L \f$ from the lowest variable touched
+ *   by the new edges onwards are refactorized. For odometry-like edges this
+ *   is a small, constant-size part at the end of the matrix; loop closures
+ *   refactorize from the oldest variable they close the loop with.
+ * - Only variables whose increment exceeds \b relinearize_threshold are
+ *   relinearized (fluid relinearization), and only the edges attached to
+ *   them are re-evaluated.
+ * - The back-substitution only updates the increments of variables affected
+ *   by a change larger than \b wildfire_threshold (partial state update).
+ *
+ * - The new edges are those notified by CGraphSlamEngine (see
+ *   notifyOfNewEdges()), so they are found without visiting the whole graph.
+ *
+ * Hence, the per-step cost depends on the size of the modified part of the
+ * problem, not on the size of the whole graph. Each call performs one
+ * Gauss-Newton step on the modified part of the problem.
+ *
+ * The graph root node is kept fixed. Since the node estimates are only
+ * written back for the variables that changed, CGraphSlamEngine does not
+ * re-estimate the nodes with Dijkstra when this optimizer is used.
+ *
+ * ### .ini Configuration Parameters
+ *
+ * \htmlinclude graphslam-engine_config_params_preamble.txt
+ *
+ * - \b class_verbosity
+ *   + \a Section       : OptimizerParameters
+ *   + \a Default value : 1 (LVL_INFO)
+ *   + \a Required      : FALSE
+ *
+ * - \b relinearize_threshold
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 0.1
+ *  + \a Required      : FALSE
+ *  + \a Description   : Variables whose increment (max. absolute value of
+ *  its components, on the manifold) is larger than this value are
+ *  relinearized.
+ *
+ * - \b wildfire_threshold
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 1e-3
+ *  + \a Required      : FALSE
+ *  + \a Description   : Changes in the increment of a variable smaller than
+ *  this value are not propagated to the variables it depends upon during the
+ *  back-substitution.
+ *
+ * \note (New in MRPT 1.5.0)
+ * \ingroup mrpt_graphslam_grp
+ */
+template<class GRAPH_T=typename mrpt::graphs::CNetworkOfPoses2DInf>
+class CIncrementalGSO:
+	public mrpt::graphslam::optimizers::CGraphSlamOptimizer<GRAPH_T>
+{
+	public:
+		// Public methods
+		//////////////////////////////////////////////////////////////
+		/**\brief Handy typedefs */
+		/**\{*/
+		typedef typename GRAPH_T::constraint_t constraint_t;
+		typedef typename GRAPH_T::constraint_t::type_value pose_t; // type of underlying poses (2D/3D)
+		typedef mrpt::graphslam::graphslam_traits<GRAPH_T> gst;
+		typedef mrpt::graphslam::CRegistrationDeciderOrOptimizer<GRAPH_T> grandpa;
+		typedef mrpt::graphslam::optimizers::CGraphSlamOptimizer<GRAPH_T> parent;
+		/**\}*/
+
+		CIncrementalGSO();
+		~CIncrementalGSO();
+
+		/**\brief Incorporate the nodes and edges added to the graph since the
+		 * last call, and update the estimate of the affected nodes.
+		 *
+		 * \return True if the graph node estimates were updated.
+		 */
+		bool updateState( mrpt::obs::CActionCollectionPtr action,
+				mrpt::obs::CSensoryFramePtr observations,
+				mrpt::obs::CObservationPtr observation );
+
+		void loadParams(const std::string& source_fname);
+		void printParams() const;
+		void getDescriptiveReport(std::string* report_str) const;
+		/**\brief The estimates of all the variables are written back to the
+		 * graph as they change, so they must not be overwritten by
+		 * CGraphSlamEngine with a Dijkstra projection of the edges
+		 */
+		bool maintainsNodeEstimates() const { return true; }
+		/**\brief Queue the new edges to be incorporated in the next call to
+		 * updateState(). If the graph gained exactly these edges, only they are
+		 * looked up; otherwise, all the edges of the graph are visited.
+		 */
+		void notifyOfNewEdges(
+				const std::vector<mrpt::utils::TPairNodeIDs>& new_edges);
+
+		/**\brief Struct for holding the optimization-related variables in a
+		 * compact form
+		 */
+		struct OptimizationParams: public mrpt::utils::CLoadableOptions {
+			public:
+				OptimizationParams();
+				~OptimizationParams();
+
+				void loadFromConfigFile(
+						const mrpt::utils::CConfigFileBase &source,
+						const std::string &section);
+				void 	dumpToTextStream(mrpt::utils::CStream &out) const;
+
+				/**\brief Relinearize variables whose increment is larger than this */
+				double relinearize_threshold;
+				/**\brief Do not propagate smaller changes in the back-substitution */
+				double wildfire_threshold;
+		};
+
+		OptimizationParams opt_params;
+
+		/**\brief Number of variables (free nodes) in the factorized problem */
+		size_t getVariableCount() const { return m_var_ids.size(); }
+		/**\brief Number of variables whose Cholesky factor columns were
+		 * recomputed in the last call to updateState()
+		 */
+		size_t getLastRefactorizedCount() const { return m_last_refactorized; }
+		/**\brief Number of graph edges visited while looking for the new ones
+		 * in the last call to updateState() \sa notifyOfNewEdges
+		 */
+		size_t getLastVisitedEdgeCount() const { return m_last_visited_edges; }
+
+	protected:
+		/**\brief Handy typedefs for the linear system */
+		/**\{*/
+		enum { DIM = gst::SE_TYPE::VECTOR_SIZE };
+		typedef Eigen::Matrix<double,DIM,DIM> block_t;
+		typedef Eigen::Matrix<double,DIM,1> vector_t;
+		/**\brief Lower-triangular sparse column: row index -> DIMxDIM block */
+		typedef typename mrpt::aligned_containers<size_t,block_t>::map_t column_t;
+		/**\}*/
+
+		/**\brief An edge of the graph, with its contribution to the linear system
+		 * at the current linearization points
+		 */
+		struct TFactor {
+			typename gst::edge_const_iterator edge;
+			size_t var1, var2; //!< Variable indices of the edge nodes (std::string::npos for the fixed root)
+			block_t H11, H22, H21; //!< Contributions to the information matrix (H21 is the block at row max(var1,var2))
+			vector_t g1, g2; //!< Contributions to the gradient
+			EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+		};
+
+		/**\brief Run one incremental update, see updateState() */
+		void optimizeGraph();
+		/**\brief Incorporate new nodes and edges, relinearize, refactorize and
+		 * solve. \return True if any node estimate changed */
+		bool incrementalUpdate();
+		/**\brief Incorporate a new edge to the linear system, updating the
+		 * lowest variable index whose column changed */
+		void addFactor(const typename gst::edge_const_iterator &it, size_t &first_changed);
+		/**\brief Find the notified new edges in the graph. \return false if
+		 * any of them is missing */
+		bool findNotifiedEdges(std::vector<typename gst::edge_const_iterator> &new_edges) const;
+		/**\brief Get (creating it if needed) the variable index of a node, or
+		 * std::string::npos for the fixed root node */
+		size_t getOrCreateVariable(const mrpt::utils::TNodeID id);
+		/**\brief Linearize a factor at the current linearization points and add
+		 * (sign=+1) its contribution to the linear system, or remove it (sign=-1) */
+		void applyFactor(TFactor &f, const double sign);
+		void linearizeFactor(TFactor &f);
+		/**\brief Access a block of a sparse column, inserting it as zeros if it does not exist */
+		static block_t & getBlock(column_t &col, const size_t row);
+		/**\brief Recompute columns [first,N) of the Cholesky factor */
+		void refactorize(const size_t first);
+		/**\brief Solve the factorized system, returning the list of variables
+		 * whose increment changed */
+		void solve(const size_t first, std::vector<size_t> &changed_vars);
+
+		bool m_has_read_config;
+
+		/**\name Variables
+		 * One entry per free node, in order of creation */
+		/**\{*/
+		std::vector<mrpt::utils::TNodeID> m_var_ids;
+		std::map<mrpt::utils::TNodeID,size_t> m_node2var;
+		typename mrpt::aligned_containers<pose_t>::vector_t m_lin_points; //!< Linearization points
+		typename mrpt::aligned_containers<vector_t>::vector_t m_deltas; //!< Current increments: x = exp(delta) (+) lin_point
+		typename mrpt::aligned_containers<vector_t>::vector_t m_grad; //!< Gradient of the cost function at the linearization points
+		typename mrpt::aligned_containers<vector_t>::vector_t m_y; //!< Solution of the forward substitution: L*y = -grad
+		std::vector<std::vector<size_t> > m_var_factors; //!< Indices of the factors attached to each variable
+		/**\}*/
+
+		/**\brief Lower triangular part of the information matrix, by columns */
+		std::vector<column_t> m_H;
+		/**\brief Cholesky factor of m_H, by columns */
+		std::vector<column_t> m_L;
+		/**\brief For each row of m_L, the columns with non-zero blocks (excluding the diagonal) */
+		std::vector<std::set<size_t> > m_L_rows;
+
+		typename mrpt::aligned_containers<TFactor>::vector_t m_factors;
+		/**\brief Number of edges already incorporated for each pair of nodes */
+		std::map<mrpt::utils::TPairNodeIDs,size_t> m_edges_done;
+		size_t m_num_edges_done;
+		/**\brief New edges notified since the last update, see notifyOfNewEdges() */
+		std::vector<mrpt::utils::TPairNodeIDs> m_notified_edges;
+		size_t m_last_visited_edges;
+
+		/**\brief Variables to be checked for relinearization in the next step */
+		std::set<size_t> m_relin_candidates;
+
+		size_t m_last_refactorized;
+};
+
+} } } // end of namespaces
+
+#include "CIncrementalGSO_impl.h"
+
+#endif /* end of include guard: CINCREMENTALGSO_H */
@@ -0,0 +1,478 @@
+/* +---------------------------------------------------------------------------+
+	 |                     Mobile Robot Programming Toolkit (MRPT)               |
+	 |                          http://www.mrpt.org/                             |
+	 |                                                                           |
+	 | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+	 | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+	 | Released under BSD License. See details in http://www.mrpt.org/License    |
+	 +---------------------------------------------------------------------------+ */
+
+#ifndef CINCREMENTALGSO_IMPL_H
+#define CINCREMENTALGSO_IMPL_H
+
+#include <Eigen/Cholesky>
+
+namespace mrpt { namespace graphslam { namespace optimizers {
+
+// Ctors, Dtors
+//////////////////////////////////////////////////////////////
+
+template<class GRAPH_T>
+CIncrementalGSO<GRAPH_T>::CIncrementalGSO():
+	m_has_read_config(false),
+	m_num_edges_done(0),
+	m_last_visited_edges(0),
+	m_last_refactorized(0)
+{
+	MRPT_START;
+	this->initializeLoggers("CIncrementalGSO");
+	MRPT_END;
+}
+template<class GRAPH_T>
+CIncrementalGSO<GRAPH_T>::~CIncrementalGSO() { }
+
+// Member function implementations
+//////////////////////////////////////////////////////////////
+template<class GRAPH_T>
+bool CIncrementalGSO<GRAPH_T>::updateState(
+		mrpt::obs::CActionCollectionPtr action,
+		mrpt::obs::CSensoryFramePtr observations,
+		mrpt::obs::CObservationPtr observation ) {
+	MRPT_START;
+	MRPT_UNUSED_PARAM(action); MRPT_UNUSED_PARAM(observations); MRPT_UNUSED_PARAM(observation);
+	return this->incrementalUpdate();
+	MRPT_END;
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::notifyOfNewEdges(
+		const std::vector<mrpt::utils::TPairNodeIDs>& new_edges) {
+	m_notified_edges.insert(m_notified_edges.end(), new_edges.begin(), new_edges.end());
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::optimizeGraph() {
+	this->incrementalUpdate();
+}
+
+template<class GRAPH_T>
+bool CIncrementalGSO<GRAPH_T>::incrementalUpdate() {
+	MRPT_START;
+	using namespace mrpt::utils;
+	ASSERT_(this->m_graph);
+	GRAPH_T &graph = *this->m_graph;
+
+	this->m_time_logger.enter("CIncrementalGSO::updateState");
+
+	// Lowest variable index whose column in the information matrix changed:
+	size_t first_changed = std::string::npos;
+
+	// 1) Incorporate new edges (and the variables of their nodes):
+	// -----------------------------------------------------------------
+	m_last_visited_edges = 0;
+	if (graph.edges.size()!=m_num_edges_done) {
+		this->m_time_logger.enter("CIncrementalGSO::new_edges");
+		std::vector<typename gst::edge_const_iterator> new_edges;
+		if (m_num_edges_done+m_notified_edges.size()==graph.edges.size() &&
+				findNotifiedEdges(new_edges)) {
+			m_last_visited_edges = new_edges.size();
+			for (size_t i=0;i<new_edges.size();i++) {
+				m_edges_done[new_edges[i]->first]++;
+				m_num_edges_done++;
+				addFactor(new_edges[i], first_changed);
+			}
+		}
+		else {
+			// Edges were inserted behind our back: look for them in the whole graph.
+			typename gst::edge_const_iterator it = graph.edges.begin();
+			while (it!=graph.edges.end()) {
+				const TPairNodeIDs ids = it->first;
+				size_t &n_done = m_edges_done[ids];
+				// New edges between the same nodes are inserted at the end of their range:
+				for (size_t k=0;k<n_done && it!=graph.edges.end() && it->first==ids;k++,m_last_visited_edges++) ++it;
+				for (;it!=graph.edges.end() && it->first==ids;++it,++n_done,++m_num_edges_done,m_last_visited_edges++)
+					addFactor(it, first_changed);
+			}
+		}
+		this->m_time_logger.leave("CIncrementalGSO::new_edges");
+	}
+	m_notified_edges.clear();
+
+	// 2) Relinearize the variables whose increment became too large:
+	// -----------------------------------------------------------------
+	this->m_time_logger.enter("CIncrementalGSO::relinearize");
+	size_t num_relinearized = 0;
+	std::set<size_t> relin_factors;
+	for (std::set<size_t>::const_iterator itV=m_relin_candidates.begin();itV!=m_relin_candidates.end();++itV) {
+		const size_t v = *itV;
+		if (m_deltas[v].array().abs().maxCoeff()<=opt_params.relinearize_threshold)
+			continue;
+
+		// New linearization point: exp(delta) (+) lin_point
+		typename gst::Array_O d;
+		for (int i=0;i<DIM;i++) d[i] = m_deltas[v][i];
+		pose_t exp_delta(mrpt::poses::UNINITIALIZED_POSE);
+		gst::SE_TYPE::exp(d,exp_delta);
+		m_lin_points[v].composeFrom(exp_delta, m_lin_points[v]);
+		m_deltas[v].setZero();
+		num_relinearized++;
+
+		relin_factors.insert(m_var_factors[v].begin(),m_var_factors[v].end());
+	}
+	m_relin_candidates.clear();
+	for (std::set<size_t>::const_iterator itF=relin_factors.begin();itF!=relin_factors.end();++itF) {
+		TFactor &f = m_factors[*itF];
+		applyFactor(f, -1.0);
+		linearizeFactor(f);
+		applyFactor(f, 1.0);
+		if (f.var1!=std::string::npos) mrpt::utils::keep_min(first_changed, f.var1);
+		if (f.var2!=std::string::npos) mrpt::utils::keep_min(first_changed, f.var2);
+	}
+	this->m_time_logger.leave("CIncrementalGSO::relinearize");
+
+	m_last_refactorized = 0;
+	if (first_changed==std::string::npos) {
+		this->m_time_logger.leave("CIncrementalGSO::updateState");
+		return false;
+	}
+
+	// 3) Update the factorization and the solution:
+	// -----------------------------------------------------------------
+	this->m_time_logger.enter("CIncrementalGSO::refactorize");
+	refactorize(first_changed);
+	this->m_time_logger.leave("CIncrementalGSO::refactorize");
+
+	this->m_time_logger.enter("CIncrementalGSO::solve");
+	std::vector<size_t> changed_vars;
+	solve(first_changed, changed_vars);
+	this->m_time_logger.leave("CIncrementalGSO::solve");
+
+	// 4) Update the estimates of the nodes in the graph:
+	// -----------------------------------------------------------------
+	for (size_t i=0;i<changed_vars.size();i++) {
+		const size_t v = changed_vars[i];
+		typename gst::Array_O d;
+		for (int k=0;k<DIM;k++) d[k] = m_deltas[v][k];
+		pose_t exp_delta(mrpt::poses::UNINITIALIZED_POSE);
+		gst::SE_TYPE::exp(d,exp_delta);
+		graph.nodes[m_var_ids[v]].composeFrom(exp_delta, m_lin_points[v]);
+		m_relin_candidates.insert(v);
+	}
+
+	this->logFmt(LVL_DEBUG,
+			"%u variables, %u factorized columns, %u updated, %u relinearized",
+			static_cast<unsigned int>(m_var_ids.size()),
+			static_cast<unsigned int>(m_last_refactorized),
+			static_cast<unsigned int>(changed_vars.size()),
+			static_cast<unsigned int>(num_relinearized));
+
+	this->m_time_logger.leave("CIncrementalGSO::updateState");
+	return true;
+	MRPT_END;
+}
+
+template<class GRAPH_T>
+bool CIncrementalGSO<GRAPH_T>::findNotifiedEdges(
+		std::vector<typename gst::edge_const_iterator> &new_edges) const {
+	// Number of edges of each pair of nodes already taken, including the
+	// notified ones found so far:
+	std::map<mrpt::utils::TPairNodeIDs,size_t> n_taken;
+	for (size_t i=0;i<m_notified_edges.size();i++) {
+		const mrpt::utils::TPairNodeIDs &ids = m_notified_edges[i];
+		std::map<mrpt::utils::TPairNodeIDs,size_t>::iterator itT = n_taken.find(ids);
+		if (itT==n_taken.end()) {
+			std::map<mrpt::utils::TPairNodeIDs,size_t>::const_iterator itD = m_edges_done.find(ids);
+			itT = n_taken.insert(std::make_pair(ids, itD!=m_edges_done.end() ? itD->second : 0)).first;
+		}
+		// New edges between the same nodes are inserted at the end of their range:
+		typename gst::edge_const_iterator it = this->m_graph->edges.lower_bound(ids);
+		for (size_t k=0;k<itT->second && it!=this->m_graph->edges.end() && it->first==ids;k++) ++it;
+		if (it==this->m_graph->edges.end() || it->first!=ids)
+			return false;
+		new_edges.push_back(it);
+		itT->second++;
+	}
+	return true;
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::addFactor(
+		const typename gst::edge_const_iterator &it, size_t &first_changed) {
+	TFactor f;
+	f.edge = it;
+	f.var1 = getOrCreateVariable(it->first.first);
+	f.var2 = getOrCreateVariable(it->first.second);
+	if (f.var1==std::string::npos && f.var2==std::string::npos)
+		return; // Both nodes are fixed
+	linearizeFactor(f);
+	applyFactor(f, 1.0);
+	m_factors.push_back(f);
+	if (f.var1!=std::string::npos) { m_var_factors[f.var1].push_back(m_factors.size()-1); mrpt::utils::keep_min(first_changed, f.var1); }
+	if (f.var2!=std::string::npos) { m_var_factors[f.var2].push_back(m_factors.size()-1); mrpt::utils::keep_min(first_changed, f.var2); }
+}
+
+template<class GRAPH_T>
+size_t CIncrementalGSO<GRAPH_T>::getOrCreateVariable(const mrpt::utils::TNodeID id) {
+	if (id==this->m_graph->root)
+		return std::string::npos;
+	std::map<mrpt::utils::TNodeID,size_t>::const_iterator it = m_node2var.find(id);
+	if (it!=m_node2var.end())
+		return it->second;
+
+	typename GRAPH_T::global_poses_t::const_iterator itP = this->m_graph->nodes.find(id);
+	ASSERTMSG_(itP!=this->m_graph->nodes.end(), mrpt::format("Node %u in an edge does not have a global pose", static_cast<unsigned int>(id)));
+
+	const size_t v = m_var_ids.size();
+	m_node2var[id] = v;
+	m_var_ids.push_back(id);
+	m_lin_points.push_back(itP->second);
+	m_deltas.push_back(vector_t::Zero());
+	m_grad.push_back(vector_t::Zero());
+	m_y.push_back(vector_t::Zero());
+	m_var_factors.resize(v+1);
+	m_H.resize(v+1);
+	m_H[v][v].setZero();
+	m_L.resize(v+1);
+	m_L_rows.resize(v+1);
+	return v;
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::linearizeFactor(TFactor &f) {
+	typedef typename gst::matrix_VxV_t matrix_t;
+
+	// Evaluate the error and Jacobians at the linearization points (or the fixed root pose):
+	typename gst::observation_info_t obs;
+	obs.edge = f.edge;
+	obs.edge_mean = &f.edge->second.getPoseMean();
+	obs.P1 = f.var1!=std::string::npos ? &m_lin_points[f.var1] : &this->m_graph->nodes[f.edge->first.first];
+	obs.P2 = f.var2!=std::string::npos ? &m_lin_points[f.var2] : &this->m_graph->nodes[f.edge->first.second];
+
+	typename gst::TPairJacobs J;
+	typename gst::Array_O err;
+	mrpt::graphslam::detail::computeJacobianAndError<gst>(obs, J, err);
+
+	typedef mrpt::graphslam::detail::AuxErrorEval<typename gst::edge_t,gst> aux_t;
+	matrix_t JtJ(mrpt::math::UNINITIALIZED_MATRIX);
+	typename gst::Array_O g;
+
+	aux_t::multiplyJtLambdaJ(J.first,JtJ,f.edge);  f.H11 = JtJ;
+	aux_t::multiplyJtLambdaJ(J.second,JtJ,f.edge); f.H22 = JtJ;
+	if (f.var1>f.var2)
+	     aux_t::multiplyJ1tLambdaJ2(J.first,J.second,JtJ,f.edge);
+	else aux_t::multiplyJ1tLambdaJ2(J.second,J.first,JtJ,f.edge);
+	f.H21 = JtJ;
+	g.fill(0); aux_t::multiply_Jt_W_err(J.first,f.edge,err,g);  f.g1 = g;
+	g.fill(0); aux_t::multiply_Jt_W_err(J.second,f.edge,err,g); f.g2 = g;
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::applyFactor(TFactor &f, const double sign) {
+	const size_t npos = std::string::npos;
+	if (f.var1!=npos) { m_H[f.var1][f.var1] += sign*f.H11; m_grad[f.var1] += sign*f.g1; }
+	if (f.var2!=npos) { m_H[f.var2][f.var2] += sign*f.H22; m_grad[f.var2] += sign*f.g2; }
+	if (f.var1!=npos && f.var2!=npos && f.var1!=f.var2) {
+		getBlock(m_H[std::min(f.var1,f.var2)], std::max(f.var1,f.var2)) += sign*f.H21;
+	}
+}
+
+template<class GRAPH_T>
+typename CIncrementalGSO<GRAPH_T>::block_t & CIncrementalGSO<GRAPH_T>::getBlock(column_t &col, const size_t row) {
+	typename column_t::iterator it = col.find(row);
+	if (it==col.end())
+		it = col.insert(std::make_pair(row, block_t(block_t::Zero()))).first;
+	return it->second;
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::refactorize(const size_t first) {
+	MRPT_START;
+	const size_t N = m_var_ids.size();
+	m_last_refactorized = N-first;
+
+	// The columns [0,first) of L do not change, since neither do the
+	// columns [0,first) of H. The trailing part is the Cholesky factor of
+	//   S = H22 - L21 * L21^t
+	// Working matrix, with the same storage than L (columns of rows >= col):
+	std::vector<column_t> W(N-first);
+	for (size_t c=first;c<N;c++)
+		W[c-first] = m_H[c];
+
+	// Columns of L21 with non-zero blocks in rows >= first:
+	std::set<size_t> cols21;
+	for (size_t r=first;r<N;r++) {
+		std::set<size_t> &row = m_L_rows[r];
+		// Also, forget the structure of the columns being recomputed:
+		row.erase(row.lower_bound(first), row.end());
+		cols21.insert(row.begin(),row.end());
+	}
+	for (std::set<size_t>::const_iterator itC=cols21.begin();itC!=cols21.end();++itC) {
+		const column_t &col = m_L[*itC];
+		for (typename column_t::const_iterator it1=col.lower_bound(first);it1!=col.end();++it1)
+			for (typename column_t::const_iterator it2=col.lower_bound(first);it2!=col.end() && it2->first<=it1->first;++it2)
+				getBlock(W[it2->first-first], it1->first).noalias() -= it1->second * it2->second.transpose();
+	}
+
+	// Right-looking block Cholesky of the working matrix:
+	Eigen::LLT<block_t> llt;
+	for (size_t k=first;k<N;k++) {
+		column_t &Wk = W[k-first];
+		column_t &Lk = m_L[k];
+		Lk.clear();
+
+		llt.compute(Wk[k]);
+		if (llt.info()!=Eigen::Success)
+			THROW_EXCEPTION(mrpt::format("Information matrix is not positive definite at node #%u", static_cast<unsigned int>(m_var_ids[k])));
+		Lk[k] = llt.matrixL();
+
+		// Off-diagonal blocks: L_rk = W_rk * L_kk^-t
+		for (typename column_t::const_iterator it=Wk.upper_bound(k);it!=Wk.end();++it) {
+			Lk[it->first] = llt.matrixL().solve(it->second.transpose()).transpose();
+			m_L_rows[it->first].insert(k);
+		}
+
+		// Update the trailing submatrix:
+		for (typename column_t::const_iterator it1=Lk.upper_bound(k);it1!=Lk.end();++it1)
+			for (typename column_t::const_iterator it2=Lk.upper_bound(k);it2!=Lk.end() && it2->first<=it1->first;++it2)
+				getBlock(W[it2->first-first], it1->first).noalias() -= it1->second * it2->second.transpose();
+	}
+	MRPT_END;
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::solve(const size_t first, std::vector<size_t> &changed_vars) {
+	const size_t N = m_var_ids.size();
+	changed_vars.clear();
+
+	// Forward substitution, L*y = -grad. Entries before "first" do not change:
+	for (size_t k=first;k<N;k++) {
+		vector_t b = -m_grad[k];
+		const std::set<size_t> &row = m_L_rows[k];
+		for (std::set<size_t>::const_iterator it=row.begin();it!=row.end();++it)
+			b.noalias() -= m_L[*it].find(k)->second * m_y[*it];
+		m_y[k] = m_L[k].find(k)->second.template triangularView<Eigen::Lower>().solve(b);
+	}
+
+	// Back substitution, L^t * delta = y. All entries from "first" on may
+	// change; entries before that are only updated if the change of a variable
+	// they depend upon exceeds the "wildfire" threshold:
+	std::set<size_t> pending;
+	for (size_t k=N;k-->0;) {
+		if (k<first) {
+			if (pending.empty()) break;
+			k = *pending.rbegin();
+			pending.erase(k);
+		}
+		const column_t &Lk = m_L[k];
+		vector_t b = m_y[k];
+		for (typename column_t::const_iterator it=Lk.upper_bound(k);it!=Lk.end();++it)
+			b.noalias() -= it->second.transpose() * m_deltas[it->first];
+		const vector_t new_delta = Lk.find(k)->second.template triangularView<Eigen::Lower>().transpose().solve(b);
+
+		const double change = (new_delta-m_deltas[k]).array().abs().maxCoeff();
+		m_deltas[k] = new_delta;
+		if (change>0 || k>=first)
+			changed_vars.push_back(k);
+		if (change>opt_params.wildfire_threshold) {
+			const std::set<size_t> &row = m_L_rows[k];
+			for (std::set<size_t>::const_iterator it=row.begin();it!=row.end() && *it<first;++it)
+				pending.insert(*it);
+		}
+	}
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::printParams() const {
+	parent::printParams();
+	opt_params.dumpToConsole();
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::loadParams(const std::string& source_fname) {
+	MRPT_START;
+	using namespace mrpt::utils;
+	parent::loadParams(source_fname);
+
+	opt_params.loadFromConfigFileName(source_fname, "OptimizerParameters");
+
+	CConfigFile source(source_fname);
+	int min_verbosity_level = source.read_int(
+			"OptimizerParameters",
+			"class_verbosity",
+			1, false);
+	this->setMinLoggingLevel(VerbosityLevel(min_verbosity_level));
+
+	this->logFmt(mrpt::utils::LVL_DEBUG, "Successfully loaded Params. ");
+	m_has_read_config = true;
+
+	MRPT_END;
+}
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::getDescriptiveReport(std::string* report_str) const {
+	MRPT_START;
+	using namespace std;
+
+	const std::string report_sep(2, '\n');
+	const std::string header_sep(80, '#');
+
+	size_t nnz_L = 0;
+	for (size_t i=0;i<m_L.size();i++) nnz_L += m_L[i].size();
+
+	stringstream class_props_ss;
+	class_props_ss << "Incremental Optimization Summary: " << std::endl;
+	class_props_ss << header_sep << std::endl;
+	class_props_ss << "Variables             = " << m_var_ids.size() << std::endl;
+	class_props_ss << "Factors               = " << m_factors.size() << std::endl;
+	class_props_ss << "Non-zero blocks in L  = " << nnz_L << std::endl;
+
+	const std::string time_res = this->m_time_logger.getStatsAsText();
+	const std::string output_res = this->getLogAsString();
+
+	report_str->clear();
+	parent::getDescriptiveReport(report_str);
+
+	*report_str += class_props_ss.str();
+	*report_str += report_sep;
+
+	*report_str += time_res;
+	*report_str += report_sep;
+
+	*report_str += output_res;
+	*report_str += report_sep;
+
+	MRPT_END;
+}
+
+// OptimizationParams
+//////////////////////////////////////////////////////////////
+template<class GRAPH_T>
+CIncrementalGSO<GRAPH_T>::OptimizationParams::OptimizationParams():
+	relinearize_threshold(0.1),
+	wildfire_threshold(1e-3)
+{ }
+template<class GRAPH_T>
+CIncrementalGSO<GRAPH_T>::OptimizationParams::~OptimizationParams() { }
+
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::OptimizationParams::dumpToTextStream(
+		mrpt::utils::CStream &out) const {
+	MRPT_START;
+	out.printf("------------------[ Incremental Optimization ]------------------\n");
+	out.printf("Relinearization threshold      = %e\n", relinearize_threshold);
+	out.printf("Wildfire threshold             = %e\n", wildfire_threshold);
+	MRPT_END;
+}
+template<class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::OptimizationParams::loadFromConfigFile(
+		const mrpt::utils::CConfigFileBase &source,
+		const std::string &section) {
+	MRPT_START;
+	MRPT_LOAD_CONFIG_VAR(relinearize_threshold, double, source, section);
+	MRPT_LOAD_CONFIG_VAR(wildfire_threshold, double, source, section);
+	MRPT_END;
+}
+
+} } } // end of namespaces
+
+#endif /* end of include guard: CINCREMENTALGSO_IMPL_H */
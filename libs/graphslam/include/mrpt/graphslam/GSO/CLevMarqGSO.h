@@ -111,6 +111,14 @@ namespace mrpt { namespace graphslam { namespace optimizers {
  *  + \a Required      : FALSE
  *  + \a Description   : Refers to the Levenberg-Marquardt optimization.
  *
+ * - \b num_threads
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 1
+ *  + \a Required      : FALSE
+ *  + \a Description   : Refers to the Levenberg-Marquardt optimization. Number
+ *  of threads used to evaluate the Jacobians and errors of the constraints
+ *  (0: as many as CPU cores).
+ *
  *  \note For a detailed description of the optimization parameters of the
  *  Levenberg-Marquardt scheme, refer to
  *  http://reference.mrpt.org/devel/group__mrpt__graphslam__grp.html#ga022f4a70be5ec7c432f46374e4bb9d66 
@@ -347,6 +355,10 @@ class CLevMarqGSO:
 
 		// Use second thread for graph optimization
 		mrpt::system::TThreadHandle m_thread_optimize;
+		/**\brief Solver state (Cholesky symbolic analysis, worker threads) kept
+		 * between successive optimizations
+		 */
+		mrpt::graphslam::TSpaLevMarqSolverCache m_solver_cache;
 
 		/**\brief Enumeration that defines the behaviors towards using or ignoring a
 		 * newly added loop closure to fully optimize the graph
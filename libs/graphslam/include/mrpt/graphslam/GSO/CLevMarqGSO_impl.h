@@ -432,7 +432,8 @@ void CLevMarqGSO<GRAPH_T>::_optimizeGraph(bool is_full_update/*=false*/) {
 			levmarq_info,
 			nodes_to_optimize,
 			opt_params.cfg,
-			&CLevMarqGSO<GRAPH_T>::levMarqFeedback); // functor feedback
+			&CLevMarqGSO<GRAPH_T>::levMarqFeedback, // functor feedback
+			&m_solver_cache); // reuse the Cholesky analysis and threads between calls
 
 	if (is_full_update) {
 		m_just_fully_optimized_graph = true;
@@ -750,6 +751,10 @@ void CLevMarqGSO<GRAPH_T>::OptimizationParams::loadFromConfigFile(
 			section,
 			"tau",
 			1e-3, false);
+	cfg["num_threads"] = source.read_int(
+			section,
+			"num_threads",
+			1, false);
 
 	MRPT_END;
 }
@@ -59,6 +59,8 @@ void TUserOptionsChecker<GRAPH_t>::createDeciderOptimizerMappings() {
 		&createGraphSlamOptimizer<CLevMarqGSO<GRAPH_t> >;
 	optimizers_map["CEmptyGSO"] =
 		&createGraphSlamOptimizer<CLevMarqGSO<GRAPH_t> >;
+	optimizers_map["CIncrementalGSO"] =
+		&createGraphSlamOptimizer<CIncrementalGSO<GRAPH_t> >;
 
 	// create the decider optimizer, specific to the GRAPH_T template type
 	this->_createDeciderOptimizerMappings();
@@ -362,6 +364,17 @@ void TUserOptionsChecker<GRAPH_t>::populateDeciderOptimizerProperties() {
 		optimizers_descriptions.push_back(opt);
 	}
 
+	{ // CIncrementalGSO
+		TOptimizerProps* opt = new TOptimizerProps;
+		opt->name = "CIncrementalGSO";
+		opt->description = "Incremental (iSAM-style) non-linear graphSLAM solver, with partial refactorization and relinearization";
+		opt->is_mr_slam_class = false;
+		opt->is_slam_2d = true;
+		opt->is_slam_3d = true;
+
+		optimizers_descriptions.push_back(opt);
+	}
+
 	MRPT_END
 }
 
@@ -68,6 +68,19 @@ class CGraphSlamOptimizer :
      * on the latest optimizer run
      */
     virtual bool justFullyOptimizedGraph() const {return false;}
+    /**\brief Used by the caller to query whether the optimizer keeps the
+     * estimates of all the graph nodes up to date by itself, in which case
+     * they are not re-estimated from the edges (Dijkstra) after each node
+     * registration
+     */
+    virtual bool maintainsNodeEstimates() const {return false;}
+    /**\brief Called by CGraphSlamEngine before updateState() with the node
+     * pairs of the edges that the registration deciders inserted in the graph
+     * (see CRegistrationDeciderOrOptimizer::getInsertedEdges). Optimizers may
+     * use them to avoid looking for the new edges in the whole graph.
+     */
+    virtual void notifyOfNewEdges(
+    		const std::vector<mrpt::utils::TPairNodeIDs>& new_edges) {}
 
 	protected:
 		/**\brief method called for optimizing the underlying graph.
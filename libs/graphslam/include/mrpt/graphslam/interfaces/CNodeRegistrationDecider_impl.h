@@ -88,7 +88,7 @@ bool CNodeRegistrationDecider<GRAPH_T>::registerNewNodeAtEnd(
 				mrpt::format(
 					"nodeID \"%lu\" with pose \"%s\" seems to be already registered.",
 					to, tmp_pose.asString().c_str()));
-		this->m_graph->insertEdgeAtEnd(from, to, constraint);
+		this->insertEdgeInGraph(from, to, constraint, /*at_end=*/ true);
 	}
 
 	m_prev_registered_nodeID = to;
@@ -21,6 +21,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 namespace mrpt { namespace graphslam {
 
@@ -137,7 +138,29 @@ class CRegistrationDeciderOrOptimizer :
 
 		std::string getClassName() const { return m_class_name; };
 
+		/**\brief Node pairs of the edges inserted in the graph with
+		 * insertEdgeInGraph() since the last call to clearInsertedEdges().
+		 *
+		 * CGraphSlamEngine passes them to the optimizer, so that it does not have
+		 * to look for the new edges in the whole graph.
+		 */
+		const std::vector<mrpt::utils::TPairNodeIDs>& getInsertedEdges() const {
+			return m_inserted_edges;
+		}
+		void clearInsertedEdges() { m_inserted_edges.clear(); }
+
 	protected:
+		/**\brief Insert an edge in the graph and keep track of it (see
+		 * getInsertedEdges)
+		 *
+		 * \param[in] at_end Use GRAPH_T::insertEdgeAtEnd instead of
+		 * GRAPH_T::insertEdge
+		 */
+		void insertEdgeInGraph(
+				const mrpt::utils::TNodeID from,
+				const mrpt::utils::TNodeID to,
+				const typename GRAPH_T::constraint_t& rel_edge,
+				const bool at_end=false);
 		/**\brief Handy function for making all the visuals assertions in a
 		 * compact manner
 		 */
@@ -174,6 +197,9 @@ class CRegistrationDeciderOrOptimizer :
 		 */
 		static const std::string header_sep;
 		static const std::string report_sep;
+
+	private:
+		std::vector<mrpt::utils::TPairNodeIDs> m_inserted_edges;
 };
 
 } } // end of namespaces
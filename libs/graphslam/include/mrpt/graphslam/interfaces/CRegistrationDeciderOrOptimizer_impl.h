@@ -128,6 +128,23 @@ void CRegistrationDeciderOrOptimizer<GRAPH_T>::setGraphPtr(GRAPH_T* graph) {
 	MRPT_LOG_DEBUG_STREAM("Fetched the graph pointer successfully");
 }
 
+template<class GRAPH_T>
+void CRegistrationDeciderOrOptimizer<GRAPH_T>::insertEdgeInGraph(
+		const mrpt::utils::TNodeID from,
+		const mrpt::utils::TNodeID to,
+		const typename GRAPH_T::constraint_t& rel_edge,
+		const bool at_end/*=false*/) {
+	ASSERT_(m_graph);
+
+	if (at_end) {
+		m_graph->insertEdgeAtEnd(from, to, rel_edge);
+	}
+	else {
+		m_graph->insertEdge(from, to, rel_edge);
+	}
+	m_inserted_edges.push_back(mrpt::utils::TPairNodeIDs(from, to));
+}
+
 template<class GRAPH_T>
 bool CRegistrationDeciderOrOptimizer<GRAPH_T>::isMultiRobotSlamClass() {
 	return is_mr_slam_class;
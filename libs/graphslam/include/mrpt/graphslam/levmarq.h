@@ -35,6 +35,7 @@ namespace mrpt
 		  * \param[in] nodes_to_optimize The list of nodes whose global poses are to be optimized. If NULL (default), all the node IDs are optimized (but that marked as \a root in the graph).
 		  * \param[in] extra_params Optional parameters, see below.
 		  * \param[in] functor_feedback Optional: a pointer to a user function can be set here to be called on each LM loop iteration (eg to refresh the current state and error, refresh a GUI, etc.)
+		  * \param[in,out] solver_cache Optional: keep one of these objects alive between successive calls to reuse the sparse Cholesky symbolic analysis (while the graph structure does not change) and the worker threads. See TSpaLevMarqSolverCache.
 		  *
 		  * List of optional parameters by name in "extra_params":
 		  *		- "verbose": (default=0) If !=0, produce verbose ouput.
@@ -44,6 +45,10 @@ namespace mrpt
 		  *		- "tau": (default=1e-3) Initial tau value for the lev-marq algorithm.
 		  *		- "e1": (default=1e-6) Lev-marq algorithm iteration stopping criterion #1: |gradient| < e1
 		  *		- "e2": (default=1e-6) Lev-marq algorithm iteration stopping criterion #2: |delta_incr| < e2*(x_norm+e2)
+		  *		- "num_threads": (default=1) Number of threads for evaluating the Jacobians and errors of all constraints (0=as many as CPU cores). (New in MRPT 1.5.0)
+		  *
+		  * The sparse Cholesky factorization of the Hessian computes its symbolic analysis (with an AMD fill-reducing ordering) only once, and then only refactorizes
+		  * it numerically in successive iterations. Pass a \a solver_cache to also reuse it among calls on a graph with the same structure.
 		  *
 		  * \note The following graph types are supported: mrpt::graphs::CNetworkOfPoses2D, mrpt::graphs::CNetworkOfPoses3D, mrpt::graphs::CNetworkOfPoses2DInf, mrpt::graphs::CNetworkOfPoses3DInf
 		  *
@@ -58,7 +63,8 @@ namespace mrpt
 			TResultInfoSpaLevMarq                                        & out_info,
 			const std::set<mrpt::utils::TNodeID>            * in_nodes_to_optimize = NULL,
 			const mrpt::utils::TParametersDouble            & extra_params = mrpt::utils::TParametersDouble(),
-			typename graphslam_traits<GRAPH_T>::TFunctorFeedback  functor_feedback = NULL
+			typename graphslam_traits<GRAPH_T>::TFunctorFeedback  functor_feedback = NULL,
+			TSpaLevMarqSolverCache                         * solver_cache = NULL
 			)
 		{
 			using namespace mrpt;
@@ -89,6 +95,7 @@ namespace mrpt
 			const double e2 = extra_params.getWithDefaultVal("e2",1e-6);
 
 			const double SCALE_HESSIAN = extra_params.getWithDefaultVal("scale_hessian",1);
+			const unsigned int num_threads = static_cast<unsigned int>(extra_params.getWithDefaultVal("num_threads",1));
 
 
 			mrpt::utils::CTimeLogger  profiler(enable_profiler);
@@ -166,13 +173,11 @@ namespace mrpt
 			const size_t nObservations = lstObservationData.size();
 			ASSERT_ABOVE_(nObservations,0)
 
-			// Cholesky object, as a pointer to reuse it between iterations:
-#if MRPT_HAS_CXX11
-			typedef std::unique_ptr<CSparseMatrix::CholeskyDecomp> SparseCholeskyDecompPtr;
-#else
-			typedef std::auto_ptr<CSparseMatrix::CholeskyDecomp> SparseCholeskyDecompPtr;
-#endif
-			SparseCholeskyDecompPtr ptrCh;
+			// Cholesky object and worker threads, to reuse them between iterations (and between calls, if the user provided a cache):
+			TSpaLevMarqSolverCache  local_cache;
+			TSpaLevMarqSolverCache &cache = solver_cache ? *solver_cache : local_cache;
+			cache.threads.resize(num_threads);
+			mrpt::system::CWorkerThreadsPool *threads = cache.threads.size()>1 ? &cache.threads : NULL;
 
 			// The list of Jacobians: for each constraint i->j,
 			//  we need the pair of Jacobians: { dh(xi,xj)_dxi, dh(xi,xj)_dxj },
@@ -188,7 +193,7 @@ namespace mrpt
 			profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");// ------------------------------\  .
 			double total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
 				graph, lstObservationData,
-				lstJacobians, errs);
+				lstJacobians, errs, threads);
 			profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");  // ------------------------------/
 
 
@@ -440,13 +445,18 @@ namespace mrpt
 				try
 				{
 					profiler.enter("optimize_graph_spa_levmarq.sp_H:chol");
-					if (!ptrCh.get())
-							ptrCh = SparseCholeskyDecompPtr(new CSparseMatrix::CholeskyDecomp(sp_H) );
-					else ptrCh.get()->update(sp_H);
+					// Only do the symbolic analysis (AMD ordering) if the structure of H changed:
+					if (cache.chol && cache.chol->hasSameStructure(sp_H))
+							cache.chol->update(sp_H);
+					else
+					{
+						cache.clear();
+						cache.chol = new CSparseMatrix::CholeskyDecomp(sp_H);
+					}
 					profiler.leave("optimize_graph_spa_levmarq.sp_H:chol");
 
 					profiler.enter("optimize_graph_spa_levmarq.sp_H:backsub");
-					ptrCh->backsub(grad,delta);
+					cache.chol->backsub(grad,delta);
 					profiler.leave("optimize_graph_spa_levmarq.sp_H:backsub");
 				}
 				catch (CExceptionNotDefPos &)
@@ -526,7 +536,7 @@ namespace mrpt
 					profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");// ------------------------------\  .
 					double new_total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
 						graph, lstObservationData,
-						new_lstJacobians, new_errs);
+						new_lstJacobians, new_errs, threads);
 					profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");// ------------------------------/
 
 					// Now, to decide whether to accept the change:
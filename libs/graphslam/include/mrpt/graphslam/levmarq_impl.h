@@ -12,6 +12,7 @@
 #include <mrpt/graphs/CNetworkOfPoses.h>
 #include <mrpt/utils/CTimeLogger.h>
 #include <mrpt/math/CSparseMatrix.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 
 #include <memory>
 
@@ -144,33 +145,18 @@ namespace mrpt
 
 		} // end NS detail
 
-		// Compute, at once, jacobians and the error vectors for each constraint in "lstObservationData", returns the overall squared error.
-		template <class GRAPH_T>
-		double computeJacobiansAndErrors(
-			const GRAPH_T &graph,
-			const std::vector<typename graphslam_traits<GRAPH_T>::observation_info_t>  &lstObservationData,
-			typename graphslam_traits<GRAPH_T>::map_pairIDs_pairJacobs_t   &lstJacobians,
-			typename mrpt::aligned_containers<typename graphslam_traits<GRAPH_T>::Array_O>::vector_t &errs
-			)
+		namespace detail
 		{
-			MRPT_UNUSED_PARAM(graph);
-			typedef graphslam_traits<GRAPH_T> gst;
-
-			lstJacobians.clear();
-			errs.clear();
-
-			const size_t nObservations = lstObservationData.size();
-
-			for (size_t i=0;i<nObservations;i++)
+			// Evaluates the Jacobians and the error vector of one constraint:
+			template <class gst>
+			inline void computeJacobianAndError(
+				const typename gst::observation_info_t & obs,
+				typename gst::TPairJacobs &jacobs,
+				typename gst::Array_O &err)
 			{
-				const typename gst::observation_info_t & obs = lstObservationData[i];
-				typename gst::edge_const_iterator it = obs.edge;
 				const typename gst::graph_t::constraint_t::type_value* EDGE_POSE = obs.edge_mean;
-				typename gst::graph_t::constraint_t::type_value* P1 = obs.P1;
-				typename gst::graph_t::constraint_t::type_value* P2 = obs.P2;
-
-				const mrpt::utils::TPairNodeIDs                   &ids  = it->first;
-				const typename gst::graph_t::edge_t  &edge = it->second;
+				const typename gst::graph_t::constraint_t::type_value* P1 = obs.P1;
+				const typename gst::graph_t::constraint_t::type_value* P2 = obs.P2;
 
 				// Compute the residual pose error of these pair of nodes + its constraint,
 				//  that is: P1DP2inv = P1 * EDGE * inv(P2)
@@ -182,16 +168,66 @@ namespace mrpt
 					P1DP2inv.composeFrom(P1D,P2inv);
 				}
 
-				// Add to vector of errors:
-				errs.resize(errs.size()+1);
-				detail::AuxErrorEval<typename gst::edge_t,gst>::computePseudoLnError(P1DP2inv, errs.back(),edge);
+				AuxErrorEval<typename gst::edge_t,gst>::computePseudoLnError(P1DP2inv, err, obs.edge->second);
 
 				// Compute the jacobians:
-				MRPT_ALIGN16 std::pair<mrpt::utils::TPairNodeIDs,typename gst::TPairJacobs> newMapEntry;
-				newMapEntry.first = ids;
-				gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(P1DP2inv, &newMapEntry.second.first,&newMapEntry.second.second);
+				gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(P1DP2inv, &jacobs.first,&jacobs.second);
+			}
 
-				// And insert into map of jacobians:
+			// Evaluates the Jacobians and errors of a range of constraints, each one into its own output slot:
+			template <class gst>
+			struct TJacobiansAndErrorsTask : public mrpt::system::CWorkerThreadsPool::TRangeTask
+			{
+				typedef typename mrpt::aligned_containers<typename gst::TPairJacobs>::vector_t  jacobs_vector_t;
+				typedef typename mrpt::aligned_containers<typename gst::Array_O>::vector_t      errs_vector_t;
+
+				TJacobiansAndErrorsTask(const std::vector<typename gst::observation_info_t> &obs_, jacobs_vector_t &jacobs_, errs_vector_t &errs_) :
+					obs(obs_), jacobs(jacobs_), errs(errs_)
+				{ }
+
+				const std::vector<typename gst::observation_info_t> &obs;
+				jacobs_vector_t &jacobs;
+				errs_vector_t   &errs;
+
+				void operator()(size_t first, size_t last) const MRPT_OVERRIDE
+				{
+					for (size_t i=first;i<last;i++)
+						computeJacobianAndError<gst>(obs[i],jacobs[i],errs[i]);
+				}
+			};
+		} // end NS detail
+
+		/** Compute, at once, jacobians and the error vectors for each constraint in "lstObservationData", returns the overall squared error.
+		  * If \a threads is provided, constraints are evaluated in parallel; results are identical to the single-threaded evaluation. */
+		template <class GRAPH_T>
+		double computeJacobiansAndErrors(
+			const GRAPH_T &graph,
+			const std::vector<typename graphslam_traits<GRAPH_T>::observation_info_t>  &lstObservationData,
+			typename graphslam_traits<GRAPH_T>::map_pairIDs_pairJacobs_t   &lstJacobians,
+			typename mrpt::aligned_containers<typename graphslam_traits<GRAPH_T>::Array_O>::vector_t &errs,
+			mrpt::system::CWorkerThreadsPool *threads = NULL
+			)
+		{
+			MRPT_UNUSED_PARAM(graph);
+			typedef graphslam_traits<GRAPH_T> gst;
+
+			const size_t nObservations = lstObservationData.size();
+
+			lstJacobians.clear();
+			errs.resize(nObservations);
+
+			typename detail::TJacobiansAndErrorsTask<gst>::jacobs_vector_t jacobs(nObservations);
+			const detail::TJacobiansAndErrorsTask<gst> task(lstObservationData, jacobs, errs);
+			if (threads)
+				threads->parallel_for(nObservations, task, 256);
+			else task(0,nObservations);
+
+			// And insert into map of jacobians (in the same order than observations, which is the ordering of the map):
+			for (size_t i=0;i<nObservations;i++)
+			{
+				MRPT_ALIGN16 std::pair<mrpt::utils::TPairNodeIDs,typename gst::TPairJacobs> newMapEntry;
+				newMapEntry.first = lstObservationData[i].edge->first;
+				newMapEntry.second = jacobs[i];
 				lstJacobians.insert(lstJacobians.end(),newMapEntry );
 			}
 
@@ -11,6 +11,8 @@
 
 #include <mrpt/graphs/CNetworkOfPoses.h>
 #include <mrpt/poses/SE_traits.h>
+#include <mrpt/math/CSparseMatrix.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 
 namespace mrpt
 {
@@ -61,6 +63,29 @@ namespace mrpt
 			double  final_total_sq_error;  //!< The sum of all the squared errors for every constraint involved in the problem.
 		};
 
+		/** Optional solver state which can be kept between successive calls to mrpt::graphslam::optimize_graph_spa_levmarq() to speed them up:
+		  *  - The symbolic analysis (AMD fill-reducing ordering and elimination tree) of the sparse Cholesky factorization of the Hessian,
+		  *    which is reused as long as the Hessian keeps the same sparse structure (i.e. the same free nodes and the same edges among them).
+		  *    Otherwise, it is automatically recomputed.
+		  *  - The pool of worker threads used to evaluate Jacobians and errors (see the "num_threads" parameter).
+		  *
+		  * Copying an object of this class does not copy the cached factorization.
+		  * \note (New in MRPT 1.5.0)
+		  */
+		struct TSpaLevMarqSolverCache
+		{
+			mrpt::math::CSparseMatrix::CholeskyDecomp *chol; //!< The last Cholesky factorization (NULL if none)
+			mrpt::system::CWorkerThreadsPool           threads; //!< Worker threads
+
+			TSpaLevMarqSolverCache() : chol(NULL) { }
+			TSpaLevMarqSolverCache(const TSpaLevMarqSolverCache &o) : chol(NULL), threads(o.threads) { }
+			TSpaLevMarqSolverCache & operator =(const TSpaLevMarqSolverCache &o) { if (this!=&o) { clear(); threads.resize(o.threads.size()); } return *this; }
+			~TSpaLevMarqSolverCache() { clear(); }
+
+			/** Discards the cached factorization */
+			void clear() { delete chol; chol = NULL; }
+		};
+
 	/**  @} */  // end of grouping
 
 	} // End of namespace
@@ -0,0 +1,110 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/graphslam/CGraphSlamEngine.h>
+#include <mrpt/graphslam/NRD/CFixedIntervalsNRD.h>
+#include <mrpt/graphslam/interfaces/CEdgeRegistrationDecider.h>
+#include <mrpt/graphslam/GSO/CIncrementalGSO.h>
+#include <mrpt/obs/CObservationOdometry.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+#include <fstream>
+
+using namespace mrpt;
+using namespace mrpt::graphs;
+using namespace mrpt::graphslam;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::utils;
+using namespace std;
+
+typedef CNetworkOfPoses2DInf graph_t;
+
+static const TNodeID TEST_LOOP_NODE = 10;
+
+// Registers a single edge from the root to node TEST_LOOP_NODE, which disagrees with the odometry
+template<class GRAPH_T>
+class CTestLoopClosureERD : public mrpt::graphslam::deciders::CEdgeRegistrationDecider<GRAPH_T>
+{
+public:
+	CTestLoopClosureERD() : m_done(false) { }
+
+	bool updateState(CActionCollectionPtr action, CSensoryFramePtr observations, CObservationPtr observation)
+	{
+		MRPT_UNUSED_PARAM(action); MRPT_UNUSED_PARAM(observations); MRPT_UNUSED_PARAM(observation);
+		if (m_done || this->m_graph->nodeCount()<=TEST_LOOP_NODE)
+			return false;
+		typename GRAPH_T::constraint_t c;
+		c.mean = CPose2D(TEST_LOOP_NODE*1.0, 0.5, 0);
+		c.cov_inv.unit();
+		c.cov_inv *= 10000;
+		this->m_graph->insertEdge(this->m_graph->root, TEST_LOOP_NODE, c);
+		m_done = true;
+		return true;
+	}
+private:
+	bool m_done;
+};
+
+static double totalSquaredError(const graph_t &graph)
+{
+	double err = 0;
+	for (graph_t::const_iterator it=graph.edges.begin();it!=graph.edges.end();++it)
+	{
+		const CPose2D P = graph.nodes.find(it->first.first)->second + it->second.getPoseMean();
+		const CPose2D E = P - graph.nodes.find(it->first.second)->second;
+		err += mrpt::utils::square(E.x())+mrpt::utils::square(E.y())+mrpt::utils::square(E.phi());
+	}
+	return err;
+}
+
+// The engine must not overwrite the estimates of an incremental optimizer with its Dijkstra pass:
+TEST(CGraphSlamEngine, keepsIncrementalOptimizerEstimates)
+{
+	const string cfg_file = mrpt::system::getTempFileName();
+	{
+		ofstream f(cfg_file.c_str());
+		f << "[GeneralConfiguration]\nclass_verbosity=3\n"
+			"[NodeRegistrationDeciderParameters]\nclass_verbosity=3\nregistration_max_distance=0.5\n"
+			"[OptimizerParameters]\nclass_verbosity=3\n";
+	}
+
+	deciders::CFixedIntervalsNRD<graph_t> nrd;
+	CTestLoopClosureERD<graph_t> erd;
+	optimizers::CIncrementalGSO<graph_t> gso;
+	{
+		CGraphSlamEngine<graph_t> engine(cfg_file, "", "", NULL, &nrd, &erd, &gso);
+		engine.setMinLoggingLevel(LVL_ERROR);
+
+		// Straight odometry, one node per reading:
+		const size_t N = 16;
+		for (size_t i=0;i<N;i++)
+		{
+			CObservationOdometryPtr obs = CObservationOdometry::Create();
+			obs->timestamp = mrpt::system::time_tToTimestamp(1000.0+i);
+			obs->odometry = CPose2D(i*1.0, 0, 0);
+			CObservationPtr o = obs;
+			size_t rawlog_entry = i;
+			engine.execGraphSlamStep(o, rawlog_entry);
+		}
+
+		const graph_t &graph = engine.getGraph();
+		ASSERT_GT(graph.nodeCount(), TEST_LOOP_NODE+1);
+		EXPECT_EQ(gso.getVariableCount(), graph.nodeCount()-1);
+
+		// What the nodes would be after a Dijkstra projection of the edges:
+		graph_t dijkstra_graph = graph;
+		dijkstra_graph.dijkstra_nodes_estimate();
+
+		// The optimizer spreads the loop closure error along the whole path:
+		EXPECT_LT(totalSquaredError(graph), 0.5*totalSquaredError(dijkstra_graph));
+		EXPECT_GT(graph.nodes.find(TEST_LOOP_NODE/2)->second.y(), 0.1);
+	}
+	mrpt::system::deleteFile(cfg_file);
+}
@@ -0,0 +1,131 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+
+#include "graph_slam_levmarq_test_common.h"
+#include <mrpt/graphslam/GSO/CIncrementalGSO.h>
+
+#include <gtest/gtest.h>
+
+using mrpt::graphslam::optimizers::CIncrementalGSO;
+
+template <class my_graph_t>
+class IncrementalGSOTester : public GraphSlamLevMarqTest<my_graph_t>, public ::testing::Test
+{
+protected:
+	static double totalSquaredError(const my_graph_t &graph)
+	{
+		typedef mrpt::graphslam::graphslam_traits<my_graph_t> gst;
+		double err = 0;
+		for (typename my_graph_t::const_iterator it=graph.edges.begin();it!=graph.edges.end();++it)
+		{
+			const typename gst::edge_poses_type P = graph.nodes.find(it->first.first)->second + it->second.getPoseMean();
+			const typename gst::edge_poses_type E = P - graph.nodes.find(it->first.second)->second;
+			typename gst::Array_O e;
+			gst::SE_TYPE::pseudo_ln(E, e);
+			err += e.squaredNorm();
+		}
+		return err;
+	}
+
+	void test_ring_path()
+	{
+		// The whole (noisy) input graph:
+		my_graph_t full;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(full);
+
+		// Feed it node by node, as graphslam-engine would do:
+		my_graph_t graph;
+		graph.root = full.root;
+		CIncrementalGSO<my_graph_t> gso;
+		gso.setMinLoggingLevel(mrpt::utils::LVL_ERROR);
+		gso.opt_params.relinearize_threshold = 1e-4;
+		gso.setGraphPtr(&graph);
+
+		for (typename my_graph_t::global_poses_t::const_iterator itN=full.nodes.begin();itN!=full.nodes.end();++itN)
+		{
+			graph.nodes[itN->first] = itN->second;
+			for (typename my_graph_t::const_iterator itE=full.edges.begin();itE!=full.edges.end();++itE)
+				if (std::max(itE->first.first,itE->first.second)==itN->first)
+					graph.insertEdge(itE->first.first,itE->first.second,itE->second);
+			gso.updateState(mrpt::obs::CActionCollectionPtr(),mrpt::obs::CSensoryFramePtr(),mrpt::obs::CObservationPtr());
+		}
+		EXPECT_EQ(gso.getVariableCount(), full.nodes.size()-1);
+
+		// Let it converge:
+		for (int i=0;i<50;i++)
+			if (!gso.updateState(mrpt::obs::CActionCollectionPtr(),mrpt::obs::CSensoryFramePtr(),mrpt::obs::CObservationPtr()))
+				break;
+
+		EXPECT_LE(totalSquaredError(graph), 1e-2);
+	}
+
+	void test_constant_cost_chain()
+	{
+		// Odometry-only chain: each step must only refactorize the last two variables,
+		// and only visit the new edge when it is notified as CGraphSlamEngine does.
+		my_graph_t graph;
+		graph.root = 0;
+		graph.nodes[0] = typename my_graph_t::global_pose_t();
+		CIncrementalGSO<my_graph_t> gso;
+		gso.setMinLoggingLevel(mrpt::utils::LVL_ERROR);
+		gso.setGraphPtr(&graph);
+
+		const typename my_graph_t::edge_t odo(typename my_graph_t::edge_t::type_value(CPose3D(1.0,0,0,DEG2RAD(10.0),0,0)));
+		for (TNodeID i=1;i<200;i++)
+		{
+			graph.nodes[i] = graph.nodes[i-1] + odo.getPoseMean();
+			graph.insertEdge(i-1,i,odo);
+			gso.notifyOfNewEdges(std::vector<TPairNodeIDs>(1, TPairNodeIDs(i-1,i)));
+			EXPECT_TRUE(gso.updateState(mrpt::obs::CActionCollectionPtr(),mrpt::obs::CSensoryFramePtr(),mrpt::obs::CObservationPtr()));
+			EXPECT_LE(gso.getLastRefactorizedCount(), 2U);
+			EXPECT_EQ(gso.getLastVisitedEdgeCount(), 1U);
+		}
+		EXPECT_LE(totalSquaredError(graph), 1e-12);
+
+		// Edges which were not notified are still found, visiting the whole graph:
+		const TNodeID n = graph.nodes.rbegin()->first;
+		graph.nodes[n+1] = graph.nodes[n] + odo.getPoseMean();
+		graph.insertEdge(n,n+1,odo);
+		graph.insertEdge(0,n+1,typename my_graph_t::edge_t(graph.nodes[n+1]));
+		gso.notifyOfNewEdges(std::vector<TPairNodeIDs>(1, TPairNodeIDs(n,n+1)));
+		EXPECT_TRUE(gso.updateState(mrpt::obs::CActionCollectionPtr(),mrpt::obs::CSensoryFramePtr(),mrpt::obs::CObservationPtr()));
+		EXPECT_EQ(gso.getLastVisitedEdgeCount(), graph.edges.size());
+		EXPECT_EQ(gso.getVariableCount(), graph.nodes.size()-1);
+		EXPECT_LE(totalSquaredError(graph), 1e-12);
+	}
+};
+
+typedef IncrementalGSOTester<CNetworkOfPoses2D> IncrementalGSOTester2D;
+typedef IncrementalGSOTester<CNetworkOfPoses3D> IncrementalGSOTester3D;
+
+TEST_F(IncrementalGSOTester2D, OptimizeSampleRingPath)
+{
+	for (int seed=1;seed<5;seed++)
+	{
+		randomGenerator.randomize(seed);
+		test_ring_path();
+	}
+}
+TEST_F(IncrementalGSOTester2D, ConstantCostChain)
+{
+	test_constant_cost_chain();
+}
+TEST_F(IncrementalGSOTester3D, OptimizeSampleRingPath)
+{
+	for (int seed=1;seed<5;seed++)
+	{
+		randomGenerator.randomize(seed);
+		test_ring_path();
+	}
+}
+TEST_F(IncrementalGSOTester3D, ConstantCostChain)
+{
+	test_constant_cost_chain();
+}
@@ -60,6 +60,33 @@ protected:
 
 	} // end test_ring_path
 
+	void test_ring_path_threads_and_cache()
+	{
+		my_graph_t graph;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(graph);
+		my_graph_t graph_mt = graph;
+
+		TParametersDouble  params;
+		params["max_iterations"] = 1000;
+
+		graphslam::TResultInfoSpaLevMarq  info, info_mt;
+		graphslam::optimize_graph_spa_levmarq(graph, info, NULL, params);
+
+		// Multithreaded Jacobians + cached solver must give exactly the same results:
+		params["num_threads"] = 3;
+		graphslam::TSpaLevMarqSolverCache cache;
+		graphslam::optimize_graph_spa_levmarq(graph_mt, info_mt, NULL, params, NULL, &cache);
+		EXPECT_EQ(info.num_iters, info_mt.num_iters);
+		EXPECT_EQ(info.final_total_sq_error, info_mt.final_total_sq_error);
+		ASSERT_TRUE(cache.chol!=NULL);
+
+		// Re-run on the already optimized graph, reusing the symbolic analysis:
+		const mrpt::math::CSparseMatrix::CholeskyDecomp *prev_chol = cache.chol;
+		graphslam::optimize_graph_spa_levmarq(graph_mt, info_mt, NULL, params, NULL, &cache);
+		EXPECT_TRUE(cache.chol==prev_chol);
+		EXPECT_LE(info_mt.final_total_sq_error, info.final_total_sq_error);
+	}
+
 	void test_graph_bin_serialization()
 	{
 		my_graph_t graph;
@@ -101,6 +128,11 @@ TEST_F(GraphSlamLevMarqTester2D, OptimizeSampleRingPath)
 		test_ring_path();
 	}
 }
+TEST_F(GraphSlamLevMarqTester2D, ThreadsAndSolverCache)
+{
+	randomGenerator.randomize(1);
+	test_ring_path_threads_and_cache();
+}
 TEST_F(GraphSlamLevMarqTester2D, BinarySerialization)
 {
 	randomGenerator.randomize(123);
@@ -115,6 +147,11 @@ TEST_F(GraphSlamLevMarqTester3D, OptimizeSampleRingPath)
 		test_ring_path();
 	}
 }
+TEST_F(GraphSlamLevMarqTester3D, ThreadsAndSolverCache)
+{
+	randomGenerator.randomize(1);
+	test_ring_path_threads_and_cache();
+}
 TEST_F(GraphSlamLevMarqTester3D, BinarySerialization)
 {
 	randomGenerator.randomize(123);
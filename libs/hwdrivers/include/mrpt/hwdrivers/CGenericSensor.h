@@ -14,6 +14,7 @@
 #include <mrpt/utils/CUncopiable.h>
 #include <mrpt/obs/CObservation.h>
 #include <mrpt/synch/CCriticalSection.h>
+#include <mrpt/hwdrivers/CObservationsChannel.h>
 #include <mrpt/system/threads.h>
 #include <map>
 
@@ -46,6 +47,8 @@ namespace mrpt
 		  *		- CGenericSensor::loadConfig: The following parameters are common to all sensors in rawlog-grabber (they are automatically loaded by rawlog-grabber) - see each class documentation for additional parameters:
 		  *			- "process_rate": (Mandatory) The rate in Hertz (Hz) at which the sensor thread should invoke "doProcess".
 		  *			- "max_queue_len": (Optional) The maximum number of objects in the observations queue (default is 200). If overflow occurs, an error message will be issued at run-time.
+		  *			  New objects are dropped while the queue is full: waiting for room would never succeed, since doProcess() and getObservations() are normally called from the same thread.
+		  *			  Applications with a grabbing thread per sensor (like rawlog-grabber) may add backpressure in their own queues (see CObservationsChannel).
 		  *			- "grab_decimation": (Optional) Grab only 1 out of N observations captured by the sensor (default is 1, i.e. do not decimate).
 		  *		- CGenericSensor::initialize
 		  *		- CGenericSensor::doProcess
@@ -101,8 +104,7 @@ namespace mrpt
 			static void registerClass(const TSensorClassId* pNewClass);
 
 		private:
-			synch::CCriticalSection			m_csObjList;		//!< The critical section for m_objList
-			TListObservations				m_objList;		//!< The queue of objects to be returned by getObservations
+			CObservationsChannel			m_objList;		//!< The (lock-free) queue of objects to be returned by getObservations
 
 			/** Used in registerClass */
 			typedef std::map< std::string , const TSensorClassId *> registered_sensor_classes_t;
@@ -205,10 +207,14 @@ namespace mrpt
 			  */
 			virtual void doProcess() = 0;
 
-			/** Returns a list of enqueued objects, emptying it (thread-safe). The objects must be freed by the invoker.
+			/** Returns a list of enqueued objects, emptying it. The objects must be freed by the invoker.
+			  * This method is thread-safe with respect to the sensor threads appending new observations, but it must not be called from several threads at once.
 			  */
 			void getObservations( TListObservations		&lstObjects );
 
+			/** Returns the counters of queued and dropped objects, and the latency of the observations queue (see "max_queue_len") \note (New in MRPT 1.5.0) */
+			void getObservationsQueueStats( CObservationsChannel::TStats &out_stats ) const { m_objList.getStats(out_stats); }
+
 			/**  Set the path where to save off-rawlog image files (will be ignored in those sensors where this is not applicable).
 			  *  An  empty string (the default value at construction) means to save images embedded in the rawlog, instead of on separate files.
 			  * \exception std::exception If the directory doesn't exists and cannot be created.
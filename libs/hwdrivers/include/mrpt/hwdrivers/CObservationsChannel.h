@@ -0,0 +1,97 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CObservationsChannel_H
+#define CObservationsChannel_H
+
+#include <mrpt/utils/CSerializable.h>
+#include <mrpt/utils/CUncopiable.h>
+#include <mrpt/system/datetime.h>
+#include <mrpt/hwdrivers/link_pragmas.h>
+#include <map>
+
+namespace mrpt
+{
+	namespace hwdrivers
+	{
+		namespace detail { struct TObservationsChannelImpl; }
+
+		/** A bounded, lock-free, multiple-producer single-consumer (MPSC) queue of timestamped objects (observations or actions),
+		  * used to move data from the threads of sensors to the thread which processes them (e.g. rawlog-grabber) without lock contention.
+		  *
+		  * Any number of threads may call push() simultaneously, but only one thread at a time may call pop() or popAll().
+		  * Objects are popped in the same order in which they were pushed (FIFO), so the order of objects from one producer is preserved.
+		  *
+		  * The capacity is fixed (rounded up to a power of 2). When the queue is full, push() follows the overflow policy set at construction:
+		  *  - opDrop: The new object is discarded immediately.
+		  *  - opBlock: Backpressure. The producer waits for room in the queue, up to a given timeout, after which the object is discarded.
+		  *
+		  * Counters of pushed and dropped objects, and of the time objects spent in the queue (latency), are available through getStats().
+		  *
+		  * \note (New in MRPT 1.5.0)
+		  * \sa CObservationsMerger, CGenericSensor
+		  * \ingroup mrpt_hwdrivers_grp
+		  */
+		class HWDRIVERS_IMPEXP CObservationsChannel : public mrpt::utils::CUncopiable
+		{
+		public:
+			/** What to do when push() finds the queue full */
+			enum TOverflowPolicy
+			{
+				opDrop = 0,
+				opBlock
+			};
+
+			/** Statistics of a channel, see getStats() */
+			struct HWDRIVERS_IMPEXP TStats
+			{
+				uint64_t num_pushed;   //!< Number of objects successfully queued
+				uint64_t num_dropped;  //!< Number of objects discarded because the queue was full
+				uint64_t num_popped;   //!< Number of objects taken out of the queue
+				double   latency_mean; //!< Average time (seconds) from push() to pop() of objects
+				double   latency_max;  //!< Maximum time (seconds) from push() to pop() of objects
+				TStats();
+			};
+
+			/** Constructor \param[in] capacity The maximum number of objects in the queue (rounded up to a power of 2) \param[in] block_timeout_ms For opBlock, maximum time to wait for room in the queue */
+			explicit CObservationsChannel(size_t capacity = 256, TOverflowPolicy policy = opDrop, unsigned int block_timeout_ms = 1000);
+			~CObservationsChannel();
+
+			/** Changes the capacity and overflow policy, discarding all queued objects. Not thread-safe: it must not be called while other threads use the queue. */
+			void reset(size_t capacity, TOverflowPolicy policy = opDrop, unsigned int block_timeout_ms = 1000);
+
+			size_t getCapacity() const;
+			TOverflowPolicy getOverflowPolicy() const;
+
+			/** Queues an object (thread-safe, lock-free). \return false if the object was dropped because the queue is full. */
+			bool push(const mrpt::system::TTimeStamp timestamp, const mrpt::utils::CSerializablePtr &obj);
+
+			/** Takes the oldest object out of the queue. Only one thread at a time may call this method.
+			  * \return false if the queue is empty. */
+			bool pop(mrpt::system::TTimeStamp &out_timestamp, mrpt::utils::CSerializablePtr &out_obj);
+
+			/** Takes all the objects out of the queue and inserts them into a timestamp-sorted list. Only one thread at a time may call this method.
+			  * \return The number of popped objects */
+			size_t popAll(std::multimap<mrpt::system::TTimeStamp, mrpt::utils::CSerializablePtr> &out_objs);
+
+			/** Returns an estimate of the number of objects in the queue (exact if there are no concurrent calls to push() or pop()) */
+			size_t size() const;
+			bool empty() const { return size()==0; }
+
+			/** Returns the counters of pushed, popped and dropped objects and the queue latency (thread-safe) */
+			void getStats(TStats &out_stats) const;
+			void resetStats(); //!< Resets all counters in the statistics
+
+		private:
+			detail::TObservationsChannelImpl *m_impl;
+		};
+
+	} // End of namespace
+} // End of namespace
+
+#endif
@@ -0,0 +1,84 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CObservationsMerger_H
+#define CObservationsMerger_H
+
+#include <mrpt/hwdrivers/CObservationsChannel.h>
+#include <string>
+#include <vector>
+
+namespace mrpt
+{
+	namespace hwdrivers
+	{
+		/** Merges the objects coming from several sensors, each one through its own CObservationsChannel, into one timestamp-ordered sequence.
+		  *
+		  * Objects are kept in an internal sorted buffer until it is safe to output them: merge() returns all the buffered objects
+		  * with timestamps not newer than the latest timestamp received from every channel (so an object arriving later from a slower
+		  * sensor can not be older than those already returned). To avoid waiting forever for a stalled or low-rate sensor, objects
+		  * which are more than \a max_delay seconds older than the newest received timestamp are always returned.
+		  *
+		  * Channels must be added with addChannel() before other threads start using them. merge() must be called from only one thread.
+		  *
+		  * \note (New in MRPT 1.5.0)
+		  * \sa CObservationsChannel, CGenericSensor
+		  * \ingroup mrpt_hwdrivers_grp
+		  */
+		class HWDRIVERS_IMPEXP CObservationsMerger : public mrpt::utils::CUncopiable
+		{
+		public:
+			typedef std::multimap<mrpt::system::TTimeStamp, mrpt::utils::CSerializablePtr> TListObservations;
+
+			/** Statistics of one channel, see getStats() */
+			struct HWDRIVERS_IMPEXP TChannelStats
+			{
+				std::string label;
+				CObservationsChannel::TStats queue;  //!< Queue counters and latency
+				uint64_t num_late;                   //!< Number of objects received after newer objects had been already returned by merge()
+				TChannelStats();
+			};
+
+			explicit CObservationsMerger(double max_delay = 1.0);
+			~CObservationsMerger();
+
+			/** Creates a new channel for a producer (e.g. the thread of a sensor). The returned object is owned by this merger. */
+			CObservationsChannel * addChannel(const std::string &label, size_t capacity = 1024, CObservationsChannel::TOverflowPolicy policy = CObservationsChannel::opBlock, unsigned int block_timeout_ms = 1000);
+
+			/** Moves all the objects which are ready from the channels into \a out_objs (which is cleared first).
+			  * \param[in] flush_all If true, return all pending objects, e.g. when all producers have finished.
+			  * \return The number of returned objects */
+			size_t merge(TListObservations &out_objs, bool flush_all = false);
+
+			/** Number of objects kept in the internal buffer, waiting for other channels */
+			size_t getPendingCount() const { return m_pending.size(); }
+
+			double getMaxDelay() const { return m_max_delay; }
+			void setMaxDelay(double max_delay) { m_max_delay = max_delay; }
+
+			/** Returns the statistics of all the channels, in the order they were added */
+			void getStats(std::vector<TChannelStats> &out_stats) const;
+
+		private:
+			struct TChannel
+			{
+				std::string           label;
+				CObservationsChannel *channel;
+				mrpt::system::TTimeStamp latest; //!< Newest timestamp received so far
+				uint64_t              num_late;
+			};
+			std::vector<TChannel>    m_channels;
+			TListObservations        m_pending;
+			double                   m_max_delay;
+			mrpt::system::TTimeStamp m_last_output; //!< Newest timestamp returned so far
+		};
+
+	} // End of namespace
+} // End of namespace
+
+#endif
@@ -34,6 +34,8 @@ CGenericSensor::CGenericSensor() :
 	m_external_images_format	("png"),
 	m_external_images_jpeg_quality (95)
 {
+	m_objList.reset(m_max_queue_len);
+
 	const char * sVerbose = getenv("MRPT_HWDRIVERS_VERBOSE");
 	m_verbose = (sVerbose!=NULL) && atoi(sVerbose)!=0;
 }
@@ -43,8 +45,6 @@ CGenericSensor::CGenericSensor() :
 -------------------------------------------------------------*/
 CGenericSensor::~CGenericSensor()
 {
-	// Free objects in list, if any:
-	m_objList.clear();
 }
 
 /*-------------------------------------------------------------
@@ -56,8 +56,6 @@ void CGenericSensor::appendObservations( const std::vector<mrpt::utils::CSeriali
 	{
 		m_grab_decimation_counter = 0;
 
-		synch::CCriticalSectionLocker	lock( & m_csObjList );
-
 		for (size_t i=0;i<objs.size();i++)
 		{
 			const CSerializablePtr &obj = objs[i];
@@ -78,7 +76,13 @@ void CGenericSensor::appendObservations( const std::vector<mrpt::utils::CSeriali
 			else THROW_EXCEPTION("Passed object must be CObservation.");
 
 			// Add it:
-			m_objList.insert( TListObsPair(timestamp, obj) );
+			if (!m_objList.push(timestamp, obj))
+			{
+				CObservationsChannel::TStats stats;
+				m_objList.getStats(stats);
+				if (stats.num_dropped==1 || (stats.num_dropped%100)==0)
+					cerr << "[CGenericSensor] Observations queue overflow (max_queue_len=" << m_objList.getCapacity() << ") in sensor '" << m_sensorLabel << "': " << stats.num_dropped << " objects dropped so far.\n";
+			}
 		}
 	}
 }
@@ -89,9 +93,8 @@ void CGenericSensor::appendObservations( const std::vector<mrpt::utils::CSeriali
 -------------------------------------------------------------*/
 void CGenericSensor::getObservations( TListObservations	&lstObjects )
 {
-	synch::CCriticalSectionLocker	lock( & m_csObjList );
-	lstObjects = m_objList;
-	m_objList.clear();			// Memory of objects will be freed by invoker.
+	lstObjects.clear();
+	m_objList.popAll(lstObjects);		// Memory of objects will be freed by invoker.
 }
 
 
@@ -138,6 +141,8 @@ void  CGenericSensor::loadConfig(
 	m_max_queue_len = static_cast<size_t>(cfg.read_int(sect,"max_queue_len",int(m_max_queue_len)));
 	m_grab_decimation = static_cast<size_t>(cfg.read_int(sect,"grab_decimation",int(m_grab_decimation)));
 
+	m_objList.reset(m_max_queue_len); // Drop policy, see the class docs
+
 	m_sensorLabel	= cfg.read_string( sect, "sensorLabel", m_sensorLabel );
 
 	m_grab_decimation_counter = 0;
@@ -0,0 +1,232 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "hwdrivers-precomp.h"   // Precompiled headers
+
+#include <mrpt/hwdrivers/CObservationsChannel.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace mrpt::hwdrivers;
+using namespace mrpt::utils;
+using namespace mrpt::system;
+
+namespace mrpt
+{
+	namespace hwdrivers
+	{
+		namespace detail
+		{
+			/** Bounded MPMC queue by D. Vyukov, used here with a single consumer: each cell has a sequence number which
+			  * tells producers and the consumer whether the cell is free for the lap of the ring they are working on. */
+			struct TObservationsChannelImpl
+			{
+				struct TCell
+				{
+					std::atomic<size_t> seq;
+					TTimeStamp          timestamp, enqueue_time;
+					CSerializablePtr    obj;
+				};
+
+				std::unique_ptr<TCell[]> cells;
+				size_t mask;
+				CObservationsChannel::TOverflowPolicy policy;
+				unsigned int block_timeout_ms;
+
+				char pad0_[64];
+				std::atomic<size_t> enqueue_pos;
+				char pad1_[64];
+				std::atomic<size_t> dequeue_pos; //!< Only modified by the consumer
+				char pad2_[64];
+
+				std::atomic<uint64_t> num_pushed, num_dropped, num_popped;
+				std::atomic<uint64_t> latency_sum_us, latency_max_us;
+
+				TObservationsChannelImpl() : mask(0), policy(CObservationsChannel::opDrop), block_timeout_ms(0),
+					enqueue_pos(0), dequeue_pos(0)
+				{
+					resetStats();
+				}
+
+				void reset(size_t capacity, CObservationsChannel::TOverflowPolicy policy_, unsigned int block_timeout_ms_)
+				{
+					size_t n = 2;
+					while (n<capacity) n<<=1;
+					cells.reset(new TCell[n]);
+					for (size_t i=0;i<n;i++)
+						cells[i].seq.store(i, std::memory_order_relaxed);
+					mask = n-1;
+					policy = policy_;
+					block_timeout_ms = block_timeout_ms_;
+					enqueue_pos.store(0);
+					dequeue_pos.store(0);
+				}
+
+				void resetStats()
+				{
+					num_pushed = 0; num_dropped = 0; num_popped = 0;
+					latency_sum_us = 0; latency_max_us = 0;
+				}
+
+				bool try_push(const TTimeStamp timestamp, const CSerializablePtr &obj)
+				{
+					size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+					for (;;)
+					{
+						TCell &cell = cells[pos & mask];
+						const size_t seq = cell.seq.load(std::memory_order_acquire);
+						const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+						if (dif==0)
+						{
+							if (enqueue_pos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+							{
+								cell.timestamp = timestamp;
+								cell.enqueue_time = mrpt::system::now();
+								cell.obj = obj;
+								cell.seq.store(pos+1, std::memory_order_release);
+								return true;
+							}
+							// else: "pos" was updated with the current value, try again
+						}
+						else if (dif<0)
+							return false; // Full
+						else pos = enqueue_pos.load(std::memory_order_relaxed);
+					}
+				}
+
+				bool try_pop(TTimeStamp &timestamp, CSerializablePtr &obj)
+				{
+					const size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+					TCell &cell = cells[pos & mask];
+					const size_t seq = cell.seq.load(std::memory_order_acquire);
+					if (seq!=pos+1)
+						return false; // Empty (or the producer of this cell has not finished writing it yet)
+
+					timestamp = cell.timestamp;
+					obj = cell.obj;
+					cell.obj.clear();
+					const TTimeStamp enqueue_time = cell.enqueue_time;
+					dequeue_pos.store(pos+1, std::memory_order_relaxed);
+					cell.seq.store(pos+mask+1, std::memory_order_release);
+
+					// Stats:
+					const uint64_t lat_us = static_cast<uint64_t>(std::max(0.0, 1e6*mrpt::system::timeDifference(enqueue_time, mrpt::system::now())));
+					num_popped.fetch_add(1, std::memory_order_relaxed);
+					latency_sum_us.fetch_add(lat_us, std::memory_order_relaxed);
+					if (lat_us>latency_max_us.load(std::memory_order_relaxed))
+						latency_max_us.store(lat_us, std::memory_order_relaxed); // Only the consumer writes this one
+					return true;
+				}
+			};
+		}
+	}
+}
+
+CObservationsChannel::TStats::TStats() :
+	num_pushed(0),
+	num_dropped(0),
+	num_popped(0),
+	latency_mean(0),
+	latency_max(0)
+{
+}
+
+CObservationsChannel::CObservationsChannel(size_t capacity, TOverflowPolicy policy, unsigned int block_timeout_ms) :
+	m_impl(new detail::TObservationsChannelImpl())
+{
+	m_impl->reset(capacity, policy, block_timeout_ms);
+}
+
+CObservationsChannel::~CObservationsChannel()
+{
+	delete m_impl;
+	m_impl = NULL;
+}
+
+void CObservationsChannel::reset(size_t capacity, TOverflowPolicy policy, unsigned int block_timeout_ms)
+{
+	m_impl->reset(capacity, policy, block_timeout_ms);
+}
+
+size_t CObservationsChannel::getCapacity() const
+{
+	return m_impl->mask+1;
+}
+
+CObservationsChannel::TOverflowPolicy CObservationsChannel::getOverflowPolicy() const
+{
+	return m_impl->policy;
+}
+
+bool CObservationsChannel::push(const TTimeStamp timestamp, const CSerializablePtr &obj)
+{
+	bool ok = m_impl->try_push(timestamp, obj);
+	if (!ok && m_impl->policy==opBlock)
+	{
+		// Backpressure: wait for the consumer to make room, yielding the CPU:
+		const TTimeStamp t0 = mrpt::system::now();
+		for (unsigned int i=0; !ok; i++)
+		{
+			if (i<64) std::this_thread::yield();
+			else
+			{
+				if (mrpt::system::timeDifference(t0, mrpt::system::now())*1000 > m_impl->block_timeout_ms)
+					break;
+				mrpt::system::sleep(1);
+			}
+			ok = m_impl->try_push(timestamp, obj);
+		}
+	}
+	if (ok)
+		m_impl->num_pushed.fetch_add(1, std::memory_order_relaxed);
+	else m_impl->num_dropped.fetch_add(1, std::memory_order_relaxed);
+	return ok;
+}
+
+bool CObservationsChannel::pop(TTimeStamp &out_timestamp, CSerializablePtr &out_obj)
+{
+	return m_impl->try_pop(out_timestamp, out_obj);
+}
+
+size_t CObservationsChannel::popAll(std::multimap<TTimeStamp, CSerializablePtr> &out_objs)
+{
+	size_t n = 0;
+	TTimeStamp t;
+	CSerializablePtr obj;
+	// Objects pushed after we start are left for the next call, so a fast producer can not keep us here forever:
+	const size_t max_n = size();
+	while (n<max_n && m_impl->try_pop(t,obj))
+	{
+		out_objs.insert(std::make_pair(t,obj));
+		n++;
+	}
+	return n;
+}
+
+size_t CObservationsChannel::size() const
+{
+	const size_t in  = m_impl->enqueue_pos.load(std::memory_order_relaxed);
+	const size_t out = m_impl->dequeue_pos.load(std::memory_order_relaxed);
+	return in>out ? std::min(in-out, m_impl->mask+1) : 0;
+}
+
+void CObservationsChannel::getStats(TStats &s) const
+{
+	s.num_pushed  = m_impl->num_pushed.load(std::memory_order_relaxed);
+	s.num_dropped = m_impl->num_dropped.load(std::memory_order_relaxed);
+	s.num_popped  = m_impl->num_popped.load(std::memory_order_relaxed);
+	s.latency_mean = s.num_popped ? 1e-6*m_impl->latency_sum_us.load(std::memory_order_relaxed)/s.num_popped : 0.0;
+	s.latency_max  = 1e-6*m_impl->latency_max_us.load(std::memory_order_relaxed);
+}
+
+void CObservationsChannel::resetStats()
+{
+	m_impl->resetStats();
+}
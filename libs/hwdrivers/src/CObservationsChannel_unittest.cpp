@@ -0,0 +1,137 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/hwdrivers/CObservationsMerger.h>
+#include <mrpt/obs/CObservationOdometry.h>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace mrpt;
+using namespace mrpt::hwdrivers;
+using namespace mrpt::obs;
+using namespace mrpt::utils;
+using namespace mrpt::system;
+using namespace std;
+
+static const TTimeStamp TEST_T0 = 131000000000000000ULL;
+
+static CSerializablePtr makeObs(TTimeStamp t, const std::string &label)
+{
+	CObservationOdometryPtr o = CObservationOdometry::Create();
+	o->timestamp = t;
+	o->sensorLabel = label;
+	return o;
+}
+
+TEST(CObservationsChannel, multipleProducers)
+{
+	const size_t NPROD = 4, N = 5000;
+	CObservationsChannel ch(64, CObservationsChannel::opBlock, 100000);
+	EXPECT_EQ(ch.getCapacity(), 64u);
+
+	std::vector<std::thread> producers;
+	for (size_t p=0;p<NPROD;p++)
+		producers.push_back(std::thread([&ch,p,N]() {
+			for (size_t i=0;i<N;i++)
+				ch.push(TEST_T0+p*N+i, makeObs(TEST_T0+p*N+i, "P"));
+		}));
+
+	// Consume while producing: each producer's objects must arrive in order, exactly once.
+	std::vector<size_t> next(NPROD,0);
+	size_t total=0;
+	while (total<NPROD*N)
+	{
+		TTimeStamp t;
+		CSerializablePtr obj;
+		if (!ch.pop(t,obj)) { std::this_thread::yield(); continue; }
+		ASSERT_TRUE(obj.present());
+		ASSERT_EQ(CObservationPtr(obj)->timestamp, t);
+		const size_t p = static_cast<size_t>((t-TEST_T0)/N), i = static_cast<size_t>((t-TEST_T0)%N);
+		ASSERT_LT(p, NPROD);
+		EXPECT_EQ(i, next[p]);
+		next[p]=i+1;
+		total++;
+	}
+	for (size_t p=0;p<NPROD;p++) producers[p].join();
+	EXPECT_TRUE(ch.empty());
+
+	CObservationsChannel::TStats stats;
+	ch.getStats(stats);
+	EXPECT_EQ(stats.num_pushed, NPROD*N);
+	EXPECT_EQ(stats.num_popped, NPROD*N);
+	EXPECT_EQ(stats.num_dropped, 0u);
+	EXPECT_GE(stats.latency_max, stats.latency_mean);
+}
+
+TEST(CObservationsChannel, overflowPolicies)
+{
+	CObservationsChannel ch(3, CObservationsChannel::opDrop); // Rounded up to 4
+	EXPECT_EQ(ch.getCapacity(), 4u);
+	for (int i=0;i<10;i++)
+		EXPECT_EQ(ch.push(TEST_T0+i, makeObs(TEST_T0+i,"A")), i<4);
+	EXPECT_EQ(ch.size(), 4u);
+
+	CObservationsChannel::TStats stats;
+	ch.getStats(stats);
+	EXPECT_EQ(stats.num_pushed, 4u);
+	EXPECT_EQ(stats.num_dropped, 6u);
+
+	std::multimap<TTimeStamp,CSerializablePtr> lst;
+	EXPECT_EQ(ch.popAll(lst), 4u);
+	ASSERT_EQ(lst.size(), 4u);
+	EXPECT_EQ(lst.begin()->first, TEST_T0);
+	EXPECT_EQ(lst.rbegin()->first, TEST_T0+3);
+
+	// Blocking with a short timeout must drop, too:
+	ch.reset(2, CObservationsChannel::opBlock, 20);
+	EXPECT_TRUE(ch.push(TEST_T0, makeObs(TEST_T0,"A")));
+	EXPECT_TRUE(ch.push(TEST_T0, makeObs(TEST_T0,"A")));
+	EXPECT_FALSE(ch.push(TEST_T0, makeObs(TEST_T0,"A")));
+}
+
+TEST(CObservationsMerger, timestampOrder)
+{
+	const TTimeStamp dt = secondsToTimestamp(0.1);
+	CObservationsMerger merger(10.0 /*max delay*/);
+	CObservationsChannel *fast = merger.addChannel("FAST",16), *slow = merger.addChannel("SLOW",16);
+	merger.addChannel("SILENT",16); // Never produces anything: must not block the others
+
+	for (int i=0;i<10;i++)
+		fast->push(TEST_T0+i*dt, makeObs(TEST_T0+i*dt,"FAST"));
+	slow->push(TEST_T0+3*dt+1, makeObs(TEST_T0+3*dt+1,"SLOW"));
+
+	// Only objects up to the latest one from SLOW can be returned:
+	CObservationsMerger::TListObservations out;
+	EXPECT_EQ(merger.merge(out), 5u);
+	EXPECT_EQ(out.rbegin()->first, TEST_T0+3*dt+1);
+	EXPECT_EQ(merger.getPendingCount(), 6u);
+
+	slow->push(TEST_T0+7*dt+1, makeObs(TEST_T0+7*dt+1,"SLOW"));
+	EXPECT_EQ(merger.merge(out), 5u);
+	EXPECT_EQ(out.begin()->first, TEST_T0+4*dt);
+	EXPECT_EQ(out.rbegin()->first, TEST_T0+7*dt+1);
+
+	// With a short max delay, the stalled SLOW sensor does not hold back the rest:
+	merger.setMaxDelay(0.15);
+	for (int i=10;i<20;i++)
+		fast->push(TEST_T0+i*dt, makeObs(TEST_T0+i*dt,"FAST"));
+	EXPECT_EQ(merger.merge(out), 10u);
+	EXPECT_EQ(out.rbegin()->first, TEST_T0+17*dt);
+
+	EXPECT_EQ(merger.merge(out,true), 2u);
+
+	std::vector<CObservationsMerger::TChannelStats> stats;
+	merger.getStats(stats);
+	ASSERT_EQ(stats.size(), 3u);
+	EXPECT_EQ(stats[0].label, "FAST");
+	EXPECT_EQ(stats[0].queue.num_pushed, 20u);
+	EXPECT_EQ(stats[1].queue.num_pushed, 2u);
+	EXPECT_EQ(stats[2].queue.num_pushed, 0u);
+	EXPECT_EQ(stats[0].num_late+stats[1].num_late, 0u);
+}
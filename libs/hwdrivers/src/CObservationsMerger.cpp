@@ -0,0 +1,107 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "hwdrivers-precomp.h"   // Precompiled headers
+
+#include <mrpt/hwdrivers/CObservationsMerger.h>
+
+using namespace mrpt::hwdrivers;
+using namespace mrpt::utils;
+using namespace mrpt::system;
+
+CObservationsMerger::TChannelStats::TChannelStats() :
+	num_late(0)
+{
+}
+
+CObservationsMerger::CObservationsMerger(double max_delay) :
+	m_max_delay(max_delay),
+	m_last_output(INVALID_TIMESTAMP)
+{
+}
+
+CObservationsMerger::~CObservationsMerger()
+{
+	for (size_t i=0;i<m_channels.size();i++)
+		delete m_channels[i].channel;
+	m_channels.clear();
+}
+
+CObservationsChannel * CObservationsMerger::addChannel(const std::string &label, size_t capacity, CObservationsChannel::TOverflowPolicy policy, unsigned int block_timeout_ms)
+{
+	TChannel c;
+	c.label = label;
+	c.channel = new CObservationsChannel(capacity, policy, block_timeout_ms);
+	c.latest = INVALID_TIMESTAMP;
+	c.num_late = 0;
+	m_channels.push_back(c);
+	return c.channel;
+}
+
+size_t CObservationsMerger::merge(TListObservations &out_objs, bool flush_all)
+{
+	out_objs.clear();
+
+	// Gather new objects, and the newest timestamp from each channel:
+	TTimeStamp watermark = INVALID_TIMESTAMP, newest = INVALID_TIMESTAMP;
+	TListObservations new_objs;
+	for (size_t i=0;i<m_channels.size();i++)
+	{
+		TChannel &c = m_channels[i];
+		new_objs.clear();
+		c.channel->popAll(new_objs);
+		for (TListObservations::const_iterator it=new_objs.begin();it!=new_objs.end();++it)
+		{
+			if (m_last_output!=INVALID_TIMESTAMP && it->first<m_last_output)
+				c.num_late++;
+			if (c.latest==INVALID_TIMESTAMP || it->first>c.latest)
+				c.latest = it->first;
+		}
+		m_pending.insert(new_objs.begin(), new_objs.end());
+
+		// Channels which never produced anything yet do not hold back the others:
+		if (c.latest==INVALID_TIMESTAMP) continue;
+		if (watermark==INVALID_TIMESTAMP || c.latest<watermark) watermark = c.latest;
+		if (newest==INVALID_TIMESTAMP || c.latest>newest) newest = c.latest;
+	}
+	if (m_pending.empty())
+		return 0;
+
+	TListObservations::iterator itEnd;
+	if (flush_all)
+		itEnd = m_pending.end();
+	else
+	{
+		TTimeStamp cutoff = watermark;
+		const TTimeStamp max_delay = mrpt::system::secondsToTimestamp(m_max_delay);
+		if (newest>max_delay && newest-max_delay>cutoff) cutoff = newest-max_delay;
+		itEnd = m_pending.upper_bound(cutoff);
+	}
+
+	out_objs.insert(m_pending.begin(), itEnd);
+	m_pending.erase(m_pending.begin(), itEnd);
+	if (!out_objs.empty())
+	{
+		const TTimeStamp last = out_objs.rbegin()->first;
+		if (m_last_output==INVALID_TIMESTAMP || last>m_last_output)
+			m_last_output = last;
+	}
+	return out_objs.size();
+}
+
+void CObservationsMerger::getStats(std::vector<TChannelStats> &out_stats) const
+{
+	out_stats.resize(m_channels.size());
+	for (size_t i=0;i<m_channels.size();i++)
+	{
+		out_stats[i].label = m_channels[i].label;
+		m_channels[i].channel->getStats(out_stats[i].queue);
+		out_stats[i].num_late = m_channels[i].num_late;
+	}
+}
@@ -125,7 +125,7 @@ namespace mrpt
 			inline void  setPoint(size_t index,float x, float y, float z) {
 				ASSERT_BELOW_(index,this->size())
 				setPointFast(index,x,y,z);
-				mark_as_modified();
+				mark_as_modified(index);
 			}
 			/// \overload
 			inline void  setPoint(size_t index,mrpt::math::TPoint3Df &p)  { setPoint(index,p.x,p.y,p.z); }
@@ -143,7 +143,7 @@ namespace mrpt
 			/// \overload
 			inline void  insertPoint( const mrpt::math::TPoint3Df &p ) { insertPoint(p.x,p.y,p.z); }
 			/// \overload
-			inline void  insertPoint( float x, float y, float z) { insertPointFast(x,y,z); mark_as_modified(); }
+			inline void  insertPoint( float x, float y, float z) { insertPointFast(x,y,z); mark_as_modified(this->x.size()-1); }
 
 			/** Changes just the color of a given point from the map. First index is 0.
 			 * \exception Throws std::exception on index out of bound.
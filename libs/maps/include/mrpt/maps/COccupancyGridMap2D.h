@@ -102,6 +102,20 @@ namespace maps
 
 		std::vector<double> precomputedLikelihood; //!< Auxiliary variables to speed up the computation of observation likelihood values for LF method among others, at a high cost in memory (see TLikelihoodOptions::enableLikelihoodCache).
 		bool precomputedLikelihoodToBeRecomputed;
+		std::vector<float> precomputedLogLikelihood; //!< Per-cell log-likelihood values for the LF method, filled upon demand by the batch version of computeLikelihoodField_Thrun(). Shares the invalidation flag precomputedLikelihoodToBeRecomputed
+
+		std::vector<float> m_distTransform; //!< Squared Euclidean distance (in cell units) from each cell to the closest occupied one, or empty if not built yet. See updateDistanceTransform()
+		float m_distTransform_validDist2; //!< Values in m_distTransform up to this one are exact; larger values are only approximate (either over- or underestimated) after incremental updates.
+		int   m_distTransform_dirty_x0, m_distTransform_dirty_x1, m_distTransform_dirty_y0, m_distTransform_dirty_y1; //!< Bounding box of the cells modified since the last update of m_distTransform (empty if x0>x1)
+
+		/** Marks a rectangle of cells as modified, for the incremental update of the distance transform (see updateDistanceTransform()) */
+		inline void markCellsAsModified(int cx0, int cx1, int cy0, int cy1) {
+			if (m_distTransform.empty()) return;
+			if (cx0<m_distTransform_dirty_x0) m_distTransform_dirty_x0=cx0;
+			if (cx1>m_distTransform_dirty_x1) m_distTransform_dirty_x1=cx1;
+			if (cy0<m_distTransform_dirty_y0) m_distTransform_dirty_y0=cy0;
+			if (cy1>m_distTransform_dirty_y1) m_distTransform_dirty_y1=cy1;
+		}
 
 		/** Used for Voronoi calculation.Same struct as "map", but contains a "0" if not a basis point. */
 		mrpt::utils::CDynamicGrid<uint8_t>	m_basis_map;
@@ -123,6 +137,7 @@ namespace maps
 		/** Change the contents [0,1] of a cell, given its index */
 		inline void   setCell_nocheck(int x,int y,float value) { 
 			map[x+y*size_x]=p2l(value);
+			markCellsAsModified(x,x,y,y);
 		}
 
 		/** Read the real valued [0,1] contents of a cell, given its index */
@@ -132,7 +147,10 @@ namespace maps
 		/** Changes a cell by its absolute index (Do not use it normally) */
 		inline void  setRawCell(unsigned int cellIndex, cellType b) {
 			if (cellIndex<size_x*size_y)
+			{
 				map[cellIndex] = b;
+				markCellsAsModified(cellIndex % size_x, cellIndex % size_x, cellIndex / size_x, cellIndex / size_x);
+			}
 		}
 
 		/** One of the methods that can be selected for implementing "computeObservationLikelihood" (This method is the Range-Scan Likelihood Consensus for gridmaps, see the ICRA2007 paper by Blanco et al.)  */
@@ -268,7 +286,8 @@ namespace maps
 			// The x> comparison implicitly holds if x<0
 			if (static_cast<unsigned int>(x)>=size_x ||	static_cast<unsigned int>(y)>=size_y)
 					return;
-			else	map[x+y*size_x]=p2l(value);
+			map[x+y*size_x]=p2l(value);
+			markCellsAsModified(x,x,y,y);
 		}
 
 		/** Read the real valued [0,1] contents of a cell, given its index */
@@ -415,6 +434,7 @@ namespace maps
 			float    LF_maxCorrsDistance; //!< [LikelihoodField] The max. distance for searching correspondences around each sensed point
 			bool     LF_useSquareDist;    //!< [LikelihoodField] (Default:false) Use `exp(dist^2/std^2)` instead of `exp(dist^2/std^2)`
 			bool     LF_alternateAverageMethod; //!< [LikelihoodField] Set this to "true" ot use an alternative method, where the likelihood of the whole range scan is computed by "averaging" of individual ranges, instead of by the "product".
+			bool     LF_useDistanceTransform; //!< [LikelihoodField] (Default:false) Take the distance from each point to the closest occupied cell from a distance transform of the grid, built upon the first query and updated incrementally as cells change (see COccupancyGridMap2D::updateDistanceTransform()), instead of searching a window of cells for each point. Results are identical; this is faster for static maps, at the cost of 4 bytes per cell.
 			float    MI_exponent;  //!< [MI] The exponent in the MI likelihood computation. Default value = 5
 			uint32_t MI_skip_rays; //!< [MI] The scan rays decimation: at every N rays, one will be used to compute the MI
 			float    MI_ratio_max_distance; //!< [MI] The ratio for the max. distance used in the MI computation and in the insertion of scans, e.g. if set to 2.0 the MI will use twice the distance that the update distance.
@@ -646,6 +666,42 @@ namespace maps
 		  */
 		double	 computeLikelihoodField_Thrun( const CPointsMap	*pm, const mrpt::poses::CPose2D *relativePose = NULL);
 
+		/** Batch version of computeLikelihoodField_Thrun(): computes the log-likelihood of the same set of points for many
+		  * candidate relative poses at once, as needed by particle filters and scan matchers.
+		  * The (decimated) points are extracted only once, then each pose is evaluated with a vectorized kernel which transforms
+		  * 8 (AVX2, if the library is built for it) or 4 (SSE2) points at a time, with a scalar fallback, and gathers the
+		  * log-likelihood of each cell from a cache table which is filled upon demand.
+		  * Results match those of computeLikelihoodField_Thrun() up to the float-precision transformation of points.
+		  * \param pm The points map
+		  * \param relativePoses The candidate poses of the points map in this map's coordinates.
+		  * \param out_log_liks The output log-likelihood for each pose.
+		  * \note Since the cache table is filled upon demand, this method must not be called concurrently on the same map.
+		  * \note If likelihoodOptions.LF_alternateAverageMethod is true, poses are evaluated one by one with the non-batch method.
+		  * \note (New in MRPT 1.5.0)
+		  */
+		void	 computeLikelihoodField_Thrun( const CPointsMap	*pm, const std::vector<mrpt::math::TPose2D> &relativePoses, std::vector<double> &out_log_liks );
+
+		/** Builds the Euclidean distance transform of the grid (the distance from each cell to the closest occupied one) with the
+		  * linear-time algorithm of Felzenszwalb & Huttenlocher, or updates it if only some cells were modified since the last call
+		  * (through updateCell(), setCell() or insertObservation()), in which case only the neighborhood of those cells is recomputed.
+		  * It is invoked automatically from the likelihood field methods when likelihoodOptions.LF_useDistanceTransform is true,
+		  * and saved along the map when serialized, if it is up to date.
+		  * \param maxDistance Distances (in meters) up to this value are exact after an incremental update. Larger ones are only approximate:
+		  *  they might be overestimated (only the occupied cells nearby the modified ones are looked at) or underestimated (cells farther away
+		  *  keep their previous values, e.g. if an obstacle was cleared). If the current transform is not exact up to this distance, it is
+		  *  rebuilt from scratch. Use 0 to force an exact transform.
+		  * \note Cells modified through getRow() are not tracked: call invalidateDistanceTransform() after doing so.
+		  * \note (New in MRPT 1.5.0)
+		  */
+		void updateDistanceTransform(float maxDistance = 0);
+
+		/** Discards the distance transform, which will be rebuilt from scratch the next time it is needed. \sa updateDistanceTransform() */
+		void invalidateDistanceTransform();
+
+		/** Returns the distance (in meters) from the cell (cx,cy) to the closest occupied cell, from the last call to updateDistanceTransform(),
+		  * or -1 if it has not been built yet or the cell is out of the map. \sa updateDistanceTransform() */
+		float getDistanceTransformValue(int cx, int cy) const;
+
 		/** Computes the likelihood [0,1] of a set of points, given the current grid map as reference.
 		  * \param pm The points map
 		  * \param relativePose The relative pose of the points map in this map's coordinates, or NULL for (0,0,0).
@@ -786,8 +842,13 @@ namespace maps
 		// See docs in base class
 		double internal_computeObservationLikelihood( const mrpt::obs::CObservation *obs, const mrpt::poses::CPose3D &takenFrom ) MRPT_OVERRIDE;
 		// See docs in base class
+		void internal_computeObservationLikelihoods( const mrpt::obs::CObservation *obs, const std::vector<mrpt::math::TPose3D> &takenFrom, std::vector<double> &out_log_liks ) MRPT_OVERRIDE;
+		// See docs in base class
 		bool internal_canComputeObservationLikelihood( const mrpt::obs::CObservation *obs ) const MRPT_OVERRIDE;
 
+		/** Likelihood [0,1] of a point falling into the cell (cx,cy) for the LF-Thrun method, from the distance to the closest occupied cell within likelihoodOptions.LF_maxCorrsDistance */
+		double computeLikelihoodField_Thrun_cell(int cx, int cy) const;
+
 		/** Returns a byte with the occupancy of the 8 sorrounding cells.
 		 * \param cx The cell index
 		 * \param cy The cell index
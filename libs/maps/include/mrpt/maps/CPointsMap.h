@@ -17,6 +17,7 @@
 #include <mrpt/obs/CSinCosLookUpTableFor2DScans.h>
 #include <mrpt/math/lightweight_geom_data.h>
 #include <mrpt/math/CMatrixFixedNumeric.h>
+#include <mrpt/math/point_cloud_kernels.h>
 #include <mrpt/utils/PLY_import_export.h>
 #include <mrpt/obs/obs_frwds.h>
 #include <mrpt/maps/link_pragmas.h>
@@ -27,6 +28,8 @@ DECLARE_MEXPLUS_FROM( mrpt::maps::CPointsMap )
 
 namespace mrpt
 {
+namespace system { class CWorkerThreadsPool; }
+
 /** \ingroup mrpt_maps_grp */
 namespace maps
 {
@@ -322,7 +325,7 @@ namespace maps
 		inline void  setPoint(size_t index,float x, float y, float z) {
 			ASSERT_BELOW_(index,this->size())
 			setPointFast(index,x,y,z);
-			mark_as_modified();
+			mark_as_modified(index);
 		}
 		/// \overload
 		inline void  setPoint(size_t index, const mrpt::math::TPoint2D &p) {  setPoint(index,p.x,p.y,0); }
@@ -357,6 +360,13 @@ namespace maps
 		/** Provides a direct access to a read-only reference of the internal point buffer. \sa getAllPoints */
 		inline const std::vector<float> & getPointsBufferRef_z() const { return z; }
 
+		/** Returns a read-only view of all the points, to be used with the vectorized kernels in mrpt/math/point_cloud_kernels.h
+		  * (e.g. mrpt::math::transformPoints(), mrpt::math::boundingBox()). The view is invalidated by any change in the number of points.
+		  * \note (New in MRPT 1.5.0) */
+		inline mrpt::math::TConstPointCloudSpan getPointsSpan() const {
+			return x.empty() ? mrpt::math::TConstPointCloudSpan() : mrpt::math::TConstPointCloudSpan(&x[0],&y[0],&z[0],x.size());
+		}
+
 		/** Returns a copy of the 2D/3D points as a std::vector of float coordinates.
 		  * If decimation is greater than 1, only 1 point out of that number will be saved in the output, effectively performing a subsampling of the points.
 		  * \sa getPointsBufferRef_x, getPointsBufferRef_y, getPointsBufferRef_z
@@ -416,7 +426,7 @@ namespace maps
 		/** Provides a way to insert (append) individual points into the map: the missing fields of child
 		  * classes (color, weight, etc) are left to their default values
 		  */
-		inline void  insertPoint( float x, float y, float z=0 ) { insertPointFast(x,y,z); mark_as_modified(); }
+		inline void  insertPoint( float x, float y, float z=0 ) { insertPointFast(x,y,z); mark_as_modified(this->x.size()-1); }
 		/// \overload
 		inline void  insertPoint( const mrpt::math::TPoint3D &p ) { insertPoint(p.x,p.y,p.z); }
 		/// overload (RGB data is ignored in classes without color information)
@@ -642,6 +652,43 @@ namespace maps
 		  */
         void extractPoints( const mrpt::math::TPoint3D &corner1, const mrpt::math::TPoint3D &corner2, CPointsMap *outMap, const double &R = 1, const double &G = 1, const double &B = 1 );
 
+		/** @name Local surface geometry (normals, covariances)
+			@{ */
+
+		/** The local geometry of the surface around each point, estimated from the covariance of its nearest neighbors.
+		  * \sa getLocalGeometry2D, getLocalGeometry3D
+		  * \note (New in MRPT 1.5.0) */
+		struct MAPS_IMPEXP TLocalGeometry
+		{
+			TLocalGeometry() : dim(0), nNeighbors(0) { }
+
+			unsigned int        dim;        //!< 2: computed with the (x,y) coordinates only, 3: with (x,y,z). 0 if not computed yet.
+			size_t              nNeighbors; //!< The number of nearest neighbors (including the point itself) used for each point
+			std::vector<float>  normals;    //!< `dim` values per point: the unit normal vector, i.e. the eigenvector of the smallest eigenvalue of the covariance of the neighbors.
+			/** `dim*(dim+1)/2` values per point, the upper triangle (xx,xy,yy / xx,xy,xz,yy,yz,zz) of the covariance of the neighbors, regularized as in Generalized-ICP
+			  * (Segal et al., 2009): unit variance along the surface and `1e-3` along the normal. */
+			std::vector<float>  cov;
+
+			inline size_t size() const { return dim ? normals.size()/dim : 0; }
+			/** Drops the data of points with indices `>=nPoints` */
+			inline void truncate(size_t nPoints) {
+				if (nPoints>=size()) return;
+				normals.resize(nPoints*dim);
+				cov.resize(nPoints*(dim*(dim+1)/2));
+			}
+		};
+
+		/** Returns the local geometry of each point in the XY plane (e.g. normals to the walls in a 2D scan), computed from its `nNeighbors` nearest neighbors with the 2D KD-tree.
+		  * Results are cached, so if the map is not modified, calling this again is free, and only the geometry of appended points is computed if points are only added at the end
+		  * of the map (the geometry of older points is not updated with the new neighbors). Optionally, computations are split among the threads of \a threads.
+		  * \note (New in MRPT 1.5.0) */
+		const TLocalGeometry & getLocalGeometry2D(size_t nNeighbors = 10, mrpt::system::CWorkerThreadsPool *threads = NULL) const;
+		/** Like getLocalGeometry2D(), for 3D surfaces, with the 3D KD-tree.
+		  * \note (New in MRPT 1.5.0) */
+		const TLocalGeometry & getLocalGeometry3D(size_t nNeighbors = 10, mrpt::system::CWorkerThreadsPool *threads = NULL) const;
+
+		/** @} */
+
 		/** @name Filter-by-height stuff
 			@{ */
 
@@ -772,9 +819,22 @@ namespace maps
 		{
 			m_largestDistanceFromOriginIsUpdated=false;
 			m_boundingBoxIsUpdated = false;
+			m_localGeometry2D.truncate(0);
+			m_localGeometry3D.truncate(0);
 			kdtree_mark_as_outdated();
 		}
 
+		/** Like mark_as_modified(), when only the points with indices `>=firstModifiedIndex` have changed, or have been appended or removed, so
+		  * the KD-tree can be updated incrementally if mrpt::math::KDTreeCapable::TKDTreeSearchParams::incremental is enabled. (New in MRPT 1.5.0) */
+		inline void mark_as_modified(size_t firstModifiedIndex) const
+		{
+			m_largestDistanceFromOriginIsUpdated=false;
+			m_boundingBoxIsUpdated = false;
+			m_localGeometry2D.truncate(firstModifiedIndex);
+			m_localGeometry3D.truncate(firstModifiedIndex);
+			kdtree_mark_as_outdated(firstModifiedIndex);
+		}
+
 	protected:
 		std::vector<float>     x,y,z;        //!< The point coordinates
 
@@ -793,6 +853,8 @@ namespace maps
 		mutable bool	m_boundingBoxIsUpdated;
 		mutable float   m_bb_min_x,m_bb_max_x, m_bb_min_y,m_bb_max_y, m_bb_min_z,m_bb_max_z;
 
+		mutable TLocalGeometry  m_localGeometry2D, m_localGeometry3D; //!< Cached results of getLocalGeometry2D(), getLocalGeometry3D()
+
 		/** This is a common version of CMetricMap::insertObservation() for point maps (actually, CMetricMap::internal_insertObservation),
 		  *   so derived classes don't need to worry implementing that method unless something special is really necesary.
 		  * See mrpt::maps::CPointsMap for the enumeration of types of observations which are accepted. */
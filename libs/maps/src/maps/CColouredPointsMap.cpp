@@ -104,6 +104,7 @@ void CColouredPointsMap::reserve(size_t newLength)
 //  and old contents are not changed.
 void CColouredPointsMap::resize(size_t newLength)
 {
+	const size_t oldLength = x.size();
 	this->reserve(newLength); // to ensure 4N capacity
 
 	x.resize( newLength, 0 );
@@ -112,7 +113,7 @@ void CColouredPointsMap::resize(size_t newLength)
 	m_color_R.resize( newLength, 1 );
 	m_color_G.resize( newLength, 1 );
 	m_color_B.resize( newLength, 1 );
-	mark_as_modified();
+	mark_as_modified(std::min(oldLength,newLength));
 }
 
 // Resizes all point buffers so they can hold the given number of points, *erasing* all previous contents
@@ -100,6 +100,11 @@ COccupancyGridMap2D::COccupancyGridMap2D(
 		x_min(),x_max(),y_min(),y_max(), resolution(),
 		precomputedLikelihood(),
 		precomputedLikelihoodToBeRecomputed(true),
+		precomputedLogLikelihood(),
+		m_distTransform(),
+		m_distTransform_validDist2(0),
+		m_distTransform_dirty_x0(std::numeric_limits<int>::max()), m_distTransform_dirty_x1(std::numeric_limits<int>::min()),
+		m_distTransform_dirty_y0(std::numeric_limits<int>::max()), m_distTransform_dirty_y1(std::numeric_limits<int>::min()),
 		m_basis_map(),
 		m_voronoi_diagram(),
 		m_is_empty(true),
@@ -233,6 +238,7 @@ void  COccupancyGridMap2D::resizeGrid(float new_x_min,float new_x_max,float new_
 
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	invalidateDistanceTransform();
 
 	// Add an additional margin:
 	if (additionalMargin)
@@ -337,6 +343,7 @@ void COccupancyGridMap2D::freeMap()
 
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	invalidateDistanceTransform();
 
 	m_is_empty=true;
 
@@ -450,6 +457,7 @@ void  COccupancyGridMap2D::fill(float default_value)
 		*it = defValue;
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	invalidateDistanceTransform();
 	//resetFeaturesCache();
 }
 
@@ -462,6 +470,8 @@ void  COccupancyGridMap2D::updateCell(int x,int y, float v)
 	if (static_cast<unsigned int>(x)>=size_x || static_cast<unsigned int>(y)>=size_y)
 		return;
 
+	markCellsAsModified(x,x,y,y);
+
 	// Get the current contents of the cell:
 	cellType	&theCell = map[x+y*size_x];
 
@@ -0,0 +1,161 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h" // Precomp header
+
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <limits>
+
+using namespace mrpt;
+using namespace mrpt::maps;
+using namespace mrpt::utils;
+using namespace std;
+
+namespace
+{
+	// "Infinite" squared distance for cells without any occupied cell in range.
+	// Large, but finite, so the parabolas intersections below remain well defined.
+	const double DT_INF = 1e20;
+
+	/** 1D squared distance transform of the sampled function f[0..n-1] (Felzenszwalb & Huttenlocher, 2004).
+	  * d[q] = min_p ( (q-p)^2 + f[p] ). v,z are work buffers of sizes n and n+1. */
+	void distanceTransform1D(const double *f, const int n, double *d, int *v, double *z)
+	{
+		int k = 0;
+		v[0] = 0;
+		z[0] = -DT_INF;
+		z[1] = DT_INF;
+		for (int q=1;q<n;q++)
+		{
+			double s  = ((f[q]+q*q)-(f[v[k]]+v[k]*v[k]))/(2*q-2*v[k]);
+			while (s <= z[k])
+			{
+				k--;
+				s  = ((f[q]+q*q)-(f[v[k]]+v[k]*v[k]))/(2*q-2*v[k]);
+			}
+			k++;
+			v[k] = q;
+			z[k] = s;
+			z[k+1] = DT_INF;
+		}
+		k = 0;
+		for (int q=0;q<n;q++)
+		{
+			while (z[k+1] < q) k++;
+			d[q] = square(q-v[k]) + f[v[k]];
+		}
+	}
+}
+
+/*---------------------------------------------------------------
+					updateDistanceTransform
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::updateDistanceTransform(float maxDistance)
+{
+	MRPT_START
+
+	if (map.empty())
+		return;
+
+	// Distance, in cells, which must be exact in the resulting transform:
+	const double K = maxDistance>0 ? ceil(maxDistance / resolution) : DT_INF;
+	const double K2 = maxDistance>0 ? square(K) : DT_INF;
+
+	// Input window (cells whose occupancy is looked at) and output window (cells whose distance is updated):
+	int in_x0, in_x1, in_y0, in_y1;
+	int out_x0, out_x1, out_y0, out_y1;
+
+	const bool isExact = m_distTransform.size()==map.size() && m_distTransform_validDist2>=K2;
+	const bool isDirty = m_distTransform_dirty_x0<=m_distTransform_dirty_x1;
+	if (isExact && !isDirty)
+		return; // Nothing to do.
+
+	const bool fullBuild = !isExact || K>=std::max(size_x,size_y);
+	if (fullBuild)
+	{
+		// Build from scratch:
+		m_distTransform.assign(map.size(), 0);
+		m_distTransform_validDist2 = std::numeric_limits<float>::max();
+		in_x0 = out_x0 = 0; in_x1 = out_x1 = size_x-1;
+		in_y0 = out_y0 = 0; in_y1 = out_y1 = size_y-1;
+	}
+	else
+	{
+		// Only cells within a distance K of the modified ones may have a different (clamped) distance,
+		// and only occupied cells within a distance K of those ones are relevant to compute it:
+		const int iK = static_cast<int>(K);
+		out_x0 = std::max(0, m_distTransform_dirty_x0-iK); out_x1 = std::min<int>(size_x-1, m_distTransform_dirty_x1+iK);
+		out_y0 = std::max(0, m_distTransform_dirty_y0-iK); out_y1 = std::min<int>(size_y-1, m_distTransform_dirty_y1+iK);
+		in_x0 = std::max(0, out_x0-iK); in_x1 = std::min<int>(size_x-1, out_x1+iK);
+		in_y0 = std::max(0, out_y0-iK); in_y1 = std::min<int>(size_y-1, out_y1+iK);
+		keep_min(m_distTransform_validDist2, static_cast<float>(K2));
+	}
+	m_distTransform_dirty_x0 = m_distTransform_dirty_y0 = std::numeric_limits<int>::max();
+	m_distTransform_dirty_x1 = m_distTransform_dirty_y1 = std::numeric_limits<int>::min();
+
+	const int nx = in_x1-in_x0+1, ny = in_y1-in_y0+1;
+	const int nmax = std::max(nx,ny);
+	const cellType thresholdCellValue = p2l(0.5f);  // Same criterion than in computeLikelihoodField_Thrun()
+
+	// Column-wise transform of the input window, stored row by row. In a full build, it is
+	// stored in-place in the output table, since both windows are the whole grid:
+	std::vector<float> g_buf;
+	if (!fullBuild) g_buf.resize(nx*ny);
+	float *g = fullBuild ? &m_distTransform[0] : &g_buf[0];
+	const int g_stride = fullBuild ? size_x : nx;
+
+	std::vector<double> f(nmax), d(nmax), z(nmax+1);
+	std::vector<int>    v(nmax);
+
+	// 1st pass: along columns
+	for (int x=0;x<nx;x++)
+	{
+		const cellType *cell = &map[(in_x0+x)+in_y0*size_x];
+		for (int y=0;y<ny;y++, cell+=size_x)
+			f[y] = (*cell < thresholdCellValue) ? 0 : DT_INF;
+		distanceTransform1D(&f[0], ny, &d[0], &v[0], &z[0]);
+		for (int y=0;y<ny;y++)
+			g[x+y*g_stride] = static_cast<float>(d[y]);
+	}
+
+	// 2nd pass: along the rows of the output window
+	for (int cy=out_y0;cy<=out_y1;cy++)
+	{
+		const float *g_row = &g[(cy-in_y0)*g_stride];
+		for (int x=0;x<nx;x++)
+			f[x] = g_row[x];
+		distanceTransform1D(&f[0], nx, &d[0], &v[0], &z[0]);
+		float *out = &m_distTransform[out_x0+cy*size_x];
+		for (int cx=out_x0;cx<=out_x1;cx++)
+			*out++ = static_cast<float>( std::min(d[cx-in_x0], DT_INF) );
+	}
+
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+					invalidateDistanceTransform
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::invalidateDistanceTransform()
+{
+	m_distTransform.clear();
+	m_distTransform_validDist2 = 0;
+	m_distTransform_dirty_x0 = m_distTransform_dirty_y0 = std::numeric_limits<int>::max();
+	m_distTransform_dirty_x1 = m_distTransform_dirty_y1 = std::numeric_limits<int>::min();
+}
+
+/*---------------------------------------------------------------
+					getDistanceTransformValue
+ ---------------------------------------------------------------*/
+float COccupancyGridMap2D::getDistanceTransformValue(int cx, int cy) const
+{
+	if (m_distTransform.size()!=map.size() || static_cast<unsigned int>(cx)>=size_x || static_cast<unsigned int>(cy)>=size_y)
+		return -1;
+	return std::sqrt(m_distTransform[cx+cy*size_x]) * resolution;
+}
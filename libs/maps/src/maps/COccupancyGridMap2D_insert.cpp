@@ -95,6 +95,12 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 			// ---------------------------------------------
 			//		Insert the scan as simple rays:
 			// ---------------------------------------------
+			// All cells which may change are within the max. insertion distance from the sensor
+			// (for the incremental update of the distance transform):
+			markCellsAsModified(
+				x2idx(laserPose.x()-insertionOptions.maxDistanceInsertion)-2, x2idx(laserPose.x()+insertionOptions.maxDistanceInsertion)+2,
+				y2idx(laserPose.y()-insertionOptions.maxDistanceInsertion)-2, y2idx(laserPose.y()+insertionOptions.maxDistanceInsertion)+2 );
+
 			int								cx,cy,N =  o->scan.size();
 			float							px,py;
 			double							A, dAK;
@@ -716,6 +722,11 @@ bool  COccupancyGridMap2D::internal_insertObservation(
 		    // ---------------------------------------------
 			//		Insert the scan as simple rays:
 			// ---------------------------------------------
+			// All cells which may change are within the max. insertion distance from the sensor
+			// (for the incremental update of the distance transform):
+			markCellsAsModified(
+				x2idx(laserPose.x()-insertionOptions.maxDistanceInsertion)-2, x2idx(laserPose.x()+insertionOptions.maxDistanceInsertion)+2,
+				y2idx(laserPose.y()-insertionOptions.maxDistanceInsertion)-2, y2idx(laserPose.y()+insertionOptions.maxDistanceInsertion)+2 );
 
 			//int		/*cx,cy,*/ N =  o->sensedData.size();
 			float	px,py;
@@ -53,7 +53,7 @@ bool  COccupancyGridMap2D::saveAsBitmapFile(const std::string &file) const
 void  COccupancyGridMap2D::writeToStream(mrpt::utils::CStream &out, int *version) const
 {
 	if (version)
-		*version = 6;
+		*version = 7;
 	else
 	{
 		// Version 3: Change to log-odds. The only change is in the loader, when translating
@@ -114,6 +114,17 @@ void  COccupancyGridMap2D::writeToStream(mrpt::utils::CStream &out, int *version
 		// Version: 5;
 		out << insertionOptions.wideningBeamsWithDistance;
 
+		// Version 7: The distance transform, only if it is up to date:
+		out << likelihoodOptions.LF_useDistanceTransform;
+		const bool saveDistTransform = m_distTransform.size()==map.size() && m_distTransform_dirty_x0>m_distTransform_dirty_x1;
+		out << saveDistTransform;
+		if (saveDistTransform)
+		{
+			out << m_distTransform_validDist2;
+			if (!m_distTransform.empty())
+				out.WriteBufferFixEndianness(&m_distTransform[0], m_distTransform.size());
+		}
+
 	}
 }
 
@@ -133,6 +144,7 @@ void  COccupancyGridMap2D::readFromStream(mrpt::utils::CStream &in, int version)
 	case 4:
 	case 5:
 	case 6:
+	case 7:
 		{
 #			ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
 				const uint8_t	MyBitsPerCell = 8;
@@ -269,6 +281,20 @@ void  COccupancyGridMap2D::readFromStream(mrpt::utils::CStream &in, int version)
 				in >> insertionOptions.wideningBeamsWithDistance;
 			}
 
+			invalidateDistanceTransform();
+			if (version>=7)
+			{
+				bool hasDistTransform;
+				in >> likelihoodOptions.LF_useDistanceTransform >> hasDistTransform;
+				if (hasDistTransform)
+				{
+					in >> m_distTransform_validDist2;
+					m_distTransform.resize(map.size());
+					if (!m_distTransform.empty())
+						in.ReadBufferFixEndianness(&m_distTransform[0], m_distTransform.size());
+				}
+			}
+
 		} break;
 	default:
 		MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version)
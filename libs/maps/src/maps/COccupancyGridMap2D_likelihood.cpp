@@ -15,6 +15,13 @@
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/utils/CStream.h>
 
+#if MRPT_HAS_SSE2
+#	include <mrpt/utils/SSE_types.h>
+#endif
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#endif
+
 
 using namespace mrpt;
 using namespace mrpt::math;
@@ -81,6 +88,56 @@ double	 COccupancyGridMap2D::internal_computeObservationLikelihood(
 
 }
 
+/*---------------------------------------------------------------
+			internal_computeObservationLikelihoods
+ The scan is converted into a points map only once for all the poses,
+ then each pose is evaluated against the likelihood field.
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::internal_computeObservationLikelihoods(
+	const CObservation		*obs,
+	const std::vector<TPose3D> &takenFrom,
+	std::vector<double>     &out_log_liks )
+{
+	if (likelihoodOptions.likelihoodMethod!=lmLikelihoodField_Thrun || !IS_CLASS(obs, CObservation2DRangeScan))
+	{
+		// Generic implementation: one pose at a time
+		CMetricMap::internal_computeObservationLikelihoods(obs,takenFrom,out_log_liks);
+		return;
+	}
+
+	const CObservation2DRangeScan	*scan = static_cast<const CObservation2DRangeScan*>(obs);
+	const size_t N = takenFrom.size();
+	if (!scan->isPlanarScan(insertionOptions.horizontalTolerance) ||
+		(insertionOptions.useMapAltitude && fabs(insertionOptions.mapAltitude - scan->sensorPose.z() ) > 0.01) )
+	{
+		out_log_liks.assign(N, -10);
+		return;
+	}
+
+	CPointsMap::TInsertionOptions		opts;
+	opts.minDistBetweenLaserPoints	= resolution*0.5f;
+	opts.isPlanarMap				= true; // Already filtered above!
+	opts.horizontalTolerance		= insertionOptions.horizontalTolerance;
+	const CPointsMap *pts = scan->buildAuxPointsMap<mrpt::maps::CPointsMap>(&opts);
+
+	if (likelihoodOptions.enableLikelihoodCache)
+	{
+		// Vectorized evaluation of all poses at once (it fills the cache, hence it is only used when enabled):
+		std::vector<TPose2D> poses2D(N);
+		for (size_t i=0;i<N;i++)
+			poses2D[i] = TPose2D(takenFrom[i].x,takenFrom[i].y,takenFrom[i].yaw);
+		computeLikelihoodField_Thrun(pts, poses2D, out_log_liks);
+		return;
+	}
+
+	out_log_liks.resize(N);
+	for (size_t i=0;i<N;i++)
+	{
+		const CPose2D pose2D(takenFrom[i].x,takenFrom[i].y,takenFrom[i].yaw);
+		out_log_liks[i] = computeLikelihoodField_Thrun(pts, &pose2D);
+	}
+}
+
 /*---------------------------------------------------------------
 			computeObservationLikelihood_Consensus
 ---------------------------------------------------------------*/
@@ -493,6 +550,85 @@ double	 COccupancyGridMap2D::computeObservationLikelihood_likelihoodField_II(
 }
 
 
+/*---------------------------------------------------------------
+					computeLikelihoodField_Thrun_cell
+ ---------------------------------------------------------------*/
+double COccupancyGridMap2D::computeLikelihoodField_Thrun_cell(int cx, int cy) const
+{
+	// The size of the checking area for matchings:
+	const int K = (int)ceil(likelihoodOptions.LF_maxCorrsDistance/*m*/ / resolution);
+	const float Q = -0.5f / square(likelihoodOptions.LF_stdHit);
+	const float zRandomTerm = likelihoodOptions.LF_zRandom / likelihoodOptions.LF_maxRange;
+	const double maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
+
+	const unsigned int size_x_1 = size_x-1;
+	const unsigned int size_y_1 = size_y-1;
+	const cellType thresholdCellValue = p2l(0.5f);
+
+	const double _resolution = this->resolution;
+	const double constDist2DiscrUnits = 100 / (_resolution * _resolution);
+	const double constDist2DiscrUnits_INV = 1.0 / constDist2DiscrUnits;
+
+	float occupiedMinDist;
+
+	if (likelihoodOptions.LF_useDistanceTransform && m_distTransform.size()==map.size())
+	{
+		// Just one look-up in the distance transform, kept up-to-date by the callers.
+		// Use the same discretization than below, so results are identical:
+		unsigned int occupiedMinDistInt = mrpt::utils::round( maxCorrDist_sq * constDist2DiscrUnits );
+		const float dist2 = m_distTransform[cx+cy*size_x];  // In cells^2
+		if (100*dist2 < occupiedMinDistInt)
+			occupiedMinDistInt = 100*static_cast<unsigned int>(dist2);
+		occupiedMinDist = occupiedMinDistInt * constDist2DiscrUnits_INV ;
+	}
+	else
+	{
+		// Find the closest occupied cell in a certain range, given by K:
+		int xx1 = max(0,cx-K);
+		int xx2 = min(size_x_1,(unsigned)(cx+K));
+		int yy1 = max(0,cy-K);
+		int yy2 = min(size_y_1,(unsigned)(cy+K));
+
+		// Optimized code: this part will be invoked a *lot* of times:
+		const cellType  *mapPtr  = &map[xx1+yy1*size_x]; // Initial pointer position
+		unsigned   incrAfterRow = size_x - ((xx2-xx1)+1);
+
+		signed int Ax0 = 10*(xx1-cx);
+		signed int Ay  = 10*(yy1-cy);
+
+		unsigned int occupiedMinDistInt = mrpt::utils::round( maxCorrDist_sq * constDist2DiscrUnits );
+
+		for (int yy=yy1;yy<=yy2;yy++)
+		{
+			unsigned int Ay2 = square((unsigned int)(Ay)); // Square is faster with unsigned.
+			signed short Ax=Ax0;
+			cellType  cell;
+
+			for (int xx=xx1;xx<=xx2;xx++)
+			{
+				if ( (cell =*mapPtr++) < thresholdCellValue )
+				{
+					unsigned int d = square((unsigned int)(Ax)) + Ay2;
+					keep_min(occupiedMinDistInt, d);
+				}
+				Ax += 10;
+			}
+			// Go to (xx1,yy++)
+			mapPtr += incrAfterRow;
+			Ay += 10;
+		}
+
+		occupiedMinDist = occupiedMinDistInt * constDist2DiscrUnits_INV ;
+	}
+
+	if (likelihoodOptions.LF_useSquareDist)
+		occupiedMinDist*=occupiedMinDist;
+
+	return zRandomTerm  + likelihoodOptions.LF_zHit * exp( Q * occupiedMinDist );
+}
+
+#define LIK_LF_CACHE_INVALID    (66)
+
 /*---------------------------------------------------------------
 					computeLikelihoodField_Thrun
  ---------------------------------------------------------------*/
@@ -502,7 +638,6 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 
 	double		ret;
 	size_t		N = pm->size();
-	int		K = (int)ceil(likelihoodOptions.LF_maxCorrsDistance/*m*/ / resolution);	// The size of the checking area for matchings:
 
 	bool		Product_T_OrSum_F = !likelihoodOptions.LF_alternateAverageMethod;
 
@@ -511,15 +646,17 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 		return -100; // No way to estimate this likelihood!!
 	}
 
+	if (likelihoodOptions.LF_useDistanceTransform)
+		updateDistanceTransform(likelihoodOptions.LF_maxCorrsDistance);
+
 	// Compute the likelihoods for each point:
 	ret = 0;
 
-	float		stdHit	= likelihoodOptions.LF_stdHit;
 	float		zHit	= likelihoodOptions.LF_zHit;
 	float		zRandom	= likelihoodOptions.LF_zRandom;
 	float		zRandomMaxRange	= likelihoodOptions.LF_maxRange;
 	float		zRandomTerm = zRandom / zRandomMaxRange;
-	float		Q = -0.5f / square(stdHit);
+	float		Q = -0.5f / square(likelihoodOptions.LF_stdHit);
 	int			M = 0;
 
 	unsigned int	size_x_1 = size_x-1;
@@ -530,31 +667,23 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 	double		maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
 	double		minimumLik = zRandomTerm  + zHit * exp( Q * maxCorrDist_sq );
 	double		ccos,ssin;
-	float		occupiedMinDist;
-
-#define LIK_LF_CACHE_INVALID    (66)
 
     if (likelihoodOptions.enableLikelihoodCache)
     {
         // Reset the precomputed likelihood values map
-        if (precomputedLikelihoodToBeRecomputed)
+        if (precomputedLikelihoodToBeRecomputed || precomputedLikelihood.size()!=map.size())
         {
 			if (!map.empty())
 					precomputedLikelihood.assign( map.size(),LIK_LF_CACHE_INVALID);
 			else	precomputedLikelihood.clear();
+			precomputedLogLikelihood.clear();
 
 			precomputedLikelihoodToBeRecomputed = false;
         }
     }
 
-	cellType	thresholdCellValue = p2l(0.5f);
 	int			decimation = likelihoodOptions.LF_decimation;
 
-	const double _resolution = this->resolution;
-	const double constDist2DiscrUnits = 100 / (_resolution * _resolution);
-	const double constDist2DiscrUnits_INV = 1.0 / constDist2DiscrUnits;
-
-
 	if (N<10) decimation = 1;
 
 	TPoint2D	pointLocal;
@@ -562,9 +691,6 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 
 	for (size_t j=0;j<N;j+= decimation)
 	{
-
-		occupiedMinDist = maxCorrDist_sq; // The max.distance
-
 		// Get the point and pass it to global coordinates:
 		if (relativePose)
 		{
@@ -606,50 +732,7 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 			if (!likelihoodOptions.enableLikelihoodCache || thisLik==LIK_LF_CACHE_INVALID )
 			{
 				// Compute now:
-				// -------------
-				// Find the closest occupied cell in a certain range, given by K:
-				int xx1 = max(0,cx-K);
-				int xx2 = min(size_x_1,(unsigned)(cx+K));
-				int yy1 = max(0,cy-K);
-				int yy2 = min(size_y_1,(unsigned)(cy+K));
-
-				// Optimized code: this part will be invoked a *lot* of times:
-				{
-					cellType  *mapPtr  = &map[xx1+yy1*size_x]; // Initial pointer position
-					unsigned   incrAfterRow = size_x - ((xx2-xx1)+1);
-
-					signed int Ax0 = 10*(xx1-cx);
-					signed int Ay  = 10*(yy1-cy);
-
-					unsigned int occupiedMinDistInt = mrpt::utils::round( maxCorrDist_sq * constDist2DiscrUnits );
-
-					for (int yy=yy1;yy<=yy2;yy++)
-					{
-						unsigned int Ay2 = square((unsigned int)(Ay)); // Square is faster with unsigned.
-						signed short Ax=Ax0;
-						cellType  cell;
-
-						for (int xx=xx1;xx<=xx2;xx++)
-						{
-							if ( (cell =*mapPtr++) < thresholdCellValue )
-							{
-								unsigned int d = square((unsigned int)(Ax)) + Ay2;
-								keep_min(occupiedMinDistInt, d);
-							}
-							Ax += 10;
-						}
-						// Go to (xx1,yy++)
-						mapPtr += incrAfterRow;
-						Ay += 10;
-					}
-
-					occupiedMinDist = occupiedMinDistInt * constDist2DiscrUnits_INV ;
-				}
-
-				if (likelihoodOptions.LF_useSquareDist)
-					occupiedMinDist*=occupiedMinDist;
-
-				thisLik = zRandomTerm  + zHit * exp( Q * occupiedMinDist );
+				thisLik = computeLikelihoodField_Thrun_cell(cx,cy);
 
                 if (likelihoodOptions.enableLikelihoodCache)
                     // And save it into the table and into "thisLik":
@@ -677,6 +760,166 @@ double	 COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap	*pm,
 	MRPT_END
 }
 
+/*---------------------------------------------------------------
+				computeLikelihoodField_Thrun (batch)
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::computeLikelihoodField_Thrun( const CPointsMap *pm, const std::vector<TPose2D> &relativePoses, std::vector<double> &out_log_liks )
+{
+	MRPT_START
+
+	const size_t nPoses = relativePoses.size();
+	const size_t N = pm->size();
+	out_log_liks.resize(nPoses);
+
+	if (!N)
+	{
+		out_log_liks.assign(nPoses, -100); // No way to estimate this likelihood!!
+		return;
+	}
+	if (likelihoodOptions.LF_alternateAverageMethod || map.empty())
+	{
+		for (size_t i=0;i<nPoses;i++)
+		{
+			const CPose2D p(relativePoses[i]);
+			out_log_liks[i] = computeLikelihoodField_Thrun(pm,&p);
+		}
+		return;
+	}
+
+	if (likelihoodOptions.LF_useDistanceTransform)
+		updateDistanceTransform(likelihoodOptions.LF_maxCorrsDistance);
+
+	// Reset the precomputed log-likelihood values map:
+	if (precomputedLikelihoodToBeRecomputed || precomputedLogLikelihood.size()!=map.size())
+	{
+		precomputedLogLikelihood.assign(map.size(), LIK_LF_CACHE_INVALID);
+		if (precomputedLikelihoodToBeRecomputed)
+		{
+			precomputedLikelihood.clear(); // Will be re-created by the non-batch method, if needed.
+			precomputedLikelihoodToBeRecomputed = false;
+		}
+	}
+
+	// Extract the decimated points only once for all the poses:
+	size_t decimation = likelihoodOptions.LF_decimation;
+	if (N<10 || !decimation) decimation = 1;
+	const size_t nPts = (N + decimation - 1) / decimation;
+
+	const std::vector<float> &pm_xs = pm->getPointsBufferRef_x();
+	const std::vector<float> &pm_ys = pm->getPointsBufferRef_y();
+	std::vector<float> xs(nPts), ys(nPts);
+	for (size_t i=0,j=0;i<nPts;i++,j+=decimation)
+	{
+		xs[i] = pm_xs[j];
+		ys[i] = pm_ys[j];
+	}
+
+	const float Q = -0.5f / square(likelihoodOptions.LF_stdHit);
+	const float zRandomTerm = likelihoodOptions.LF_zRandom / likelihoodOptions.LF_maxRange;
+	const float minimumLogLik = static_cast<float>( log( zRandomTerm + likelihoodOptions.LF_zHit * exp( Q * square(likelihoodOptions.LF_maxCorrsDistance) ) ) );
+
+	const unsigned int size_x_1 = size_x-1;
+	const unsigned int size_y_1 = size_y-1;
+	const float invResolution = 1.0f / resolution;
+	float *logLikTable = &precomputedLogLikelihood[0];
+
+	// Log-likelihood of one cell, outside of the map or not, filling the cache if needed:
+	auto cellLogLik = [&](int cx, int cy) -> float
+	{
+		if ( static_cast<unsigned>(cx)>=size_x_1 || static_cast<unsigned>(cy)>=size_y_1 )
+			return minimumLogLik;
+		float &v = logLikTable[ cx+cy*size_x ];
+		if (v==LIK_LF_CACHE_INVALID)
+			v = static_cast<float>( log( computeLikelihoodField_Thrun_cell(cx,cy) ) );
+		return v;
+	};
+
+	for (size_t k=0;k<nPoses;k++)
+	{
+		const TPose2D &pose = relativePoses[k];
+		// Fold the map origin and the resolution into the transformation, so cell indices
+		// are computed directly from the local coordinates of points:
+		const float ccos = static_cast<float>(cos(pose.phi)) * invResolution;
+		const float ssin = static_cast<float>(sin(pose.phi)) * invResolution;
+		const float ox = static_cast<float>( (pose.x - x_min) * invResolution );
+		const float oy = static_cast<float>( (pose.y - y_min) * invResolution );
+
+		double ret = 0;
+		size_t i = 0;
+
+#if defined(__AVX2__)
+		{
+			const __m256 cos_8val = _mm256_set1_ps(ccos), sin_8val = _mm256_set1_ps(ssin);
+			const __m256 ox_8val = _mm256_set1_ps(ox), oy_8val = _mm256_set1_ps(oy);
+			const __m256 outside_8val = _mm256_set1_ps(minimumLogLik);
+			const __m256 invalid_8val = _mm256_set1_ps(LIK_LF_CACHE_INVALID);
+			const __m256i minus1 = _mm256_set1_epi32(-1);
+			const __m256i sx_8val = _mm256_set1_epi32(size_x), sx1_8val = _mm256_set1_epi32(size_x_1), sy1_8val = _mm256_set1_epi32(size_y_1);
+			__m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+
+			for ( ; i+8<=nPts; i+=8)
+			{
+				const __m256 px = _mm256_loadu_ps(&xs[i]);
+				const __m256 py = _mm256_loadu_ps(&ys[i]);
+				const __m256i cxs = _mm256_cvttps_epi32( _mm256_add_ps(ox_8val, _mm256_sub_ps( _mm256_mul_ps(px,cos_8val), _mm256_mul_ps(py,sin_8val) ) ) );
+				const __m256i cys = _mm256_cvttps_epi32( _mm256_add_ps(oy_8val, _mm256_add_ps( _mm256_mul_ps(px,sin_8val), _mm256_mul_ps(py,cos_8val) ) ) );
+				const __m256i inside = _mm256_and_si256(
+					_mm256_and_si256( _mm256_cmpgt_epi32(cxs,minus1), _mm256_cmpgt_epi32(sx1_8val,cxs) ),
+					_mm256_and_si256( _mm256_cmpgt_epi32(cys,minus1), _mm256_cmpgt_epi32(sy1_8val,cys) ) );
+				const __m256i idxs = _mm256_add_epi32(cxs, _mm256_mullo_epi32(cys,sx_8val));
+				__m256 vals = _mm256_mask_i32gather_ps(outside_8val, logLikTable, idxs, _mm256_castsi256_ps(inside), 4);
+
+				// Fill the cache for cells not evaluated yet:
+				if (_mm256_movemask_ps(_mm256_cmp_ps(vals,invalid_8val,_CMP_EQ_OQ)))
+				{
+					MRPT_ALIGN32 int cx_arr[8], cy_arr[8];
+					MRPT_ALIGN32 float val_arr[8];
+					_mm256_store_si256(reinterpret_cast<__m256i*>(cx_arr), cxs);
+					_mm256_store_si256(reinterpret_cast<__m256i*>(cy_arr), cys);
+					_mm256_store_ps(val_arr, vals);
+					for (int l=0;l<8;l++)
+						if (val_arr[l]==LIK_LF_CACHE_INVALID)
+							val_arr[l] = cellLogLik(cx_arr[l],cy_arr[l]);
+					vals = _mm256_load_ps(val_arr);
+				}
+				acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm256_castps256_ps128(vals)));
+				acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm256_extractf128_ps(vals,1)));
+			}
+			MRPT_ALIGN32 double acc_arr[4];
+			_mm256_store_pd(acc_arr, _mm256_add_pd(acc0,acc1));
+			ret += (acc_arr[0]+acc_arr[1]) + (acc_arr[2]+acc_arr[3]);
+		}
+#endif
+#if MRPT_HAS_SSE2
+		{
+			const __m128 cos_4val = _mm_set1_ps(ccos), sin_4val = _mm_set1_ps(ssin);
+			const __m128 ox_4val = _mm_set1_ps(ox), oy_4val = _mm_set1_ps(oy);
+			MRPT_ALIGN16 int cx_arr[4], cy_arr[4];
+
+			for ( ; i+4<=nPts; i+=4)
+			{
+				const __m128 px = _mm_loadu_ps(&xs[i]);
+				const __m128 py = _mm_loadu_ps(&ys[i]);
+				_mm_store_si128(reinterpret_cast<__m128i*>(cx_arr), _mm_cvttps_epi32( _mm_add_ps(ox_4val, _mm_sub_ps( _mm_mul_ps(px,cos_4val), _mm_mul_ps(py,sin_4val) ) ) ) );
+				_mm_store_si128(reinterpret_cast<__m128i*>(cy_arr), _mm_cvttps_epi32( _mm_add_ps(oy_4val, _mm_add_ps( _mm_mul_ps(px,sin_4val), _mm_mul_ps(py,cos_4val) ) ) ) );
+				ret += (cellLogLik(cx_arr[0],cy_arr[0]) + cellLogLik(cx_arr[1],cy_arr[1])) + (cellLogLik(cx_arr[2],cy_arr[2]) + cellLogLik(cx_arr[3],cy_arr[3]));
+			}
+		}
+#endif
+		// Remaining points (or all of them, without SSE2):
+		for ( ; i<nPts; i++)
+		{
+			const int cx = static_cast<int>( ox + (xs[i]*ccos - ys[i]*ssin) );
+			const int cy = static_cast<int>( oy + (xs[i]*ssin + ys[i]*ccos) );
+			ret += cellLogLik(cx,cy);
+		}
+
+		out_log_liks[k] = ret;
+	}
+
+	MRPT_END
+}
+
 /*---------------------------------------------------------------
 					computeLikelihoodField_II
  ---------------------------------------------------------------*/
@@ -788,6 +1031,7 @@ COccupancyGridMap2D::TLikelihoodOptions::TLikelihoodOptions() :
 	LF_maxCorrsDistance				( 0.3f ),
 	LF_useSquareDist				( false ),
 	LF_alternateAverageMethod		( false ),
+	LF_useDistanceTransform			( false ),
 
 	MI_exponent						( 2.5f ),
 	MI_skip_rays					( 10 ),
@@ -824,6 +1068,7 @@ void  COccupancyGridMap2D::TLikelihoodOptions::loadFromConfigFile(
 	LF_maxCorrsDistance					= iniFile.read_float(section,"LF_maxCorrsDistance",LF_maxCorrsDistance);
 	LF_useSquareDist					= iniFile.read_bool(section,"LF_useSquareDist",LF_useSquareDist);
 	LF_alternateAverageMethod			= iniFile.read_bool(section,"LF_alternateAverageMethod",LF_alternateAverageMethod);
+	LF_useDistanceTransform				= iniFile.read_bool(section,"LF_useDistanceTransform",LF_useDistanceTransform);
 
 	MI_exponent							= iniFile.read_float(section,"MI_exponent",MI_exponent);
 	MI_skip_rays						= iniFile.read_int(section,"MI_skip_rays",MI_skip_rays);
@@ -870,6 +1115,7 @@ void  COccupancyGridMap2D::TLikelihoodOptions::dumpToTextStream(mrpt::utils::CSt
 	out.printf("LF_maxCorrsDistance                     = %f\n",	LF_maxCorrsDistance );
 	out.printf("LF_useSquareDist                        = %c\n",	LF_useSquareDist ? 'Y':'N');
 	out.printf("LF_alternateAverageMethod               = %c\n",	LF_alternateAverageMethod ? 'Y':'N');
+	out.printf("LF_useDistanceTransform                 = %c\n",	LF_useDistanceTransform ? 'Y':'N');
 	out.printf("MI_exponent                             = %f\n",	MI_exponent );
 	out.printf("MI_skip_rays                            = %u\n",	MI_skip_rays );
 	out.printf("MI_ratio_max_distance                   = %f\n",	MI_ratio_max_distance );
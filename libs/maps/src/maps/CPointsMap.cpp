@@ -289,15 +289,18 @@ void  CPointsMap::clipOutOfRangeInZ(float zMin, float zMax)
  ---------------------------------------------------------------*/
 void  CPointsMap::clipOutOfRange(const TPoint2D	&p, float maxRange)
 {
-	size_t			i,n=size();
-	vector<bool>	deletionMask;
+	const size_t	n=size();
+	vector<bool>	deletionMask(n);
 
-	// The deletion mask:
-	deletionMask.resize(n);
+	// 2D squared distances (z=NULL) of all the points to "p":
+	vector<float>	dist2(n);
+	const TConstPointCloudSpan pts = getPointsSpan();
+	mrpt::math::squaredDistancesToPoint( TConstPointCloudSpan(pts.x,pts.y,NULL,n), TPoint3Df(p.x,p.y,0), n ? &dist2[0] : NULL );
 
-	// Compute it:
-	for (i=0;i<n;i++)
-		deletionMask[i] = std::sqrt( square(p.x-x[i]) + square(p.y-y[i])) > maxRange;
+	// The deletion mask:
+	const float maxRange2 = square(maxRange);
+	for (size_t i=0;i<n;i++)
+		deletionMask[i] = dist2[i] > maxRange2;
 
 	// Perform deletion:
 	applyDeletionMask(deletionMask);
@@ -558,15 +561,11 @@ void CPointsMap::determineMatching2D(
  ---------------------------------------------------------------*/
 void  CPointsMap::changeCoordinatesReference(const CPose2D	&newBase)
 {
-	const size_t N = x.size();
-
-	const CPose3D	newBase3D(newBase);
-
-	for (size_t i=0;i<N;i++)
-		newBase3D.composePoint(
-			x[i],y[i],z[i],  // In
-			x[i],y[i],z[i]   // Out
-		);
+	if (!x.empty())
+	{
+		const TPointCloudSpan pts(&x[0],&y[0],&z[0],x.size());
+		mrpt::math::transformPoints(newBase, pts, pts);  // In-place
+	}
 
 	mark_as_modified();
 }
@@ -576,13 +575,11 @@ void  CPointsMap::changeCoordinatesReference(const CPose2D	&newBase)
  ---------------------------------------------------------------*/
 void  CPointsMap::changeCoordinatesReference(const CPose3D	&newBase)
 {
-	const size_t N = x.size();
-
-	for (size_t i=0;i<N;i++)
-		newBase.composePoint(
-			x[i],y[i],z[i],  // In
-			x[i],y[i],z[i]   // Out
-		);
+	if (!x.empty())
+	{
+		const TPointCloudSpan pts(&x[0],&y[0],&z[0],x.size());
+		mrpt::math::transformPoints(newBase, pts, pts);  // In-place
+	}
 
 	mark_as_modified();
 }
@@ -789,12 +786,12 @@ float  CPointsMap::getLargestDistanceFromOrigin() const
 	if (!m_largestDistanceFromOriginIsUpdated)
 	{
 		// NO: Update it:
-		vector<float>::const_iterator    X,Y,Z;
-		float	maxDistSq = 0, d;
-		for (X=x.begin(),Y=y.begin(),Z=z.begin();X!=x.end();++X,++Y,++Z)
+		float	maxDistSq = 0;
+		if (!x.empty())
 		{
-			d = square(*X)+square(*Y)+square(*Z);
-			maxDistSq = max( d, maxDistSq );
+			vector<float> dist2(x.size());
+			mrpt::math::squaredDistancesToPoint( getPointsSpan(), TPoint3Df(0,0,0), &dist2[0] );
+			maxDistSq = *std::max_element(dist2.begin(),dist2.end());
 		}
 
 		m_largestDistanceFromOrigin = sqrt( maxDistSq );
@@ -903,97 +900,11 @@ void CPointsMap::boundingBox(
 		}
 		else
 		{
-#if MRPT_HAS_SSE2
-			// Vectorized version: ~ 9x times faster
-
-			// Number of 4-floats:
-			size_t nPackets = nPoints/4;
-			if ( (nPoints & 0x03)!=0) nPackets++;
-
-			// Pad with zeros to make sure we have a number of points multiple of 4
-			size_t nPoints_4align = nPoints;
-			size_t nExtraPad = 0;
-			if (0!=(nPoints & 0x03))
-			{
-				nExtraPad = 4 - (nPoints & 0x03);
-				nPoints_4align+=nExtraPad;
-			}
-
-			// We'll assume that the real allocated memory in the source buffers at least have room for a maximum
-			//  of 3 more floats, and pad with zeroes there (yeah, fuck correct-constness....)
-			// JLBC OCT/2016: resize() methods in maps have been modified to enforce capacities to be 4*N by design,
-			// but will leave this code here just in case (for some edge cases?)
-			if ( x.capacity()<nPoints_4align ||
-				 y.capacity()<nPoints_4align ||
-				 z.capacity()<nPoints_4align )
-			{
-				// This will happen perhaps...once in a lifetime? Anyway:
-				const_cast<vector<float>*>(&x)->reserve(nPoints_4align+16);
-				const_cast<vector<float>*>(&y)->reserve(nPoints_4align+16);
-				const_cast<vector<float>*>(&z)->reserve(nPoints_4align+16);
-			}
-
-			if (nExtraPad)
-			{
-				float *ptr_in_x = const_cast<float*>(&x[0]);
-				float *ptr_in_y = const_cast<float*>(&y[0]);
-				float *ptr_in_z = const_cast<float*>(&z[0]);
-				for (size_t k=nExtraPad;k; k--) {
-					ptr_in_x[nPoints+k-1]=0;
-					ptr_in_y[nPoints+k-1]=0;
-					ptr_in_z[nPoints+k-1]=0;
-				}
-			}
-
-			// For the bounding box:
-			__m128 x_mins = _mm_set1_ps( std::numeric_limits<float>::max() );
-			__m128 x_maxs = _mm_set1_ps( std::numeric_limits<float>::min() );
-			__m128 y_mins = x_mins, y_maxs = x_maxs;
-			__m128 z_mins = x_mins, z_maxs = x_maxs;
-
-			const float *ptr_in_x = &this->x[0];
-			const float *ptr_in_y = &this->y[0];
-			const float *ptr_in_z = &this->z[0];
-
-			for( ; nPackets; nPackets--, ptr_in_x+=4, ptr_in_y+=4, ptr_in_z+=4 )
-			{
-				const __m128 xs = _mm_loadu_ps(ptr_in_x); // *Unaligned* load
-				x_mins = _mm_min_ps(x_mins,xs); x_maxs = _mm_max_ps(x_maxs,xs);
-
-				const __m128 ys = _mm_loadu_ps(ptr_in_y);
-				y_mins = _mm_min_ps(y_mins,ys); y_maxs = _mm_max_ps(y_maxs,ys);
-
-				const __m128 zs = _mm_loadu_ps(ptr_in_z);
-				z_mins = _mm_min_ps(z_mins,zs); z_maxs = _mm_max_ps(z_maxs,zs);
-			}
-
-			// Recover the min/max:
-			MRPT_ALIGN16 float temp_nums[4];
-
-			_mm_store_ps(temp_nums, x_mins); m_bb_min_x=min(min(temp_nums[0],temp_nums[1]),min(temp_nums[2],temp_nums[3]));
-			_mm_store_ps(temp_nums, y_mins); m_bb_min_y=min(min(temp_nums[0],temp_nums[1]),min(temp_nums[2],temp_nums[3]));
-			_mm_store_ps(temp_nums, z_mins); m_bb_min_z=min(min(temp_nums[0],temp_nums[1]),min(temp_nums[2],temp_nums[3]));
-			_mm_store_ps(temp_nums, x_maxs); m_bb_max_x=max(max(temp_nums[0],temp_nums[1]),max(temp_nums[2],temp_nums[3]));
-			_mm_store_ps(temp_nums, y_maxs); m_bb_max_y=max(max(temp_nums[0],temp_nums[1]),max(temp_nums[2],temp_nums[3]));
-			_mm_store_ps(temp_nums, z_maxs); m_bb_max_z=max(max(temp_nums[0],temp_nums[1]),max(temp_nums[2],temp_nums[3]));
-
-#else
-			// Non vectorized version:
-			m_bb_min_x =
-			m_bb_min_y =
-			m_bb_min_z = (std::numeric_limits<float>::max)();
-
-			m_bb_max_x =
-			m_bb_max_y =
-			m_bb_max_z = -(std::numeric_limits<float>::max)();
-
-			for (vector<float>::const_iterator xi=x.begin(), yi=y.begin(), zi=z.begin(); xi!=x.end();xi++,yi++,zi++)
-			{
-				m_bb_min_x = min( m_bb_min_x, *xi ); m_bb_max_x = max( m_bb_max_x, *xi );
-				m_bb_min_y = min( m_bb_min_y, *yi ); m_bb_max_y = max( m_bb_max_y, *yi );
-				m_bb_min_z = min( m_bb_min_z, *zi ); m_bb_max_z = max( m_bb_max_z, *zi );
-			}
-#endif
+			TPoint3Df bbMin, bbMax;
+			mrpt::math::boundingBox( getPointsSpan(), bbMin, bbMax );
+			m_bb_min_x = bbMin.x; m_bb_max_x = bbMax.x;
+			m_bb_min_y = bbMin.y; m_bb_max_y = bbMax.y;
+			m_bb_min_z = bbMin.z; m_bb_max_z = bbMax.z;
 
 		}
 		m_boundingBoxIsUpdated = true;
@@ -1031,10 +942,6 @@ void  CPointsMap::determineMatching3D(
 	size_t					_sumSqrCount = 0;
 	size_t					nOtherMapPointsWithCorrespondence = 0;	// Number of points with one corrs. at least
 
-	float local_x_min= std::numeric_limits<float>::max(), local_x_max= -std::numeric_limits<float>::max();
-	float local_y_min= std::numeric_limits<float>::max(), local_y_max= -std::numeric_limits<float>::max();
-	float local_z_min= std::numeric_limits<float>::max(), local_z_max= -std::numeric_limits<float>::max();
-
 	double					maxDistForCorrespondenceSquared;
 
 
@@ -1048,29 +955,29 @@ void  CPointsMap::determineMatching3D(
 	// Empty maps?  Nothing to do
 	if (!nGlobalPoints || !nLocalPoints) return;
 
-	// Try to do matching only if the bounding boxes have some overlap:
-	// Transform all local points:
-	vector<float> x_locals(nLocalPoints), y_locals(nLocalPoints), z_locals(nLocalPoints);
+	// Points of the local map to be matched: localIdx = offset + i * decimation
+	const size_t offset = params.offset_other_map_points, decimation = params.decimation_other_map_points;
+	if (offset>=nLocalPoints) return;
+	const size_t nUsedPoints = (nLocalPoints-offset+decimation-1)/decimation;
 
-	for (unsigned int localIdx=params.offset_other_map_points;localIdx<nLocalPoints;localIdx+=params.decimation_other_map_points)
+	// Try to do matching only if the bounding boxes have some overlap:
+	// Transform the used local points (packed first, if decimated, to use the vectorized kernel), and find their bounding box:
+	vector<float> x_locals(nUsedPoints), y_locals(nUsedPoints), z_locals(nUsedPoints);
+	const TPointCloudSpan localPts(&x_locals[0],&y_locals[0],&z_locals[0],nUsedPoints);
+	if (decimation==1)
+		mrpt::math::transformPoints(otherMapPose, otherMap->getPointsSpan(), localPts);
+	else
 	{
-		float x_local,y_local,z_local;
-		otherMapPose.composePoint(
-			otherMap->x[localIdx], otherMap->y[localIdx], otherMap->z[localIdx],
-			x_local,y_local,z_local );
-
-		x_locals[localIdx] = x_local;
-		y_locals[localIdx] = y_local;
-		z_locals[localIdx] = z_local;
-
-		// Find the bounding box:
-		local_x_min = min(local_x_min,x_local);
-		local_x_max = max(local_x_max,x_local);
-		local_y_min = min(local_y_min,y_local);
-		local_y_max = max(local_y_max,y_local);
-		local_z_min = min(local_z_min,z_local);
-		local_z_max = max(local_z_max,z_local);
+		for (size_t i=0, localIdx=offset;i<nUsedPoints;i++, localIdx+=decimation)
+		{
+			x_locals[i] = otherMap->x[localIdx];
+			y_locals[i] = otherMap->y[localIdx];
+			z_locals[i] = otherMap->z[localIdx];
+		}
+		mrpt::math::transformPoints(otherMapPose, localPts, localPts);
 	}
+	TPoint3Df local_min, local_max;
+	mrpt::math::boundingBox(localPts, local_min, local_max);
 
 	// Find the bounding box:
 	float global_x_min, global_x_max, global_y_min, global_y_max, global_z_min, global_z_max;
@@ -1081,19 +988,21 @@ void  CPointsMap::determineMatching3D(
 
 	// Solo hacer matching si existe alguna posibilidad de que
 	//  los dos mapas se toquen:
-	if (local_x_min>global_x_max ||
-		local_x_max<global_x_min ||
-		local_y_min>global_y_max ||
-		local_y_max<global_y_min) return;	// No need to compute: matching is ZERO.
+	if (local_min.x>global_x_max ||
+		local_max.x<global_x_min ||
+		local_min.y>global_y_max ||
+		local_max.y<global_y_min) return;	// No need to compute: matching is ZERO.
 
 	// Loop for each point in local map:
 	// --------------------------------------------------
-	for (unsigned int localIdx=params.offset_other_map_points; localIdx<nLocalPoints; localIdx+=params.decimation_other_map_points)
+	for (size_t i=0;i<nUsedPoints;i++)
 	{
+		const size_t localIdx = offset + i*decimation;
+
 		// For speed-up:
-		const float x_local = x_locals[localIdx];
-		const float y_local = y_locals[localIdx];
-		const float z_local = z_locals[localIdx];
+		const float x_local = x_locals[i];
+		const float y_local = y_locals[i];
+		const float z_local = z_locals[i];
 
 		{
 			// KD-TREE implementation
@@ -1547,7 +1456,7 @@ void  CPointsMap::addFrom(const CPointsMap &anotherMap)
 	// Also copy other data fields (color, ...)
 	addFrom_classSpecific(anotherMap,nThis);
 
-	mark_as_modified();
+	mark_as_modified(nThis);
 }
 
 /** Save the point cloud as a PCL PCD file, in either ASCII or binary format \return false on any error */
@@ -1625,25 +1534,15 @@ void  CPointsMap::insertAnotherMap(
 	// Set the new size:
 	this->resize( N_this + N_other );
 
-	mrpt::math::TPoint3Df pt;
-	size_t src,dst;
-	for (src=0, dst=N_this; src<N_other; src++, dst++)
-	{
-		// Load the next point:
-		otherMap->getPointFast(src,pt.x,pt.y,pt.z);
-
-		// Translation:
-		double gx,gy,gz;
-		otherPose.composePoint(pt.x,pt.y,pt.z,  gx,gy,gz);
-
-		// Add to this map:
-		this->setPointFast(dst,gx,gy,gz);
-	}
+	// Transform all the points at once, right into their final place:
+	if (N_other)
+		mrpt::math::transformPoints(otherPose, otherMap->getPointsSpan(),
+			TPointCloudSpan(&x[N_this],&y[N_this],&z[N_this],N_other) );
 
 	// Also copy other data fields (color, ...)
 	addFrom_classSpecific(*otherMap, N_this);
 
-	mark_as_modified();
+	mark_as_modified(N_this);
 }
 
 
@@ -1700,7 +1599,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservation2DRangeScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_modified(this->size()); // New points are appended. Fusing or deleting points below marks all of them.
 
 		const CObservation2DRangeScan *o = static_cast<const CObservation2DRangeScan *>(obs);
 		// Insert only HORIZONTAL scans??
@@ -1784,7 +1683,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservation3DRangeScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_modified(this->size());
 
 		const CObservation3DRangeScan *o = static_cast<const CObservation3DRangeScan *>(obs);
 		// Insert only HORIZONTAL scans??
@@ -1843,7 +1742,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservationRange  (IRs, Sonars, etc.)
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_modified(this->size());
 
 		const CObservationRange* o = static_cast<const CObservationRange*>(obs);
 
@@ -1886,7 +1785,7 @@ bool  CPointsMap::internal_insertObservation(
 		/********************************************************************
 					OBSERVATION TYPE: CObservationVelodyneScan
 		 ********************************************************************/
-		mark_as_modified();
+		mark_as_modified(this->size());
 
 		const CObservationVelodyneScan *o = static_cast<const CObservationVelodyneScan *>(obs);
 
@@ -1960,6 +1859,36 @@ void  CPointsMap::fuseWith(
 	// Speeds-up possible memory reallocations:
 	reserve( x.size() + nOther );
 
+	// Closest correspondence of each point in the other map, in a single pass over the list:
+	// ------------------------------------------------------------------------------------------
+	const size_t nCorrs = correspondences.size();
+	vector<float> corrDist2(nCorrs);
+	if (nCorrs)
+	{
+		vector<float> cx_this(nCorrs), cy_this(nCorrs), cz_this(nCorrs), cx_other(nCorrs), cy_other(nCorrs), cz_other(nCorrs);
+		for (size_t k=0;k<nCorrs;k++)
+		{
+			const TMatchingPair &c = correspondences[k];
+			cx_this[k] = c.this_x;   cy_this[k] = c.this_y;   cz_this[k] = c.this_z;
+			cx_other[k] = c.other_x; cy_other[k] = c.other_y; cz_other[k] = c.other_z;
+		}
+		mrpt::math::squaredDistances(
+			TConstPointCloudSpan(&cx_other[0],&cy_other[0],&cz_other[0],nCorrs),
+			TConstPointCloudSpan(&cx_this[0],&cy_this[0],&cz_this[0],nCorrs),
+			&corrDist2[0]);
+	}
+	vector<int>   closestCorrs(nOther, -1);
+	vector<float> closestCorrsDist2(nOther, std::numeric_limits<float>::max());
+	for (size_t k=0;k<nCorrs;k++)
+	{
+		const TMatchingPair &c = correspondences[k];
+		if (c.other_idx<nOther && corrDist2[k]<closestCorrsDist2[c.other_idx])
+		{
+			closestCorrsDist2[c.other_idx] = corrDist2[k];
+			closestCorrs[c.other_idx] = c.this_idx;
+		}
+	}
+
 	// Merge matched points from both maps:
 	//  AND add new points which have been not matched:
 	// -------------------------------------------------
@@ -1967,23 +1896,8 @@ void  CPointsMap::fuseWith(
 	{
 		const unsigned long	w_a = otherMap->getPoint(i,a);	// Get "local" point into "a"
 
-		// Find closest correspondence of "a":
-		int			closestCorr = -1;
-		float		minDist	= std::numeric_limits<float>::max();
-		for (TMatchingPairList::const_iterator corrsIt = correspondences.begin(); corrsIt!=correspondences.end(); ++corrsIt)
-		{
-			if (corrsIt->other_idx==i)
-			{
-				float	dist = square( corrsIt->other_x - corrsIt->this_x ) +
-							   square( corrsIt->other_y - corrsIt->this_y ) +
-							   square( corrsIt->other_z - corrsIt->this_z );
-				if (dist<minDist)
-				{
-					minDist = dist;
-					closestCorr = corrsIt->this_idx;
-				}
-			}
-		} // End of for each correspondence...
+		// Closest correspondence of "a":
+		const int closestCorr = closestCorrs[i];
 
 		if (closestCorr!=-1)
 		{	// Merge:		FUSION
@@ -2023,7 +1937,7 @@ void CPointsMap::loadFromVelodyneScan(
 	if (scan.point_cloud.x.empty())
 		return;
 
-	this->mark_as_modified();
+	this->mark_as_modified(this->size()); // New points are appended at the end, unless the map is cleared below.
 
 	// Insert vs. load and replace:
 	if (!insertionOptions.addToExistingPointsMap)
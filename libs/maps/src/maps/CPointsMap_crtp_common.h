@@ -31,7 +31,7 @@ namespace detail
 			using namespace mrpt::poses;
 			using mrpt::math::square;
 			using mrpt::utils::DEG2RAD;
-			obj.mark_as_modified();
+			obj.mark_as_modified(obj.x.size()); // New points are appended at the end, unless the map is cleared below.
 
 			// If robot pose is supplied, compute sensor pose relative to it.
 			CPose3D sensorPose3D(UNINITIALIZED_POSE);
@@ -304,7 +304,7 @@ namespace detail
 		{
 			using namespace mrpt::poses;
 			using mrpt::math::square;
-			obj.mark_as_modified();
+			obj.mark_as_modified(obj.x.size()); // New points are appended at the end, unless the map is cleared below.
 
 			// If robot pose is supplied, compute sensor pose relative to it.
 			CPose3D sensorPose3D(UNINITIALIZED_POSE);
@@ -0,0 +1,139 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h" // Precomp header
+
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <Eigen/Eigenvalues>
+
+using namespace mrpt;
+using namespace mrpt::maps;
+using namespace mrpt::math;
+using namespace std;
+
+namespace
+{
+	// Variance along the normal of the regularized covariances, relative to the unit variance along the surface (as in the GICP paper):
+	const float GICP_EPSILON = 1e-3f;
+
+	/** Estimates the normal and regularized covariance of points `[first+i0,first+i1)`, with DIM=2 or 3 */
+	template <int DIM>
+	struct TLocalGeometryTask : public mrpt::system::CWorkerThreadsPool::TRangeTask
+	{
+		TLocalGeometryTask(const CPointsMap &map_, size_t first_, size_t nNeighbors_, float *normals_, float *cov_) :
+			map(map_), first(first_), nNeighbors(nNeighbors_), normals(normals_), cov(cov_)
+		{ }
+
+		const CPointsMap &map;
+		const size_t first, nNeighbors;
+		float *normals, *cov;
+
+		void operator()(size_t i0, size_t i1) const MRPT_OVERRIDE
+		{
+			typedef Eigen::Matrix<float,DIM,1>   vector_t;
+			typedef Eigen::Matrix<float,DIM,DIM> matrix_t;
+			const size_t COV_LEN = DIM*(DIM+1)/2;
+
+			const TConstPointCloudSpan pts = map.getPointsSpan();
+			std::vector<size_t> idxs;
+			std::vector<float>  dists;
+			Eigen::SelfAdjointEigenSolver<matrix_t> eig;
+
+			for (size_t k=i0;k<i1;k++)
+			{
+				const size_t i = first+k;
+				if (DIM==2)
+					map.kdTreeNClosestPoint2DIdx(pts.x[i],pts.y[i],nNeighbors,idxs,dists);
+				else
+					map.kdTreeNClosestPoint3DIdx(pts.x[i],pts.y[i],pts.z[i],nNeighbors,idxs,dists);
+
+				const float * const coords[3] = { pts.x, pts.y, pts.z };
+				vector_t mean = vector_t::Zero();
+				for (size_t j=0;j<idxs.size();j++)
+					for (int d=0;d<DIM;d++) mean[d]+=coords[d][idxs[j]];
+				mean/=static_cast<float>(idxs.size());
+
+				matrix_t C = matrix_t::Zero();
+				for (size_t j=0;j<idxs.size();j++)
+				{
+					vector_t v;
+					for (int d=0;d<DIM;d++) v[d]=coords[d][idxs[j]]-mean[d];
+					C.noalias() += v*v.transpose();
+				}
+
+				vector_t n = vector_t::Zero();
+				n[DIM-1] = 1;  // Default for degenerate cases (too few neighbors)
+				if (idxs.size()>=size_t(DIM))
+				{
+					eig.compute(C);
+					if (eig.info()==Eigen::Success)
+						n = eig.eigenvectors().col(0).normalized();  // Eigenvalues are sorted in increasing order
+				}
+
+				// Regularized covariance: unit variance along the surface, epsilon along its normal:
+				const matrix_t Creg = matrix_t::Identity() - (1-GICP_EPSILON)*n*n.transpose();
+
+				float *out_n = normals+k*DIM, *out_c = cov+k*COV_LEN;
+				for (int d=0;d<DIM;d++) out_n[d]=n[d];
+				for (int r=0;r<DIM;r++)
+					for (int c=r;c<DIM;c++)
+						*out_c++ = Creg(r,c);
+			}
+		}
+	};
+
+	template <int DIM>
+	void updateLocalGeometry(const CPointsMap &map, CPointsMap::TLocalGeometry &lg, size_t nNeighbors, mrpt::system::CWorkerThreadsPool *threads)
+	{
+		ASSERT_(nNeighbors>0)
+		const size_t N = map.size();
+		if (lg.dim!=DIM || lg.nNeighbors!=nNeighbors)
+		{
+			lg = CPointsMap::TLocalGeometry();
+			lg.dim = DIM;
+			lg.nNeighbors = nNeighbors;
+		}
+		const size_t nDone = lg.size();
+		if (nDone>=N) return;
+
+		// Only compute the geometry of points not done yet:
+		lg.normals.resize(N*DIM);
+		lg.cov.resize(N*(DIM*(DIM+1)/2));
+		if (DIM==2) map.kdTreeEnsureIndexBuilt2D();
+		else        map.kdTreeEnsureIndexBuilt3D();
+
+		const TLocalGeometryTask<DIM> task(map, nDone, std::min(nNeighbors,N), &lg.normals[nDone*DIM], &lg.cov[nDone*(DIM*(DIM+1)/2)]);
+		if (threads)
+			threads->parallel_for(N-nDone, task, 64);
+		else task(0,N-nDone);
+	}
+}
+
+/*---------------------------------------------------------------
+					getLocalGeometry2D
+ ---------------------------------------------------------------*/
+const CPointsMap::TLocalGeometry & CPointsMap::getLocalGeometry2D(size_t nNeighbors, mrpt::system::CWorkerThreadsPool *threads) const
+{
+	MRPT_START
+	updateLocalGeometry<2>(*this, m_localGeometry2D, nNeighbors, threads);
+	return m_localGeometry2D;
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+					getLocalGeometry3D
+ ---------------------------------------------------------------*/
+const CPointsMap::TLocalGeometry & CPointsMap::getLocalGeometry3D(size_t nNeighbors, mrpt::system::CWorkerThreadsPool *threads) const
+{
+	MRPT_START
+	updateLocalGeometry<3>(*this, m_localGeometry3D, nNeighbors, threads);
+	return m_localGeometry3D;
+	MRPT_END
+}
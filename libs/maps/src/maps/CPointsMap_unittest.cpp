@@ -12,7 +12,9 @@
 #include <mrpt/maps/CWeightedPointsMap.h>
 #include <mrpt/maps/CColouredPointsMap.h>
 #include <mrpt/poses/CPoint2D.h>
+#include <mrpt/random.h>
 #include <gtest/gtest.h>
+#include <limits>
 
 using namespace mrpt;
 using namespace mrpt::maps;
@@ -193,3 +195,131 @@ TEST(CColouredPointsMapTests, clipOutOfRange)
 	do_test_clipOutOfRange<CColouredPointsMap>();
 }
 
+
+template <class MAP>
+void do_test_incrementalKDTree()
+{
+	mrpt::random::randomGenerator.randomize(123);
+
+	MAP pts;
+	pts.kdtree_search_params.incremental = true;
+	pts.kdtree_search_params.leaf_max_size = 4;
+
+	for (int iter=0;iter<60;iter++)
+	{
+		// Grow the map in small batches, shrinking it from time to time:
+		const size_t nNew = 1+ (iter % 7);
+		for (size_t i=0;i<nNew;i++)
+			pts.insertPoint(
+				mrpt::random::randomGenerator.drawUniform(-10,10),
+				mrpt::random::randomGenerator.drawUniform(-10,10),
+				mrpt::random::randomGenerator.drawUniform(-10,10) );
+		if (iter % 13 == 12)
+			pts.resize(pts.size()/2);
+		if (iter % 17 == 16)
+			pts.setPoint(0, 100,100,100);
+
+		const size_t N = pts.size();
+		for (int q=0;q<5;q++)
+		{
+			const float qx = mrpt::random::randomGenerator.drawUniform(-12,12);
+			const float qy = mrpt::random::randomGenerator.drawUniform(-12,12);
+			const float qz = mrpt::random::randomGenerator.drawUniform(-12,12);
+
+			// Brute force:
+			float best2D=std::numeric_limits<float>::max(), best3D=std::numeric_limits<float>::max();
+			size_t nInRadius = 0;
+			for (size_t i=0;i<N;i++)
+			{
+				float x,y,z;
+				pts.getPoint(i,x,y,z);
+				const float d2 = square(x-qx)+square(y-qy);
+				const float d3 = d2+square(z-qz);
+				keep_min(best2D,d2);
+				keep_min(best3D,d3);
+				if (d3<=25.0f) nInRadius++;
+			}
+
+			float dist2D, dist3D;
+			pts.kdTreeClosestPoint2D(qx,qy,dist2D);
+			std::vector<size_t> idxs;
+			std::vector<float> dists;
+			pts.kdTreeNClosestPoint3DIdx(qx,qy,qz,1,idxs,dists);
+			dist3D = dists[0];
+			EXPECT_NEAR(dist2D,best2D,1e-4f);
+			EXPECT_NEAR(dist3D,best3D,1e-4f);
+
+			std::vector<std::pair<size_t,float> > inRadius;
+			EXPECT_EQ(pts.kdTreeRadiusSearch3D(qx,qy,qz,25.0f,inRadius),nInRadius);
+			for (size_t i=1;i<inRadius.size();i++)
+				EXPECT_LE(inRadius[i-1].second,inRadius[i].second);
+		}
+	}
+}
+
+TEST(CSimplePointsMapTests, incrementalKDTree)
+{
+	do_test_incrementalKDTree<CSimplePointsMap>();
+}
+
+TEST(CColouredPointsMapTests, incrementalKDTree)
+{
+	do_test_incrementalKDTree<CColouredPointsMap>();
+}
+
+// Matching with a decimated "other" map must only use (and report) the points offset + k*decimation:
+TEST(CSimplePointsMapTests, determineMatching3D_decimation)
+{
+	mrpt::random::randomGenerator.randomize(321);
+
+	CSimplePointsMap global_map, local_map;
+	for (int i=0;i<200;i++)
+		global_map.insertPoint(
+			mrpt::random::randomGenerator.drawUniform(-5,5),
+			mrpt::random::randomGenerator.drawUniform(-5,5),
+			mrpt::random::randomGenerator.drawUniform(-1,1) );
+	for (int i=0;i<100;i++)
+		local_map.insertPoint(
+			mrpt::random::randomGenerator.drawUniform(-4,4),
+			mrpt::random::randomGenerator.drawUniform(-4,4),
+			mrpt::random::randomGenerator.drawUniform(-1,1) );
+
+	const CPose3D pose(0.3,-0.2,0.1, 0.4,0.05,-0.02);
+	TMatchingParams params;
+	params.maxDistForCorrespondence = 0.8f;
+	params.decimation_other_map_points = 3;
+	params.offset_other_map_points = 2;
+
+	TMatchingPairList corrs;
+	TMatchingExtraResults extra;
+	global_map.determineMatching3D(&local_map, pose, corrs, params, extra);
+
+	// Brute force:
+	size_t nExpected = 0;
+	for (size_t i=params.offset_other_map_points;i<local_map.size();i+=params.decimation_other_map_points)
+	{
+		float lx,ly,lz, gx,gy,gz;
+		local_map.getPoint(i,lx,ly,lz);
+		pose.composePoint(lx,ly,lz, gx,gy,gz);
+		float best = std::numeric_limits<float>::max();
+		for (size_t j=0;j<global_map.size();j++)
+		{
+			float x,y,z;
+			global_map.getPoint(j,x,y,z);
+			keep_min(best, square(x-gx)+square(y-gy)+square(z-gz));
+		}
+		if (best<square(params.maxDistForCorrespondence)) nExpected++;
+	}
+	EXPECT_GT(nExpected, 0u);
+	EXPECT_EQ(nExpected, corrs.size());
+	EXPECT_FLOAT_EQ(params.decimation_other_map_points*nExpected/static_cast<float>(local_map.size()), extra.correspondencesRatio);
+	for (TMatchingPairList::const_iterator it=corrs.begin();it!=corrs.end();++it)
+	{
+		EXPECT_EQ(params.offset_other_map_points, it->other_idx % params.decimation_other_map_points);
+		float lx,ly,lz;
+		local_map.getPoint(it->other_idx,lx,ly,lz);
+		EXPECT_EQ(lx, it->other_x);
+		EXPECT_EQ(ly, it->other_y);
+		EXPECT_EQ(lz, it->other_z);
+	}
+}
@@ -85,11 +85,12 @@ void CSimplePointsMap::reserve(size_t newLength)
 //  and old contents are not changed.
 void CSimplePointsMap::resize(size_t newLength)
 {
+	const size_t oldLength = x.size();
 	this->reserve(newLength); // to ensure 4N capacity
 	x.resize( newLength, 0 );
 	y.resize( newLength, 0 );
 	z.resize( newLength, 0 );
-	mark_as_modified();
+	mark_as_modified(std::min(oldLength,newLength));
 }
 
 // Resizes all point buffers so they can hold the given number of points, *erasing* all previous contents
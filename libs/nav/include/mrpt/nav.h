@@ -29,5 +29,6 @@
 #include <mrpt/nav/tpspace/CPTG_Holo_Blend.h>
 
 #include <mrpt/nav/planners/PlannerSimple2D.h>
+#include <mrpt/nav/planners/PlannerDStarLite2D.h>
 #include <mrpt/nav/planners/PlannerRRT_SE2_TPS.h>
 
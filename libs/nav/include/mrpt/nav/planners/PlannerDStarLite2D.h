@@ -0,0 +1,123 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef PlannerDStarLite2D_H
+#define PlannerDStarLite2D_H
+
+#include <mrpt/nav/link_pragmas.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/poses/CPose2D.h>
+#include <mrpt/utils/pimpl.h>
+#include <deque>
+
+namespace mrpt
+{
+namespace nav
+{
+	namespace detail { struct TDStarLiteImpl; }
+
+	/** \addtogroup nav_planners Path planning
+	  * \ingroup mrpt_nav_grp
+	  * @{ */
+
+	/** Incremental path planner in 2D occupancy grids for holonomic circular robots, based on D* Lite:
+	 *   - S. Koenig, M. Likhachev, "D* Lite", AAAI 2002.
+	 *
+	 * It can be used instead of PlannerSimple2D when the path must be recomputed often while the map is being
+	 * updated or the robot moves towards the same target: the search state is kept between calls to computePath(),
+	 * and only the cells affected by changes in the map or by the new robot position are processed again.
+	 *
+	 * The grid is 8-connected. Cells closer than `robotRadius` to an obstacle can't be traversed, and cells within
+	 * `inflationRadius` of that area have an additional cost, which makes paths keep clear of obstacles when possible.
+	 * Changes in the map are detected by comparing it against a copy of its obstacles from the previous call, which
+	 * takes a single pass over the raw cells; the clearance layer is then only updated around the changed cells.
+	 *
+	 * By default the search state is stored for all cells (12 bytes per cell, plus 2 bytes per cell for the obstacle
+	 * and cost layers). For large maps, `maxStoredCells` switches to a sparse storage with only the cells reached by the
+	 * search, which fails if it would need more than that number of cells.
+	 *
+	 * The search is restarted from scratch when the target, the map size or resolution, or any parameter changes.
+	 *
+	 * \sa PlannerSimple2D
+	 * \note (New in MRPT 1.5.0)
+	 */
+	class NAV_IMPEXP PlannerDStarLite2D
+	{
+	public:
+		PlannerDStarLite2D();  //!< Default constructor
+		virtual ~PlannerDStarLite2D(); //!< Destructor
+
+		/** The maximum occupancy probability to consider a cell as an obstacle, default=0.5 (same meaning as in PlannerSimple2D) */
+		float	occupancyThreshold;
+
+		/** The minimum distance between points in the returned found path (default=0.4); Notice
+		  *  that full grid resolution is used in path finding, this is only a way to reduce the
+		  *  amount of redundant information to be returned.
+		  */
+		float	minStepInReturnedPath;
+
+		float	robotRadius;  //!< The aproximate robot radius used in the planification: closer cells to obstacles can't be traversed. Default is 0.35m
+
+		/** Width [meters] of the band around the `robotRadius` area where traversing cells has an additional cost, decreasing
+		  * linearly from `inflationCostFactor` times the cell size next to it to zero (default=0.5m, 0 to disable) */
+		float	inflationRadius;
+		float	inflationCostFactor; //!< See `inflationRadius` (default=2.0)
+
+		/** If >0, keep the search state only for the cells reached by the search, up to this number of cells, instead of
+		  * for the whole grid. Searches which need more cells fail as if no path existed (default=0: no limit, dense storage) */
+		size_t	maxStoredCells;
+
+		/** This method compute the optimal path for a circular robot, in the given
+		  *   occupancy grid map, from the origin location to a target point, reusing
+		  *   the results from the previous call if the target is the same.
+		  *
+		  * \param theMap	[IN] The occupancy gridmap used to the planning.
+		  * \param origin	[IN] The starting pose of the robot, in coordinates of "map".
+		  * \param target	[IN] The desired target pose for the robot, in coordinates of "map".
+		  * \param path		[OUT] The found path, in global coordinates relative to "map".
+		  * \param notFound	[OUT] Will be true if no path has been found.
+		  * \param maxSearchPathLength [IN] The maximum path length to search for, in meters (-1 = no limit)
+		  *
+		  * \exception std::exception On any error
+		  */
+		void  computePath(
+				const mrpt::maps::COccupancyGridMap2D	&theMap,
+				const mrpt::poses::CPose2D				&origin,
+				const mrpt::poses::CPose2D				&target,
+				std::deque<mrpt::math::TPoint2D>	&path,
+				bool						&notFound,
+				float						maxSearchPathLength = -1
+				);
+
+		/** Discards the search state, so the next call to computePath() starts from scratch */
+		void  resetSearch();
+
+		/** Statistics of the last call to computePath() */
+		struct NAV_IMPEXP TStats
+		{
+			bool   full_replan;    //!< Whether the search was restarted from scratch
+			size_t changed_cells;  //!< Number of cells whose traversal cost changed since the previous call
+			size_t expanded_cells; //!< Number of cells expanded by the search
+			size_t stored_cells;   //!< Number of cells with search state (all of them, unless `maxStoredCells`>0)
+			double path_cost;      //!< Cost of the found path: its length [meters] plus the inflation costs
+
+			TStats() : full_replan(false), changed_cells(0), expanded_cells(0), stored_cells(0), path_cost(0) {}
+		};
+
+		const TStats & getLastStats() const { return m_last_stats; }
+
+	private:
+		PIMPL_DECLARE_TYPE(detail::TDStarLiteImpl, m_impl);
+		TStats m_last_stats;
+	};
+
+	  /** @} */
+	} // End of namespace
+} // End of namespace
+
+#endif
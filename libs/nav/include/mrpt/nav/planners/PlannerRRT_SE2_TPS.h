@@ -12,6 +12,7 @@
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/nav/planners/TMoveTree.h>
 #include <mrpt/nav/planners/PlannerRRT_common.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <numeric>
 
 #include <mrpt/nav/link_pragmas.h>
@@ -58,6 +59,12 @@ namespace mrpt
 		* // Analyze contents of planner_result...
 		* \endcode
 		*
+		*  The planner is "any-time": calling `solve()` again with the same `result` keeps growing the same tree, and with
+		*  `RRTEndCriteria::minComputationTime`>0 it keeps refining the best path until the time budget `maxComputationTime` runs out.
+		*  Setting `RRTAlgorithmParams::rewiringRadius` enables the RRT* rewiring step, which makes these refinements converge towards
+		*  shorter paths, and `RRTAlgorithmParams::ptg_eval_threads` evaluates the extensions with each PTG in parallel.
+		*  Each improvement of the best path can be handled, while planning continues, by overriding onNewBestSolution().
+		*
 		*  - Changes history:
 		*    - 06/MAR/2014: Creation (MB)
 		*    - 06/JAN/2015: Refactoring (JLBC)
@@ -86,6 +93,7 @@ namespace mrpt
 
 			/** Constructor */
 			PlannerRRT_SE2_TPS();
+			virtual ~PlannerRRT_SE2_TPS() {}
 
 			/** Load all params from a config file source */
 			void loadConfig(const mrpt::utils::CConfigFileBase &cfgSource, const std::string &sSectionName = std::string("PTG_CONFIG"));
@@ -98,6 +106,19 @@ namespace mrpt
 
 		protected:
 			bool m_initialized;
+			mrpt::system::CWorkerThreadsPool m_ptg_eval_threads; //!< Threads to evaluate the PTGs, see RRTAlgorithmParams::ptg_eval_threads
+
+			/** Called from within solve() each time a better path to the goal is found (`result.best_goal_node_id` and
+			  * `result.path_cost` are already updated). Default implementation does nothing. (New in MRPT 1.5.0) */
+			virtual void onNewBestSolution(const TPlannerInput &pi, const TPlannerResult &result);
+
+			/** RRT* step for a node just added to the tree: reconnects it to the lowest-cost parent within `params.rewiringRadius`
+			  * and then rewires its neighbors through it whenever that reduces their cost. \return true if the tree changed. */
+			bool rewireNewNode(const TPlannerInput &pi, TPlannerResult &result, const mrpt::utils::TNodeID new_node_id);
+
+			/** Finds the shortest collision-free PTG path from `from` which ends at `to`, in position and heading, up to
+			  * one step of the PTG path. \return false if there is none. */
+			bool findDirectEdge(const TPlannerInput &pi, const node_pose_t &from, const node_pose_t &to, TMoveEdgeSE2_TP &out_edge);
 
 		}; // end class PlannerRRT_SE2_TPS
 		
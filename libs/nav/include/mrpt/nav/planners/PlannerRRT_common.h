@@ -96,6 +96,15 @@ namespace mrpt
 
 			size_t save_3d_log_freq; //!< Frequency (in iters) of saving tree state to debug log files viewable in SceneViewer3D (default=0, disabled)
 
+			/** RRT* mode: if >0, each new node is connected to the lowest-cost parent among the nodes within this radius [meters],
+			  * and those nodes are rewired through the new node if that shortens their paths, so the best path keeps improving while
+			  * the planner runs (default=0, disabled: plain RRT). Edges are only rewired through PTG paths which end at the rewired
+			  * node, up to one path step, so the paths of its descendants remain valid. (New in MRPT 1.5.0) */
+			double rewiringRadius;
+			/** Number of threads to evaluate the tree extensions with each PTG concurrently (default=1: sequential; 0: as many as CPU cores).
+			  * The resulting tree is the same than with a sequential evaluation. (New in MRPT 1.5.0) */
+			size_t ptg_eval_threads;
+
 			RRTAlgorithmParams();
 		};
 
@@ -11,6 +11,7 @@
 
 #include <mrpt/graphs/CDirectedTree.h>
 #include <mrpt/utils/traits_map.h>
+#include <mrpt/utils/CDynamicGrid.h>
 #include <mrpt/math/wrap2pi.h>
 #include <mrpt/poses/CPose2D.h>
 
@@ -39,6 +40,9 @@ namespace mrpt
 		*      - addEdge (from, to)
 		*      - add here more instructions
 		*
+		*  Nodes are also kept in a grid of buckets by their (x,y) coordinates (NODE_TYPE_DATA must have a `state` field with `x` and `y`),
+		*  so getNearestNode() and getNodesWithinXYDistance() only need to visit the nodes around the query point.
+		*
 		*
 		* <b>Changes history</b>
 		*      - 06/MAR/2014: Creation (MB)
@@ -71,7 +75,12 @@ namespace mrpt
 			typedef typename MAPS_IMPLEMENTATION::template map<mrpt::utils::TNodeID, node_t>  node_map_t;  //!< Map: TNode_ID => Node info
 			typedef std::list<node_t> path_t; //!< A topological path up-tree
 
-			/** Finds the nearest node to a given pose, using the given metric */
+			TMoveTree() : m_nodes_index(0,0,0,0,1.0) {}
+
+			/** Finds the nearest node to a given pose, using the given metric.
+			  * Nodes are visited in rings of buckets of increasing size around the query point, and the search stops as soon as the
+			  * metric `cannotBeNearerThan()` discards all the nodes in the next ring, so it must be a true lower bound of `distance()`.
+			  */
 			template <class NODE_TYPE_FOR_METRIC>
 			mrpt::utils::TNodeID getNearestNode(
 				const NODE_TYPE_FOR_METRIC &query_pt,
@@ -84,24 +93,94 @@ namespace mrpt
 
 				double min_d = std::numeric_limits<double>::max();
 				mrpt::utils::TNodeID min_id=INVALID_NODEID;
-				for (typename node_map_t::const_iterator it=m_nodes.begin();it!=m_nodes.end();++it)
+				const NODE_TYPE_FOR_METRIC ptTo(query_pt.state);
+
+				const double res = m_nodes_index.getResolution();
+				const int nx = static_cast<int>(m_nodes_index.getSizeX()), ny = static_cast<int>(m_nodes_index.getSizeY());
+				const int cx0 = static_cast<int>(std::floor((query_pt.state.x-m_nodes_index.getXMin())/res));
+				const int cy0 = static_cast<int>(std::floor((query_pt.state.y-m_nodes_index.getYMin())/res));
+
+				// Rings entirely outside of the grid are empty: start with the first one which overlaps it.
+				const int r_min = std::max(std::max(std::max(0,-cx0),cx0-(nx-1)), std::max(-cy0,cy0-(ny-1)));
+				for (int r=r_min;;r++)
 				{
-					if (ignored_nodes && ignored_nodes->find(it->first)!=ignored_nodes->end())
-						continue; // ignore it
-					const NODE_TYPE_FOR_METRIC ptTo(query_pt.state);
-					const NODE_TYPE_FOR_METRIC ptFrom(it->second.state);
-					if (distanceMetricEvaluator.cannotBeNearerThan(ptFrom,ptTo,min_d))
-						continue; // Skip the more expensive calculation of exact distance
-					double d = distanceMetricEvaluator.distance(ptFrom,ptTo);
-					if (d<min_d) {
-						min_d = d;
-						min_id = it->first;
+					if (r>r_min)
+					{
+						// All nodes in this ring are farther than (r-1)*res along x or y:
+						mrpt::math::TPose2D ring_bound = query_pt.state;
+						ring_bound.x += (r-1)*res;
+						if (distanceMetricEvaluator.cannotBeNearerThan(NODE_TYPE_FOR_METRIC(ring_bound),ptTo,min_d))
+							break;
+					}
+					// Rows cy0-r and cy0+r, then the rest of columns cx0-r and cx0+r:
+					for (int side=0;side<4;side++)
+					{
+						int x0,x1,y0,y1;
+						switch (side)
+						{
+						case 0: x0=cx0-r; x1=cx0+r; y0=y1=cy0-r; break;
+						case 1: if (!r) continue; x0=cx0-r; x1=cx0+r; y0=y1=cy0+r; break;
+						case 2: if (!r) continue; x0=x1=cx0-r; y0=cy0-r+1; y1=cy0+r-1; break;
+						default: if (!r) continue; x0=x1=cx0+r; y0=cy0-r+1; y1=cy0+r-1; break;
+						};
+						x0 = std::max(x0,0); x1 = std::min(x1,nx-1);
+						y0 = std::max(y0,0); y1 = std::min(y1,ny-1);
+						for (int cy=y0;cy<=y1;cy++)
+						{
+							for (int cx=x0;cx<=x1;cx++)
+							{
+								const std::vector<mrpt::utils::TNodeID> &bucket = *m_nodes_index.cellByIndex(cx,cy);
+								for (size_t i=0;i<bucket.size();i++)
+								{
+									const mrpt::utils::TNodeID id = bucket[i];
+									if (ignored_nodes && ignored_nodes->find(id)!=ignored_nodes->end())
+										continue; // ignore it
+									const NODE_TYPE_FOR_METRIC ptFrom(m_nodes.find(id)->second.state);
+									if (distanceMetricEvaluator.cannotBeNearerThan(ptFrom,ptTo,min_d))
+										continue; // Skip the more expensive calculation of exact distance
+									double d = distanceMetricEvaluator.distance(ptFrom,ptTo);
+									if (d<min_d || (d==min_d && id<min_id)) { // Same result than visiting nodes in ID order
+										min_d = d;
+										min_id = id;
+									}
+								}
+							}
+						}
 					}
+					// Already covered the whole grid?
+					if (cx0-r<=0 && cy0-r<=0 && cx0+r>=nx-1 && cy0+r>=ny-1)
+						break;
 				}
 				if (out_distance) *out_distance = min_d;
 				return min_id;
 			}
 
+			/** Returns the IDs of all nodes whose (x,y) coordinates are within a given Euclidean distance of (x,y) */
+			void getNodesWithinXYDistance(const double x, const double y, const double max_dist, std::vector<mrpt::utils::TNodeID> &out_ids) const
+			{
+				out_ids.clear();
+				const int cx0 = std::max(0, m_nodes_index.x2idx(x-max_dist)), cx1 = std::min(static_cast<int>(m_nodes_index.getSizeX())-1, m_nodes_index.x2idx(x+max_dist));
+				const int cy0 = std::max(0, m_nodes_index.y2idx(y-max_dist)), cy1 = std::min(static_cast<int>(m_nodes_index.getSizeY())-1, m_nodes_index.y2idx(y+max_dist));
+				for (int cy=cy0;cy<=cy1;cy++)
+					for (int cx=cx0;cx<=cx1;cx++)
+					{
+						const std::vector<mrpt::utils::TNodeID> &bucket = *m_nodes_index.cellByIndex(cx,cy);
+						for (size_t i=0;i<bucket.size();i++)
+						{
+							const node_t &n = m_nodes.find(bucket[i])->second;
+							if (mrpt::math::square(n.state.x-x)+mrpt::math::square(n.state.y-y)<=mrpt::math::square(max_dist))
+								out_ids.push_back(bucket[i]);
+						}
+					}
+			}
+
+			/** Changes the size of the buckets used to speed up searches (default=1.0). Only allowed while the tree is empty. */
+			void setNodesIndexResolution(const double resolution)
+			{
+				ASSERT_(m_nodes.empty() && resolution>0)
+				m_nodes_index.setSize(0,0,0,0,resolution);
+			}
+
 			void insertNodeAndEdge(
 				const mrpt::utils::TNodeID parent_id, 
 				const mrpt::utils::TNodeID new_child_id, 
@@ -113,12 +192,39 @@ namespace mrpt
 				edges_of_parent.push_back( typename base_t::TEdgeInfo(new_child_id,false/*direction_child_to_parent*/, new_edge_data ) );
 				// node:
 				m_nodes[new_child_id] = node_t(new_child_id,parent_id, &edges_of_parent.back().data, new_child_node_data);
+				insertInIndex(new_child_id, new_child_node_data);
 			}
 
 			/** Insert a node without edges (should be used only for a tree root node) */
 			void insertNode(const mrpt::utils::TNodeID node_id, const NODE_TYPE_DATA &node_data) 
 			{
 				m_nodes[node_id] = node_t(node_id,INVALID_NODEID, NULL, node_data);
+				insertInIndex(node_id, node_data);
+			}
+
+			/** Moves a node (with all its descendants) to hang from a different parent, through a new edge. Used to rewire trees in RRT*.
+			  * The new parent must not be a descendant of the node. */
+			void changeParent(
+				const mrpt::utils::TNodeID node_id,
+				const mrpt::utils::TNodeID new_parent_id,
+				const EDGE_TYPE &new_edge_data)
+			{
+				typename node_map_t::iterator it = m_nodes.find(node_id);
+				ASSERT_(it!=m_nodes.end() && it->second.parent_id!=INVALID_NODEID)
+				ASSERT_(m_nodes.find(new_parent_id)!=m_nodes.end())
+				node_t &node = it->second;
+
+				typename base_t::TListEdges & old_edges = base_t::edges_to_children[node.parent_id];
+				for (typename base_t::TListEdges::iterator itE=old_edges.begin();itE!=old_edges.end();++itE)
+					if (itE->id==node_id) {
+						old_edges.erase(itE);
+						break;
+					}
+
+				typename base_t::TListEdges & new_edges = base_t::edges_to_children[new_parent_id];
+				new_edges.push_back( typename base_t::TEdgeInfo(node_id,false/*direction_child_to_parent*/, new_edge_data ) );
+				node.parent_id = new_parent_id;
+				node.edge_to_parent = &new_edges.back().data;
 			}
 
 			mrpt::utils::TNodeID getNextFreeNodeID() const { return m_nodes.size(); }
@@ -157,6 +263,16 @@ namespace mrpt
 
 		private:
 			node_map_t  m_nodes;  //!< Info per node
+			mrpt::utils::CDynamicGrid<std::vector<mrpt::utils::TNodeID> > m_nodes_index; //!< Node IDs, by their (x,y) coordinates
+
+			void insertInIndex(const mrpt::utils::TNodeID node_id, const NODE_TYPE_DATA &node_data)
+			{
+				const double x = node_data.state.x, y = node_data.state.y, res = m_nodes_index.getResolution();
+				if (!m_nodes_index.getSizeX())
+					m_nodes_index.setSize(x-10*res,x+10*res,y-10*res,y+10*res,res);
+				else m_nodes_index.resize(x-res,x+res,y-res,y+res, std::vector<mrpt::utils::TNodeID>(), 10*res);
+				m_nodes_index.cellByPos(x,y)->push_back(node_id);
+			}
 
 		}; // end TMoveTree
 
@@ -192,8 +308,9 @@ namespace mrpt
 		{
 			bool cannotBeNearerThan(const TNodeSE2 &a, const TNodeSE2& b,const double d) const
 			{
-				if (std::abs(a.state.x-b.state.x)>d) return true;
-				if (std::abs(a.state.y-b.state.y)>d) return true;
+				// distance() is squared:
+				if (mrpt::math::square(a.state.x-b.state.x)>d) return true;
+				if (mrpt::math::square(a.state.y-b.state.y)>d) return true;
 				return false;
 			}
 
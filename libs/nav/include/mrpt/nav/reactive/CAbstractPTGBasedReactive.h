@@ -17,6 +17,7 @@
 #include <mrpt/nav/reactive/TCandidateMovementPTG.h>
 #include <mrpt/nav/reactive/CMultiObjectiveMotionOptimizerBase.h>
 #include <mrpt/utils/CTimeLogger.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <mrpt/system/datetime.h>
 #include <mrpt/math/filters.h>
 #include <mrpt/synch/CCriticalSection.h>
@@ -167,6 +168,11 @@ namespace mrpt
 			bool  enable_obstacle_filtering;
 			bool  evaluate_clearance; //!< Default: false
 			double max_dist_for_timebased_path_prediction; //!< Max dist [meters] to use time-based path prediction for NOP evaluation.
+			/** Number of threads to evaluate the PTGs concurrently in each navigation step (default=1: evaluate them sequentially in the
+			  * calling thread; 0: as many as CPU cores). Except for timing values, log records do not depend on this number.
+			  * Derived classes must allow concurrent calls to STEP3_WSpaceToTPSpace() for different PTG indices to use values other than 1.
+			  * \note (New in MRPT 1.5.0) */
+			uint32_t ptg_eval_threads;
 
 			virtual void loadFromConfigFile(const mrpt::utils::CConfigFileBase &c, const std::string &s) MRPT_OVERRIDE;
 			virtual void saveToConfigFile(mrpt::utils::CConfigFileBase &c, const std::string &s) const MRPT_OVERRIDE;
@@ -227,6 +233,7 @@ namespace mrpt
 		mrpt::utils::CTicTac	timerForExecutionPeriod;
 
 		mrpt::utils::CTimeLogger m_timelogger; //!< A complete time logger \sa enableTimeLog()
+		mrpt::system::CWorkerThreadsPool m_ptg_eval_threads; //!< Threads to evaluate the PTGs, see TAbstractPTGNavigatorParams::ptg_eval_threads
 		bool  m_PTGsMustBeReInitialized;
 
 		/** @name Variables for CReactiveNavigationSystem::performNavigationStep
@@ -250,7 +257,8 @@ namespace mrpt
 
 		/** Builds TP-Obstacles from Workspace obstacles for the given PTG.
 		  * "out_TPObstacles" is already initialized to the proper length and maximum collision-free distance for each "k" trajectory index.
-		  * Distances are in "pseudo-meters". They will be normalized automatically to [0,1] upon return. */
+		  * Distances are in "pseudo-meters". They will be normalized automatically to [0,1] upon return.
+		  * If TAbstractPTGNavigatorParams::ptg_eval_threads!=1, it is called concurrently from several threads for different PTGs. */
 		virtual void STEP3_WSpaceToTPSpace(const size_t ptg_idx,std::vector<double> &out_TPObstacles, mrpt::nav::ClearanceDiagram &out_clearance, const mrpt::math::TPose2D &rel_pose_PTG_origin_wrt_sense, const bool eval_clearance) = 0;
 
 		/** Generates a pointcloud of obstacles, and the robot shape, to be saved in the logging record for the current timestep */
@@ -310,6 +318,10 @@ namespace mrpt
 			const mrpt::math::TPose2D &relPoseVelCmd_NOP = mrpt::poses::CPose2D()
 		);
 
+		/** Registers in m_timelogger the times of one PTG evaluated with build_movement_candidate(). This is done afterwards,
+		  * from the calling thread, since PTGs may be evaluated in parallel and CTimeLogger user measures are not thread-safe. */
+		void registerPTGEvaluationTimes(const TInfoPerPTG &ipf, const CLogFileRecord::TInfoPerPTG &ipp, const bool this_is_PTG_continuation);
+
 		struct NAV_IMPEXP TSentVelCmd
 		{
 			int ptg_index; //!< 0-based index of used PTG
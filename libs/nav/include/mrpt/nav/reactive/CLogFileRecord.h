@@ -47,6 +47,8 @@ namespace nav
 			mrpt::math::TPoint2D     TP_Target;     //!< Target location in TP-Space
 			mrpt::math::TPoint2D     TP_Robot;      //!< Robot location in TP-Space: normally (0,0), except during "NOP cmd vel" steps
 			double timeForTPObsTransformation,timeForHolonomicMethod;  //!< Time, in seconds.
+			double timeForCandidateScores; //!< Time, in seconds, to evaluate the motion candidate of this PTG (New in MRPT 1.5.0)
+			double timeForPTGEvaluation;   //!< Total time, in seconds, to evaluate this PTG, including all the above (New in MRPT 1.5.0)
 			double desiredDirection,desiredSpeed;          //!< The results from the holonomic method.
 			double evaluation;                       //!< Final score of this candidate
 			mrpt::utils::TParametersDouble  evalFactors;   //!< Evaluation factors
@@ -63,6 +65,8 @@ namespace nav
 		/** Known values: 
 		 *	- "executionTime": The total computation time, excluding sensing.
 		 *	- "estimatedExecutionPeriod": The estimated execution period.
+		 *	- "PTGsEvaluationTime": Wall time to evaluate all the PTGs, see TInfoPerPTG::timeForPTGEvaluation for the time of each one (New in MRPT 1.5.0)
+		 *	- "PTGsEvaluationThreads": Number of threads used to evaluate the PTGs (New in MRPT 1.5.0)
 		 */
 		std::map<std::string, double>  values;
 		/** Known values:
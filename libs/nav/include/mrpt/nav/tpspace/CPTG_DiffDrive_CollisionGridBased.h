@@ -12,6 +12,7 @@
 #include <mrpt/utils/CDynamicGrid.h>
 #include <mrpt/math/CPolygon.h>
 #include <mrpt/utils/TEnumType.h>
+#include <mrpt/utils/TMemoryBlockOwner.h>
 
 namespace mrpt
 {
@@ -38,6 +39,7 @@ namespace nav
 	/** Base class for all PTGs suitable to non-holonomic, differentially-driven (or Ackermann) vehicles
 	  * based on numerical integration of the trajectories and collision look-up-table.
 	  * Regarding `initialize()`: in this this family of PTGs, the method builds the collision grid or load it from a cache file.
+	  * Cache files are not compressed, so they can be memory-mapped and shared by all the processes using the same PTG (since MRPT 1.5.0).
 	  * Collision grids must be calculated before calling getTPObstacle(). Robot shape must be set before initializing with setRobotShape().
 	  * The rest of PTG parameters should have been set at the constructor.
 	  */
@@ -76,6 +78,8 @@ namespace nav
 
 		void updateTPObstacle(double ox, double oy, std::vector<double> &tp_obstacles) const MRPT_OVERRIDE;
 		void updateTPObstacleSingle(double ox, double oy, uint16_t k, double &tp_obstacle_k) const MRPT_OVERRIDE;
+		/** Obstacles are sorted by their collision grid cell, and each cell list of (k,d) pairs is walked only once, no matter how many obstacles fall inside it. */
+		void updateTPObstacleBatch(const std::vector<double> &ox, const std::vector<double> &oy, std::vector<double> &tp_obstacles) const MRPT_OVERRIDE;
 		
 		/** This family of PTGs ignores the dynamic states */
 		virtual void onNewNavDynamicState() MRPT_OVERRIDE {
@@ -131,25 +135,74 @@ protected:
 		  */
 		typedef std::vector<std::pair<uint16_t,float> > TCollisionCell;
 
-		/** An internal class for storing the collision grid  */
+		/** One (k,d) pair of the compact collision grid. This is also the exact binary layout in cache files. */
+		struct TCollisionEntry
+		{
+			float    dist; //!< Distance (in meters) to collision
+			uint16_t k;    //!< Path index
+			uint16_t reserved;
+		};
+
+		/** A read-only view of the list of (k,d) pairs of one cell of the compact collision grid */
+		struct TCollisionCellRef
+		{
+			TCollisionCellRef() : first(NULL), last(NULL) {}
+			TCollisionCellRef(const TCollisionEntry *f, const TCollisionEntry *l) : first(f), last(l) {}
+			const TCollisionEntry *first, *last;
+
+			const TCollisionEntry * begin() const { return first; }
+			const TCollisionEntry * end() const { return last; }
+			bool empty() const { return first==last; }
+			size_t size() const { return last-first; }
+		};
+
+		/** An internal class for storing the collision grid.
+		  * The grid is built cell by cell with updateCellInfo(), then converted with compact() into a CSR (compressed sparse row)
+		  * layout: one array with all the (k,d) pairs, sorted by cell, and one array with the index of the first pair of each cell.
+		  * Cache files store these two arrays as-is, so loadFromFile() just memory-maps the file, without parsing or copying it:
+		  * loading is nearly instantaneous, and all the processes using the same cache file share the same physical memory.
+		  */
 		class NAV_IMPEXP CCollisionGrid : public mrpt::utils::CDynamicGrid<TCollisionCell>
 		{
 		private:
 			CPTG_DiffDrive_CollisionGridBased const * m_parent;
 
+			std::vector<uint32_t>         m_own_offsets;  //!< CSR data, if not read from a memory-mapped file
+			std::vector<TCollisionEntry>  m_own_entries;
+			mrpt::utils::TMemoryBlockOwnerPtr m_mapped_file; //!< The memory-mapped cache file, if the CSR data was loaded from it
+			const uint32_t        *m_mapped_offsets;
+			const TCollisionEntry *m_mapped_entries;
+
+			const uint32_t * csrOffsets() const { return m_mapped_file.present() ? m_mapped_offsets : (m_own_offsets.empty() ? NULL : &m_own_offsets[0]); }
+			const TCollisionEntry * csrEntries() const { return m_mapped_file.present() ? m_mapped_entries : (m_own_entries.empty() ? NULL : &m_own_entries[0]); }
+
 		public:
 			CCollisionGrid(float x_min, float x_max,float y_min, float y_max, float resolution, CPTG_DiffDrive_CollisionGridBased* parent )
 				: mrpt::utils::CDynamicGrid<TCollisionCell>(x_min,x_max,y_min,y_max,resolution),
-				m_parent(parent)
+				m_parent(parent),
+				m_mapped_offsets(NULL),
+				m_mapped_entries(NULL)
 			{
 			}
 			virtual ~CCollisionGrid() { }
 
-			bool saveToFile( mrpt::utils::CStream* fil, const mrpt::math::CPolygon & computed_robotShape ) const;	//!< Save to file, true = OK
-			bool loadFromFile( mrpt::utils::CStream* fil, const mrpt::math::CPolygon & current_robotShape );	//!< Load from file,  true = OK
+			/** Saves the compact grid to a (non-compressed) cache file, tagged with the given key. The file is written under a
+			  * temporary name and then renamed, so other processes never see a partially-written file. \return true = OK */
+			bool saveToFile(const std::string &fileName, const uint64_t cache_key) const;
+			/** Memory-maps a cache file written by saveToFile(). Returns false (and leaves the grid unmodified) if the file does
+			  * not exist, is corrupted, or was generated with a different key or grid size. \return true = OK */
+			bool loadFromFile(const std::string &fileName, const uint64_t cache_key);
 
-			/** For an obstacle (x,y), returns a vector with all the pairs (a,d) such as the robot collides */
-			const TCollisionCell & getTPObstacle( const float obsX, const float obsY) const;
+			/** Converts the grid built with updateCellInfo() into the compact layout, and frees the per-cell lists */
+			void compact();
+			/** Frees all the memory of the compact grid (and unmaps the cache file, if any) */
+			void clearCompact();
+			bool isCompact() const { return csrOffsets()!=NULL; } //!< Whether the compact grid is ready to use
+
+			/** For an obstacle (x,y), returns all the pairs (k,d) such as the robot collides (an empty list if the grid is not compact yet). */
+			TCollisionCellRef getTPObstacle( const float obsX, const float obsY) const;
+			/** Like getTPObstacle() but for a given cell index. Out-of-range indices return an empty list. */
+			TCollisionCellRef getCellByIndex(const int cx, const int cy) const;
 
 			/** Updates the info into a cell: It updates the cell only if the distance d for the path k is lower than the previous value:
 				*	\param cellInfo The index of the cell
@@ -160,9 +213,13 @@ protected:
 
 		}; // end of class CCollisionGrid
 
+		/** A hash of the robot shape and all the PTG parameters which determine the collision grid: cache files built with
+		  * a different key are discarded and recomputed. */
+		uint64_t getCollisionGridCacheKey() const;
+
 		// Save/Load from files.
-		bool saveColGridsToFile( const std::string &filename, const mrpt::math::CPolygon & computed_robotShape ) const;	// true = OK
-		bool loadColGridsFromFile( const std::string &filename, const mrpt::math::CPolygon & current_robotShape ); // true = OK
+		bool saveColGridsToFile( const std::string &filename, const uint64_t cache_key ) const;	// true = OK
+		bool loadColGridsFromFile( const std::string &filename, const uint64_t cache_key ); // true = OK
 
 		CCollisionGrid	m_collisionGrid; //!< The collision grid
 
@@ -58,6 +58,8 @@ namespace mrpt
 
 		void updateTPObstacle(double ox, double oy, std::vector<double> &tp_obstacles) const MRPT_OVERRIDE;
 		void updateTPObstacleSingle(double ox, double oy, uint16_t k, double &tp_obstacle_k) const MRPT_OVERRIDE;
+		/** Evaluates the parameters of each path only once for all the obstacles */
+		void updateTPObstacleBatch(const std::vector<double> &ox, const std::vector<double> &oy, std::vector<double> &tp_obstacles) const MRPT_OVERRIDE;
 
 		static double PATH_TIME_STEP;  //!< Duration of each PTG "step"  (default: 10e-3=10 ms)
 		static double eps;             //!< Mathematical "epsilon", to detect ill-conditioned situations (e.g. 1/0) (Default: 1e-4)
@@ -183,6 +183,16 @@ namespace nav
 		/** Like updateTPObstacle() but for one direction only (`k`) in TP-Space. `tp_obstacle_k` must be initialized with initTPObstacleSingle() before call (collision-free ranges, in "pseudometers", un-normalized). */
 		virtual void updateTPObstacleSingle(double ox, double oy, uint16_t k, double &tp_obstacle_k) const = 0;
 
+		/** Like updateTPObstacle() but for a whole set of obstacle points at once, with exactly the same results than calling updateTPObstacle()
+		  * for each point. The default implementation does just that, but PTGs with a costly per-point evaluation reimplement it in a more efficient way
+		  * (e.g. walking each cell of a collision grid only once, or evaluating the path parameters only once per path).
+		  * \param [in] ox Obstacle points (X), relative coordinates wrt origin of the PTG.
+		  * \param [in] oy Obstacle points (Y), relative coordinates wrt origin of the PTG. Must have the same length than `ox`.
+		  * \param [in,out] tp_obstacles A vector of length `getAlphaValuesCount()`, initialized with `initTPObstacles()`.
+		  * \note (New in MRPT 1.5.0)
+		  */
+		virtual void updateTPObstacleBatch(const std::vector<double> &ox, const std::vector<double> &oy, std::vector<double> &tp_obstacles) const;
+
 		/** Loads a set of default parameters into the PTG. Users normally will call `loadFromConfigFile()` instead, this method is provided 
 		  * exclusively for the PTG-configurator tool. */
 		virtual void loadDefaultParams();
@@ -330,6 +340,8 @@ protected:
 		  * \param inout_tp_obs The target where to store the new TP-Obs distance, if it fulfills the criteria determined by the collision behavior.
 		  */
 		void internal_TPObsDistancePostprocess(const double ox, const double oy, const double new_tp_obs_dist, double &inout_tp_obs) const;
+		/** \overload For callers which already know whether the obstacle point is inside the robot shape */
+		void internal_TPObsDistancePostprocess(const bool is_obs_inside_robot_shape, const double new_tp_obs_dist, double &inout_tp_obs) const;
 
 		virtual void internal_readFromStream(mrpt::utils::CStream &in);
 		virtual void internal_writeToStream(mrpt::utils::CStream &out) const;
@@ -0,0 +1,554 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "nav-precomp.h"   // Precompiled headers
+
+#include <mrpt/nav/planners/PlannerDStarLite2D.h>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+using namespace mrpt;
+using namespace mrpt::maps;
+using namespace mrpt::utils;
+using namespace mrpt::math;
+using namespace mrpt::poses;
+using namespace mrpt::nav;
+using namespace std;
+
+namespace mrpt
+{
+namespace nav
+{
+namespace detail
+{
+	static const float INF = std::numeric_limits<float>::infinity();
+	// 8-neighborhood: the first 4 ones are horizontal/vertical moves.
+	static const int NEIGH_DX[8] = { 1,-1, 0, 0, 1, 1,-1,-1 };
+	static const int NEIGH_DY[8] = { 0, 0, 1,-1, 1,-1, 1,-1 };
+
+	struct TDStarLiteImpl
+	{
+		struct TState
+		{
+			TState() : g(INF), rhs(INF), open_id(0) {}
+			float g, rhs;
+			uint32_t open_id; //!< ID of the only valid entry of this cell in the OPEN queue, 0 if it is not in the queue
+		};
+		struct TOpenEntry
+		{
+			float k1, k2;
+			uint32_t idx, id;
+			// std::priority_queue<> returns the largest element: reverse the order to get the lowest key first.
+			bool operator <(const TOpenEntry &o) const { return k1>o.k1 || (k1==o.k1 && k2>o.k2); }
+		};
+
+		TDStarLiteImpl() :
+			valid(false), size_x(0), size_y(0), x_min(0), y_min(0), resolution(0),
+			occupancyThreshold(0), robotRadius(0), inflationRadius(0), inflationCostFactor(0), maxStoredCells(0),
+			range_cells(0), last_open_id(0), goal(0), start(0), last_start(0), km(0), expanded(0)
+		{
+		}
+
+		bool valid; //!< false if the search must be restarted
+
+		// Grid geometry and parameters of the current search:
+		int size_x, size_y;
+		float x_min, y_min, resolution;
+		float occupancyThreshold, robotRadius, inflationRadius, inflationCostFactor;
+		size_t maxStoredCells;
+		int range_cells; //!< Max. distance [cells] from obstacles to cells with some extra cost
+
+		std::vector<uint8_t> occupied;    //!< 1 for cells with obstacles, as they were in the map in the previous call
+		std::vector<uint8_t> cost;        //!< 255: can't be traversed; otherwise, the inflation cost of the cell in [0,254]
+		std::vector<uint16_t> tmp_dist;   //!< Temporary buffer for updateCosts()
+		std::vector<uint8_t> occupied_lut; //!< Whether each possible (unsigned) raw cell value is an obstacle
+
+		std::vector<TState> dense_states;
+		std::unordered_map<uint32_t,TState> sparse_states; //!< Used instead of `dense_states` if `maxStoredCells`>0
+		std::priority_queue<TOpenEntry> open; //!< The OPEN queue, with lazy removal of entries
+		uint32_t last_open_id;
+
+		uint32_t goal, start, last_start;
+		float km;
+		size_t expanded;
+
+		// ----------- Search state -----------
+		// Note: references returned by stateRW() may be invalidated by later calls in sparse mode.
+		TState state(uint32_t i) const
+		{
+			if (!maxStoredCells) return dense_states[i];
+			std::unordered_map<uint32_t,TState>::const_iterator it = sparse_states.find(i);
+			return it==sparse_states.end() ? TState() : it->second;
+		}
+		TState & stateRW(uint32_t i)
+		{
+			return maxStoredCells ? sparse_states[i] : dense_states[i];
+		}
+		size_t storedCells() const { return maxStoredCells ? sparse_states.size() : dense_states.size(); }
+
+		// ----------- Graph -----------
+		bool isBlocked(uint32_t i) const { return cost[i]==255 && i!=goal; }
+		float penalty(uint32_t i) const { return cost[i]==255 ? 254.f : cost[i]; }
+
+		/** Cost of moving from cell (ux,uy) to its neighbor in direction `dir`, INF if not possible */
+		float edgeCost(int ux, int uy, int dir) const
+		{
+			const int vx = ux+NEIGH_DX[dir], vy = uy+NEIGH_DY[dir];
+			if (vx<0 || vy<0 || vx>=size_x || vy>=size_y) return INF;
+			const uint32_t v = vx+vy*size_x;
+			if (isBlocked(v)) return INF;
+			if (dir>=4 && (isBlocked(vx+uy*size_x) || isBlocked(ux+vy*size_x)))
+				return INF; // Don't cut corners
+			const float len = dir<4 ? resolution : static_cast<float>(resolution*M_SQRT2);
+			return len*(1.f + inflationCostFactor*(penalty(ux+uy*size_x)+penalty(v))*(1.f/508));
+		}
+
+		/** Octile distance, a lower bound of the path cost between two cells */
+		float heuristic(uint32_t a, uint32_t b) const
+		{
+			const int dx = std::abs(static_cast<int>(a%size_x)-static_cast<int>(b%size_x));
+			const int dy = std::abs(static_cast<int>(a/size_x)-static_cast<int>(b/size_x));
+			return resolution*(std::max(dx,dy) + static_cast<float>(M_SQRT2-1)*std::min(dx,dy));
+		}
+
+		// ----------- D* Lite -----------
+		void calcKey(uint32_t i, float &k1, float &k2) const
+		{
+			const TState s = state(i);
+			k2 = std::min(s.g, s.rhs);
+			k1 = k2 + heuristic(start,i) + km;
+		}
+		static bool keyLess(float a1, float a2, float b1, float b2) { return a1<b1 || (a1==b1 && a2<b2); }
+
+		void push(uint32_t i)
+		{
+			TOpenEntry e;
+			calcKey(i, e.k1, e.k2);
+			e.idx = i;
+			e.id = ++last_open_id;
+			if (!e.id) e.id = ++last_open_id;
+			stateRW(i).open_id = e.id;
+			open.push(e);
+		}
+
+		/** Removes stale entries from the top of the queue. \return false if it's empty */
+		bool cleanTop()
+		{
+			while (!open.empty() && state(open.top().idx).open_id!=open.top().id)
+				open.pop();
+			return !open.empty();
+		}
+
+		void updateVertex(uint32_t i)
+		{
+			TState s = state(i);
+			if (i!=goal)
+			{
+				const int x = i%size_x, y = i/size_x;
+				float rhs = INF;
+				for (int dir=0;dir<8;dir++)
+				{
+					const float c = edgeCost(x,y,dir);
+					if (c==INF) continue;
+					rhs = std::min(rhs, c+state(x+NEIGH_DX[dir]+(y+NEIGH_DY[dir])*size_x).g);
+				}
+				if (rhs==INF && s.rhs==INF && s.g==INF && !s.open_id)
+					return; // Unreached cell which remains so: don't store it
+				stateRW(i).rhs = s.rhs = rhs;
+			}
+			if (s.g!=s.rhs) push(i);
+			else if (s.open_id) stateRW(i).open_id = 0;
+		}
+
+		void updateNeighbors(uint32_t i)
+		{
+			const int x = i%size_x, y = i/size_x;
+			for (int dir=0;dir<8;dir++)
+			{
+				const int nx = x+NEIGH_DX[dir], ny = y+NEIGH_DY[dir];
+				if (nx>=0 && ny>=0 && nx<size_x && ny<size_y)
+					updateVertex(nx+ny*size_x);
+			}
+		}
+
+		/** \return false if the search needs to store more than `maxStoredCells` cells */
+		bool computeShortestPath()
+		{
+			for (;;)
+			{
+				if (!cleanTop()) break;
+				const TOpenEntry top = open.top();
+				float sk1, sk2;
+				calcKey(start, sk1, sk2);
+				const TState s_start = state(start);
+				if (!keyLess(top.k1,top.k2, sk1,sk2) && s_start.rhs==s_start.g)
+					break;
+
+				open.pop();
+				stateRW(top.idx).open_id = 0;
+				expanded++;
+
+				float k1, k2;
+				calcKey(top.idx, k1, k2);
+				if (keyLess(top.k1,top.k2, k1,k2))
+					push(top.idx); // Outdated key
+				else
+				{
+					TState &u = stateRW(top.idx);
+					if (u.g>u.rhs)
+					{
+						u.g = u.rhs; // Now locally consistent
+						updateNeighbors(top.idx);
+					}
+					else
+					{
+						u.g = INF;
+						updateVertex(top.idx);
+						updateNeighbors(top.idx);
+					}
+				}
+				if (maxStoredCells && sparse_states.size()>maxStoredCells)
+					return false;
+			}
+			return true;
+		}
+
+		// ----------- Obstacles and costs -----------
+		void buildOccupiedLUT()
+		{
+			const size_t N = size_t(1) << (8*sizeof(COccupancyGridMap2D::cellType));
+			occupied_lut.resize(N);
+			for (size_t i=0;i<N;i++)
+			{
+				COccupancyGridMap2D::cellType l = static_cast<COccupancyGridMap2D::cellType>(static_cast<COccupancyGridMap2D::cellTypeUnsigned>(i));
+				if (l<COccupancyGridMap2D::OCCGRID_CELLTYPE_MIN) l = COccupancyGridMap2D::OCCGRID_CELLTYPE_MIN;
+				occupied_lut[i] = COccupancyGridMap2D::l2p(l)>occupancyThreshold ? 0:1;
+			}
+		}
+		uint8_t isOccupied(COccupancyGridMap2D::cellType l) const
+		{
+			return occupied_lut[static_cast<COccupancyGridMap2D::cellTypeUnsigned>(l)];
+		}
+
+		/** Cost of a cell, from its distance to the nearest obstacle (in 1/3 of cells) */
+		uint8_t costFromDistance(int dist3) const
+		{
+			if (!dist3) return 255;
+			const float d = dist3*resolution*(1.f/3);
+			if (d<robotRadius) return 255;
+			if (inflationRadius<=0 || d>=robotRadius+inflationRadius) return 0;
+			return static_cast<uint8_t>(std::min(254, mrpt::utils::round(254*(1-(d-robotRadius)/inflationRadius))));
+		}
+
+		/** Recomputes the cost of cells in the given (inclusive) range from the obstacles around them, appending the changed ones to `changed` */
+		void updateCosts(int x0, int y0, int x1, int y1, std::vector<uint32_t> *changed)
+		{
+			// Cells farther than `range_cells` from the range can't affect it:
+			const int wx0 = std::max(0,x0-range_cells), wx1 = std::min(size_x-1,x1+range_cells);
+			const int wy0 = std::max(0,y0-range_cells), wy1 = std::min(size_y-1,y1+range_cells);
+			const int W = wx1-wx0+1, H = wy1-wy0+1;
+			const int FAR = 0xFFFF;
+
+			// Chamfer (3,4) distance transform, in two passes:
+			tmp_dist.resize(W*H);
+			for (int y=0;y<H;y++)
+				for (int x=0;x<W;x++)
+					tmp_dist[x+y*W] = occupied[wx0+x+(wy0+y)*size_x] ? 0 : FAR;
+			for (int y=0;y<H;y++)
+			{
+				uint16_t *row = &tmp_dist[y*W], *prev = y>0 ? &tmp_dist[(y-1)*W] : NULL;
+				for (int x=0;x<W;x++)
+				{
+					int d = row[x];
+					if (x>0) d = std::min(d, row[x-1]+3);
+					if (prev)
+					{
+						d = std::min(d, prev[x]+3);
+						if (x>0) d = std::min(d, prev[x-1]+4);
+						if (x<W-1) d = std::min(d, prev[x+1]+4);
+					}
+					row[x] = static_cast<uint16_t>(d);
+				}
+			}
+			for (int y=H-1;y>=0;y--)
+			{
+				uint16_t *row = &tmp_dist[y*W], *next = y<H-1 ? &tmp_dist[(y+1)*W] : NULL;
+				for (int x=W-1;x>=0;x--)
+				{
+					int d = row[x];
+					if (x<W-1) d = std::min(d, row[x+1]+3);
+					if (next)
+					{
+						d = std::min(d, next[x]+3);
+						if (x>0) d = std::min(d, next[x-1]+4);
+						if (x<W-1) d = std::min(d, next[x+1]+4);
+					}
+					row[x] = static_cast<uint16_t>(d);
+				}
+			}
+
+			for (int y=y0;y<=y1;y++)
+				for (int x=x0;x<=x1;x++)
+				{
+					const uint32_t i = x+y*size_x;
+					const uint8_t c = costFromDistance(tmp_dist[x-wx0+(y-wy0)*W]);
+					if (c==cost[i]) continue;
+					cost[i] = c;
+					if (changed) changed->push_back(i);
+				}
+		}
+
+		/** Detects changes in the obstacles of the map, and updates the costs around them. \return The number of changed cells */
+		size_t detectChanges(const COccupancyGridMap2D &m)
+		{
+			// Mark tiles with changes:
+			const int TILE = 64;
+			const int ntx = (size_x+TILE-1)/TILE, nty = (size_y+TILE-1)/TILE;
+			std::vector<uint8_t> dirty(ntx*nty,0);
+			const std::vector<COccupancyGridMap2D::cellType> &raw = m.getRawMap();
+			bool any = false;
+			for (int y=0;y<size_y;y++)
+			{
+				const COccupancyGridMap2D::cellType *row = &raw[y*size_x];
+				uint8_t *occ = &occupied[y*size_x];
+				for (int x=0;x<size_x;x++)
+				{
+					const uint8_t o = isOccupied(row[x]);
+					if (o==occ[x]) continue;
+					occ[x] = o;
+					dirty[x/TILE+(y/TILE)*ntx] = 1;
+					any = true;
+				}
+			}
+			if (!any) return 0;
+
+			// Recompute costs around the changed tiles, and repair the search where they changed:
+			std::vector<uint32_t> changed;
+			for (int ty=0;ty<nty;ty++)
+				for (int tx=0;tx<ntx;tx++)
+				{
+					if (!dirty[tx+ty*ntx]) continue;
+					updateCosts(
+						std::max(0,tx*TILE-range_cells), std::max(0,ty*TILE-range_cells),
+						std::min(size_x-1,(tx+1)*TILE-1+range_cells), std::min(size_y-1,(ty+1)*TILE-1+range_cells),
+						&changed);
+				}
+			for (size_t k=0;k<changed.size();k++)
+			{
+				updateVertex(changed[k]);
+				updateNeighbors(changed[k]);
+			}
+			return changed.size();
+		}
+
+		void reset(const COccupancyGridMap2D &m, const PlannerDStarLite2D &p, uint32_t goal_idx, uint32_t start_idx)
+		{
+			size_x = m.getSizeX(); size_y = m.getSizeY();
+			x_min = m.getXMin(); y_min = m.getYMin(); resolution = m.getResolution();
+			occupancyThreshold = p.occupancyThreshold;
+			robotRadius = p.robotRadius;
+			inflationRadius = std::max(0.f, p.inflationRadius);
+			inflationCostFactor = p.inflationCostFactor;
+			maxStoredCells = p.maxStoredCells;
+			range_cells = static_cast<int>(std::ceil((robotRadius+inflationRadius)/resolution))+1;
+			ASSERTMSG_(range_cells*3<0xFFFF/2, "robotRadius and inflationRadius are too large for this grid resolution")
+
+			const size_t N = size_t(size_x)*size_y;
+			buildOccupiedLUT();
+			occupied.resize(N);
+			const std::vector<COccupancyGridMap2D::cellType> &raw = m.getRawMap();
+			for (size_t i=0;i<N;i++)
+				occupied[i] = isOccupied(raw[i]);
+
+			// Costs, in bands of rows to bound the size of the temporary buffers:
+			cost.assign(N,0);
+			const int BAND = 256;
+			for (int y=0;y<size_y;y+=BAND)
+				updateCosts(0,y, size_x-1,std::min(size_y-1,y+BAND-1), NULL);
+
+			if (maxStoredCells) {
+				std::vector<TState>().swap(dense_states);
+				sparse_states.clear();
+			}
+			else {
+				dense_states.assign(N, TState());
+				std::unordered_map<uint32_t,TState>().swap(sparse_states);
+			}
+			open = std::priority_queue<TOpenEntry>();
+			last_open_id = 0;
+			km = 0;
+			goal = goal_idx;
+			start = last_start = start_idx;
+
+			stateRW(goal).rhs = 0;
+			push(goal);
+			valid = true;
+		}
+
+		bool needsReset(const COccupancyGridMap2D &m, const PlannerDStarLite2D &p, uint32_t goal_idx) const
+		{
+			return !valid || goal_idx!=goal ||
+				size_x!=static_cast<int>(m.getSizeX()) || size_y!=static_cast<int>(m.getSizeY()) ||
+				x_min!=m.getXMin() || y_min!=m.getYMin() || resolution!=m.getResolution() ||
+				occupancyThreshold!=p.occupancyThreshold || robotRadius!=p.robotRadius ||
+				inflationRadius!=std::max(0.f, p.inflationRadius) || inflationCostFactor!=p.inflationCostFactor ||
+				maxStoredCells!=p.maxStoredCells;
+		}
+	};
+}
+}
+}
+
+PIMPL_IMPLEMENT(mrpt::nav::detail::TDStarLiteImpl);
+
+/*---------------------------------------------------------------
+						Constructor
+  ---------------------------------------------------------------*/
+PlannerDStarLite2D::PlannerDStarLite2D() :
+	occupancyThreshold ( 0.5f ),
+	minStepInReturnedPath (0.4f),
+	robotRadius(0.35f),
+	inflationRadius(0.5f),
+	inflationCostFactor(2.0f),
+	maxStoredCells(0)
+{
+	PIMPL_CONSTRUCT(detail::TDStarLiteImpl, m_impl);
+}
+
+PlannerDStarLite2D::~PlannerDStarLite2D()
+{
+}
+
+void PlannerDStarLite2D::resetSearch()
+{
+	PIMPL_GET_REF(detail::TDStarLiteImpl, m_impl).valid = false;
+}
+
+/*---------------------------------------------------------------
+						computePath
+  ---------------------------------------------------------------*/
+void PlannerDStarLite2D::computePath(
+	const COccupancyGridMap2D	&theMap,
+	const CPose2D				&origin_,
+	const CPose2D				&target_,
+	std::deque<math::TPoint2D>	&path,
+	bool						&notFound,
+	float						maxSearchPathLength )
+{
+	MRPT_START
+
+	detail::TDStarLiteImpl &d = PIMPL_GET_REF(detail::TDStarLiteImpl, m_impl);
+	const TPoint2D  origin = TPoint2D(origin_);
+	const TPoint2D  target = TPoint2D(target_);
+
+	m_last_stats = TStats();
+	path.clear();
+	notFound = true;
+
+	// Check that origin and target falls inside the grid theMap!!
+	// -----------------------------------------------------------
+	ASSERT_(origin.x>theMap.getXMin() && origin.x<theMap.getXMax() &&
+			origin.y>theMap.getYMin() && origin.y<theMap.getYMax());
+	ASSERT_(target.x>theMap.getXMin() && target.x<theMap.getXMax() &&
+			target.y>theMap.getYMin() && target.y<theMap.getYMax() );
+
+	const int size_x = theMap.getSizeX();
+	const uint32_t start_idx = theMap.x2idx(origin.x) + size_x*theMap.y2idx(origin.y);
+	const uint32_t goal_idx  = theMap.x2idx(target.x) + size_x*theMap.y2idx(target.y);
+
+	// Check for the special case of origin and target in the same cell:
+	// -----------------------------------------------------------------
+	if (start_idx==goal_idx)
+	{
+		path.push_back(TPoint2D(target.x,target.y));
+		notFound = false;
+		return;
+	}
+
+	// Restart the search, or repair it with the changes since the last call:
+	// -----------------------------------------------------------------
+	if (d.needsReset(theMap, *this, goal_idx))
+	{
+		d.reset(theMap, *this, goal_idx, start_idx);
+		m_last_stats.full_replan = true;
+	}
+	else
+	{
+		d.start = start_idx;
+		if (d.start!=d.last_start)
+		{
+			d.km += d.heuristic(d.last_start, d.start);
+			d.last_start = d.start;
+		}
+		m_last_stats.changed_cells = d.detectChanges(theMap);
+	}
+
+	d.expanded = 0;
+	const bool search_ok = d.computeShortestPath();
+	m_last_stats.expanded_cells = d.expanded;
+	m_last_stats.stored_cells = d.storedCells();
+	if (!search_ok)
+	{
+		d.valid = false; // Memory limit exceeded: the search is not complete
+		return;
+	}
+
+	const float path_cost = d.state(start_idx).g;
+	if (path_cost==detail::INF)
+		return; // No path
+
+	// Follow the lowest cost neighbors from the origin to the target:
+	// ----------------------------------------------------------------
+	std::vector<uint32_t> cells;
+	float path_len = 0;
+	for (uint32_t i=start_idx; i!=goal_idx; )
+	{
+		const int x = i%size_x, y = i/size_x;
+		float best = detail::INF;
+		int best_dir = -1;
+		for (int dir=0;dir<8;dir++)
+		{
+			const float c = d.edgeCost(x,y,dir);
+			if (c==detail::INF) continue;
+			const float v = c + d.state(x+detail::NEIGH_DX[dir]+(y+detail::NEIGH_DY[dir])*size_x).g;
+			if (v<best) { best=v; best_dir=dir; }
+		}
+		ASSERT_(best_dir>=0 && cells.size()<d.storedCells());
+		path_len += best_dir<4 ? theMap.getResolution() : static_cast<float>(theMap.getResolution()*M_SQRT2);
+		i = x+detail::NEIGH_DX[best_dir]+(y+detail::NEIGH_DY[best_dir])*size_x;
+		cells.push_back(i);
+	}
+
+	// Exceeded the max. desired search length??
+	if (maxSearchPathLength>0 && path_len>maxSearchPathLength)
+		return;
+
+	notFound = false;
+	m_last_stats.path_cost = path_cost;
+
+	// Translate the path-of-cells to a path-of-2d-points with subsampling
+	//-------------------------------------------------------------------------------
+	float last_xx = origin.x, last_yy = origin.y;
+	for (size_t k=0;k+1<cells.size();k++)
+	{
+		const float xx = theMap.idx2x(cells[k]%size_x), yy = theMap.idx2y(cells[k]/size_x);
+		// Enough distance??
+		if (std::sqrt(square(xx-last_xx)+square(yy-last_yy)) > minStepInReturnedPath)
+		{
+			path.push_back(TPoint2D(xx,yy));
+			last_xx = xx;
+			last_yy = yy;
+		}
+	}
+	// Add the target point:
+	path.push_back(TPoint2D(target.x,target.y));
+
+	MRPT_END
+}
@@ -0,0 +1,134 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/nav/planners/PlannerDStarLite2D.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::nav;
+using namespace mrpt::maps;
+using namespace mrpt::math;
+using namespace mrpt::poses;
+using namespace std;
+
+namespace
+{
+	void addWall(COccupancyGridMap2D &grid, float x, float y0, float y1)
+	{
+		for (int cy=grid.y2idx(y0);cy<=grid.y2idx(y1);cy++)
+			grid.setCell(grid.x2idx(x), cy, 0.0f);
+	}
+
+	void checkPathIsFree(const COccupancyGridMap2D &grid, const std::deque<TPoint2D> &path)
+	{
+		for (size_t i=0;i<path.size();i++)
+			EXPECT_GT(grid.getPos(path[i].x,path[i].y), 0.5f);
+	}
+}
+
+TEST(NavTests, PlannerDStarLite2D_incremental)
+{
+	COccupancyGridMap2D grid(-10,10,-10,10,0.1f);
+	grid.fill(1.0f);
+	addWall(grid, 0, -5, 5);
+
+	const CPose2D target(8,0,0);
+	CPose2D origin(-8,0,0);
+
+	PlannerDStarLite2D planner;
+	std::deque<TPoint2D> path;
+	bool notFound;
+	planner.computePath(grid, origin, target, path, notFound);
+	ASSERT_FALSE(notFound);
+	EXPECT_TRUE(planner.getLastStats().full_replan);
+	EXPECT_GT(planner.getLastStats().path_cost, 16.0);
+	EXPECT_NEAR(path.back().x, 8, 1e-6);
+	checkPathIsFree(grid, path);
+
+	// Move the robot and add a small obstacle: must give the same cost as planning from scratch, with much less work:
+	origin = CPose2D(-7.5,0.5,0);
+	addWall(grid, 5, -8, -7);
+	planner.computePath(grid, origin, target, path, notFound);
+	ASSERT_FALSE(notFound);
+	const PlannerDStarLite2D::TStats inc = planner.getLastStats();
+	EXPECT_FALSE(inc.full_replan);
+	EXPECT_GT(inc.changed_cells, 0u);
+	checkPathIsFree(grid, path);
+	{
+		PlannerDStarLite2D fresh;
+		std::deque<TPoint2D> path2;
+		fresh.computePath(grid, origin, target, path2, notFound);
+		ASSERT_FALSE(notFound);
+		EXPECT_TRUE(fresh.getLastStats().full_replan);
+		EXPECT_NEAR(inc.path_cost, fresh.getLastStats().path_cost, 1e-3);
+		EXPECT_LT(inc.expanded_cells, fresh.getLastStats().expanded_cells/2);
+	}
+
+	// Block the current way, forcing a long detour:
+	origin = CPose2D(-6,1,0);
+	addWall(grid, 3, -9.9f, 2);
+	planner.computePath(grid, origin, target, path, notFound);
+	ASSERT_FALSE(notFound);
+	checkPathIsFree(grid, path);
+	{
+		PlannerDStarLite2D fresh;
+		std::deque<TPoint2D> path2;
+		fresh.computePath(grid, origin, target, path2, notFound);
+		ASSERT_FALSE(notFound);
+		EXPECT_NEAR(planner.getLastStats().path_cost, fresh.getLastStats().path_cost, 1e-3);
+	}
+
+	// No changes at all: nothing to do.
+	planner.computePath(grid, origin, target, path, notFound);
+	ASSERT_FALSE(notFound);
+	EXPECT_EQ(planner.getLastStats().changed_cells, 0u);
+	EXPECT_EQ(planner.getLastStats().expanded_cells, 0u);
+
+	// Close the last gap: no path.
+	addWall(grid, 3, 2, 9.9f);
+	planner.computePath(grid, origin, target, path, notFound);
+	EXPECT_TRUE(notFound);
+
+	// Reopen it:
+	for (int cy=grid.y2idx(-9.9f);cy<=grid.y2idx(9.9f);cy++)
+		grid.setCell(grid.x2idx(3.0f), cy, 1.0f);
+	planner.computePath(grid, origin, target, path, notFound);
+	EXPECT_FALSE(notFound);
+	EXPECT_FALSE(planner.getLastStats().full_replan);
+}
+
+TEST(NavTests, PlannerDStarLite2D_boundedMemory)
+{
+	COccupancyGridMap2D grid(-10,10,-10,10,0.1f);
+	grid.fill(1.0f);
+	addWall(grid, 0, -5, 5);
+	const CPose2D origin(-8,0,0), target(8,0,0);
+
+	PlannerDStarLite2D dense;
+	std::deque<TPoint2D> path;
+	bool notFound;
+	dense.computePath(grid, origin, target, path, notFound);
+	ASSERT_FALSE(notFound);
+	EXPECT_EQ(dense.getLastStats().stored_cells, grid.getSizeX()*grid.getSizeY());
+
+	PlannerDStarLite2D sparse;
+	sparse.maxStoredCells = 100;
+	sparse.computePath(grid, origin, target, path, notFound);
+	EXPECT_TRUE(notFound);
+
+	sparse.maxStoredCells = 30000;
+	sparse.computePath(grid, origin, target, path, notFound);
+	ASSERT_FALSE(notFound);
+	EXPECT_NEAR(sparse.getLastStats().path_cost, dense.getLastStats().path_cost, 1e-3);
+	EXPECT_LE(sparse.getLastStats().stored_cells, 30000u);
+
+	// Search length limit:
+	sparse.computePath(grid, origin, target, path, notFound, 10.0f);
+	EXPECT_TRUE(notFound);
+}
@@ -21,8 +21,6 @@ using namespace mrpt::math;
 using namespace mrpt::poses;
 using namespace std;
 
-MRPT_TODO("Optimize getNearestNode() with KD-tree!")
-
 PlannerRRT_SE2_TPS::PlannerRRT_SE2_TPS() :
 	m_initialized(false)
 {
@@ -42,9 +40,152 @@ void PlannerRRT_SE2_TPS::initialize()
 	m_initialized = true;
 }
 
+void PlannerRRT_SE2_TPS::onNewBestSolution(const TPlannerInput &, const TPlannerResult &)
+{
+	// Default: do nothing
+}
+
+// Cost of the path from the root to a given node:
+static double costToCome(const TMoveTreeSE2_TP &tree, mrpt::utils::TNodeID id)
+{
+	const TMoveTreeSE2_TP::node_map_t &nodes = tree.getAllNodes();
+	double cost = 0;
+	for (;;)
+	{
+		const TMoveTreeSE2_TP::node_t &node = nodes.find(id)->second;
+		if (!node.edge_to_parent)
+			return cost;
+		cost += node.edge_to_parent->cost;
+		id = node.parent_id;
+	}
+}
+
+bool PlannerRRT_SE2_TPS::findDirectEdge(const TPlannerInput &pi, const node_pose_t &from, const node_pose_t &to, TMoveEdgeSE2_TP &out_edge)
+{
+	const CPose2D from_pose(from);
+	const CPose2D rel = CPose2D(to) - from_pose;
+	bool found = false;
+
+	for (size_t idxPTG=0;idxPTG<m_PTGs.size();++idxPTG)
+	{
+		const CParameterizedTrajectoryGenerator &ptg = *m_PTGs[idxPTG];
+
+		int k;
+		double d;
+		if (!ptg.inverseMap_WS2TP(rel.x(), rel.y(), k, d))
+			continue;
+		d *= ptg.getRefDistance();
+		if (d<=0 || d>std::min(params.maxLength, ptg.getRefDistance()) || (found && d>=out_edge.cost))
+			continue;
+
+		// The path must end at the target node, also in heading, up to the PTG discretization (one path step):
+		// the target keeps its state, from which the edges to its descendants were collision-checked.
+		uint32_t nStep;
+		if (!ptg.getPathStepForDist(k, d, nStep))
+			continue;
+		const size_t nSteps = ptg.getPathStepCount(k);
+		if (nSteps<2)
+			continue;
+		mrpt::math::TPose2D end_rel, next_rel;
+		ptg.getPathPose(k, nStep, end_rel);
+		ptg.getPathPose(k, nStep+1<nSteps ? nStep+1 : nStep-1, next_rel);
+		const double EPS = 1e-3; // Numerical slack for paths which don't move (in rotation or translation) between steps
+		const double max_dist_err = std::sqrt(mrpt::math::square(next_rel.x-end_rel.x)+mrpt::math::square(next_rel.y-end_rel.y)) + EPS;
+		const double max_ang_err  = std::abs(mrpt::math::angDistance(next_rel.phi, end_rel.phi)) + EPS;
+		if (std::sqrt(mrpt::math::square(end_rel.x-rel.x())+mrpt::math::square(end_rel.y-rel.y()))>max_dist_err ||
+			std::abs(mrpt::math::angDistance(end_rel.phi, rel.phi()))>max_ang_err)
+			continue;
+
+		// Collision check along the path:
+		const double MAX_DIST_FOR_OBSTACLES = 1.5*ptg.getRefDistance();
+		double d_free = .0;
+		transformPointcloudWithSquareClipping(pi.obstacles_points, m_local_obs, from_pose, MAX_DIST_FOR_OBSTACLES);
+		spaceTransformerOneDirectionOnly(k, m_local_obs, &ptg, MAX_DIST_FOR_OBSTACLES, d_free);
+		if (d_free<d)
+			continue;
+
+		out_edge = TMoveEdgeSE2_TP(INVALID_NODEID, to);
+		out_edge.cost      = d;
+		out_edge.ptg_index = idxPTG;
+		out_edge.ptg_K     = k;
+		out_edge.ptg_dist  = d;
+		found = true;
+	}
+	return found;
+}
+
+bool PlannerRRT_SE2_TPS::rewireNewNode(const TPlannerInput &pi, TPlannerResult &result, const mrpt::utils::TNodeID new_node_id)
+{
+	static const CTimeLogger::TSectionHandle hRewire = CTimeLogger::registerSection("PT_RRT::solve.rewire");
+	CTimeLoggerEntry tle(m_timelogger, hRewire);
+
+	TMoveTreeSE2_TP &tree = result.move_tree;
+	const TMoveTreeSE2_TP::node_map_t &nodes = tree.getAllNodes();
+	const node_pose_t new_state = nodes.find(new_node_id)->second.state;
+
+	std::vector<mrpt::utils::TNodeID> near_ids;
+	tree.getNodesWithinXYDistance(new_state.x, new_state.y, params.rewiringRadius, near_ids);
+
+	bool changed = false;
+	double new_cost = costToCome(tree, new_node_id);
+
+	// 1) Choose the parent which leads to the lowest cost. Collisions are only checked for the
+	//    candidates which would improve the current cost, in increasing order of cost:
+	std::multimap<double, TMoveEdgeSE2_TP> parent_candidates;
+	for (size_t i=0;i<near_ids.size();i++)
+	{
+		const mrpt::utils::TNodeID id = near_ids[i];
+		if (id==new_node_id || id==nodes.find(new_node_id)->second.parent_id)
+			continue;
+		const double cost_via = costToCome(tree, id);
+		if (cost_via>=new_cost)
+			continue;
+		const CPose2D rel = CPose2D(new_state) - CPose2D(nodes.find(id)->second.state);
+		if (cost_via + rel.norm() >= new_cost)
+			continue; // Paths are never shorter than the straight line
+		TMoveEdgeSE2_TP edge;
+		if (!findDirectEdge(pi, nodes.find(id)->second.state, new_state, edge) || cost_via+edge.cost>=new_cost)
+			continue;
+		edge.parent_id = id;
+		parent_candidates.insert(std::make_pair(cost_via+edge.cost, edge));
+	}
+	if (!parent_candidates.empty())
+	{
+		const TMoveEdgeSE2_TP &best = parent_candidates.begin()->second;
+		tree.changeParent(new_node_id, best.parent_id, best);
+		new_cost = parent_candidates.begin()->first;
+		changed = true;
+	}
+
+	// 2) Rewire the neighbors through the new node, if that is cheaper for them.
+	//    The new node is a leaf, so only its ancestors can't hang from it:
+	std::set<mrpt::utils::TNodeID> ancestors;
+	for (mrpt::utils::TNodeID id = nodes.find(new_node_id)->second.parent_id; id!=INVALID_NODEID; id = nodes.find(id)->second.parent_id)
+		ancestors.insert(id);
+
+	for (size_t i=0;i<near_ids.size();i++)
+	{
+		const mrpt::utils::TNodeID id = near_ids[i];
+		if (id==new_node_id || ancestors.count(id))
+			continue;
+		const node_pose_t &near_state = nodes.find(id)->second.state;
+		const double cur_cost = costToCome(tree, id);
+		const CPose2D rel = CPose2D(near_state) - CPose2D(new_state);
+		if (new_cost + rel.norm() >= cur_cost)
+			continue;
+		TMoveEdgeSE2_TP edge;
+		if (!findDirectEdge(pi, new_state, near_state, edge) || new_cost+edge.cost>=cur_cost)
+			continue;
+		edge.parent_id = new_node_id;
+		tree.changeParent(id, new_node_id, edge);
+		changed = true;
+	}
+	return changed;
+}
+
 /** The main API entry point: tries to find a planned path from 'goal' to 'target' */
-void PlannerRRT_SE2_TPS::solve( 
-	const PlannerRRT_SE2_TPS::TPlannerInput &pi, 
+void PlannerRRT_SE2_TPS::solve(
+	const PlannerRRT_SE2_TPS::TPlannerInput &pi,
 	PlannerRRT_SE2_TPS::TPlannerResult & result )
 {
 	mrpt::utils::CTimeLoggerEntry tle(m_timelogger,"PT_RRT::solve");
@@ -56,6 +197,12 @@ void PlannerRRT_SE2_TPS::solve(
 	double max_veh_radius=0.;
 	for (const auto & ptg : m_PTGs)
 		mrpt::utils::keep_max(max_veh_radius, ptg->getMaxRobotRadius());
+	for (const auto & ptg : m_PTGs)
+		ASSERT_ABOVE_(ptg->getRefDistance(),1.1*max_veh_radius); // Make sure the PTG covers at least a bit more than the vehicle shape!! (should be much, much higher)
+
+	// The KD-tree of obstacles is used to clip them around each node. Build it now, since it's not thread-safe to do it on demand:
+	pi.obstacles_points.kdTreeEnsureIndexBuilt2D();
+	m_ptg_eval_threads.resize(params.ptg_eval_threads);
 
 	// [Algo `tp_space_rrt`: Line 1]: Init tree adding the initial pose
 	if (result.move_tree.getAllNodes().empty())
@@ -72,6 +219,189 @@ void PlannerRRT_SE2_TPS::solve(
 	static size_t SAVE_LOG_SOLVE_COUNT=0;
 	SAVE_LOG_SOLVE_COUNT++;
 
+	static const CTimeLogger::TSectionHandle hGetNearestNode = CTimeLogger::registerSection("TMoveTree::getNearestNode");
+	static const CTimeLogger::TSectionHandle hChangeCoordRef = CTimeLogger::registerSection("PT_RRT::solve.changeCoordinatesReference");
+	static const CTimeLogger::TSectionHandle hSpaceTransformer = CTimeLogger::registerSection("PT_RRT::solve.SpaceTransformer");
+
+	// The best extension of the tree towards x_rand with each PTG:
+	struct TExtensionCandidate
+	{
+		TExtensionCandidate() : found_nearest(false), valid(false) {}
+		bool found_nearest; //!< Whether any node can reach x_rand with this PTG
+		bool valid;         //!< Whether `edge` is a collision-free new edge, far enough from existing nodes
+		TMoveEdgeSE2_TP edge;
+		std::string log_txt;
+	};
+
+	// Computes the extensions with a range of PTGs. Each PTG is only used by one thread, since they are not thread-safe:
+	struct TExtendTask : public mrpt::system::CWorkerThreadsPool::TRangeTask
+	{
+		PlannerRRT_SE2_TPS &planner;
+		const TPlannerInput &pi;
+		const TPlannerResult &result;
+		const node_pose_t &x_rand;
+		std::vector<TExtensionCandidate> &candidates;
+		mrpt::maps::CSimplePointsMap *local_obs; //!< Temporary map to reuse, or NULL to use one per call
+
+		TExtendTask(PlannerRRT_SE2_TPS &planner_, const TPlannerInput &pi_, const TPlannerResult &result_, const node_pose_t &x_rand_,
+			std::vector<TExtensionCandidate> &candidates_, mrpt::maps::CSimplePointsMap *local_obs_) :
+			planner(planner_), pi(pi_), result(result_), x_rand(x_rand_), candidates(candidates_), local_obs(local_obs_)
+		{ }
+
+		void operator()(size_t first, size_t last) const MRPT_OVERRIDE
+		{
+			mrpt::maps::CSimplePointsMap tmp_obs;
+			mrpt::maps::CSimplePointsMap &obs = local_obs ? *local_obs : tmp_obs;
+			for (size_t idxPTG=first;idxPTG<last;++idxPTG)
+				extend(idxPTG, obs, candidates[idxPTG]);
+		}
+
+		void extend(const size_t idxPTG, mrpt::maps::CSimplePointsMap &obs, TExtensionCandidate &out) const
+		{
+			const CParameterizedTrajectoryGenerator &ptg = *planner.m_PTGs[idxPTG];
+			const RRTAlgorithmParams &params = planner.params;
+
+			// [Algo `tp_space_rrt`: Line 5]: Search nearest neig. to x_rand
+			// -----------------------------------------------
+			const PoseDistanceMetric<TNodeSE2_TP> distance_evaluator(ptg);
+			const PoseDistanceMetric<TNodeSE2> distance_evaluator_se2;  // Plain distances in SE(2), not along PTGs
+
+			const TNodeSE2_TP query_node(x_rand);
+
+			mrpt::utils::TNodeID x_nearest_id;
+			{
+				CTimeLoggerEntry tle(planner.m_timelogger, hGetNearestNode);
+				x_nearest_id = result.move_tree.getNearestNode(query_node, distance_evaluator );
+			}
+			if (x_nearest_id==INVALID_NODEID)
+				return; // We can't find any close node, at least with this PTG's paths: skip
+			out.found_nearest = true;
+
+			const TNodeSE2_TP &     x_nearest_node = result.move_tree.getAllNodes().find(x_nearest_id)->second;
+
+			// [Algo `tp_space_rrt`: Line 6]: Relative target
+			// -----------------------------------------------
+			const CPose2D x_nearest_pose( x_nearest_node.state );
+			const CPose2D x_rand_rel = CPose2D(x_rand) - x_nearest_pose;
+
+			// [Algo `tp_space_rrt`: Line 7]: Relative target in TP-Space
+			// ------------------------------------------------------------
+			const double D_max = std::min(params.maxLength, ptg.getRefDistance() );
+
+			double d_rand; // Coordinates in TP-space
+			int   k_rand; // k_rand is the index of target_alpha in PTGs corresponding to a specific d_rand
+			//bool tp_point_is_exact =
+			ptg.inverseMap_WS2TP(
+				x_rand_rel.x(), x_rand_rel.y(),
+				k_rand, d_rand );
+			d_rand *= ptg.getRefDistance(); // distance to target, in "real meters"
+
+			// [Algo `tp_space_rrt`: Line 8]: TP-Obstacles
+			// ------------------------------------------------------------
+			// Transform obstacles as seen from x_nearest_node -> TP_obstacles
+			double TP_Obstacles_k_rand = .0;
+			const double MAX_DIST_FOR_OBSTACLES = 1.5*ptg.getRefDistance(); // Maximum Euclidean distance (radius) for considering obstacles around the current robot pose
+
+			{
+				CTimeLoggerEntry tle(planner.m_timelogger, hChangeCoordRef);
+				PlannerTPS_VirtualBase::transformPointcloudWithSquareClipping(pi.obstacles_points,obs,x_nearest_pose,MAX_DIST_FOR_OBSTACLES);
+			}
+			{
+				CTimeLoggerEntry tle(planner.m_timelogger, hSpaceTransformer);
+				planner.spaceTransformerOneDirectionOnly(k_rand, obs, &ptg, MAX_DIST_FOR_OBSTACLES, TP_Obstacles_k_rand);
+			}
+
+			// directions k_rand in TP_obstacles[k_rand] = d_free
+			// this is the collision free distance to the TP_target
+			const double d_free = TP_Obstacles_k_rand;
+
+			// [Algo `tp_space_rrt`: Line 10]: d_new
+			// ------------------------------------------------------------
+			const double d_new = std::min(D_max, d_rand);   //distance of the new candidate state in TP-space
+
+#ifdef DO_LOG_TXTS
+			out.log_txt += mrpt::format("tp_idx=%u\n d_free: %f d_rand=%f d_new=%f\n",static_cast<unsigned int>(idxPTG),d_free,d_rand,d_new);
+			out.log_txt += mrpt::format(" nearest:%s\n",x_nearest_pose.asString().c_str());
+#endif
+
+			// [Algo `tp_space_rrt`: Line 13]: Do we have free space?
+			// ------------------------------------------------------------
+			if (d_free<d_new)
+			{
+#ifdef DO_LOG_TXTS
+				out.log_txt += mrpt::format(" -> d_free NOT < d_rand\n");
+#endif
+				return;
+			}
+
+			// [Algo `tp_space_rrt`: Line 14]: PTG function
+			// ------------------------------------------------------------
+			//given d_rand and k_rand provides x,y,phi of the point in c-space
+			uint32_t nStep;
+			ptg.getPathStepForDist(k_rand, d_new, nStep);
+
+			mrpt::math::TPose2D rel_pose;
+			ptg.getPathPose(k_rand, nStep, rel_pose);
+
+			mrpt::math::wrapToPiInPlace(rel_pose.phi); // wrap to [-pi,pi] -->avoid out of bounds errors
+
+			// [Algo `tp_space_rrt`: Line 15]: pose composition
+			// ------------------------------------------------------------
+			const mrpt::poses::CPose2D new_state_rel(rel_pose);
+			const mrpt::poses::CPose2D new_state = x_nearest_pose+new_state_rel; //compose the new_motion as the last nmotion and the new state
+
+			// Check whether there's already a too-close node around:
+			// --------------------------------------------------------
+			bool accept_this_node = true;
+
+			// Is this a potential solution
+			const double goal_dist = new_state.distance2DTo(pi.goal_pose.x,pi.goal_pose.y);
+			const double goal_ang  = std::abs( mrpt::math::angDistance(new_state.phi(), pi.goal_pose.phi ) );
+			const bool is_acceptable_goal =
+				(goal_dist<planner.end_criteria.acceptedDistToTarget) &&
+				(goal_ang <planner.end_criteria.acceptedAngToTarget);
+
+			mrpt::utils::TNodeID new_nearest_id=INVALID_NODEID;
+			if (!is_acceptable_goal) // Only check for nearby nodes if this is not a solution!
+			{
+				double new_nearest_dist;
+				const TNodeSE2 new_state_node(new_state);
+
+				{
+					CTimeLoggerEntry tle(planner.m_timelogger, hGetNearestNode);
+					new_nearest_id = result.move_tree.getNearestNode(new_state_node, distance_evaluator_se2,&new_nearest_dist, &result.acceptable_goal_node_ids );
+				}
+
+				if (new_nearest_id!=INVALID_NODEID)
+				{
+					// Also check angular distance:
+					const double new_nearest_ang = std::abs( mrpt::math::angDistance(new_state.phi(), result.move_tree.getAllNodes().find(new_nearest_id)->second.state.phi ) );
+					accept_this_node = (new_nearest_dist>=params.minDistanceBetweenNewNodes || new_nearest_ang >= params.minAngBetweenNewNodes);
+				}
+			}
+
+			if (!accept_this_node)
+			{
+#ifdef DO_LOG_TXTS
+				if (new_nearest_id!=INVALID_NODEID) {
+					out.log_txt += mrpt::format(" -> new node NOT accepted for closeness to: %s\n",result.move_tree.getAllNodes().find(new_nearest_id)->second.state.asString().c_str());
+				}
+#endif
+				return; // Too close node, skip!
+			}
+
+			// [Algo `tp_space_rrt`: Line 16]: Add to candidate solution set
+			// ------------------------------------------------------------
+			// Create "movement" (tree edge) object:
+			out.edge = TMoveEdgeSE2_TP(x_nearest_id, mrpt::math::TPose2D(new_state));
+			out.edge.cost     = d_new;
+			out.edge.ptg_index= idxPTG;
+			out.edge.ptg_K    = k_rand;
+			out.edge.ptg_dist = d_new;
+			out.valid = true;
+		}
+	};
+
 	// Keep track of the best solution so far:
 	// By reusing the contents of "result" we make the algorithm re-callable ("any-time" algorithm) to refine results
 
@@ -109,30 +439,27 @@ void PlannerRRT_SE2_TPS::solve(
 		typedef std::map<double,TMoveEdgeSE2_TP> sorted_solution_list_t;
 		sorted_solution_list_t  candidate_new_nodes; // Map: cost -> info. Pick begin() to select the lowest-cose one.
 
-		const PoseDistanceMetric<TNodeSE2> distance_evaluator_se2;  // Plain distances in SE(2), not along PTGs
 		bool is_new_best_solution = false; // Just for logging purposes
 
 //#define DO_LOG_TXTS
-		std::string sLogTxt; 
+		std::string sLogTxt;
 
-		// [Algo `tp_space_rrt`: Line 5]: For each PTG
+		// [Algo `tp_space_rrt`: Line 5]: For each PTG, possibly in parallel (see RRTAlgorithmParams::ptg_eval_threads)
 		// -----------------------------------------
 		const size_t nPTGs = m_PTGs.size();
+		std::vector<TExtensionCandidate> candidates(nPTGs);
+		if (m_ptg_eval_threads.size()<=1 || nPTGs<2)
+			TExtendTask(*this, pi, result, x_rand, candidates, &m_local_obs)(0, nPTGs);
+		else
+			m_ptg_eval_threads.parallel_for(nPTGs, TExtendTask(*this, pi, result, x_rand, candidates, NULL));
+
+		// Collect the candidates in PTG order, so the result is the same than with a sequential evaluation:
 		for (size_t idxPTG=0;idxPTG<nPTGs;++idxPTG)
 		{
 			rrt_iter_counter++;
+			sLogTxt += candidates[idxPTG].log_txt;
 
-			// [Algo `tp_space_rrt`: Line 5]: Search nearest neig. to x_rand
-			// -----------------------------------------------
-			const PoseDistanceMetric<TNodeSE2_TP> distance_evaluator(*m_PTGs[idxPTG]);
-
-			const TNodeSE2_TP query_node(x_rand);
-			
-			m_timelogger.enter("TMoveTree::getNearestNode");
-			mrpt::utils::TNodeID x_nearest_id = result.move_tree.getNearestNode(query_node, distance_evaluator );
-			m_timelogger.leave("TMoveTree::getNearestNode");
-
-			if (x_nearest_id==INVALID_NODEID)
+			if (!candidates[idxPTG].found_nearest)
 			{
 				// We can't find any close node, at least with this PTG's paths: skip
 
@@ -153,147 +480,11 @@ void PlannerRRT_SE2_TPS::solve(
 					mrpt::system::createDirectory("./rrt_log_trees");
 					scene.saveToFile( mrpt::format("./rrt_log_trees/rrt_log_%03u_%06u.3Dscene",static_cast<unsigned int>(SAVE_LOG_SOLVE_COUNT),static_cast<unsigned int>(rrt_iter_counter) ) );
 				}
-
 				continue; // Skip
 			}
 
-			const TNodeSE2_TP &     x_nearest_node = result.move_tree.getAllNodes().find(x_nearest_id)->second;
-
-			// [Algo `tp_space_rrt`: Line 6]: Relative target
-			// -----------------------------------------------
-			const CPose2D x_nearest_pose( x_nearest_node.state );
-			const CPose2D x_rand_rel = x_rand_pose - x_nearest_pose;
-
-			// [Algo `tp_space_rrt`: Line 7]: Relative target in TP-Space
-			// ------------------------------------------------------------
-			const double D_max = std::min(params.maxLength, m_PTGs[idxPTG]->getRefDistance() );
-
-			double d_rand; // Coordinates in TP-space
-			int   k_rand; // k_rand is the index of target_alpha in PTGs corresponding to a specific d_rand
-			//bool tp_point_is_exact =
-			m_PTGs[idxPTG]->inverseMap_WS2TP(
-				x_rand_rel.x(), x_rand_rel.y(),
-				k_rand, d_rand );
-			d_rand *= m_PTGs[idxPTG]->getRefDistance(); // distance to target, in "real meters"
-
-			float d_free;
-			//bool local_obs_ok = false; // Just for 3D log files: indicates whether obstacle points have been recomputed
-
-			// [Algo `tp_space_rrt`: Line 8]: TP-Obstacles
-			// ------------------------------------------------------------
-			// Transform obstacles as seen from x_nearest_node -> TP_obstacles
-			double TP_Obstacles_k_rand = .0; //vector<double> TP_Obstacles;
-			const double MAX_DIST_FOR_OBSTACLES = 1.5*m_PTGs[idxPTG]->getRefDistance(); // Maximum Euclidean distance (radius) for considering obstacles around the current robot pose
-			
-			ASSERT_ABOVE_(m_PTGs[idxPTG]->getRefDistance(),1.1*max_veh_radius); // Make sure the PTG covers at least a bit more than the vehicle shape!! (should be much, much higher)
-
-			{
-				CTimeLoggerEntry tle(m_timelogger,"PT_RRT::solve.changeCoordinatesReference");
-				transformPointcloudWithSquareClipping(pi.obstacles_points,m_local_obs,CPose2D(x_nearest_node.state),MAX_DIST_FOR_OBSTACLES);
-				//local_obs_ok=true;
-			}
-			{
-				CTimeLoggerEntry tle(m_timelogger,"PT_RRT::solve.SpaceTransformer");
-				spaceTransformerOneDirectionOnly(k_rand, m_local_obs, m_PTGs[idxPTG].pointer(), MAX_DIST_FOR_OBSTACLES, TP_Obstacles_k_rand);
-			}
-
-			// directions k_rand in TP_obstacles[k_rand] = d_free
-			// this is the collision free distance to the TP_target
-			d_free = TP_Obstacles_k_rand; // TP_Obstacles[k_rand];
-
-			// [Algo `tp_space_rrt`: Line 10]: d_new
-			// ------------------------------------------------------------
-			double d_new = std::min(D_max, d_rand);   //distance of the new candidate state in TP-space
-
-			//mrpt::poses::CPose2D *log_new_state_ptr=NULL; // For graphical logs only
-
-#ifdef DO_LOG_TXTS
-			sLogTxt += mrpt::format("tp_idx=%u tp_exact=%c\n d_free: %f d_rand=%f d_new=%f\n",static_cast<unsigned int>(idxPTG), tp_point_is_exact ? 'Y':'N',d_free,d_rand,d_new);
-			sLogTxt += mrpt::format(" nearest:%s\n",x_nearest_pose.asString().c_str());
-#endif
-
-			// [Algo `tp_space_rrt`: Line 13]: Do we have free space?
-			// ------------------------------------------------------------
-			if ( d_free>=d_new )
-			{
-				// [Algo `tp_space_rrt`: Line 14]: PTG function
-				// ------------------------------------------------------------
-				//given d_rand and k_rand provides x,y,phi of the point in c-space
-				uint32_t nStep;
-				m_PTGs[idxPTG]->getPathStepForDist(k_rand, d_new, nStep);
-
-				mrpt::math::TPose2D rel_pose;
-				m_PTGs[idxPTG]->getPathPose(k_rand, nStep, rel_pose);
-
-				mrpt::math::wrapToPiInPlace(rel_pose.phi); // wrap to [-pi,pi] -->avoid out of bounds errors
-
-				// [Algo `tp_space_rrt`: Line 15]: pose composition
-				// ------------------------------------------------------------
-				const mrpt::poses::CPose2D new_state_rel(rel_pose);
-				mrpt::poses::CPose2D new_state = x_nearest_pose+new_state_rel; //compose the new_motion as the last nmotion and the new state
-				//log_new_state_ptr = &new_state;
-
-				// Check whether there's already a too-close node around:
-				// --------------------------------------------------------
-				bool accept_this_node = true;
-
-
-				// Is this a potential solution
-				const double goal_dist = new_state.distance2DTo(pi.goal_pose.x,pi.goal_pose.y);
-				const double goal_ang  = std::abs( mrpt::math::angDistance(new_state.phi(), pi.goal_pose.phi ) );
-				const bool is_acceptable_goal =
-					(goal_dist<end_criteria.acceptedDistToTarget) &&
-					(goal_ang <end_criteria.acceptedAngToTarget);
-
-				mrpt::utils::TNodeID new_nearest_id=INVALID_NODEID;
-				if (!is_acceptable_goal) // Only check for nearby nodes if this is not a solution!
-				{
-					double new_nearest_dist;
-					const TNodeSE2 new_state_node(new_state);
-
-					m_timelogger.enter("TMoveTree::getNearestNode");
-					new_nearest_id = result.move_tree.getNearestNode(new_state_node, distance_evaluator_se2,&new_nearest_dist, &result.acceptable_goal_node_ids );
-					m_timelogger.leave("TMoveTree::getNearestNode");
-
-					if (new_nearest_id!=INVALID_NODEID)
-					{
-						// Also check angular distance:
-						const double new_nearest_ang = std::abs( mrpt::math::angDistance(new_state.phi(), result.move_tree.getAllNodes().find(new_nearest_id)->second.state.phi ) );
-						accept_this_node = (new_nearest_dist>=params.minDistanceBetweenNewNodes || new_nearest_ang >= params.minAngBetweenNewNodes);
-					}
-				}
-
-				if (!accept_this_node)
-				{
-#ifdef DO_LOG_TXTS
-					if (new_nearest_id!=INVALID_NODEID) {
-						sLogTxt += mrpt::format(" -> new node NOT accepted for closeness to: %s\n",result.move_tree.getAllNodes().find(new_nearest_id)->second.state.asString().c_str());
-					}
-#endif
-					continue; // Too close node, skip!
-				}
-
-				// [Algo `tp_space_rrt`: Line 16]: Add to candidate solution set
-				// ------------------------------------------------------------
-				// Create "movement" (tree edge) object:
-				TMoveEdgeSE2_TP new_edge(x_nearest_id, mrpt::math::TPose2D(new_state));
-				
-				new_edge.cost     = d_new;
-				new_edge.ptg_index= idxPTG;
-				new_edge.ptg_K    = k_rand;
-				new_edge.ptg_dist = d_new;
-
-				candidate_new_nodes[new_edge.cost] = new_edge;
-
-			} // end if the path is obstacle free
-			else
-			{
-#ifdef DO_LOG_TXTS
-				sLogTxt += mrpt::format(" -> d_free NOT < d_rand\n");
-#endif
-			}
-
-
+			if (candidates[idxPTG].valid)
+				candidate_new_nodes[candidates[idxPTG].edge.cost] = candidates[idxPTG].edge;
 		} // end for idxPTG
 
 		// [Algo `tp_space_rrt`: Line 19]: Any solution found?
@@ -307,40 +498,47 @@ void PlannerRRT_SE2_TPS::solve(
 			const mrpt::utils::TNodeID new_child_id = result.move_tree.getNextFreeNodeID();
 			result.move_tree.insertNodeAndEdge(best_edge.parent_id, new_child_id, new_state_node, best_edge);
 
+			// RRT*: pick the best parent for the new node, and rewire its neighbors through it:
+			const bool rewired = params.rewiringRadius>0 && rewireNewNode(pi, result, new_child_id);
+
 			// Distance to goal:
 			const double goal_dist = mrpt::poses::CPose2D(best_edge.end_state).distance2DTo(pi.goal_pose.x,pi.goal_pose.y);
 			const double goal_ang  = std::abs( mrpt::math::angDistance(best_edge.end_state.phi, pi.goal_pose.phi ) );
 
-			const bool is_acceptable_goal = 
-				(goal_dist<end_criteria.acceptedDistToTarget) && 
+			const bool is_acceptable_goal =
+				(goal_dist<end_criteria.acceptedDistToTarget) &&
 				(goal_ang <end_criteria.acceptedAngToTarget);
 
 			if (is_acceptable_goal)
 				result.acceptable_goal_node_ids.insert(new_child_id);
 
-			// Total path length:
-			double this_path_cost = std::numeric_limits<double>::max();
-			if (is_acceptable_goal)  // Don't waste time computing path length if it doesn't matter anyway
+			// Check if this should be the new optimal path.
+			// Rewiring may shorten the path to any goal node, otherwise only the new one must be checked:
+			if (is_acceptable_goal || rewired)
 			{
-				TMoveTreeSE2_TP::path_t candidate_solution_path;
-				result.move_tree.backtrackPath(new_child_id,candidate_solution_path);
-				this_path_cost=0;
-				for (TMoveTreeSE2_TP::path_t::const_iterator it=candidate_solution_path.begin();it!=candidate_solution_path.end();++it)
-					if (it->edge_to_parent)
-						this_path_cost+=it->edge_to_parent->cost;
-			}
+				std::set<mrpt::utils::TNodeID> goals_to_check;
+				if (rewired) goals_to_check = result.acceptable_goal_node_ids;
+				else goals_to_check.insert(new_child_id);
 
-			// Check if this should be the new optimal path:
-			if (is_acceptable_goal && this_path_cost<result.path_cost)
-			{
-				result.goal_distance  = goal_dist;
-				result.path_cost = this_path_cost;
+				for (std::set<mrpt::utils::TNodeID>::const_iterator it=goals_to_check.begin();it!=goals_to_check.end();++it)
+				{
+					// Total path length:
+					const double this_path_cost = costToCome(result.move_tree, *it);
+					if (this_path_cost<result.path_cost)
+					{
+						result.goal_distance = mrpt::poses::CPose2D(result.move_tree.getAllNodes().find(*it)->second.state).distance2DTo(pi.goal_pose.x,pi.goal_pose.y);
+						result.path_cost = this_path_cost;
 
-				result.best_goal_node_id = new_child_id;
-				is_new_best_solution=true;
+						result.best_goal_node_id = *it;
+						is_new_best_solution=true;
+					}
+				}
 			}
 		} // end if any candidate found
 
+		if (is_new_best_solution)
+			onNewBestSolution(pi, result);
+
 		//  Graphical logging, if enabled:
 		// ------------------------------------------------------
 		if (params.save_3d_log_freq>0 && (++SAVE_3D_TREE_LOG_DECIMATION_CNT >= params.save_3d_log_freq || is_new_best_solution))
@@ -352,9 +550,6 @@ void PlannerRRT_SE2_TPS::solve(
 			TRenderPlannedPathOptions render_options;
 			render_options.highlight_path_to_node_id = result.best_goal_node_id;
 			render_options.x_rand_pose = &x_rand_pose;
-			//render_options.x_nearest_pose = &x_nearest_pose;
-			//if (local_obs_ok) render_options.local_obs_from_nearest_pose =  &m_local_obs;
-			//render_options.new_state = log_new_state_ptr;
 			render_options.highlight_last_added_edge = true;
 			render_options.ground_xy_grid_frequency = 1.0;
 
@@ -378,6 +573,3 @@ void PlannerRRT_SE2_TPS::solve(
 	result.computation_time = working_time.Tac();
 
 }  // end solve()
-
-
-
@@ -0,0 +1,241 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/nav/planners/PlannerRRT_SE2_TPS.h>
+#include <mrpt/utils/CConfigFileMemory.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::nav;
+using namespace mrpt::math;
+using namespace mrpt::poses;
+using namespace mrpt::utils;
+using namespace std;
+
+TEST(NavTests, TMoveTree_getNearestNode)
+{
+	mrpt::random::CRandomGenerator rnd(1234);
+
+	TMoveTreeSE2_TP tree;
+	tree.setNodesIndexResolution(0.5);
+	tree.root = 0;
+	tree.insertNode(0, TNodeSE2_TP(TPose2D(0,0,0)));
+	for (TNodeID id=1;id<500;id++)
+	{
+		const TNodeID parent = rnd.drawUniform32bit() % id;
+		const TPose2D p(rnd.drawUniform(-10,15), rnd.drawUniform(-5,5), rnd.drawUniform(-M_PI,M_PI));
+		tree.insertNodeAndEdge(parent, id, TNodeSE2_TP(p), TMoveEdgeSE2_TP(parent,p));
+	}
+
+	std::set<TNodeID> ignored;
+	for (TNodeID id=0;id<500;id+=7)
+		ignored.insert(id);
+
+	const PoseDistanceMetric<TNodeSE2> metric;
+	for (int i=0;i<200;i++)
+	{
+		// Include queries far from all nodes:
+		const TNodeSE2 q(TPose2D(rnd.drawUniform(-30,30), rnd.drawUniform(-20,20), rnd.drawUniform(-M_PI,M_PI)));
+		const bool use_ignored = (i%2)!=0;
+
+		// Brute force:
+		double min_d = std::numeric_limits<double>::max();
+		TNodeID min_id = INVALID_NODEID;
+		for (TMoveTreeSE2_TP::node_map_t::const_iterator it=tree.getAllNodes().begin();it!=tree.getAllNodes().end();++it)
+		{
+			if (use_ignored && ignored.count(it->first)) continue;
+			const double d = metric.distance(TNodeSE2(it->second.state), q);
+			if (d<min_d) { min_d=d; min_id=it->first; }
+		}
+
+		double d;
+		EXPECT_EQ(min_id, tree.getNearestNode(q, metric, &d, use_ignored ? &ignored : NULL));
+		EXPECT_DOUBLE_EQ(min_d, d);
+	}
+
+	// Radius search:
+	std::vector<TNodeID> ids;
+	tree.getNodesWithinXYDistance(1.0, 2.0, 3.0, ids);
+	size_t n_expected=0;
+	for (TMoveTreeSE2_TP::node_map_t::const_iterator it=tree.getAllNodes().begin();it!=tree.getAllNodes().end();++it)
+		if (square(it->second.state.x-1.0)+square(it->second.state.y-2.0)<=9.0)
+		{
+			n_expected++;
+			EXPECT_TRUE(std::find(ids.begin(),ids.end(),it->first)!=ids.end());
+		}
+	EXPECT_EQ(n_expected, ids.size());
+}
+
+TEST(NavTests, TMoveTree_changeParent)
+{
+	TMoveTreeSE2_TP tree;
+	tree.root = 0;
+	tree.insertNode(0, TNodeSE2_TP(TPose2D(0,0,0)));
+	for (TNodeID id=1;id<=3;id++)
+	{
+		TMoveEdgeSE2_TP e(id-1, TPose2D(id,0,0));
+		e.cost = 1.0;
+		tree.insertNodeAndEdge(id-1, id, TNodeSE2_TP(e.end_state), e);
+	}
+	// 0 -> 1 -> 2 -> 3  ==>  0 -> 1, 0 -> 2 -> 3
+	TMoveEdgeSE2_TP e(0, TPose2D(2,0,0));
+	e.cost = 1.5;
+	tree.changeParent(2, 0, e);
+
+	TMoveTreeSE2_TP::path_t path;
+	tree.backtrackPath(3, path);
+	ASSERT_EQ(path.size(), 3u);
+	EXPECT_EQ(path.front().node_id, 0u);
+	double cost=0;
+	for (TMoveTreeSE2_TP::path_t::const_iterator it=path.begin();it!=path.end();++it)
+		if (it->edge_to_parent) cost+=it->edge_to_parent->cost;
+	EXPECT_DOUBLE_EQ(cost, 2.5);
+	EXPECT_EQ(tree.edges_to_children[0].size(), 2u);
+	EXPECT_TRUE(tree.edges_to_children[1].empty());
+}
+
+namespace
+{
+	class PlannerCountingSolutions : public PlannerRRT_SE2_TPS
+	{
+	public:
+		PlannerCountingSolutions() : num_solutions(0), last_cost(std::numeric_limits<double>::max()), costs_decrease(true) {}
+		size_t num_solutions;
+		double last_cost;
+		bool costs_decrease;
+	protected:
+		void onNewBestSolution(const TPlannerInput &, const TPlannerResult &result) MRPT_OVERRIDE
+		{
+			num_solutions++;
+			if (result.path_cost>=last_cost) costs_decrease=false;
+			last_cost = result.path_cost;
+		}
+	};
+
+	void setupPlanner(PlannerRRT_SE2_TPS &planner, size_t num_threads, double rewiring_radius)
+	{
+		CConfigFileMemory cfg;
+		cfg.write("PTG_CONFIG","robot_shape","[-0.2 0.2 0.2 -0.2; -0.1 -0.1 0.1 0.1]");
+		cfg.write("PTG_CONFIG","PTG_COUNT",2);
+		cfg.write("PTG_CONFIG","PTG0_Type","CPTG_DiffDrive_C");
+		cfg.write("PTG_CONFIG","PTG0_K",1.0);
+		cfg.write("PTG_CONFIG","PTG1_Type","CPTG_DiffDrive_alpha");
+		cfg.write("PTG_CONFIG","PTG1_cte_a0v_deg",57);
+		cfg.write("PTG_CONFIG","PTG1_cte_a0w_deg",57);
+		for (int i=0;i<2;i++)
+		{
+			cfg.write("PTG_CONFIG",mrpt::format("PTG%i_resolution",i),0.10);
+			cfg.write("PTG_CONFIG",mrpt::format("PTG%i_refDistance",i),3.0);
+			cfg.write("PTG_CONFIG",mrpt::format("PTG%i_num_paths",i),61);
+			cfg.write("PTG_CONFIG",mrpt::format("PTG%i_v_max_mps",i),2.0);
+			cfg.write("PTG_CONFIG",mrpt::format("PTG%i_w_max_dps",i),120);
+		}
+		planner.loadConfig(cfg);
+		planner.params.ptg_verbose = false;
+		planner.params.ptg_cache_files_directory = mrpt::system::extractFileDirectory(mrpt::system::getTempFileName());
+		planner.params.maxLength = 1.5;
+		planner.params.ptg_eval_threads = num_threads;
+		planner.params.rewiringRadius = rewiring_radius;
+		planner.end_criteria.acceptedDistToTarget = 0.30;
+		planner.end_criteria.acceptedAngToTarget = DEG2RAD(180);
+		planner.end_criteria.maxComputationTime = 20.0;
+		planner.getProfiler().disable();
+		planner.initialize();
+	}
+
+	void setupProblem(PlannerRRT_SE2_TPS::TPlannerInput &pi)
+	{
+		pi.start_pose = TPose2D(0,0,0);
+		pi.goal_pose = TPose2D(4,0,0);
+		pi.world_bbox_min = TPose2D(-2,-3,-M_PI);
+		pi.world_bbox_max = TPose2D(6,3,M_PI);
+		// A wall between start and goal:
+		for (double y=-1.5;y<=1.5;y+=0.05)
+			pi.obstacles_points.insertPoint(2.0,y,0);
+	}
+}
+
+TEST(NavTests, PlannerRRT_SE2_TPS_threads_and_rewiring)
+{
+	PlannerRRT_SE2_TPS::TPlannerInput pi;
+	setupProblem(pi);
+
+	// The same tree must be built with one or more threads:
+	PlannerRRT_SE2_TPS::TPlannerResult res1, res2;
+	{
+		PlannerRRT_SE2_TPS planner;
+		setupPlanner(planner, 1, 0);
+		mrpt::random::randomGenerator.randomize(321);
+		planner.solve(pi, res1);
+	}
+	PlannerCountingSolutions planner;
+	setupPlanner(planner, 2, 1.0);
+	planner.params.rewiringRadius = 0; // Plain RRT for the first solution
+	mrpt::random::randomGenerator.randomize(321);
+	planner.solve(pi, res2);
+
+	ASSERT_TRUE(res1.success);
+	ASSERT_TRUE(res2.success);
+	EXPECT_EQ(res1.move_tree.getAllNodes().size(), res2.move_tree.getAllNodes().size());
+	EXPECT_EQ(res1.best_goal_node_id, res2.best_goal_node_id);
+	EXPECT_DOUBLE_EQ(res1.path_cost, res2.path_cost);
+	EXPECT_EQ(planner.num_solutions, 1u);
+
+	// Keep refining the same tree with RRT* (any-time planning):
+	planner.params.rewiringRadius = 1.0;
+	planner.end_criteria.minComputationTime = 1.0;
+	const double first_cost = res2.path_cost;
+	planner.solve(pi, res2);
+	EXPECT_TRUE(res2.success);
+	EXPECT_LE(res2.path_cost, first_cost);
+	EXPECT_TRUE(planner.costs_decrease);
+	EXPECT_DOUBLE_EQ(planner.last_cost, res2.path_cost);
+
+	// The tree must remain consistent after rewiring: every node reaches the root, and path costs add up:
+	const TMoveTreeSE2_TP::node_map_t &nodes = res2.move_tree.getAllNodes();
+	for (TMoveTreeSE2_TP::node_map_t::const_iterator it=nodes.begin();it!=nodes.end();++it)
+	{
+		TNodeID id = it->first;
+		size_t depth=0;
+		while (id!=res2.move_tree.root && depth<=nodes.size())
+		{
+			const TMoveTreeSE2_TP::node_t &n = nodes.find(id)->second;
+			ASSERT_TRUE(n.edge_to_parent!=NULL);
+			EXPECT_EQ(n.edge_to_parent->parent_id, n.parent_id);
+			id = n.parent_id;
+			depth++;
+		}
+		EXPECT_EQ(id, res2.move_tree.root);
+	}
+	// ...and every edge, rewired or not, takes its node to the state of its child (up to one PTG step):
+	for (TMoveTreeSE2_TP::node_map_t::const_iterator it=nodes.begin();it!=nodes.end();++it)
+	{
+		if (!it->second.edge_to_parent)
+			continue;
+		const TMoveEdgeSE2_TP &e = *it->second.edge_to_parent;
+		const CParameterizedTrajectoryGenerator &ptg = *planner.getPTGs()[e.ptg_index];
+		uint32_t nStep;
+		ASSERT_TRUE(ptg.getPathStepForDist(e.ptg_K, e.ptg_dist, nStep));
+		const uint32_t nNext = nStep+1<ptg.getPathStepCount(e.ptg_K) ? nStep+1 : nStep-1;
+		TPose2D end_rel, next_rel;
+		ptg.getPathPose(e.ptg_K, nStep, end_rel);
+		ptg.getPathPose(e.ptg_K, nNext, next_rel);
+		const CPose2D end = CPose2D(nodes.find(it->second.parent_id)->second.state) + CPose2D(end_rel);
+		EXPECT_LE(end.distance2DTo(it->second.state.x, it->second.state.y), CPose2D(next_rel).distance2DTo(end_rel.x, end_rel.y)+1e-3);
+		EXPECT_LE(std::abs(mrpt::math::angDistance(end.phi(), it->second.state.phi)), std::abs(mrpt::math::angDistance(next_rel.phi, end_rel.phi))+1e-3);
+	}
+	TMoveTreeSE2_TP::path_t path;
+	res2.move_tree.backtrackPath(res2.best_goal_node_id, path);
+	double cost=0;
+	for (TMoveTreeSE2_TP::path_t::const_iterator it=path.begin();it!=path.end();++it)
+		if (it->edge_to_parent) cost+=it->edge_to_parent->cost;
+	EXPECT_NEAR(cost, res2.path_cost, 1e-9);
+}
@@ -27,7 +27,9 @@ RRTAlgorithmParams::RRTAlgorithmParams() :
 	minDistanceBetweenNewNodes(0.10),
 	minAngBetweenNewNodes(mrpt::utils::DEG2RAD(15)),
 	ptg_verbose(true),
-	save_3d_log_freq(0)
+	save_3d_log_freq(0),
+	rewiringRadius(0),
+	ptg_eval_threads(1)
 {
 	robot_shape.push_back(mrpt::math::TPoint2D(-0.5, -0.5));
 	robot_shape.push_back(mrpt::math::TPoint2D(0.8, -0.4));
@@ -77,7 +79,7 @@ void PlannerTPS_VirtualBase::internal_initialize_PTG()
 		}
 
 		m_PTGs[i]->initialize(
-			mrpt::format("%s/TPRRT_PTG_%03u.dat.gz", params.ptg_cache_files_directory.c_str(), static_cast<unsigned int>(i)),
+			mrpt::format("%s/TPRRT_PTG_%03u.dat", params.ptg_cache_files_directory.c_str(), static_cast<unsigned int>(i)),
 			params.ptg_verbose
 		);
 	}
@@ -135,13 +137,20 @@ void PlannerTPS_VirtualBase::transformPointcloudWithSquareClipping(
 	in_map.getPointsBuffer(nObs, obs_xs, obs_ys, obs_zs);
 
 	out_map.clear();
-	out_map.reserve(nObs); // Prealloc mem for speed-up
+
+	// Only visit the points within the circle circumscribing the square, with the KD-tree of the map.
+	// (Callers from several threads must build it in advance with kdTreeEnsureIndexBuilt2D())
+	std::vector<std::pair<size_t, float> > idxs;
+	if (nObs)
+		in_map.kdTreeRadiusSearch2D(static_cast<float>(asSeenFrom.x()), static_cast<float>(asSeenFrom.y()), static_cast<float>(2 * MAX_DIST_XY*MAX_DIST_XY), idxs);
+	out_map.reserve(idxs.size()); // Prealloc mem for speed-up
 
 	const CPose2D invPose = -asSeenFrom;
 	// We can safely discard the rest of obstacles, since they cannot be converted into TP-Obstacles anyway!
 
-	for (size_t obs = 0; obs<nObs; obs++)
+	for (size_t i = 0; i<idxs.size(); i++)
 	{
+		const size_t obs = idxs[i].first;
 		const double gx = obs_xs[obs], gy = obs_ys[obs];
 
 		if (std::abs(gx - asSeenFrom.x())>MAX_DIST_XY || std::abs(gy - asSeenFrom.y())>MAX_DIST_XY)
@@ -392,25 +392,77 @@ void CAbstractPTGBasedReactive::performNavigationStep()
 		m_infoPerPTG_timestamp = tim_start_iteration;
 		vector<TCandidateMovementPTG> candidate_movs(nPTGs+1); // the last extra one is for the evaluation of "NOP motion command" choice.
 
-		for (size_t indexPTG=0;indexPTG<nPTGs;indexPTG++)
+		// Evaluate each PTG, possibly in parallel (see TAbstractPTGNavigatorParams::ptg_eval_threads):
 		{
-			CParameterizedTrajectoryGenerator * ptg = getPTG(indexPTG);
-			TInfoPerPTG &ipf = m_infoPerPTG[indexPTG];
-
-			// The picked movement in TP-Space (to be determined by holonomic method below)
-			TCandidateMovementPTG &cm = candidate_movs[indexPTG];
+			struct TEvalPTGsTask : public mrpt::system::CWorkerThreadsPool::TRangeTask
+			{
+				CAbstractPTGBasedReactive &nav;
+				const TPose2D &relTarget, &rel_pose_PTG_origin_wrt_sense;
+				std::vector<TCandidateMovementPTG> &candidate_movs;
+				std::vector<CLogFileRecord> *ptgLogRecs; //!< One per PTG, or NULL to write all to newLogRec
+				CLogFileRecord &newLogRec;
+				const mrpt::system::TTimeStamp tim_start_iteration;
+
+				TEvalPTGsTask(CAbstractPTGBasedReactive &nav_, const TPose2D &relTarget_, const TPose2D &rel_pose_PTG_origin_wrt_sense_,
+					std::vector<TCandidateMovementPTG> &candidate_movs_, std::vector<CLogFileRecord> *ptgLogRecs_, CLogFileRecord &newLogRec_,
+					const mrpt::system::TTimeStamp tim_start_iteration_) :
+					nav(nav_), relTarget(relTarget_), rel_pose_PTG_origin_wrt_sense(rel_pose_PTG_origin_wrt_sense_),
+					candidate_movs(candidate_movs_), ptgLogRecs(ptgLogRecs_), newLogRec(newLogRec_), tim_start_iteration(tim_start_iteration_)
+				{}
+
+				void operator()(size_t first, size_t last) const MRPT_OVERRIDE
+				{
+					for (size_t indexPTG=first;indexPTG<last;indexPTG++)
+					{
+						nav.build_movement_candidate(
+							nav.getPTG(indexPTG), indexPTG,
+							relTarget, rel_pose_PTG_origin_wrt_sense,
+							nav.m_infoPerPTG[indexPTG], candidate_movs[indexPTG],
+							ptgLogRecs ? (*ptgLogRecs)[indexPTG] : newLogRec, false /* this is a regular PTG reactive case */,
+							nav.m_holonomicMethod[indexPTG],
+							tim_start_iteration,
+							*nav.m_navigationParams
+							);
+					}
+				}
+			};
 
 			ASSERT_(m_navigationParams);
-			build_movement_candidate(
-				ptg, indexPTG,
-				relTarget, rel_pose_PTG_origin_wrt_sense,
-				ipf, cm,
-				newLogRec, false /* this is a regular PTG reactive case */,
-				m_holonomicMethod[indexPTG],
-				tim_start_iteration,
-				*m_navigationParams
-				);
-		} // end for each PTG
+			mrpt::utils::CTicTac tictacPTGs;
+			m_ptg_eval_threads.resize(params_abstract_ptg_navigator.ptg_eval_threads);
+
+			if (m_ptg_eval_threads.size()<=1 || nPTGs<2)
+			{
+				TEvalPTGsTask(*this, relTarget, rel_pose_PTG_origin_wrt_sense, candidate_movs, NULL, newLogRec, tim_start_iteration)(0, nPTGs);
+			}
+			else
+			{
+				// Each PTG writes its debug messages into its own log record. They are merged afterwards in PTG order,
+				// so the final log is exactly the same as in the sequential evaluation:
+				std::vector<CLogFileRecord> ptgLogRecs(nPTGs);
+				for (size_t indexPTG=0;indexPTG<nPTGs;indexPTG++)
+				{
+					ptgLogRecs[indexPTG].infoPerPTG.resize(indexPTG+1);
+					std::swap(ptgLogRecs[indexPTG].infoPerPTG[indexPTG], newLogRec.infoPerPTG[indexPTG]);
+				}
+
+				m_ptg_eval_threads.parallel_for(nPTGs, TEvalPTGsTask(*this, relTarget, rel_pose_PTG_origin_wrt_sense, candidate_movs, &ptgLogRecs, newLogRec, tim_start_iteration));
+
+				for (size_t indexPTG=0;indexPTG<nPTGs;indexPTG++)
+				{
+					std::swap(ptgLogRecs[indexPTG].infoPerPTG[indexPTG], newLogRec.infoPerPTG[indexPTG]);
+					for (const auto &msg : ptgLogRecs[indexPTG].additional_debug_msgs)
+						newLogRec.additional_debug_msgs[msg.first] = msg.second;
+				}
+			}
+
+			newLogRec.values["PTGsEvaluationTime"] = tictacPTGs.Tac();
+			newLogRec.values["PTGsEvaluationThreads"] = std::min<size_t>(m_ptg_eval_threads.size(), nPTGs);
+
+			// CTimeLogger user measures are not thread-safe: register them here, in PTG order.
+			for (size_t indexPTG=0;indexPTG<nPTGs;indexPTG++)
+				registerPTGEvaluationTimes(m_infoPerPTG[indexPTG], newLogRec.infoPerPTG[indexPTG], false);
+		}
 
 		// check for collision, which is reflected by ALL TP-Obstacles being zero:
 		bool is_all_ptg_collision = true;
@@ -524,6 +576,7 @@ void CAbstractPTGBasedReactive::performNavigationStep()
 					tim_start_iteration,
 					*m_navigationParams,
 					rel_cur_pose_wrt_last_vel_cmd_NOP);
+				registerPTGEvaluationTimes(m_infoPerPTG[nPTGs], newLogRec.infoPerPTG[nPTGs], true);
 
 			} // end valid interpolated origin pose
 			else
@@ -1214,7 +1267,9 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 		}
 	}
 
-	double timeForTPObsTransformation = .0, timeForHolonomicMethod = .0;
+	// This may run in parallel for different PTGs: use a local timer, and only thread-safe CTimeLogger methods.
+	mrpt::utils::CTicTac tictacPTG, tictacStep;
+	double timeForTPObsTransformation = .0, timeForHolonomicMethod = .0, timeForCandidateScores = .0;
 
 	// Normal PTG validity filter: check if target falls into the PTG domain:
 	if (ipf.valid_TP)
@@ -1243,7 +1298,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 		//  STEP3(b): Build TP-Obstacles
 		// -----------------------------------------------------------------------------
 		{
-			tictac.Tic();
+			tictacStep.Tic();
 
 			// Initialize TP-Obstacles:
 			const size_t Ki = ptg->getAlphaValuesCount();
@@ -1263,16 +1318,14 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 			const double _refD = 1.0 / ptg->getRefDistance();
 			for (size_t i = 0; i < Ki; i++) ipf.TP_Obstacles[i] *= _refD;
 
-			timeForTPObsTransformation = tictac.Tac();
-			if (m_timelogger.isEnabled())
-				m_timelogger.registerUserMeasure("navigationStep.STEP3_WSpaceToTPSpace", timeForTPObsTransformation);
+			timeForTPObsTransformation = tictacStep.Tac();
 		}
 
 		//  STEP4: Holonomic navigation method
 		// -----------------------------------------------------------------------------
 		if (!this_is_PTG_continuation)
 		{
-			tictac.Tic();
+			tictacStep.Tic();
 
 			ASSERT_(holoMethod);
 			// Slow down if we are approaching the final target, etc.
@@ -1319,9 +1372,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 			// Scale:
 			cm.speed *= velScale;
 
-			timeForHolonomicMethod = tictac.Tac();
-			if (m_timelogger.isEnabled())
-				m_timelogger.registerUserMeasure("navigationStep.STEP4_HolonomicMethod", timeForHolonomicMethod);
+			timeForHolonomicMethod = tictacStep.Tac();
 		}
 		else
 		{
@@ -1333,7 +1384,9 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 		// STEP5: Evaluate each movement to assign them a "evaluation" value.
 		// ---------------------------------------------------------------------
 		{
-			CTimeLoggerEntry tle(m_timelogger, "navigationStep.calc_move_candidate_scores");
+			static const CTimeLogger::TSectionHandle hScores = CTimeLogger::registerSection("navigationStep.calc_move_candidate_scores");
+			CTimeLoggerEntry tle(m_timelogger, hScores);
+			tictacStep.Tic();
 
 			calc_move_candidate_scores(
 				cm,
@@ -1355,15 +1408,22 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 
 			//  SAVE LOG
 			newLogRec.infoPerPTG[idx_in_log_infoPerPTGs].evalFactors = cm.props;
+			timeForCandidateScores = tictacStep.Tac();
 		}
 
 	} // end "valid_TP"
 
+	// Timing (always stored, see registerPTGEvaluationTimes()):
+	CLogFileRecord::TInfoPerPTG &ipp = newLogRec.infoPerPTG[idx_in_log_infoPerPTGs];
+	ipp.timeForTPObsTransformation = timeForTPObsTransformation;
+	ipp.timeForHolonomicMethod = timeForHolonomicMethod;
+	ipp.timeForCandidateScores = timeForCandidateScores;
+	ipp.timeForPTGEvaluation = tictacPTG.Tac();
+
 	// Logging:
 	const bool fill_log_record = (m_logFile != NULL || m_enableKeepLogRecords);
 	if (fill_log_record)
 	{
-		CLogFileRecord::TInfoPerPTG &ipp = newLogRec.infoPerPTG[idx_in_log_infoPerPTGs];
 		if (!this_is_PTG_continuation)
 		     ipp.PTG_desc = ptg->getDescription();
 		else ipp.PTG_desc = mrpt::format("NOP cmdvel (prev PTG idx=%u)", static_cast<unsigned int>(m_lastSentVelCmd.ptg_index) );
@@ -1374,11 +1434,18 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 		ipp.HLFR = HLFR;
 		ipp.desiredDirection = cm.direction;
 		ipp.desiredSpeed = cm.speed;
-		ipp.timeForTPObsTransformation = timeForTPObsTransformation;
-		ipp.timeForHolonomicMethod = timeForHolonomicMethod;
 	}
 }
 
+void CAbstractPTGBasedReactive::registerPTGEvaluationTimes(const TInfoPerPTG &ipf, const CLogFileRecord::TInfoPerPTG &ipp, const bool this_is_PTG_continuation)
+{
+	if (!m_timelogger.isEnabled() || !ipf.valid_TP)
+		return;
+	m_timelogger.registerUserMeasure("navigationStep.STEP3_WSpaceToTPSpace", ipp.timeForTPObsTransformation);
+	if (!this_is_PTG_continuation)
+		m_timelogger.registerUserMeasure("navigationStep.STEP4_HolonomicMethod", ipp.timeForHolonomicMethod);
+}
+
 void CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::loadFromConfigFile(const mrpt::utils::CConfigFileBase & c, const std::string & s)
 {
 	MRPT_START;
@@ -1397,6 +1464,7 @@ void CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR_CS(enable_obstacle_filtering, bool);
 	MRPT_LOAD_CONFIG_VAR_CS(evaluate_clearance, bool);
 	MRPT_LOAD_CONFIG_VAR_CS(max_dist_for_timebased_path_prediction, double);
+	MRPT_LOAD_CONFIG_VAR_CS(ptg_eval_threads, int);
 
 	MRPT_END;
 }
@@ -1433,6 +1501,7 @@ void CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::saveToConfigFile(mr
 	MRPT_SAVE_CONFIG_VAR_COMMENT(enable_obstacle_filtering, "Enabled obstacle filtering (params in its own section)");
 	MRPT_SAVE_CONFIG_VAR_COMMENT(evaluate_clearance, "Enable exact computation of clearance (default=false)");
 	MRPT_SAVE_CONFIG_VAR_COMMENT(max_dist_for_timebased_path_prediction, "Max dist [meters] to use time-based path prediction for NOP evaluation");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(ptg_eval_threads, "Number of threads to evaluate the PTGs concurrently (default=1: sequential; 0: as many as CPU cores)");
 }
 
 CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::TAbstractPTGNavigatorParams() :
@@ -1448,7 +1517,8 @@ CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::TAbstractPTGNavigatorPar
 	robot_absolute_speed_limits(),
 	enable_obstacle_filtering(true),
 	evaluate_clearance(false),
-	max_dist_for_timebased_path_prediction(2.0)
+	max_dist_for_timebased_path_prediction(2.0),
+	ptg_eval_threads(1)
 {
 }
 
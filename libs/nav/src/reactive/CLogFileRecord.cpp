@@ -49,7 +49,7 @@ CLogFileRecord::CLogFileRecord() :
 void  CLogFileRecord::writeToStream(mrpt::utils::CStream &out,int *version) const
 {
 	if (version)
-		*version = 25;
+		*version = 26;
 	else
 	{
 		uint32_t	i,n;
@@ -80,6 +80,7 @@ void  CLogFileRecord::writeToStream(mrpt::utils::CStream &out,int *version) cons
 
 			// Was: out << infoPerPTG[i].clearance.raw_clearances; // v19
 			infoPerPTG[i].clearance.writeToStream(out); // v25
+			out << infoPerPTG[i].timeForCandidateScores << infoPerPTG[i].timeForPTGEvaluation; // v26
 		}
 		out << nSelectedPTG << WS_Obstacles;
 		out << WS_Obstacles_original; // v20
@@ -164,6 +165,7 @@ void  CLogFileRecord::readFromStream(mrpt::utils::CStream &in,int version)
 	case 23:
 	case 24:
 	case 25:
+	case 26:
 		{
 			// Version 0 --------------
 			uint32_t  i,n;
@@ -239,6 +241,14 @@ void  CLogFileRecord::readFromStream(mrpt::utils::CStream &in,int version)
 				else {
 					ipp.clearance.clear();
 				}
+
+				if (version >= 26) {
+					in >> ipp.timeForCandidateScores >> ipp.timeForPTGEvaluation;
+				}
+				else {
+					ipp.timeForCandidateScores = .0;
+					ipp.timeForPTGEvaluation = ipp.timeForTPObsTransformation + ipp.timeForHolonomicMethod;
+				}
 			}
 
 			in >> nSelectedPTG >> WS_Obstacles;
@@ -157,7 +157,7 @@ void CReactiveNavigationSystem::STEP1_InitPTGs()
 
 			// Init:
 			PTGs[i]->initialize(
-				format("%s/ReacNavGrid_%03u.dat.gz", params_abstract_ptg_navigator.ptg_cache_files_directory.c_str(), i),
+				format("%s/ReacNavGrid_%03u.dat", params_abstract_ptg_navigator.ptg_cache_files_directory.c_str(), i),
 				m_enableConsoleOutput /*verbose*/
 			);
 			logStr(mrpt::utils::LVL_INFO,"Done!");
@@ -212,6 +212,9 @@ void CReactiveNavigationSystem::STEP3_WSpaceToTPSpace(const size_t ptg_idx,std::
 	const float *xs,*ys,*zs;
 	m_WS_Obstacles.getPointsBuffer(nObs,xs,ys,zs);
 
+	std::vector<double> obs_x, obs_y;
+	obs_x.reserve(nObs);
+	obs_y.reserve(nObs);
 	for (size_t obs=0;obs<nObs;obs++)
 	{
 		double ox,oy,oz=zs[obs];
@@ -221,12 +224,16 @@ void CReactiveNavigationSystem::STEP3_WSpaceToTPSpace(const size_t ptg_idx,std::
 			oy>-OBS_MAX_XY && oy<OBS_MAX_XY &&
 			oz>=params_reactive_nav.min_obstacles_height && oz<= params_reactive_nav.max_obstacles_height)
 		{
-			ptg->updateTPObstacle(ox, oy, out_TPObstacles);
-			if (eval_clearance) {
-				ptg->updateClearance(ox, oy, out_clearance);
-			}
+			obs_x.push_back(ox);
+			obs_y.push_back(oy);
 		}
 	}
+
+	ptg->updateTPObstacleBatch(obs_x, obs_y, out_TPObstacles);
+	if (eval_clearance) {
+		for (size_t i=0;i<obs_x.size();i++)
+			ptg->updateClearance(obs_x[i], obs_y[i], out_clearance);
+	}
 }
 
 
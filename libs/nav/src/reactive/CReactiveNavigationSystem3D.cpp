@@ -169,7 +169,7 @@ void CReactiveNavigationSystem3D::STEP1_InitPTGs()
 				}
 
 				m_ptgmultilevel[j].PTGs[i]->initialize(
-					format("%s/ReacNavGrid_%03u_L%02u.dat.gz", params_abstract_ptg_navigator.ptg_cache_files_directory.c_str(), i, j),
+					format("%s/ReacNavGrid_%03u_L%02u.dat", params_abstract_ptg_navigator.ptg_cache_files_directory.c_str(), i, j),
 					m_enableConsoleOutput /*verbose*/
 				);
 				MRPT_LOG_INFO("...Done.");
@@ -257,20 +257,23 @@ void CReactiveNavigationSystem3D::STEP3_WSpaceToTPSpace(
 
 	const mrpt::poses::CPose2D rel_pose_PTG_origin_wrt_sense(rel_pose_PTG_origin_wrt_sense_);
 
+	std::vector<double> obs_x, obs_y;
 	for (size_t j=0;j<m_robotShape.size();j++)
 	{
 		size_t nObs;
 		const float *xs,*ys,*zs;
 		m_WS_Obstacles_inlevels[j].getPointsBuffer(nObs,xs,ys,zs);
 
+		obs_x.resize(nObs);
+		obs_y.resize(nObs);
 		for (size_t obs=0;obs<nObs;obs++)
-		{
-			double ox, oy;
-			rel_pose_PTG_origin_wrt_sense.composePoint(xs[obs], ys[obs], ox, oy);
-			m_ptgmultilevel[ptg_idx].PTGs[j]->updateTPObstacle(ox, oy, out_TPObstacles);
-			if (eval_clearance) {
-				m_ptgmultilevel[ptg_idx].PTGs[j]->updateClearance(ox, oy, out_clearance);
-			}
+			rel_pose_PTG_origin_wrt_sense.composePoint(xs[obs], ys[obs], obs_x[obs], obs_y[obs]);
+
+		CParameterizedTrajectoryGenerator *ptg = m_ptgmultilevel[ptg_idx].PTGs[j];
+		ptg->updateTPObstacleBatch(obs_x, obs_y, out_TPObstacles);
+		if (eval_clearance) {
+			for (size_t obs=0;obs<nObs;obs++)
+				ptg->updateClearance(obs_x[obs], obs_y[obs], out_clearance);
 		}
 	}
 
@@ -26,7 +26,9 @@ void run_rnav_test(
 	const TPoint2D &world_topleft,
 	const TPoint2D &world_rightbottom,
 	const TPoint2D &block_obstacle_topleft = TPoint2D(0,0),
-	const TPoint2D &block_obstacle_rightbottom = TPoint2D(0,0)
+	const TPoint2D &block_obstacle_rightbottom = TPoint2D(0,0),
+	const unsigned int ptg_eval_threads = 1,
+	mrpt::nav::CLogFileRecord *out_first_step_log = NULL //!< If provided, only the first navigation step is run, and its log is returned here
 	)
 {
 	using namespace std;
@@ -43,6 +45,7 @@ void run_rnav_test(
 
 	mrpt::utils::CConfigFile cfg(sFil);
 	cfg.write("CAbstractPTGBasedReactive", "holonomic_method", sHoloMethod);
+	cfg.write("CAbstractPTGBasedReactive", "ptg_eval_threads", ptg_eval_threads);
 	cfg.discardSavingChanges();
 
 	// Create a grid map with a synthetic test environment with a simple obstacle:
@@ -117,6 +120,7 @@ void run_rnav_test(
 		//printf("[run_rnav_test] navlog dir: `%s`\n", sTmpDir.c_str());
 		rnav.setLogFileDirectory(sTmpDir);
 		rnav.enableLogFile(true);
+		rnav.enableKeepLogRecords(out_first_step_log!=NULL);
 	}
 
 	// Load options:
@@ -132,6 +136,15 @@ void run_rnav_test(
 
 	rnav.navigate(&np);
 
+	if (out_first_step_log)
+	{
+		rnav.navigationStep();
+		rnav.getLastLogRecord(*out_first_step_log);
+		const_cast<mrpt::utils::CTimeLogger&>(rnav.getTimeLogger()).clear(true);
+		const_cast<mrpt::utils::CTimeLogger&>(rnav.getDelaysTimeLogger()).clear(true);
+		return;
+	}
+
 	unsigned int MAX_ITERS = 200;
 	for (unsigned int i = 0; i < MAX_ITERS; i++)
 	{
@@ -195,3 +208,46 @@ TEST(CReactiveNavigationSystem3D, with_obstacle_nav_ND) {
 TEST(CReactiveNavigationSystem3D, with_obstacle_nav_FullEval) {
 	run_rnav_test<mrpt::nav::CReactiveNavigationSystem3D>("reactive3d_config.ini", "CHolonomicFullEval", with_obs_trg, with_obs_topleft, with_obs_bottomright, obs_tl, obs_br);
 }
+
+TEST(CReactiveNavigationSystem, with_obstacle_nav_FullEval_parallel_PTGs) {
+	run_rnav_test<mrpt::nav::CReactiveNavigationSystem>("reactive2d_config.ini", "CHolonomicFullEval", with_obs_trg, with_obs_topleft, with_obs_bottomright, obs_tl, obs_br, 4);
+}
+TEST(CReactiveNavigationSystem3D, with_obstacle_nav_FullEval_parallel_PTGs) {
+	run_rnav_test<mrpt::nav::CReactiveNavigationSystem3D>("reactive3d_config.ini", "CHolonomicFullEval", with_obs_trg, with_obs_topleft, with_obs_bottomright, obs_tl, obs_br, 4);
+}
+
+// The log of a navigation step must not depend on the PTGs being evaluated in parallel (except for the timing fields):
+template <typename RNAVCLASS>
+void run_rnav_parallel_log_test(const std::string &sFilename)
+{
+	mrpt::nav::CLogFileRecord log_seq, log_par;
+	run_rnav_test<RNAVCLASS>(sFilename, "CHolonomicFullEval", with_obs_trg, with_obs_topleft, with_obs_bottomright, obs_tl, obs_br, 1, &log_seq);
+	run_rnav_test<RNAVCLASS>(sFilename, "CHolonomicFullEval", with_obs_trg, with_obs_topleft, with_obs_bottomright, obs_tl, obs_br, 4, &log_par);
+
+	if (!mrpt::system::fileExists(mrpt::system::find_mrpt_shared_dir() + std::string("config_files/navigation-ptgs/") + sFilename))
+		return; // Skipped, see run_rnav_test()
+	ASSERT_FALSE(log_seq.infoPerPTG.empty());
+	ASSERT_EQ(log_seq.infoPerPTG.size(), log_par.infoPerPTG.size());
+	for (size_t i=0;i<log_seq.infoPerPTG.size();i++)
+	{
+		const mrpt::nav::CLogFileRecord::TInfoPerPTG &s = log_seq.infoPerPTG[i], &p = log_par.infoPerPTG[i];
+		EXPECT_EQ(s.PTG_desc, p.PTG_desc);
+		ASSERT_EQ(s.TP_Obstacles.size(), p.TP_Obstacles.size());
+		for (int k=0;k<s.TP_Obstacles.size();k++)
+			EXPECT_EQ(s.TP_Obstacles[k], p.TP_Obstacles[k]);
+		EXPECT_EQ(s.TP_Target, p.TP_Target);
+		EXPECT_EQ(s.desiredDirection, p.desiredDirection);
+		EXPECT_EQ(s.desiredSpeed, p.desiredSpeed);
+		EXPECT_EQ(s.evaluation, p.evaluation);
+		EXPECT_TRUE(s.evalFactors==p.evalFactors);
+	}
+	EXPECT_TRUE(log_seq.additional_debug_msgs==log_par.additional_debug_msgs);
+	EXPECT_EQ(log_seq.nSelectedPTG, log_par.nSelectedPTG);
+}
+
+TEST(CReactiveNavigationSystem, parallel_PTGs_same_log) {
+	run_rnav_parallel_log_test<mrpt::nav::CReactiveNavigationSystem>("reactive2d_config.ini");
+}
+TEST(CReactiveNavigationSystem3D, parallel_PTGs_same_log) {
+	run_rnav_parallel_log_test<mrpt::nav::CReactiveNavigationSystem3D>("reactive3d_config.ini");
+}
@@ -11,12 +11,17 @@
 
 #include <mrpt/nav/tpspace/CPTG_DiffDrive_CollisionGridBased.h>
 
-#include <mrpt/utils/CFileGZInputStream.h>
-#include <mrpt/utils/CFileGZOutputStream.h>
+#include <mrpt/utils/CFileOutputStream.h>
+#include <mrpt/utils/CMemoryMappedFile.h>
+#include <mrpt/utils/ts_hash_map.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/system/threads.h>
+#include <mrpt/system/datetime.h>
 #include <mrpt/utils/CTicTac.h>
 #include <mrpt/math/geometry.h>
 #include <mrpt/utils/stl_serialization.h>
 #include <mrpt/kinematics/CVehicleVelCmd_DiffDriven.h>
+#include <algorithm>
 
 using namespace mrpt::nav;
 
@@ -263,12 +268,21 @@ mrpt::kinematics::CVehicleVelCmdPtr CPTG_DiffDrive_CollisionGridBased::direction
 /*---------------------------------------------------------------
 					getTPObstacle
   ---------------------------------------------------------------*/
-const CPTG_DiffDrive_CollisionGridBased::TCollisionCell & CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::getTPObstacle(
+CPTG_DiffDrive_CollisionGridBased::TCollisionCellRef CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::getTPObstacle(
 	const float obsX, const float obsY) const
 {
-	static const TCollisionCell  emptyCell;
-	const TCollisionCell *cell = cellByPos(obsX,obsY);
-	return cell!=NULL ? *cell : emptyCell;
+	return getCellByIndex(x2idx(obsX), y2idx(obsY));
+}
+
+CPTG_DiffDrive_CollisionGridBased::TCollisionCellRef CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::getCellByIndex(const int cx, const int cy) const
+{
+	if (cx<0 || cy<0 || cx>=static_cast<int>(m_size_x) || cy>=static_cast<int>(m_size_y))
+		return TCollisionCellRef();
+	const uint32_t *offsets = csrOffsets();
+	if (!offsets) return TCollisionCellRef(); // Not built yet (e.g. a PTG just deserialized)
+	const TCollisionEntry *entries = csrEntries();
+	const size_t idx = cx + cy*m_size_x;
+	return TCollisionCellRef(entries+offsets[idx], entries+offsets[idx+1]);
 }
 
 /*---------------------------------------------------------------
@@ -304,92 +318,142 @@ void CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::updateCellInfo(
 	}
 }
 
+void CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::compact()
+{
+	clearCompact();
+
+	const size_t N = m_map.size();
+	size_t nEntries = 0;
+	for (size_t i=0;i<N;i++)
+		nEntries += m_map[i].size();
+	ASSERT_BELOW_(nEntries, static_cast<size_t>(std::numeric_limits<uint32_t>::max()));
+
+	m_own_offsets.resize(N+1);
+	m_own_entries.resize(nEntries);
+	uint32_t idx = 0;
+	for (size_t i=0;i<N;i++)
+	{
+		m_own_offsets[i] = idx;
+		for (size_t j=0;j<m_map[i].size();j++, idx++)
+		{
+			m_own_entries[idx].k = m_map[i][j].first;
+			m_own_entries[idx].dist = m_map[i][j].second;
+			m_own_entries[idx].reserved = 0;
+		}
+	}
+	m_own_offsets[N] = idx;
+
+	// The per-cell lists are no longer needed:
+	std::vector<TCollisionCell>().swap(m_map);
+}
+
+void CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::clearCompact()
+{
+	std::vector<uint32_t>().swap(m_own_offsets);
+	std::vector<TCollisionEntry>().swap(m_own_entries);
+	m_mapped_file.clear();
+	m_mapped_offsets = NULL;
+	m_mapped_entries = NULL;
+}
 
 /*---------------------------------------------------------------
 					Save to file
   ---------------------------------------------------------------*/
-bool CPTG_DiffDrive_CollisionGridBased::saveColGridsToFile( const std::string &filename, const mrpt::math::CPolygon & computed_robotShape ) const
+bool CPTG_DiffDrive_CollisionGridBased::saveColGridsToFile( const std::string &filename, const uint64_t cache_key ) const
 {
-	try
-	{
-		mrpt::utils::CFileGZOutputStream   fo(filename);
-		if (!fo.fileOpenCorrectly()) return false;
-
-		const uint32_t n = 1; // for backwards compatibility...
-		fo << n;
-		return m_collisionGrid.saveToFile(&fo, computed_robotShape);
-	}
-	catch (...)
-	{
-		return false;
-	}
+	return m_collisionGrid.saveToFile(filename, cache_key);
 }
 
 /*---------------------------------------------------------------
 					Load from file
   ---------------------------------------------------------------*/
-bool CPTG_DiffDrive_CollisionGridBased::loadColGridsFromFile( const std::string &filename, const mrpt::math::CPolygon & current_robotShape  )
+bool CPTG_DiffDrive_CollisionGridBased::loadColGridsFromFile( const std::string &filename, const uint64_t cache_key )
 {
-	try
-	{
-		mrpt::utils::CFileGZInputStream   fi(filename);
-		if (!fi.fileOpenCorrectly()) return false;
+	return m_collisionGrid.loadFromFile(filename, cache_key);
+}
+
+uint64_t CPTG_DiffDrive_CollisionGridBased::getCollisionGridCacheKey() const
+{
+	// All the parameters which determine the paths, the grid, and the robot shape, in text form:
+	std::string s = mrpt::format("%s|%u|%.9g|%.9g|%.9g|%.9g|%.9g|",
+		getDescription().c_str(), static_cast<unsigned int>(m_alphaValuesCount),
+		V_MAX, W_MAX, turningRadiusReference, refDistance, m_resolution);
+	for (size_t i=0;i<m_robotShape.verticesCount();i++)
+		s += mrpt::format("%.9g,%.9g|", m_robotShape.GetVertex_x(i), m_robotShape.GetVertex_y(i));
+
+	uint64_t key;
+	mrpt::utils::reduced_hash(s, key);
+	return key;
+}
 
-		uint32_t n;
-		fi >> n;
-		if (n!=1) return false; // Incompatible (old) format, just discard and recompute.
+namespace
+{
+	const uint32_t COLGRID_FILE_MAGIC   = 0xC0C0C0C4; // Was 0xC0C0C0C3 for the old gz-compressed, serialized format
+	const uint32_t COLGRID_FILE_VERSION = 1;
+	const uint32_t COLGRID_FILE_ENDIANNESS = 0x01020304; // Files are written in the native byte order
 
-		return m_collisionGrid.loadFromFile(&fi,current_robotShape);
-	}
-	catch(...)
+	/** Header of collision grid cache files. Followed by (size_x*size_y+1) uint32_t cell offsets, then num_entries TCollisionEntry's */
+	struct TColGridFileHeader
 	{
-		return false;
-	}
+		uint32_t magic, version, endianness, header_size;
+		uint64_t cache_key;
+		double   x_min, x_max, y_min, y_max, resolution;
+		uint32_t size_x, size_y;
+		uint32_t num_entries, reserved;
+	};
 }
 
-const uint32_t COLGRID_FILE_MAGIC     = 0xC0C0C0C3;
-
 /*---------------------------------------------------------------
 					Save to file
   ---------------------------------------------------------------*/
-bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::saveToFile( mrpt::utils::CStream *f, const mrpt::math::CPolygon & computed_robotShape ) const
+bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::saveToFile( const std::string &fileName, const uint64_t cache_key ) const
 {
+	if (fileName.empty() || !isCompact()) return false;
+
+	const size_t N = m_size_x*m_size_y;
+	const uint32_t *offsets = csrOffsets();
+
+	TColGridFileHeader h;
+	::memset(&h, 0, sizeof(h));
+	h.magic = COLGRID_FILE_MAGIC;
+	h.version = COLGRID_FILE_VERSION;
+	h.endianness = COLGRID_FILE_ENDIANNESS;
+	h.header_size = sizeof(h);
+	h.cache_key = cache_key;
+	h.x_min = m_x_min; h.x_max = m_x_max;
+	h.y_min = m_y_min; h.y_max = m_y_max;
+	h.resolution = m_resolution;
+	h.size_x = m_size_x; h.size_y = m_size_y;
+	h.num_entries = offsets[N];
+
+	// Write to a temporary file, then rename it: processes which have the old file memory-mapped keep using it safely.
+	const std::string tmpFile = mrpt::format("%s.%lx_%llx.tmp", fileName.c_str(),
+		mrpt::system::getCurrentThreadId(), static_cast<unsigned long long>(mrpt::system::getCurrentTime()));
 	try
 	{
-		if (!f) return false;
-
-		const uint8_t serialize_version = 2; // v1: As of jun 2012, v2: As of dec-2013
-
-		// Save magic signature && serialization version:
-		*f << COLGRID_FILE_MAGIC << serialize_version;
-
-		// Robot shape:
-		*f << computed_robotShape;
-
-		// and standard PTG data:
-		*f << m_parent->getDescription()
-			<< m_parent->getAlphaValuesCount()
-			<< static_cast<float>(m_parent->getMax_V())
-			<< static_cast<float>(m_parent->getMax_W());
-
-		*f << m_x_min << m_x_max << m_y_min << m_y_max;
-		*f << m_resolution;
-
-		//v1 was:  *f << m_map;
-		uint32_t N = m_map.size();
-		*f << N;
-		for (uint32_t i=0;i<N;i++)
 		{
-			uint32_t M = m_map[i].size();
-			*f << M;
-			for (uint32_t k=0;k<M;k++)
-				*f << m_map[i][k].first << m_map[i][k].second;
+			mrpt::utils::CFileOutputStream f;
+			if (!f.open(tmpFile)) return false;
+			f.WriteBuffer(&h, sizeof(h));
+			f.WriteBuffer(offsets, sizeof(uint32_t)*(N+1));
+			if (h.num_entries)
+				f.WriteBuffer(csrEntries(), sizeof(TCollisionEntry)*h.num_entries);
+		}
+		if (!mrpt::system::renameFile(tmpFile, fileName))
+		{
+			// rename() does not overwrite existing files in Windows:
+			mrpt::system::deleteFile(fileName);
+			if (!mrpt::system::renameFile(tmpFile, fileName))
+			{
+				mrpt::system::deleteFile(tmpFile);
+				return false;
+			}
 		}
-
 		return true;
 	}
 	catch(...)
 	{
+		mrpt::system::deleteFile(tmpFile);
 		return false;
 	}
 }
@@ -397,91 +461,54 @@ bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::saveToFile( mrpt::utils:
 /*---------------------------------------------------------------
 						loadFromFile
   ---------------------------------------------------------------*/
-bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadFromFile( mrpt::utils::CStream *f, const mrpt::math::CPolygon & current_robotShape  )
+bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadFromFile( const std::string &fileName, const uint64_t cache_key )
 {
-	try
-	{
-		if (!f) return false;
-
-		// Return false if the file contents doesn't match what we expected:
-		uint32_t file_magic;
-		*f >> file_magic;
+	if (fileName.empty() || !mrpt::system::fileExists(fileName)) return false;
 
-		// It doesn't seem to be a valid file or was in an old format, just recompute the grid:
-		if (COLGRID_FILE_MAGIC!=file_magic)
-			return false;
-
-		uint8_t serialized_version;
-		*f >> serialized_version;
+	mrpt::utils::CMemoryMappedFile *mf = new mrpt::utils::CMemoryMappedFile();
+	mrpt::utils::TMemoryBlockOwnerPtr mf_ptr(mf); // Takes ownership, also in case of errors
+	if (!mf->open(fileName) || mf->size()<sizeof(TColGridFileHeader))
+		return false;
 
-		switch (serialized_version)
-		{
-		case 2:
-			{
-				mrpt::math::CPolygon stored_shape;
-				*f >> stored_shape;
+	// Return false if the file contents doesn't match what we expected (e.g. a file in the old format, or from an
+	// older MRPT version, or for different PTG parameters): the grid will be just recomputed.
+	TColGridFileHeader h;
+	::memcpy(&h, mf->data(), sizeof(h));
+	if (h.magic!=COLGRID_FILE_MAGIC || h.version!=COLGRID_FILE_VERSION || h.endianness!=COLGRID_FILE_ENDIANNESS ||
+		h.header_size!=sizeof(h) || h.cache_key!=cache_key)
+		return false;
 
-				const bool shapes_match =
-					( stored_shape.size()==current_robotShape.size() &&
-					  std::equal(stored_shape.begin(),stored_shape.end(), current_robotShape.begin() ) );
+	// Cell dimensions must also match exactly:
+	if (h.size_x!=m_size_x || h.size_y!=m_size_y ||
+		std::abs(h.x_min-m_x_min)>1e-6 || std::abs(h.x_max-m_x_max)>1e-6 ||
+		std::abs(h.y_min-m_y_min)>1e-6 || std::abs(h.y_max-m_y_max)>1e-6 ||
+		std::abs(h.resolution-m_resolution)>1e-6)
+		return false;
 
-				if (!shapes_match) return false; // Must recompute if the robot shape changed.
-			}
-			break;
+	const uint64_t N = static_cast<uint64_t>(h.size_x)*h.size_y;
+	const uint64_t expected_size = sizeof(h) + sizeof(uint32_t)*(N+1) + sizeof(TCollisionEntry)*static_cast<uint64_t>(h.num_entries);
+	if (mf->size()!=expected_size)
+		return false;
 
-		case 1:
-		default:
-			// Unknown version: Maybe we are loading a file from a more recent version of MRPT? Whatever, we can't read it: It's safer just to re-generate the PTG data
+	// Sanity checks of the contents, to avoid out-of-bounds accesses later on with corrupted files:
+	const uint32_t *offsets = reinterpret_cast<const uint32_t*>(mf->data()+sizeof(h));
+	const TCollisionEntry *entries = reinterpret_cast<const TCollisionEntry*>(offsets+N+1);
+	if (offsets[0]!=0 || offsets[N]!=h.num_entries)
+		return false;
+	for (uint64_t i=0;i<N;i++)
+		if (offsets[i]>offsets[i+1])
+			return false;
+	const uint16_t nPaths = m_parent->getAlphaValuesCount();
+	for (uint32_t i=0;i<h.num_entries;i++)
+		if (entries[i].k>=nPaths)
 			return false;
-		};
-
-		// Standard PTG data:
-		const std::string expected_desc = m_parent->getDescription();
-		std::string desc;
-		*f >> desc;
-		if (desc!=expected_desc) return false;
-
-		// and standard PTG data:
-#define READ_UINT16_CHECK_IT_MATCHES_STORED(_VAR) { uint16_t ff; *f >> ff; if (ff!=_VAR) return false; }
-#define READ_FLOAT_CHECK_IT_MATCHES_STORED(_VAR) { float ff; *f >> ff; if (std::abs(ff-_VAR)>1e-4f) return false; }
-#define READ_DOUBLE_CHECK_IT_MATCHES_STORED(_VAR) { double ff; *f >> ff; if (std::abs(ff-_VAR)>1e-6) return false; }
-
-		READ_UINT16_CHECK_IT_MATCHES_STORED(m_parent->getAlphaValuesCount())
-		READ_FLOAT_CHECK_IT_MATCHES_STORED(m_parent->getMax_V())
-		READ_FLOAT_CHECK_IT_MATCHES_STORED(m_parent->getMax_W())
-
-		// Cell dimensions:
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_x_min)
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_x_max)
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_y_min)
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_y_max)
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_resolution)
-
-		// OK, all parameters seem to be exactly the same than when we precomputed the table: load it.
-		//v1 was:  *f >> m_map;
-		uint32_t N;
-		*f >> N;
-		 m_map.resize(N);
-		for (uint32_t i=0;i<N;i++)
-		{
-			uint32_t M;
-			*f >> M;
-			 m_map[i].resize(M);
-			for (uint32_t k=0;k<M;k++)
-				*f >> m_map[i][k].first >> m_map[i][k].second;
-		}
 
-		return true;
-	}
-	catch(std::exception &e)
-	{
-		std::cerr << "[CCollisionGrid::loadFromFile] " << e.what();
-		return false;
-	}
-	catch(...)
-	{
-		return false;
-	}
+	clearCompact();
+	std::vector<TCollisionCell>().swap(m_map); // Not needed anymore
+	m_mapped_file = mf_ptr;
+	m_mapped_offsets = offsets;
+	m_mapped_entries = entries;
+	return true;
 }
 
 bool CPTG_DiffDrive_CollisionGridBased::inverseMap_WS2TP(double x, double y, int &out_k, double &out_d, double tolerance_dist) const
@@ -610,6 +637,7 @@ void CPTG_DiffDrive_CollisionGridBased::internal_processNewRobotShape()
 void CPTG_DiffDrive_CollisionGridBased::internal_deinitialize()
 {
 	m_trajectory.clear(); // Free trajectories
+	m_collisionGrid.clearCompact();
 }
 
 void CPTG_DiffDrive_CollisionGridBased::internal_initialize(const std::string & cacheFilename, const bool verbose)
@@ -656,7 +684,8 @@ void CPTG_DiffDrive_CollisionGridBased::internal_initialize(const std::string &
 	ASSERTMSG_(Ki>0, "The PTG seems to be not initialized!");
 
 	// Load the cached version, if possible
-	if ( loadColGridsFromFile( cacheFilename, m_robotShape ) )
+	const uint64_t cache_key = getCollisionGridCacheKey();
+	if ( loadColGridsFromFile( cacheFilename, cache_key ) )
 	{
 		if (verbose)
 			cout << "loaded from file OK" << endl;
@@ -733,11 +762,13 @@ void CPTG_DiffDrive_CollisionGridBased::internal_initialize(const std::string &
 				cout << k << "/" << Ki << ",";
 		} // k
 
+		m_collisionGrid.compact();
+
 		if (verbose)
 			cout << format("Done! [%.03f sec]\n",tictac.Tac() );
 
 		// save it to the cache file for the next run:
-		saveColGridsToFile( cacheFilename, m_robotShape );
+		saveColGridsToFile( cacheFilename, cache_key );
 
 	}	// "else" recompute all PTG
 
@@ -794,26 +825,67 @@ void CPTG_DiffDrive_CollisionGridBased::updateTPObstacle(
 	std::vector<double> &tp_obstacles) const
 {
 	ASSERTMSG_(!m_trajectory.empty(), "PTG has not been initialized!");
-	const TCollisionCell & cell = m_collisionGrid.getTPObstacle(ox, oy);
+	const TCollisionCellRef cell = m_collisionGrid.getTPObstacle(ox, oy);
 	// Keep the minimum distance:
-	for (TCollisionCell::const_iterator i = cell.begin(); i != cell.end(); ++i) {
-		const double dist = i->second;
-		internal_TPObsDistancePostprocess(ox,oy,dist, tp_obstacles[i->first]);
+	for (const TCollisionEntry *i = cell.begin(); i != cell.end(); ++i) {
+		const double dist = i->dist;
+		internal_TPObsDistancePostprocess(ox,oy,dist, tp_obstacles[i->k]);
 	}
 }
 
 void CPTG_DiffDrive_CollisionGridBased::updateTPObstacleSingle(double ox, double oy, uint16_t k, double &tp_obstacle_k) const
 {
 	ASSERTMSG_(!m_trajectory.empty(), "PTG has not been initialized!");
-	const TCollisionCell & cell = m_collisionGrid.getTPObstacle(ox, oy);
+	const TCollisionCellRef cell = m_collisionGrid.getTPObstacle(ox, oy);
 	// Keep the minimum distance:
-	for (TCollisionCell::const_iterator i = cell.begin(); i != cell.end(); ++i)
-		if (i->first == k) {
-			const double dist = i->second;
+	for (const TCollisionEntry *i = cell.begin(); i != cell.end(); ++i)
+		if (i->k == k) {
+			const double dist = i->dist;
 			internal_TPObsDistancePostprocess(ox,oy,dist, tp_obstacle_k);
 		}
 }
 
+void CPTG_DiffDrive_CollisionGridBased::updateTPObstacleBatch(const std::vector<double> &ox, const std::vector<double> &oy, std::vector<double> &tp_obstacles) const
+{
+	ASSERTMSG_(!m_trajectory.empty(), "PTG has not been initialized!");
+	ASSERT_EQUAL_(ox.size(), oy.size());
+
+	// No point farther than the farthest vertex can be inside the robot shape:
+	double shape_max_r2 = .0;
+	for (size_t i = 0; i < m_robotShape.verticesCount(); i++)
+		mrpt::utils::keep_max(shape_max_r2, mrpt::utils::square(m_robotShape.GetVertex_x(i)) + mrpt::utils::square(m_robotShape.GetVertex_y(i)));
+
+	// All the obstacles falling in the same cell, and all of them either inside or outside of the robot shape, lead to
+	// exactly the same updates of TP-Obstacles: build the list of unique keys (cell index)*2+(inside robot),
+	// sorted to visit the cells in memory order.
+	const size_t nx = m_collisionGrid.getSizeX(), ny = m_collisionGrid.getSizeY();
+	std::vector<uint32_t> keys;
+	keys.reserve(ox.size());
+	for (size_t i = 0; i < ox.size(); i++)
+	{
+		// Same rounding than in CCollisionGrid::getTPObstacle():
+		const int cx = m_collisionGrid.x2idx(static_cast<float>(ox[i]));
+		const int cy = m_collisionGrid.y2idx(static_cast<float>(oy[i]));
+		if (cx < 0 || cy < 0 || cx >= static_cast<int>(nx) || cy >= static_cast<int>(ny))
+			continue;
+		if (m_collisionGrid.getCellByIndex(cx, cy).empty())
+			continue;
+		const bool inside = (ox[i] * ox[i] + oy[i] * oy[i] <= shape_max_r2) && isPointInsideRobotShape(ox[i], oy[i]);
+		keys.push_back(static_cast<uint32_t>(cx + cy*nx) * 2 + (inside ? 1 : 0));
+	}
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	for (size_t j = 0; j < keys.size(); j++)
+	{
+		const uint32_t idx = keys[j] >> 1;
+		const bool inside = (keys[j] & 1) != 0;
+		const TCollisionCellRef cell = m_collisionGrid.getCellByIndex(idx % nx, idx / nx);
+		for (const TCollisionEntry *i = cell.begin(); i != cell.end(); ++i)
+			internal_TPObsDistancePostprocess(inside, i->dist, tp_obstacles[i->k]);
+	}
+}
+
 void CPTG_DiffDrive_CollisionGridBased::internal_readFromStream(mrpt::utils::CStream &in)
 {
 	CParameterizedTrajectoryGenerator::internal_readFromStream(in);
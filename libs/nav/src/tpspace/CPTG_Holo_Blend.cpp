@@ -558,12 +558,13 @@ bool CPTG_Holo_Blend::getPathStepForDist(uint16_t k, double dist, uint32_t &out_
 }
 
 
-void CPTG_Holo_Blend::updateTPObstacleSingle(double ox, double oy, uint16_t k, double &tp_obstacle_k) const
+/** Shortest distance along a path (given by the parameters in COMMON_PTG_DESIGN_PARAMS) until the robot collides with the obstacle (ox,oy).
+  * \return false if there is no collision. */
+static inline bool calc_obstacle_collision_dist(
+	const double ox, const double oy, const double R,
+	const double vxi, const double vyi, const double vxf, const double vyf, const double vf_mod, const double T_ramp, const double V_MAX,
+	double &out_dist)
 {
-	const double R = m_robotRadius;
-	const double dir = CParameterizedTrajectoryGenerator::index2alpha(k);
-	COMMON_PTG_DESIGN_PARAMS;
-
 	const double TR2_ = 1.0 / (2 * T_ramp);
 	const double TR_2 = T_ramp*0.5;
 	const double T_ramp_thres099 = T_ramp*0.99;
@@ -588,13 +589,13 @@ void CPTG_Holo_Blend::updateTPObstacleSingle(double ox, double oy, uint16_t k, d
 
 	double roots[4];
 	int num_real_sols = 0;
-	if (std::abs(a)>eps)
+	if (std::abs(a)>CPTG_Holo_Blend::eps)
 	{
 		// General case: 4th order equation
 		// a * x^4 + b * x^3 + c * x^2 + d * x + e
 		num_real_sols = mrpt::math::solve_poly4(roots, b / a, c / a, d / a, e / a);
 	}
-	else if (std::abs(b)>eps) {
+	else if (std::abs(b)>CPTG_Holo_Blend::eps) {
 		// Special case: k2=k4=0 (straight line path, no blend)
 		// 3rd order equation:
 		// b * x^3 + c * x^2 + d * x + e
@@ -655,16 +656,22 @@ void CPTG_Holo_Blend::updateTPObstacleSingle(double ox, double oy, uint16_t k, d
 	}
 
 	// Valid solution?
-	if (sol_t<0) return;
+	if (sol_t<0) return false;
 	// Compute the transversed distance:
-	double dist;
-
 	if (sol_t<T_ramp)
-		dist = calc_trans_distance_t_below_Tramp(k2, k4, vxi, vyi, sol_t);
-	else dist = (sol_t - T_ramp) * V_MAX + calc_trans_distance_t_below_Tramp(k2, k4, vxi, vyi, T_ramp);
+		out_dist = CPTG_Holo_Blend::calc_trans_distance_t_below_Tramp(k2, k4, vxi, vyi, sol_t);
+	else out_dist = (sol_t - T_ramp) * V_MAX + CPTG_Holo_Blend::calc_trans_distance_t_below_Tramp(k2, k4, vxi, vyi, T_ramp);
+	return true;
+}
+
+void CPTG_Holo_Blend::updateTPObstacleSingle(double ox, double oy, uint16_t k, double &tp_obstacle_k) const
+{
+	const double dir = CParameterizedTrajectoryGenerator::index2alpha(k);
+	COMMON_PTG_DESIGN_PARAMS;
 
-	// Store in the output variable:
-	internal_TPObsDistancePostprocess(ox, oy, dist, tp_obstacle_k);
+	double dist;
+	if (calc_obstacle_collision_dist(ox, oy, m_robotRadius, vxi, vyi, vxf, vyf, vf_mod, T_ramp, V_MAX, dist))
+		internal_TPObsDistancePostprocess(ox, oy, dist, tp_obstacle_k);
 }
 
 void CPTG_Holo_Blend::updateTPObstacle(double ox, double oy, std::vector<double> &tp_obstacles) const
@@ -677,6 +684,33 @@ void CPTG_Holo_Blend::updateTPObstacle(double ox, double oy, std::vector<double>
 	} // end for each "k" alpha
 }
 
+void CPTG_Holo_Blend::updateTPObstacleBatch(const std::vector<double> &ox, const std::vector<double> &oy, std::vector<double> &tp_obstacles) const
+{
+	PERFORMANCE_BENCHMARK;
+	ASSERT_EQUAL_(ox.size(), oy.size());
+
+	const size_t N = ox.size();
+	std::vector<uint8_t> inside(N);
+	for (size_t i = 0; i < N; i++)
+		inside[i] = isPointInsideRobotShape(ox[i], oy[i]) ? 1 : 0;
+
+	// Path parameters (including the evaluation of the user expressions) are computed once per path, not once per obstacle:
+	for (unsigned int k = 0; k < m_alphaValuesCount; k++)
+	{
+		const double dir = CParameterizedTrajectoryGenerator::index2alpha(k);
+		COMMON_PTG_DESIGN_PARAMS;
+
+		double tp_obstacle_k = tp_obstacles[k];
+		for (size_t i = 0; i < N; i++)
+		{
+			double dist;
+			if (calc_obstacle_collision_dist(ox[i], oy[i], m_robotRadius, vxi, vyi, vxf, vyf, vf_mod, T_ramp, V_MAX, dist))
+				internal_TPObsDistancePostprocess(inside[i] != 0, dist, tp_obstacle_k);
+		}
+		tp_obstacles[k] = tp_obstacle_k;
+	} // end for each "k" alpha
+}
+
 void CPTG_Holo_Blend::internal_processNewRobotShape()
 {
 	// Nothing to do in a closed-form PTG.
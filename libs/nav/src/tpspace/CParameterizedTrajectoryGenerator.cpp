@@ -335,7 +335,11 @@ void CParameterizedTrajectoryGenerator::deinitialize()
 
 void CParameterizedTrajectoryGenerator::internal_TPObsDistancePostprocess(const double ox, const double oy, const double new_tp_obs_dist, double &inout_tp_obs) const
 {
-	const bool is_obs_inside_robot_shape = isPointInsideRobotShape(ox,oy);
+	internal_TPObsDistancePostprocess(isPointInsideRobotShape(ox,oy), new_tp_obs_dist, inout_tp_obs);
+}
+
+void CParameterizedTrajectoryGenerator::internal_TPObsDistancePostprocess(const bool is_obs_inside_robot_shape, const double new_tp_obs_dist, double &inout_tp_obs) const
+{
 	if (!is_obs_inside_robot_shape)
 	{
 		mrpt::utils::keep_min(inout_tp_obs, new_tp_obs_dist);
@@ -370,6 +374,13 @@ void CParameterizedTrajectoryGenerator::internal_TPObsDistancePostprocess(const
 	}
 }
 
+void CParameterizedTrajectoryGenerator::updateTPObstacleBatch(const std::vector<double> &ox, const std::vector<double> &oy, std::vector<double> &tp_obstacles) const
+{
+	ASSERT_EQUAL_(ox.size(), oy.size());
+	for (size_t i = 0; i < ox.size(); i++)
+		updateTPObstacle(ox[i], oy[i], tp_obstacles);
+}
+
 void mrpt::nav::CParameterizedTrajectoryGenerator::initClearanceDiagram(ClearanceDiagram & cd) const
 {
 	cd.resize(m_alphaValuesCount, m_clearance_decimated_paths);
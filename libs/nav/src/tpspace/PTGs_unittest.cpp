@@ -8,6 +8,7 @@
    +---------------------------------------------------------------------------+ */
 
 #include <mrpt/nav/tpspace/CParameterizedTrajectoryGenerator.h>
+#include <mrpt/nav/tpspace/CPTG_DiffDrive_CollisionGridBased.h>
 #include <mrpt/utils/CConfigFile.h>
 #include <mrpt/system/filesystem.h>
 #include <gtest/gtest.h>
@@ -150,6 +151,31 @@ TEST(NavTests, PTGs_tests)
 			EXPECT_TRUE(any_change_all);
 		}
 
+		// TEST: updateTPObstacleBatch() == updateTPObstacle() for each point
+		{
+			std::vector<double> obs_x, obs_y;
+			const double step = refDist*0.024;
+			for (double ox=-refDist*0.6;ox<refDist*0.6;ox+=step)
+				for (double oy=-refDist*0.6;oy<refDist*0.6;oy+=step)
+				{
+					// Several points per collision grid cell, and some inside the robot:
+					obs_x.push_back(ox);
+					obs_y.push_back(oy);
+					obs_x.push_back(ox+0.002);
+					obs_y.push_back(oy+0.001);
+				}
+
+			std::vector<double> TP_obstacles, TP_obstacles_batch;
+			ptg->initTPObstacles(TP_obstacles);
+			ptg->initTPObstacles(TP_obstacles_batch);
+			for (size_t i=0;i<obs_x.size();i++)
+				ptg->updateTPObstacle(obs_x[i],obs_y[i], TP_obstacles);
+			ptg->updateTPObstacleBatch(obs_x, obs_y, TP_obstacles_batch);
+
+			EXPECT_TRUE(TP_obstacles==TP_obstacles_batch) << "PTG: " << sPTGDesc << endl;
+			num_tests_run++;
+		}
+
 
 		printf("PTG `%50s` run %6u tests.\n", sPTGDesc.c_str(), (unsigned int)num_tests_run );
 
@@ -162,3 +188,69 @@ TEST(NavTests, PTGs_tests)
 
 }
 
+
+TEST(NavTests, PTGs_collision_grid_cache)
+{
+	using namespace std;
+	using namespace mrpt;
+	using namespace mrpt::nav;
+
+	const string sFil = mrpt::utils::MRPT_GLOBAL_UNITTEST_SRC_DIR + string("/tests/PTGs_for_tests.ini");
+	if (!mrpt::system::fileExists(sFil))
+	{
+		cerr << "**WARNING* Skipping tests since file cannot be found: '" << sFil << "'\n";
+		return;
+	}
+
+	mrpt::utils::CConfigFile cfg(sFil);
+	const unsigned int PTG_COUNT = cfg.read_int("PTG_UNIT_TESTS","PTG_COUNT",0, true );
+	const string sCacheFil = mrpt::system::getTempFileName();
+
+	for ( unsigned int n=0;n<PTG_COUNT;n++)
+	{
+		const string sPTGName = cfg.read_string("PTG_UNIT_TESTS",format("PTG%u_Type", n ),"", true );
+		CPTG_DiffDrive_CollisionGridBased *ptgs[4];
+		for (int i=0;i<4;i++)
+		{
+			CParameterizedTrajectoryGenerator *ptg = CParameterizedTrajectoryGenerator::CreatePTG(sPTGName,cfg,"PTG_UNIT_TESTS", format("PTG%u_",n) );
+			ptgs[i] = dynamic_cast<CPTG_DiffDrive_CollisionGridBased*>(ptg);
+			if (!ptgs[i]) delete ptg;
+		}
+		if (!ptgs[0]) continue;
+
+		// [2],[3]: a different robot shape, without and with a cache file built for the original shape:
+		mrpt::math::CPolygon shape = ptgs[0]->getRobotShape();
+		for (size_t i=0;i<shape.size();i++) shape[i].x*=1.5;
+		ptgs[2]->setRobotShape(shape);
+		ptgs[3]->setRobotShape(shape);
+
+		mrpt::system::deleteFile(sCacheFil);
+		ptgs[0]->initialize(sCacheFil, false);  // Computes and saves the collision grid
+		EXPECT_TRUE(mrpt::system::fileExists(sCacheFil));
+		ptgs[1]->initialize(sCacheFil, false);  // Loads the file
+		ptgs[2]->initialize(string(), false);
+		ptgs[3]->initialize(sCacheFil, false);  // Must discard the file
+
+		const double refDist = ptgs[0]->getRefDistance();
+		size_t num_diffs_shape = 0;
+		for (double ox=-refDist*0.6;ox<refDist*0.6;ox+=refDist*0.013)
+		{
+			for (double oy=-refDist*0.6;oy<refDist*0.6;oy+=refDist*0.017)
+			{
+				vector<double> tp_obs[4];
+				for (int i=0;i<4;i++)
+				{
+					ptgs[i]->initTPObstacles(tp_obs[i]);
+					ptgs[i]->updateTPObstacle(ox,oy,tp_obs[i]);
+				}
+				EXPECT_TRUE(tp_obs[0]==tp_obs[1]) << "PTG: " << ptgs[0]->getDescription() << " ox=" << ox << " oy=" << oy;
+				EXPECT_TRUE(tp_obs[2]==tp_obs[3]) << "PTG: " << ptgs[0]->getDescription() << " ox=" << ox << " oy=" << oy;
+				if (tp_obs[0]!=tp_obs[2]) num_diffs_shape++;
+			}
+		}
+		EXPECT_GT(num_diffs_shape, 0u) << "PTG: " << ptgs[0]->getDescription();
+
+		for (int i=0;i<4;i++) delete ptgs[i];
+	}
+	mrpt::system::deleteFile(sCacheFil);
+}
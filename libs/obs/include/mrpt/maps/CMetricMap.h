@@ -78,6 +78,10 @@ namespace mrpt
 			  * This is called automatically from insertObservation() when internal_insertObservation returns true. */
 			virtual void OnPostSuccesfulInsertObs(const mrpt::obs::CObservation *) { /* Default: do nothing */ }
 
+		protected:
+			/** Internal method called by computeObservationLikelihoods(). The default implementation calls internal_computeObservationLikelihood() once per pose: override it in maps able to evaluate a batch of poses faster. */
+			virtual void internal_computeObservationLikelihoods( const mrpt::obs::CObservation *obs, const std::vector<mrpt::math::TPose3D> &takenFrom, std::vector<double> &out_log_liks );
+
 		public:
 			/** Erase all the contents of the map */
 			void  clear();
@@ -129,6 +133,17 @@ namespace mrpt
 			/** \overload */
 			double	 computeObservationLikelihood( const mrpt::obs::CObservation *obs, const mrpt::poses::CPose2D &takenFrom );
 
+			/** Computes the log-likelihood of a given observation for a batch of robot 3D poses, which may be much faster
+			 *  than calling computeObservationLikelihood() once per pose, e.g. within particle filters.  See: \ref maps_observations
+			 *
+			 * \param[in] obs The observation.
+			 * \param[in] takenFrom The candidate robot poses the observation may be taken from.
+			 * \param[out] out_log_liks The log-likelihood for each pose in `takenFrom`, in the same order.
+			 * \note (New in MRPT 1.5.0)
+			 * \sa computeObservationLikelihood
+			 */
+			void computeObservationLikelihoods( const mrpt::obs::CObservation *obs, const std::vector<mrpt::math::TPose3D> &takenFrom, std::vector<double> &out_log_liks );
+
 			/** Returns true if this map is able to compute a sensible likelihood function for this observation (i.e. an occupancy grid map cannot with an image).  See: \ref maps_observations
 			 * \param obs The observation.
 			 * \sa computeObservationLikelihood, genericMapParams.enableObservationLikelihood
@@ -56,6 +56,9 @@ MRPT_WARNING("Including <mrpt/obs.h> makes compilation much slower, consider inc
 
 // Others:
 #include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CRawlogIndexed.h>
+#include <mrpt/obs/CRawlogPrefetchReader.h>
+#include <mrpt/obs/CRawlogAsyncWriter.h>
 #include <mrpt/obs/carmen_log_tools.h>
 #include <mrpt/obs/obs_utils.h>
 
@@ -32,10 +32,11 @@ namespace obs
 	{
 		bool takeIntoAccountSensorPoseOnRobot;           //!< (Default: false) If false, local (sensor-centric) coordinates of points are generated. Otherwise, points are transformed with \a sensorPose. Furthermore, if provided, those coordinates are transformed with \a robotPoseInTheWorld
 		const mrpt::poses::CPose3D *robotPoseInTheWorld; //!< (Default: NULL) Read takeIntoAccountSensorPoseOnRobot
-		bool PROJ3D_USE_LUT; //!< (Default:true) [Only used when `range_is_depth`=true] Whether to use a Look-up-table (LUT) to speed up the conversion. It's thread safe in all situations <b>except</b> when you call this method from different threads <b>and</b> with different camera parameter matrices. In all other cases, it is a good idea to left it enabled.
+		bool PROJ3D_USE_LUT; //!< (Default:true) [Only used when `range_is_depth`=true] Whether to use a Look-up-table (LUT) to speed up the conversion. Tables are cached for each set of camera parameters and image size, in a thread-safe way (see CObservation3DRangeScan::get3DProjLUT()), so it is a good idea to left it enabled.
 		bool USE_SSE2; //!< (Default:true) If possible, use SSE2 optimized code.
 		bool MAKE_DENSE; //!< (Default:true) set to false if you want to preserve the organization of the point cloud
-		T3DPointsProjectionParams() :  takeIntoAccountSensorPoseOnRobot(false), robotPoseInTheWorld(NULL), PROJ3D_USE_LUT(true),USE_SSE2(true), MAKE_DENSE(true)
+		unsigned int decimation; //!< (Default:1) If >1, only one out of every `decimation` rows and columns of the range image is projected, in the same pass as range filtering (New in MRPT 1.5.0)
+		T3DPointsProjectionParams() :  takeIntoAccountSensorPoseOnRobot(false), robotPoseInTheWorld(NULL), PROJ3D_USE_LUT(true),USE_SSE2(true), MAKE_DENSE(true), decimation(1)
 		{}
 	};
 	/** Used in CObservation3DRangeScan::convertTo2DScan() */
@@ -133,6 +134,7 @@ namespace obs
 	 *  \note Starting at serialization version 6 (MRPT 0.9.5+), the new field \a intensityImageChannel
 	 *  \note Starting at serialization version 7 (MRPT 1.3.1+), new fields for semantic labeling
 	 *  \note Since MRPT 1.5.0, external files format can be selected at runtime with `CObservation3DRangeScan::EXTERNALS_AS_TEXT`
+	 *  \note Starting at serialization version 9 (MRPT 1.5.0+), range images and point clouds can be serialized in a compact form, see `CObservation3DRangeScan::COMPACT_RANGE_UNITS` and `CObservation3DRangeScan::COMPACT_SKIP_POINTS3D`
 	 *
 	 * \sa mrpt::hwdrivers::CSwissRanger3DCamera, mrpt::hwdrivers::CKinect, CObservation
 	 * \ingroup mrpt_obs_grp
@@ -282,6 +284,23 @@ namespace obs
 		  **/
 		static bool EXTERNALS_AS_TEXT;
 
+		/** \name Compact serialization (New in MRPT 1.5.0)
+		  * These settings only affect how observations are written: all serialization versions can always be loaded.
+		  * @{ */
+		/** (Default=0, disabled) If >0, range images are serialized as 16 bit integer multiples of this value (in meters), further
+		  * compressed with a lossless codec (differences between neighbor pixels plus ZIP), typically reducing the size of RGB-D rawlogs several times.
+		  * Use 1e-3 (1 mm) for Kinect-like sensors, whose native depth resolution is 1mm, so no information is lost.
+		  * Otherwise, ranges are rounded to the nearest multiple of this value. Range images with values which can not be
+		  * represented (negative, NaN, or larger than 65535 times this value) are serialized as floats.
+		  */
+		static float COMPACT_RANGE_UNITS;
+		/** (Default=false) If true, the 3D point cloud is not serialized if the range image is, and it is regenerated from the range image
+		  * and camera parameters with project3DPointsFromDepthImage() while loading. Only enable it if the point clouds were
+		  * generated that way, as done by mrpt::hwdrivers::CKinect and mrpt::hwdrivers::COpenNI2Sensor.
+		  */
+		static bool COMPACT_SKIP_POINTS3D;
+		/** @} */
+
 		/** \name Point cloud
 		  * @{ */
 		bool hasPoints3D; //!< true means the field points3D contains valid data.
@@ -564,13 +583,19 @@ namespace obs
 			mrpt::utils::TCamera			&out_camParams,
 			const double camera_offset = 0.01 );
 
-		/** Look-up-table struct for project3DPointsFromDepthImageInto() */
+		/** Look-up-table struct for project3DPointsFromDepthImageInto(): the projection coefficients of each pixel of a depth camera */
 		struct TCached3DProjTables
 		{
 			mrpt::math::CVectorFloat Kzs,Kys;
 			mrpt::utils::TCamera  prev_camParams;
+			int W, H; //!< Size of the range images
 		};
-		static TCached3DProjTables m_3dproj_lut; //!< 3D point cloud projection look-up-table \sa project3DPointsFromDepthImage
+		typedef stlplus::smart_ptr_nocopy<TCached3DProjTables> TCached3DProjTablesPtr;
+
+		/** Returns the (read-only) 3D projection look-up-table for some camera parameters and range image size. Tables are kept in a
+		  * thread-safe cache shared by all observations, so several cameras (or threads) can use their own tables without rebuilding them.
+		  * \note (New in MRPT 1.5.0) \sa project3DPointsFromDepthImage */
+		static TCached3DProjTablesPtr get3DProjLUT(const mrpt::utils::TCamera &camParams, const int W, const int H);
 
 	}; // End of class def.
 	DEFINE_SERIALIZABLE_POST_CUSTOM_BASE_LINKAGE( CObservation3DRangeScan, CObservation,OBS_IMPEXP )
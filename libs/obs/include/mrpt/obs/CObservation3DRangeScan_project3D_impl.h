@@ -15,7 +15,7 @@ namespace mrpt {
 namespace obs {
 namespace detail {
 	// Auxiliary functions which implement SSE-optimized proyection of 3D point cloud:
-	template <class POINTMAP> void do_project_3d_pointcloud(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &filterParams, bool MAKE_DENSE);
+	template <class POINTMAP> void do_project_3d_pointcloud(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &filterParams, bool MAKE_DENSE, const int decimation);
 	template <class POINTMAP> void do_project_3d_pointcloud_SSE2(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &filterParams, bool MAKE_DENSE);
 
 	template <class POINTMAP>
@@ -38,10 +38,20 @@ namespace detail {
 		const int H = src_obs.rangeImage.rows();
 		ASSERT_(W!=0 && H!=0);
 		const size_t WH = W*H;
+		const int decim = projectParams.decimation>1 ? static_cast<int>(projectParams.decimation) : 1;
 
 		src_obs.resizePoints3DVectors(WH); // This is to make sure points3D_idxs_{x,y} have the expected sizes.
 		pca.resize(WH); // Reserve memory for 3D points. It will be later resized again to the actual number of valid points
 
+		if (filterParams.rangeMask_min) { // sanity check:
+			ASSERT_EQUAL_(filterParams.rangeMask_min->cols(), src_obs.rangeImage.cols());
+			ASSERT_EQUAL_(filterParams.rangeMask_min->rows(), src_obs.rangeImage.rows());
+		}
+		if (filterParams.rangeMask_max) { // sanity check:
+			ASSERT_EQUAL_(filterParams.rangeMask_max->cols(), src_obs.rangeImage.cols());
+			ASSERT_EQUAL_(filterParams.rangeMask_max->rows(), src_obs.rangeImage.rows());
+		}
+
 		if (src_obs.range_is_depth)
 		{
 			// range_is_depth = true
@@ -49,47 +59,20 @@ namespace detail {
 			// Use cached tables?
 			if (projectParams.PROJ3D_USE_LUT)
 			{
-				// Use LUT:
-				if (src_obs.m_3dproj_lut.prev_camParams!=src_obs.cameraParams || WH!=size_t(src_obs.m_3dproj_lut.Kys.size()))
-				{
-					src_obs.m_3dproj_lut.prev_camParams = src_obs.cameraParams;
-					src_obs.m_3dproj_lut.Kys.resize(WH);
-					src_obs.m_3dproj_lut.Kzs.resize(WH);
-
-					const float r_cx = src_obs.cameraParams.cx();
-					const float r_cy = src_obs.cameraParams.cy();
-					const float r_fx_inv = 1.0f/src_obs.cameraParams.fx();
-					const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
-
-					float *kys = &src_obs.m_3dproj_lut.Kys[0];
-					float *kzs = &src_obs.m_3dproj_lut.Kzs[0];
-					for (int r=0;r<H;r++)
-						for (int c=0;c<W;c++)
-						{
-							*kys++ = (r_cx - c) * r_fx_inv;
-							*kzs++ = (r_cy - r) * r_fy_inv;
-						}
-				} // end update LUT.
+				// Use LUT, shared by all observations from cameras with the same parameters:
+				const CObservation3DRangeScan::TCached3DProjTablesPtr lut = CObservation3DRangeScan::get3DProjLUT(src_obs.cameraParams,W,H);
+				ASSERT_EQUAL_(WH,size_t(lut->Kys.size()))
+				ASSERT_EQUAL_(WH,size_t(lut->Kzs.size()))
+				const float *kys = lut->Kys.data();
+				const float *kzs = lut->Kzs.data();
 
-				ASSERT_EQUAL_(WH,size_t(src_obs.m_3dproj_lut.Kys.size()))
-				ASSERT_EQUAL_(WH,size_t(src_obs.m_3dproj_lut.Kzs.size()))
-				float *kys = &src_obs.m_3dproj_lut.Kys[0];
-				float *kzs = &src_obs.m_3dproj_lut.Kzs[0];
-
-				if (filterParams.rangeMask_min) { // sanity check:
-					ASSERT_EQUAL_(filterParams.rangeMask_min->cols(), src_obs.rangeImage.cols());
-					ASSERT_EQUAL_(filterParams.rangeMask_min->rows(), src_obs.rangeImage.rows());
-				}
-				if (filterParams.rangeMask_max) { // sanity check:
-					ASSERT_EQUAL_(filterParams.rangeMask_max->cols(), src_obs.rangeImage.cols());
-					ASSERT_EQUAL_(filterParams.rangeMask_max->rows(), src_obs.rangeImage.rows());
-				}
 	#if MRPT_HAS_SSE2
-				if ((W & 0x07)==0 && projectParams.USE_SSE2)
+				// Rows of the matrices are 16-aligned if W=4*N:
+				if ((W & 0x03)==0 && decim==1 && projectParams.USE_SSE2)
 					 do_project_3d_pointcloud_SSE2(H,W,kys,kzs,src_obs.rangeImage,pca, src_obs.points3D_idxs_x, src_obs.points3D_idxs_y, filterParams, projectParams.MAKE_DENSE);
-				else do_project_3d_pointcloud(H,W,kys,kzs,src_obs.rangeImage,pca, src_obs.points3D_idxs_x, src_obs.points3D_idxs_y, filterParams, projectParams.MAKE_DENSE);  // if image width is not 8*N, use standard method
+				else do_project_3d_pointcloud(H,W,kys,kzs,src_obs.rangeImage,pca, src_obs.points3D_idxs_x, src_obs.points3D_idxs_y, filterParams, projectParams.MAKE_DENSE, decim);  // if image width is not 4*N, use standard method
 	#else
-				do_project_3d_pointcloud(H,W,kys,kzs,src_obs.rangeImage,pca,src_obs.points3D_idxs_x, src_obs.points3D_idxs_y,filterParams, projectParams.MAKE_DENSE);
+				do_project_3d_pointcloud(H,W,kys,kzs,src_obs.rangeImage,pca,src_obs.points3D_idxs_x, src_obs.points3D_idxs_y,filterParams, projectParams.MAKE_DENSE, decim);
 	#endif
 			}
 			else
@@ -101,8 +84,8 @@ namespace detail {
 				const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
 				TRangeImageFilter rif(filterParams);
 				size_t idx=0;
-				for (int r=0;r<H;r++)
-					for (int c=0;c<W;c++)
+				for (int r=0;r<H;r+=decim)
+					for (int c=0;c<W;c+=decim)
 					{
 						const float D = src_obs.rangeImage.coeff(r,c);
 						if (rif.do_range_filter(r,c,D))
@@ -138,8 +121,8 @@ namespace detail {
 			const float r_fy_inv = 1.0f/src_obs.cameraParams.fy();
 			TRangeImageFilter rif(filterParams);
 			size_t idx=0;
-			for (int r=0;r<H;r++)
-				for (int c=0;c<W;c++)
+			for (int r=0;r<H;r+=decim)
+				for (int c=0;c<W;c+=decim)
 				{
 					const float D = src_obs.rangeImage.coeff(r,c);
 					if (rif.do_range_filter(r,c,D))
@@ -276,13 +259,15 @@ namespace detail {
 
 	// Auxiliary functions which implement proyection of 3D point clouds:
 	template <class POINTMAP>
-	inline void do_project_3d_pointcloud(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &fp, bool MAKE_DENSE)
+	inline void do_project_3d_pointcloud(const int H,const int W,const float *kys,const float *kzs,const mrpt::math::CMatrix &rangeImage, mrpt::utils::PointCloudAdapter<POINTMAP> &pca, std::vector<uint16_t> &idxs_x, std::vector<uint16_t> &idxs_y,const mrpt::obs::TRangeImageFilterParams &fp, bool MAKE_DENSE, const int decimation)
 	{
 		TRangeImageFilter rif(fp);
 		// Preconditions: minRangeMask() has the right size
 		size_t idx=0;
-		for (int r=0;r<H;r++)
-			for (int c=0;c<W;c++)
+		for (int r=0;r<H;r+=decimation)
+		{
+			const float *kys_row = kys + r*W, *kzs_row = kzs + r*W;
+			for (int c=0;c<W;c+=decimation)
 			{
 				const float D = rangeImage.coeff(r,c);
 				if (!rif.do_range_filter(r,c,D)){
@@ -294,11 +279,12 @@ namespace detail {
 					continue;
 				}
 
-				pca.setPointXYZ(idx, D /*x*/, *kys++ * D /*y*/, *kzs++ * D /*z*/);
+				pca.setPointXYZ(idx, D /*x*/, kys_row[c] * D /*y*/, kzs_row[c] * D /*z*/);
 				idxs_x[idx]=c;
 				idxs_y[idx]=r;
 				++idx;
 			}
+		}
 		pca.resize(idx);
 	}
 
@@ -18,6 +18,7 @@
 
 namespace mrpt {
 namespace poses { class CPose3DInterpolator; }
+namespace system { class CWorkerThreadsPool; }
 namespace obs 
 {
 	DEFINE_SERIALIZABLE_PRE_CUSTOM_BASE_LINKAGE( CObservationVelodyneScan, CObservation, OBS_IMPEXP)
@@ -176,6 +177,9 @@ namespace obs
 			bool   dualKeepStrongest, dualKeepLast; //!< (Default:true) In VLP16 dual mode, keep both or just one of the returns.
 			bool   generatePerPointTimestamp;       //!< (Default:false) If `true`, populate the vector timestamp
 			bool   generatePerPointAzimuth;         //!< (Default:false) If `true`, populate the vector azimuth
+			/** (Default:NULL) If set to a pool with more than one thread, raw packets are decoded in parallel with it.
+			  * The generated points are exactly the same (and in the same order) than with sequential decoding. (New in MRPT 1.5.0) */
+			mrpt::system::CWorkerThreadsPool *threads;
 
 			TGeneratePointCloudParameters();
 		};
@@ -0,0 +1,84 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CRawlogAsyncWriter_H
+#define CRawlogAsyncWriter_H
+
+#include <mrpt/utils/CSerializable.h>
+#include <mrpt/utils/CUncopiable.h>
+#include <mrpt/obs/link_pragmas.h>
+#include <string>
+
+namespace mrpt
+{
+	namespace obs
+	{
+		namespace detail { struct TRawlogAsyncWriterImpl; }
+
+		/** Writer of gz-compressed rawlog files which serializes and compresses objects in a background thread, so
+		  * the producer (e.g. a sensor grabbing loop) is not blocked by the CPU cost of compression nor by disk I/O.
+		  *
+		  * Objects are kept in a bounded queue of up to \a queueLength objects: if the writing thread can not keep up with
+		  * the producer, write() blocks until there is room in the queue.
+		  *
+		  * Objects passed as smart pointers are not copied, so they must not be modified after being passed to write().
+		  * Objects passed by reference are cloned (with a shallow copy of their smart pointer members, e.g. the observations
+		  * in a CSensoryFrame), so they can be reused by the caller right after the call.
+		  *
+		  * The output is a regular rawlog file, which can be loaded by CRawlog or any other MRPT program.
+		  *
+		  * \note (New in MRPT 1.5.0)
+		  * \sa CRawlog, CRawlogPrefetchReader, mrpt::utils::CFileGZOutputStream
+		  * \ingroup mrpt_obs_grp
+		  */
+		class OBS_IMPEXP CRawlogAsyncWriter : public mrpt::utils::CUncopiable
+		{
+		public:
+			CRawlogAsyncWriter(); //!< Default constructor, see open()
+			/** Constructor which opens a rawlog file for writing \exception std::exception On error creating the file */
+			explicit CRawlogAsyncWriter(const std::string &rawlogFile, int compress_level = 1, size_t queueLength = 64, unsigned int compress_threads = 1);
+			/** Destructor: writes all pending objects and closes the file */
+			~CRawlogAsyncWriter();
+
+			/** Creates a rawlog file (closing any previous one) and starts the writing thread.
+			  * \param[in] compress_level The gzip compression level (0:none, 9:max, see mrpt::utils::CFileGZOutputStream)
+			  * \param[in] queueLength The maximum number of objects waiting to be written.
+			  * \param[in] compress_threads If !=1, the number of threads for parallel compression (0: as many as CPU cores), see mrpt::utils::CFileGZOutputStream::open()
+			  * \return false on error creating the file.
+			  */
+			bool open(const std::string &rawlogFile, int compress_level = 1, size_t queueLength = 64, unsigned int compress_threads = 1);
+			/** Writes all pending objects and closes the file.
+			  * \exception std::exception If there was an error writing any of the pending objects. */
+			void close();
+			bool isOpen() const;
+
+			/** Queues an object to be written (blocks if the queue is full). The object must not be modified afterwards.
+			  * \exception std::exception If there was an error writing any previous object. */
+			void write(const mrpt::utils::CSerializablePtr &obj);
+			/** Queues a copy of an object to be written (blocks if the queue is full).
+			  * \exception std::exception If there was an error writing any previous object. */
+			void write(const mrpt::utils::CSerializable &obj);
+
+			CRawlogAsyncWriter & operator << (const mrpt::utils::CSerializablePtr &obj) { write(obj); return *this; }
+			CRawlogAsyncWriter & operator << (const mrpt::utils::CSerializable &obj) { write(obj); return *this; }
+
+			/** Blocks until all queued objects have been written to the file.
+			  * \exception std::exception If there was an error writing any object. */
+			void flush();
+
+			/** Returns the number of objects waiting to be written (for statistics or debugging) */
+			size_t getQueueLength() const;
+
+		private:
+			detail::TRawlogAsyncWriterImpl *m_impl;
+		};
+
+	} // End of namespace
+} // End of namespace
+
+#endif
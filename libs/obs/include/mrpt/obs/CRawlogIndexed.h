@@ -0,0 +1,141 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CRawlogIndexed_H
+#define CRawlogIndexed_H
+
+#include <mrpt/obs/CRawlog.h>
+#include <mrpt/utils/CMemoryMappedFile.h>
+#include <mrpt/utils/CUncopiable.h>
+#include <vector>
+#include <string>
+#include <map>
+
+namespace mrpt
+{
+	namespace obs
+	{
+		/** A read-only, lazy view of a rawlog file with random access to its entries, intended for very large datasets.
+		 *
+		 *  Unlike CRawlog::loadFromRawLogFile(), which deserializes the whole file into memory, this class memory-maps
+		 *  the rawlog file (see mrpt::utils::CMemoryMappedFile) and only deserializes an entry when it is requested
+		 *  with getAsGeneric(), getAsObservation(), etc. Hence, opening a dataset is nearly instantaneous and the
+		 *  required memory does not depend on its size.
+		 *
+		 *  Random access relies on a sidecar index file (by default, the rawlog file name plus ".idx", see getIndexFileName())
+		 *  with the offset, length, class name, timestamp and sensor label of each entry. The index is built automatically
+		 *  by open() the first time a rawlog is opened (one sequential pass over the file), and rebuilt if the rawlog file
+		 *  is modified afterwards.
+		 *
+		 *  The body of the rawlog must be uncompressed, since gz-compressed streams cannot be randomly accessed. Use
+		 *  convertToIndexed() to convert a regular (gz-compressed) rawlog into an uncompressed one plus its index. Both are still
+		 *  regular rawlog files which can be loaded with CRawlog or any other MRPT program.
+		 *
+		 *  Access to entries is thread-safe (const methods only read the mapped memory).
+		 *
+		 *  With enableZeroCopy(), large payloads (e.g. the pixels of uncompressed images in mrpt::utils::CImage) of the returned objects
+		 *  reference the mapped memory instead of being copied into newly allocated buffers. Such objects keep the file mapped
+		 *  while they are alive, even after close() or the destruction of this object, and copy their data on the first modification.
+		 *
+		 * Example:
+		 * \code
+		 *  CRawlogIndexed::convertToIndexed("dataset.rawlog", "dataset_indexed.rawlog"); // Only once
+		 *
+		 *  CRawlogIndexed rawlog;
+		 *  if (!rawlog.open("dataset_indexed.rawlog")) ...
+		 *  const size_t idx = rawlog.findEntryByTime( t );
+		 *  if (idx!=CRawlogIndexed::npos && rawlog.getType(idx)==CRawlog::etObservation)
+		 *    CObservationPtr obs = rawlog.getAsObservation(idx);
+		 * \endcode
+		 *
+		 * \note (New in MRPT 1.5.0)
+		 * \sa CRawlog, mrpt::utils::CMemoryMappedFile
+		 * \ingroup mrpt_obs_grp
+		 */
+		class OBS_IMPEXP CRawlogIndexed : public mrpt::utils::CUncopiable
+		{
+		public:
+			/** Information stored in the index for each entry of the rawlog */
+			struct OBS_IMPEXP TEntry
+			{
+				TEntry();
+
+				uint64_t                offset;      //!< Offset of the serialized object in the rawlog file (bytes)
+				uint64_t                length;      //!< Length of the serialized object (bytes)
+				mrpt::system::TTimeStamp timestamp;  //!< Timestamp of the observation; the first observation of a CSensoryFrame; the first action of a CActionCollection; or INVALID_TIMESTAMP
+				CRawlog::TEntryType     type;        //!< Type of entry
+				std::string             className;   //!< The class of the serialized object
+				std::string             sensorLabel; //!< Sensor label of observations (empty for other entries)
+			};
+			typedef std::vector<TEntry> TEntryList;
+
+			static const size_t npos; //!< Used to signal "not found" in findEntryByTime()
+
+			CRawlogIndexed();
+			~CRawlogIndexed();
+
+			/** Opens (memory-maps) a rawlog file with an uncompressed body, and loads its index (see class description).
+			  * \param[in] buildIndexIfMissing If true, the index is (re)built if it does not exist or it is outdated. Otherwise, such a case is an error.
+			  * \return false on any error (e.g. the file is gz-compressed: see convertToIndexed())
+			  */
+			bool open(const std::string &rawlogFile, bool buildIndexIfMissing = true);
+			void close();
+			bool isOpen() const { return m_file!=NULL; }
+			const std::string & getFileName() const { return m_fileName; }
+
+			/** Enables or disables (default) zero-copy deserialization of large payloads from the mapped file (see class description) */
+			void enableZeroCopy(bool enable) { m_zero_copy = enable; }
+			bool isZeroCopyEnabled() const { return m_zero_copy; }
+
+			size_t size() const { return m_entries.size(); } //!< Number of entries in the rawlog
+			const TEntry & getEntryInfo(size_t index) const; //!< Returns the indexed information of one entry, without deserializing it. \exception std::exception On index out of bounds
+			const TEntryList & getEntries() const { return m_entries; }
+			CRawlog::TEntryType getType(size_t index) const { return getEntryInfo(index).type; }
+
+			/** \name Lazy access to entries. Each call deserializes the entry from the mapped file.
+			  * \exception std::exception On index out of bounds, or if the entry is not of the requested type.
+			  * @{ */
+			mrpt::utils::CSerializablePtr getAsGeneric(size_t index) const;
+			CObservationPtr       getAsObservation(size_t index) const;
+			CSensoryFramePtr      getAsObservations(size_t index) const;
+			CActionCollectionPtr  getAsAction(size_t index) const;
+			/** @} */
+
+			/** Returns the index of the entry with a valid timestamp closest to \a t (in O(log N), also with a sensor label), or npos if there is none.
+			  * \param[in] sensorLabel If not empty, only observations with this sensor label are considered.
+			  */
+			size_t findEntryByTime(const mrpt::system::TTimeStamp t, const std::string &sensorLabel = std::string()) const;
+
+			/** Scans a rawlog file with an uncompressed body and writes its index.
+			  * \return false on any error. */
+			static bool buildIndex(const std::string &rawlogFile, const std::string &indexFile);
+
+			/** Copies a rawlog (which may be gz-compressed) into a new file with an uncompressed body, and writes its index.
+			  * \return false on any error. */
+			static bool convertToIndexed(const std::string &srcRawlogFile, const std::string &dstRawlogFile);
+
+			/** The default name of the index file of a rawlog: the same file name plus ".idx" */
+			static std::string getIndexFileName(const std::string &rawlogFile);
+
+		private:
+			mrpt::utils::TMemoryBlockOwnerPtr    m_file_owner; //!< Holds the mapped file, which is shared with zero-copy deserialized objects
+			const mrpt::utils::CMemoryMappedFile *m_file; //!< The object in m_file_owner, or NULL if closed
+			std::string                    m_fileName;
+			bool                           m_zero_copy;
+			TEntryList                     m_entries;
+			std::vector<size_t>            m_by_time; //!< Entries with valid timestamps, sorted by time
+			std::map<std::string,std::vector<size_t> > m_by_label_time; //!< The same as m_by_time, for each sensor label
+
+			bool loadIndex(const std::string &rawlogFile, const std::string &indexFile);
+			void updateTimeIndex();
+		};
+
+	} // End of namespace
+} // End of namespace
+
+#endif
@@ -0,0 +1,99 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+#ifndef CRawlogPrefetchReader_H
+#define CRawlogPrefetchReader_H
+
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/utils/CUncopiable.h>
+#include <mrpt/obs/link_pragmas.h>
+#include <string>
+
+namespace mrpt
+{
+	namespace obs
+	{
+		namespace detail { struct TRawlogPrefetchReaderImpl; }
+
+		/** Sequential reader of rawlog files (gz-compressed or not) which decompresses and deserializes objects in a
+		  * background thread, ahead of the consumer.
+		  *
+		  * Objects are kept in a bounded queue of up to \a queueLength objects, so the reading thread is blocked while the
+		  * consumer is busy processing the previous entries, and the consumer only waits for I/O if the queue runs empty.
+		  * This overlaps the decompression and deserialization costs with the processing of the data, which is the
+		  * typical bottleneck of offline replays of datasets (SLAM, localization,...).
+		  *
+		  * The methods getActionObservationPairOrObservation() and readActionObservationPair() have the same semantics
+		  * than the static methods with the same names in CRawlog, which read from a mrpt::utils::CStream.
+		  *
+		  * Example:
+		  * \code
+		  *  CRawlogPrefetchReader rawlog("dataset.rawlog");
+		  *  CActionCollectionPtr action;
+		  *  CSensoryFramePtr     observations;
+		  *  CObservationPtr      observation;
+		  *  size_t               rawlogEntry = 0;
+		  *  while (rawlog.getActionObservationPairOrObservation(action,observations,observation,rawlogEntry)) {
+		  *    ...
+		  *  }
+		  * \endcode
+		  *
+		  * \note Only one consumer thread should read from an object of this class.
+		  * \note (New in MRPT 1.5.0)
+		  * \sa CRawlog, CRawlogAsyncWriter
+		  * \ingroup mrpt_obs_grp
+		  */
+		class OBS_IMPEXP CRawlogPrefetchReader : public mrpt::utils::CUncopiable
+		{
+		public:
+			CRawlogPrefetchReader(); //!< Default constructor, see open()
+			/** Constructor which opens a rawlog file \exception std::exception On error opening the file */
+			explicit CRawlogPrefetchReader(const std::string &rawlogFile, size_t queueLength = 32);
+			~CRawlogPrefetchReader();
+
+			/** Opens a rawlog file (closing any previous one) and starts prefetching its objects.
+			  * \param[in] queueLength The maximum number of objects read in advance.
+			  * \return false on error opening the file.
+			  */
+			bool open(const std::string &rawlogFile, size_t queueLength = 32);
+			void close(); //!< Stops the background thread and closes the file.
+			bool isOpen() const;
+
+			/** Gets the next object in the rawlog, waiting for it to be read if needed.
+			  * \return false at the end of the file.
+			  * \exception std::exception If there was an error reading or deserializing the object in the background thread.
+			  */
+			bool getNextObject(mrpt::utils::CSerializablePtr &obj);
+
+			/** Like CRawlog::getActionObservationPairOrObservation(), but reading from the prefetch queue.
+			  * \return false on end of file or error. */
+			bool getActionObservationPairOrObservation(
+				CActionCollectionPtr &action,
+				CSensoryFramePtr     &observations,
+				CObservationPtr      &observation,
+				size_t               &rawlogEntry );
+
+			/** Like CRawlog::readActionObservationPair(), but reading from the prefetch queue.
+			  * \return false on end of file or error. */
+			bool readActionObservationPair(
+				CActionCollectionPtr &action,
+				CSensoryFramePtr     &observations,
+				size_t               &rawlogEntry );
+
+			/** Returns the number of objects already read and waiting in the queue (for statistics or debugging) */
+			size_t getQueueLength() const;
+
+		private:
+			detail::TRawlogPrefetchReaderImpl *m_impl;
+		};
+
+	} // End of namespace
+} // End of namespace
+
+#endif
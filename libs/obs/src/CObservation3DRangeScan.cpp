@@ -23,8 +23,11 @@
 #include <mrpt/utils/CConfigFileMemory.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/string_utils.h>
+#include <mrpt/compress/zip.h>
+#include <mrpt/synch/CCriticalSection.h>
 
 #include <limits>
+#include <deque>
 
 using namespace std;
 using namespace mrpt::obs;
@@ -35,10 +38,122 @@ using namespace mrpt::math;
 // This must be added to any CSerializable class implementation file.
 IMPLEMENTS_SERIALIZABLE(CObservation3DRangeScan, CObservation,mrpt::obs)
 
-// Static LUT:
-CObservation3DRangeScan::TCached3DProjTables CObservation3DRangeScan::m_3dproj_lut;
-
 bool CObservation3DRangeScan::EXTERNALS_AS_TEXT = false;
+float CObservation3DRangeScan::COMPACT_RANGE_UNITS = 0;
+bool CObservation3DRangeScan::COMPACT_SKIP_POINTS3D = false;
+
+/*---------------------------------------------------------------
+						get3DProjLUT
+ ---------------------------------------------------------------*/
+CObservation3DRangeScan::TCached3DProjTablesPtr CObservation3DRangeScan::get3DProjLUT(const mrpt::utils::TCamera &camParams, const int W, const int H)
+{
+	// Most recently used tables first. Enough entries for several cameras (e.g. a rig of RGBD sensors) grabbing at once:
+	static const size_t MAX_CACHED_TABLES = 8;
+	static mrpt::synch::CCriticalSection cs;
+	static std::deque<TCached3DProjTablesPtr> cache;
+
+	{
+		mrpt::synch::CCriticalSectionLocker lock(&cs);
+		for (size_t i=0;i<cache.size();i++)
+		{
+			if (cache[i]->W==W && cache[i]->H==H && !(cache[i]->prev_camParams!=camParams))
+			{
+				const TCached3DProjTablesPtr lut = cache[i];
+				if (i!=0) {
+					cache.erase(cache.begin()+i);
+					cache.push_front(lut);
+				}
+				return lut;
+			}
+		}
+	}
+
+	// Not found: build new tables (out of the critical section, this may take a while):
+	TCached3DProjTablesPtr lut(new TCached3DProjTables);
+	lut->prev_camParams = camParams;
+	lut->W = W;
+	lut->H = H;
+	lut->Kys.resize(W*H);
+	lut->Kzs.resize(W*H);
+
+	const float r_cx = camParams.cx();
+	const float r_cy = camParams.cy();
+	const float r_fx_inv = 1.0f/camParams.fx();
+	const float r_fy_inv = 1.0f/camParams.fy();
+	float *kys = &lut->Kys[0];
+	float *kzs = &lut->Kzs[0];
+	for (int r=0;r<H;r++)
+		for (int c=0;c<W;c++)
+		{
+			*kys++ = (r_cx - c) * r_fx_inv;
+			*kzs++ = (r_cy - r) * r_fy_inv;
+		}
+
+	mrpt::synch::CCriticalSectionLocker lock(&cs);
+	cache.push_front(lut);
+	if (cache.size()>MAX_CACHED_TABLES)
+		cache.pop_back();
+	return lut;
+}
+
+namespace
+{
+	// Range image encodings (serialization v9):
+	const uint8_t RANGE_ENCODING_FLOAT = 0;   // A CMatrix of floats
+	const uint8_t RANGE_ENCODING_UINT16 = 1;  // See encodeRangeImage16()
+
+	/** Compact, lossless encoding of a range image quantized to 16 bit: each value is replaced by its difference with the
+	  * pixel on its left (the one above, for the first column), which is small and repeats a lot in smooth surfaces, then the
+	  * low and high bytes of all the differences are stored in two separate planes, and the result is ZIP-compressed.
+	  * \return false if any range can not be represented, so the image must be stored as floats. */
+	bool encodeRangeImage16(const CMatrix &ranges, const float units, std::vector<uint8_t> &out_zip)
+	{
+		const size_t H = ranges.rows(), W = ranges.cols(), N = H*W;
+		const float inv_units = 1.0f/units;
+		std::vector<uint8_t> planes(2*N);
+		uint16_t left = 0, up = 0;
+		for (size_t r=0,i=0;r<H;r++)
+		{
+			for (size_t c=0;c<W;c++,i++)
+			{
+				const float v = ranges(r,c)*inv_units;
+				if (!(v>=0 && v<=65535.0f)) // Also catches NaNs
+					return false;
+				const uint16_t q = static_cast<uint16_t>(v+0.5f);
+				const uint16_t d = static_cast<uint16_t>(q - (c==0 ? up : left)); // (modulo 2^16)
+				planes[i]   = static_cast<uint8_t>(d);
+				planes[N+i] = static_cast<uint8_t>(d>>8);
+				if (c==0) up = q;
+				left = q;
+			}
+		}
+		out_zip.clear();
+		if (N) mrpt::compress::zip::compress(planes, out_zip);
+		return true;
+	}
+
+	void decodeRangeImage16(mrpt::utils::CStream &in, const uint32_t zipLen, const float units, CMatrix &ranges)
+	{
+		const size_t H = ranges.rows(), W = ranges.cols(), N = H*W;
+		if (!N) return;
+		std::vector<uint8_t> planes(2*N);
+		size_t nDecomp = 0;
+		mrpt::compress::zip::decompress(in, zipLen, &planes[0], planes.size(), nDecomp);
+		ASSERT_EQUAL_(nDecomp, planes.size());
+		uint16_t left = 0, up = 0;
+		for (size_t r=0,i=0;r<H;r++)
+		{
+			for (size_t c=0;c<W;c++,i++)
+			{
+				const uint16_t d = static_cast<uint16_t>(planes[i] | (planes[N+i]<<8));
+				const uint16_t q = static_cast<uint16_t>(d + (c==0 ? up : left));
+				ranges(r,c) = q*units;
+				if (c==0) up = q;
+				left = q;
+			}
+		}
+	}
+}
 
 
 // Whether to use a memory pool for 3D points:
@@ -170,14 +285,19 @@ CObservation3DRangeScan::~CObservation3DRangeScan()
 void  CObservation3DRangeScan::writeToStream(mrpt::utils::CStream &out, int *version) const
 {
 	if (version)
-		*version = 8;
+		*version = 9;
 	else
 	{
 		// The data
 		out << maxRange << sensorPose;
 
+		// New in v9: Skip points which will be regenerated from the range image upon loading
+		const bool skipPoints3D = COMPACT_SKIP_POINTS3D && hasRangeImage && !m_rangeImage_external_stored && !m_points3D_external_stored;
+
 		out << hasPoints3D;
 		if (hasPoints3D)
+			out << skipPoints3D;  // New in v9
+		if (hasPoints3D && !skipPoints3D)
 		{
 			ASSERT_(points3D_x.size()==points3D_y.size() && points3D_x.size()==points3D_z.size() && points3D_idxs_x.size()==points3D_x.size() && points3D_idxs_y.size()==points3D_x.size())
 			uint32_t N = points3D_x.size();
@@ -192,7 +312,22 @@ void  CObservation3DRangeScan::writeToStream(mrpt::utils::CStream &out, int *ver
 			}
 		}
 
-		out << hasRangeImage; if (hasRangeImage) out << rangeImage;
+		out << hasRangeImage;
+		if (hasRangeImage)
+		{
+			// New in v9: encoding
+			std::vector<uint8_t> zip;
+			if (COMPACT_RANGE_UNITS>0 && !m_rangeImage_external_stored && encodeRangeImage16(rangeImage,COMPACT_RANGE_UNITS,zip))
+			{
+				out << RANGE_ENCODING_UINT16 << COMPACT_RANGE_UNITS;
+				out << static_cast<uint32_t>(rangeImage.rows()) << static_cast<uint32_t>(rangeImage.cols()) << static_cast<uint32_t>(zip.size());
+				if (!zip.empty()) out.WriteBuffer(&zip[0],zip.size());
+			}
+			else
+			{
+				out << RANGE_ENCODING_FLOAT << rangeImage;
+			}
+		}
 		out << hasIntensityImage; if (hasIntensityImage)  out << intensityImage;
 		out << hasConfidenceImage; if (hasConfidenceImage) out << confidenceImage;
 
@@ -239,6 +374,7 @@ void  CObservation3DRangeScan::readFromStream(mrpt::utils::CStream &in, int vers
 	case 6:
 	case 7:
 	case 8:
+	case 9:
 		{
 			uint32_t		N;
 
@@ -248,7 +384,11 @@ void  CObservation3DRangeScan::readFromStream(mrpt::utils::CStream &in, int vers
 				in >> hasPoints3D;
 			else hasPoints3D = true;
 
-			if (hasPoints3D)
+			bool skippedPoints3D = false;
+			if (hasPoints3D && version>=9)
+				in >> skippedPoints3D;
+
+			if (hasPoints3D && !skippedPoints3D)
 			{
 				in >> N;
 				resizePoints3DVectors(N);
@@ -280,11 +420,27 @@ void  CObservation3DRangeScan::readFromStream(mrpt::utils::CStream &in, int vers
 				in >> hasRangeImage;
 				if (hasRangeImage)
 				{
+					uint8_t rangeEncoding = RANGE_ENCODING_FLOAT;
+					if (version>=9)
+						in >> rangeEncoding;
+
+					if (rangeEncoding==RANGE_ENCODING_UINT16)
+					{
+						float units;
+						uint32_t rows, cols, zipLen;
+						in >> units >> rows >> cols >> zipLen;
+						this->rangeImage_setSize(rows,cols);
+						decodeRangeImage16(in,zipLen,units,rangeImage);
+					}
+					else if (rangeEncoding==RANGE_ENCODING_FLOAT)
+					{
 #ifdef COBS3DRANGE_USE_MEMPOOL
-					// We should call "rangeImage_setSize()" to exploit the mempool:
-					this->rangeImage_setSize(480,640);
+						// We should call "rangeImage_setSize()" to exploit the mempool:
+						this->rangeImage_setSize(480,640);
 #endif
-					in >> rangeImage;
+						in >> rangeImage;
+					}
+					else THROW_EXCEPTION_FMT("Unknown range image encoding: %u",static_cast<unsigned>(rangeEncoding))
 				}
 
 				in >> hasIntensityImage;
@@ -359,6 +515,10 @@ void  CObservation3DRangeScan::readFromStream(mrpt::utils::CStream &in, int vers
 					pixelLabels = TPixelLabelInfoPtr( TPixelLabelInfoBase::readAndBuildFromStream(in) );
 			}
 
+			// v9: Regenerate the point cloud, once all the camera parameters are loaded:
+			if (skippedPoints3D)
+				this->project3DPointsFromDepthImage();
+
 		} break;
 	default:
 		MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version)
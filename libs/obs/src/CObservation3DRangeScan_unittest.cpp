@@ -8,6 +8,7 @@
    +---------------------------------------------------------------------------+ */
 
 #include <mrpt/obs/CObservation3DRangeScan.h>
+#include <mrpt/utils/CMemoryStream.h>
 
 #include <gtest/gtest.h>
 
@@ -177,3 +178,122 @@ TEST(CObservation3DRangeScan, Project3D_filterMax)
 		EXPECT_EQ(o.points3D_x.size(), 3U ) << " testcase flags: i=" << i << std::endl;
 	}
 }
+
+TEST(CObservation3DRangeScan, Project3D_LUTsMatchDirect)
+{
+	// All methods must produce the same points, for all pixels:
+	mrpt::obs::CObservation3DRangeScan  ref;
+	mrpt::obs::T3DPointsProjectionParams pp;
+	fillSampleObs(ref,pp,0);
+	pp.PROJ3D_USE_LUT = false;
+	ref.project3DPointsFromDepthImageInto(ref,pp);
+	ASSERT_EQ(ref.points3D_x.size(),21U);
+
+	for (int i=0;i<4;i++)
+	{
+		mrpt::obs::CObservation3DRangeScan  o;
+		fillSampleObs(o,pp,i|1 /*LUT*/);
+		o.project3DPointsFromDepthImageInto(o,pp);
+		ASSERT_EQ(o.points3D_x.size(),ref.points3D_x.size()) << " testcase flags: i=" << i << std::endl;
+		for (size_t k=0;k<o.points3D_x.size();k++)
+		{
+			EXPECT_EQ(o.points3D_idxs_x[k], ref.points3D_idxs_x[k]);
+			EXPECT_EQ(o.points3D_idxs_y[k], ref.points3D_idxs_y[k]);
+			EXPECT_NEAR(o.points3D_y[k], ref.points3D_y[k], 1e-5f);
+			EXPECT_NEAR(o.points3D_z[k], ref.points3D_z[k], 1e-5f);
+		}
+	}
+
+	// A different camera must not reuse the tables of the first one:
+	mrpt::obs::CObservation3DRangeScan o2;
+	fillSampleObs(o2,pp,1);
+	o2.cameraParams.fx(o2.cameraParams.fx()*2);
+	o2.project3DPointsFromDepthImageInto(o2,pp);
+	ASSERT_EQ(o2.points3D_y.size(),ref.points3D_y.size());
+	EXPECT_NEAR(o2.points3D_y[0], 0.5f*ref.points3D_y[0], 1e-5f);
+}
+
+TEST(CObservation3DRangeScan, Project3D_decimation)
+{
+	mrpt::obs::T3DPointsProjectionParams pp;
+	for (int i=0;i<8;i++) // test all combinations of flags
+	{
+		mrpt::obs::CObservation3DRangeScan  o;
+		fillSampleObs(o,pp,i);
+		pp.decimation = 2;
+		o.project3DPointsFromDepthImageInto(o,pp);
+		// Valid pixels (r,c) with 10<=c<=r<16 and both even: rows 10,12,14 with 1,2,3 columns
+		EXPECT_EQ(o.points3D_x.size(),6U) << " testcase flags: i=" << i << std::endl;
+		for (size_t k=0;k<o.points3D_x.size();k++)
+		{
+			EXPECT_EQ(o.points3D_idxs_x[k]%2, 0);
+			EXPECT_EQ(o.points3D_idxs_y[k]%2, 0);
+		}
+	}
+}
+
+// Serializes and deserializes an observation, with the given compact serialization settings:
+static void serializeRoundTrip(const mrpt::obs::CObservation3DRangeScan &o, mrpt::obs::CObservation3DRangeScan &o2, float units, bool skipPoints, size_t *out_size = NULL)
+{
+	using mrpt::obs::CObservation3DRangeScan;
+	const float old_units = CObservation3DRangeScan::COMPACT_RANGE_UNITS;
+	const bool old_skip = CObservation3DRangeScan::COMPACT_SKIP_POINTS3D;
+	CObservation3DRangeScan::COMPACT_RANGE_UNITS = units;
+	CObservation3DRangeScan::COMPACT_SKIP_POINTS3D = skipPoints;
+	mrpt::utils::CMemoryStream buf;
+	buf << o;
+	CObservation3DRangeScan::COMPACT_RANGE_UNITS = old_units;
+	CObservation3DRangeScan::COMPACT_SKIP_POINTS3D = old_skip;
+	if (out_size) *out_size = buf.getTotalBytesCount();
+	buf.Seek(0);
+	buf >> o2;
+}
+
+TEST(CObservation3DRangeScan, compactSerialization)
+{
+	mrpt::obs::CObservation3DRangeScan o;
+	mrpt::obs::T3DPointsProjectionParams pp;
+	fillSampleObs(o,pp,0);
+	// A smooth surface, in millimeters:
+	for (int r=0;r<TEST_RANGEIMG_HEIGHT;r++)
+		for (int c=0;c<TEST_RANGEIMG_WIDTH;c++)
+			o.rangeImage(r,c) = (r==5 && c==7) ? 0.0f : 1.0f + 0.001f*(r*3+c);
+	o.project3DPointsFromDepthImage();
+	ASSERT_TRUE(o.hasPoints3D);
+
+	size_t size_float=0, size_compact=0, size_nopts=0;
+	mrpt::obs::CObservation3DRangeScan o_float, o_compact, o_nopts;
+	serializeRoundTrip(o, o_float, 0, false, &size_float);
+	serializeRoundTrip(o, o_compact, 1e-3f, false, &size_compact);
+	serializeRoundTrip(o, o_nopts, 1e-3f, true, &size_nopts);
+	EXPECT_LT(size_compact, size_float);
+	EXPECT_LT(size_nopts, size_compact);
+
+	EXPECT_TRUE(o_float.rangeImage == o.rangeImage);
+	ASSERT_EQ(o_compact.rangeImage.rows(), o.rangeImage.rows());
+	ASSERT_EQ(o_compact.rangeImage.cols(), o.rangeImage.cols());
+	EXPECT_NEAR((o_compact.rangeImage - o.rangeImage).array().abs().maxCoeff(), 0.0f, 1e-5f);
+	EXPECT_TRUE(o_compact.points3D_x == o.points3D_x);
+
+	// Regenerated points:
+	ASSERT_TRUE(o_nopts.hasPoints3D);
+	ASSERT_EQ(o_nopts.points3D_x.size(), o.points3D_x.size());
+	EXPECT_TRUE(o_nopts.points3D_idxs_x == o.points3D_idxs_x);
+	EXPECT_TRUE(o_nopts.points3D_idxs_y == o.points3D_idxs_y);
+	for (size_t i=0;i<o.points3D_x.size();i++)
+	{
+		EXPECT_NEAR(o_nopts.points3D_x[i], o.points3D_x[i], 1e-4f);
+		EXPECT_NEAR(o_nopts.points3D_y[i], o.points3D_y[i], 1e-4f);
+		EXPECT_NEAR(o_nopts.points3D_z[i], o.points3D_z[i], 1e-4f);
+	}
+}
+
+TEST(CObservation3DRangeScan, compactSerializationFallback)
+{
+	mrpt::obs::CObservation3DRangeScan o, o2;
+	mrpt::obs::T3DPointsProjectionParams pp;
+	fillSampleObs(o,pp,0);
+	o.rangeImage(1,1) = 100.0f; // Not representable in 16 bit with 1mm units: stored as floats
+	serializeRoundTrip(o, o2, 1e-3f, false);
+	EXPECT_TRUE(o2.rangeImage == o.rangeImage);
+}
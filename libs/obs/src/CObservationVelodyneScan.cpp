@@ -13,6 +13,7 @@
 #include <mrpt/poses/CPose3DInterpolator.h>
 #include <mrpt/utils/round.h>
 #include <mrpt/utils/CStream.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 
 using namespace std;
 using namespace mrpt::obs;
@@ -65,7 +66,8 @@ CObservationVelodyneScan::TGeneratePointCloudParameters::TGeneratePointCloudPara
 	dualKeepStrongest(true),
 	dualKeepLast(true),
 	generatePerPointTimestamp(false),
-	generatePerPointAzimuth(false)
+	generatePerPointAzimuth(false),
+	threads(NULL)
 {
 }
 
@@ -135,8 +137,16 @@ void  CObservationVelodyneScan::readFromStream(mrpt::utils::CStream &in, int ver
 			{
 				uint32_t N; 
 				in >> N;
-				scan_packets.resize(N);
-				if (N) in.ReadBuffer(&scan_packets[0],sizeof(scan_packets[0])*N);
+				// If the stream supports it, copy the packets straight from its buffer (saving the zero-fill of resize()):
+				mrpt::utils::TMemoryBlockOwnerPtr owner;
+				const TVelodyneRawPacket *pkts = static_cast<const TVelodyneRawPacket*>(in.ReadBufferZeroCopy(sizeof(TVelodyneRawPacket)*N, owner));
+				if (pkts)
+					scan_packets.assign(pkts, pkts+N);
+				else
+				{
+					scan_packets.resize(N);
+					if (N) in.ReadBuffer(&scan_packets[0],sizeof(scan_packets[0])*N);
+				}
 			}
 			{
 				uint32_t N; 
@@ -182,97 +192,162 @@ double VLP16AdjustTimeStamp(int firingblock,int dsr,int firingwithinblock)  //!<
 		(firingwithinblock * VLP16_FIRING_TOFFSET);
 }
 
-/** Auxiliary class used to refactor CObservationVelodyneScan::generatePointCloud() */
-struct PointCloudStorageWrapper {
-	/** Process the insertion of a new (x,y,z) point to the cloud, in sensor-centric coordinates, with the exact timestamp of that LIDAR ray */
-	virtual void add_point(double pt_x,double pt_y, double pt_z,uint8_t pt_intensity, const mrpt::system::TTimeStamp &tim, const float azimuth) = 0;
-};
-
-static void velodyne_scan_to_pointcloud(
-	const CObservationVelodyneScan & scan,
-	const CObservationVelodyneScan::TGeneratePointCloudParameters &params,
-	PointCloudStorageWrapper & out_pc)
+namespace
 {
-	// Initially based on code from ROS velodyne & from vtkVelodyneHDLReader::vtkInternal::ProcessHDLPacket(). 
-	using mrpt::utils::round;
-
-	// Access to sin/cos table:
-	mrpt::obs::T2DScanProperties scan_props;
-	scan_props.aperture = 2*M_PI;
-	scan_props.nRays = CObservationVelodyneScan::ROTATION_MAX_UNITS;
-	scan_props.rightToLeft = true;
-	// The LUT contains sin/cos values for angles in this order: [180deg ... 0 deg ... -180 deg]
-	const CSinCosLookUpTableFor2DScans::TSinCosValues & lut_sincos = velodyne_sincos_tables.getSinCosForScan(scan_props);
-
-	const int minAzimuth_int = round( params.minAzimuth_deg * 100 );
-	const int maxAzimuth_int = round( params.maxAzimuth_deg * 100 );
-	const float realMinDist = std::max(static_cast<float>(scan.minRange),params.minDistance);
-	const float realMaxDist = std::min(params.maxDistance,static_cast<float>(scan.maxRange));
-	const int16_t isolatedPointsFilterDistance_units = params.isolatedPointsFilterDistance/CObservationVelodyneScan::DISTANCE_RESOLUTION;
-
-	// This is: 16,32,64 depending on the LIDAR model
-	const size_t num_lasers = scan.calibration.laser_corrections.size();
-
-	for (size_t iPkt = 0; iPkt<scan.scan_packets.size();iPkt++)
+	/** Tables for decoding the raw packets of one scan, computed once from the LIDAR model (number of lasers in the calibration)
+	  * instead of once per point: the fraction of the azimuth increment between consecutive blocks which must be added to each
+	  * return, according to its firing time within the block; and the sin/cos of all the azimuth values. */
+	struct TVelodyneDecodeTables
 	{
-		const CObservationVelodyneScan::TVelodyneRawPacket *raw = &scan.scan_packets[iPkt];
+		/** Indices: [0:single|1:dual return mode][block][dsr] */
+		double azimuth_frac[2][CObservationVelodyneScan::BLOCKS_PER_PACKET][SCANS_PER_FIRING];
+		const CSinCosLookUpTableFor2DScans::TSinCosValues *lut_sincos;
 
-		mrpt::system::TTimeStamp pkt_tim; // Find out timestamp of this pkt
+		explicit TVelodyneDecodeTables(const size_t num_lasers)
 		{
+			// Access to sin/cos table:
+			mrpt::obs::T2DScanProperties scan_props;
+			scan_props.aperture = 2*M_PI;
+			scan_props.nRays = CObservationVelodyneScan::ROTATION_MAX_UNITS;
+			scan_props.rightToLeft = true;
+			// The LUT contains sin/cos values for angles in this order: [180deg ... 0 deg ... -180 deg]
+			lut_sincos = &velodyne_sincos_tables.getSinCosForScan(scan_props);
+
+			for (int dual=0;dual<2;dual++)
+			for (int block=0;block<CObservationVelodyneScan::BLOCKS_PER_PACKET;block++)
+			for (int dsr=0;dsr<SCANS_PER_FIRING;dsr++)
+			{
+				// Azimuth correction: correct for the laser rotation as a function of timing during the firings
+				// Note: only the upper bank is accepted for 16 and 32 lasers, so laserId==dsr and firingWithinBlock==false
+				double timestampadjustment = 0.0; // [us] since beginning of scan
+				double blockdsr0 = 0.0;
+				double nextblockdsr0 = 1.0;
+				switch (num_lasers)
+				{
+				// VLP-16
+				case 16:
+					{
+						const int firingblock = dual ? block/2 : block;
+						timestampadjustment = VLP16AdjustTimeStamp(firingblock, dsr, 0);
+						nextblockdsr0 = VLP16AdjustTimeStamp(firingblock+1,0,0);
+						blockdsr0 = VLP16AdjustTimeStamp(firingblock,0,0);
+					}
+					break;
+				// HDL-32:
+				case 32:
+					timestampadjustment = HDL32AdjustTimeStamp(block, dsr);
+					nextblockdsr0 = HDL32AdjustTimeStamp(block+1,0);
+					blockdsr0 = HDL32AdjustTimeStamp(block,0);
+					break;
+				case 64:
+					break;
+				default: {
+					THROW_EXCEPTION("Error: unhandled LIDAR model!")
+					}
+				};
+				azimuth_frac[dual][block][dsr] = (timestampadjustment - blockdsr0) / (nextblockdsr0 - blockdsr0);
+			}
+		}
+	};
+
+	/** Points decoded from all the packets of a scan, in sensor-centric coordinates (structure of arrays).
+	  * Each packet has a preallocated slot of SCANS_PER_PACKET entries, so packets can be decoded in parallel. */
+	struct TVelodyneDecodedPoints
+	{
+		std::vector<float>   x,y,z,azimuth;
+		std::vector<uint8_t> intensity;
+		std::vector<uint16_t> count;     //!< Number of valid points in each packet
+		std::vector<uint16_t> invalid_blocks; //!< Number of blocks with mangled headers in each packet
+		std::vector<mrpt::system::TTimeStamp> timestamp; //!< Timestamp of each packet
+
+		void resize(size_t nPackets)
+		{
+			const size_t N = nPackets*CObservationVelodyneScan::SCANS_PER_PACKET;
+			x.resize(N); y.resize(N); z.resize(N); azimuth.resize(N); intensity.resize(N);
+			count.assign(nPackets,0);
+			invalid_blocks.assign(nPackets,0);
+			timestamp.resize(nPackets);
+		}
+		size_t total_count() const
+		{
+			size_t n=0;
+			for (size_t i=0;i<count.size();i++) n+=count[i];
+			return n;
+		}
+	};
+
+	/** Decodes all the returns in one raw packet into its slot of the output. Thread-safe (for different packets). */
+	void velodyne_decode_packet(
+		const CObservationVelodyneScan & scan,
+		const CObservationVelodyneScan::TGeneratePointCloudParameters &params,
+		const TVelodyneDecodeTables &tables,
+		const size_t iPkt,
+		TVelodyneDecodedPoints &out)
+	{
+		// Initially based on code from ROS velodyne & from vtkVelodyneHDLReader::vtkInternal::ProcessHDLPacket().
+		using mrpt::utils::round;
+
+		const int minAzimuth_int = round( params.minAzimuth_deg * 100 );
+		const int maxAzimuth_int = round( params.maxAzimuth_deg * 100 );
+		const float realMinDist = std::max(static_cast<float>(scan.minRange),params.minDistance);
+		const float realMaxDist = std::min(params.maxDistance,static_cast<float>(scan.maxRange));
+		const int16_t isolatedPointsFilterDistance_units = params.isolatedPointsFilterDistance/CObservationVelodyneScan::DISTANCE_RESOLUTION;
+		const CSinCosLookUpTableFor2DScans::TSinCosValues & lut_sincos = *tables.lut_sincos;
+
+		// This is: 16,32,64 depending on the LIDAR model
+		const size_t num_lasers = scan.calibration.laser_corrections.size();
+
+		const CObservationVelodyneScan::TVelodyneRawPacket *raw = &scan.scan_packets[iPkt];
+
+		{ // Find out timestamp of this pkt
 			const uint32_t us_pkt0     = scan.scan_packets[0].gps_timestamp;
 			const uint32_t us_pkt_this = raw->gps_timestamp;
 			// Handle the case of time counter reset by new hour 00:00:00
 			const uint32_t us_ellapsed = (us_pkt_this>=us_pkt0) ? (us_pkt_this-us_pkt0) : (1000000UL*3600UL + us_pkt_this-us_pkt0);
-			pkt_tim = mrpt::system::timestampAdd(scan.timestamp,us_ellapsed*1e-6);
+			out.timestamp[iPkt] = mrpt::system::timestampAdd(scan.timestamp,us_ellapsed*1e-6);
 		}
 
+		const bool is_dual = (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL);
+
 		// Take the median rotational speed as a good value for interpolating the missing azimuths:
 		int median_azimuth_diff;
 		{
 			// In dual return, the azimuth rate is actually twice this estimation:
-			const int nBlocksPerAzimuth = (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL) ? 2 : 1;
-			std::vector<int> diffs(CObservationVelodyneScan::BLOCKS_PER_PACKET - nBlocksPerAzimuth);
-			for(int i = 0; i < CObservationVelodyneScan::BLOCKS_PER_PACKET-nBlocksPerAzimuth; ++i) {
-				int localDiff = (CObservationVelodyneScan::ROTATION_MAX_UNITS + raw->blocks[i+nBlocksPerAzimuth].rotation - raw->blocks[i].rotation) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				diffs[i] = localDiff;
-			}
-			std::nth_element(diffs.begin(), diffs.begin() + CObservationVelodyneScan::BLOCKS_PER_PACKET/2, diffs.end()); // Calc median
+			const int nBlocksPerAzimuth = is_dual ? 2 : 1;
+			int diffs[CObservationVelodyneScan::BLOCKS_PER_PACKET];
+			const int nDiffs = CObservationVelodyneScan::BLOCKS_PER_PACKET - nBlocksPerAzimuth;
+			for(int i = 0; i < nDiffs; ++i)
+				diffs[i] = (CObservationVelodyneScan::ROTATION_MAX_UNITS + raw->blocks[i+nBlocksPerAzimuth].rotation - raw->blocks[i].rotation) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
+			std::nth_element(diffs, diffs + CObservationVelodyneScan::BLOCKS_PER_PACKET/2, diffs + nDiffs); // Calc median
 			median_azimuth_diff = diffs[CObservationVelodyneScan::BLOCKS_PER_PACKET/2];
 		}
 
+		const size_t out_idx0 = iPkt*CObservationVelodyneScan::SCANS_PER_PACKET;
+		size_t out_idx = out_idx0;
+
 		for (int block = 0; block < CObservationVelodyneScan::BLOCKS_PER_PACKET; block++)  // Firings per packet
 		{
 			// ignore packets with mangled or otherwise different contents
 			if ((num_lasers!=64 && CObservationVelodyneScan::UPPER_BANK != raw->blocks[block].header) ||
 				(raw->blocks[block].header!=CObservationVelodyneScan::UPPER_BANK && raw->blocks[block].header!=CObservationVelodyneScan::LOWER_BANK) )
 			{
-				cerr << "[CObservationVelodyneScan] skipping invalid packet: block " << block << " header value is " << raw->blocks[block].header;
+				out.invalid_blocks[iPkt]++;
 				continue;
 			}
 
 			const int dsr_offset = (raw->blocks[block].header==CObservationVelodyneScan::LOWER_BANK) ? 32:0;
 			const float azimuth_raw_f = (float)(raw->blocks[block].rotation);
-			const bool block_is_dual_2nd_ranges  = (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL && ((block & 0x01)!=0));
-			const bool block_is_dual_last_ranges = (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL && ((block & 0x01)==0));
+			const bool block_is_dual_2nd_ranges  = (is_dual && ((block & 0x01)!=0));
+			const bool block_is_dual_last_ranges = (is_dual && ((block & 0x01)==0));
+			const double *azimuth_frac = tables.azimuth_frac[is_dual ? 1:0][block];
 
 			for (int dsr=0,k=0; dsr < SCANS_PER_FIRING; dsr++, k++)
 			{
 				if (!raw->blocks[block].laser_returns[k].distance) // Invalid return?
 					continue;
 
-				const uint8_t rawLaserId = static_cast<uint8_t>(dsr + dsr_offset);
-				uint8_t laserId = rawLaserId;
-
-				// Detect VLP-16 data and adjust laser id if necessary
-				bool firingWithinBlock = false;
-				if(num_lasers==16) {
-					if(laserId >= 16) {
-						laserId -= 16;
-						firingWithinBlock = true;
-					}
-				}
-
-				ASSERT_BELOW_(laserId,num_lasers)
+				// The LIDAR model was checked by TVelodyneDecodeTables, so laserId is always in range here:
+				const uint8_t laserId = static_cast<uint8_t>(dsr + dsr_offset);
 				const mrpt::obs::VelodyneCalibration::PerLaserCalib &calib = scan.calibration.laser_corrections[laserId];
 
 				// In dual return, if the distance is equal in both ranges, ignore one of them:
@@ -308,40 +383,7 @@ static void velodyne_scan_to_pointcloud(
 				}
 
 				// Azimuth correction: correct for the laser rotation as a function of timing during the firings
-				double timestampadjustment = 0.0; // [us] since beginning of scan
-				double blockdsr0 = 0.0;
-				double nextblockdsr0 = 1.0;
-				switch (num_lasers)
-				{
-				// VLP-16
-				case 16:
-					{
-						if (raw->laser_return_mode==CObservationVelodyneScan::RETMODE_DUAL) {
-							timestampadjustment = VLP16AdjustTimeStamp(block/2, laserId, firingWithinBlock);
-							nextblockdsr0 = VLP16AdjustTimeStamp(block/2+1,0,0);
-							blockdsr0 = VLP16AdjustTimeStamp(block/2,0,0);
-						}
-						else {
-							timestampadjustment = VLP16AdjustTimeStamp(block, laserId, firingWithinBlock);
-							nextblockdsr0 = VLP16AdjustTimeStamp(block+1,0,0);
-							blockdsr0 = VLP16AdjustTimeStamp(block,0,0);
-						}
-					}
-					break;
-				// HDL-32:
-				case 32:
-					timestampadjustment = HDL32AdjustTimeStamp(block, dsr);
-					nextblockdsr0 = HDL32AdjustTimeStamp(block+1,0);
-					blockdsr0 = HDL32AdjustTimeStamp(block,0);
-					break;
-				case 64:
-					break;
-				default: {
-					THROW_EXCEPTION("Error: unhandled LIDAR model!")
-					}
-				};
-
-				const int azimuthadjustment = mrpt::utils::round( median_azimuth_diff * ((timestampadjustment - blockdsr0) / (nextblockdsr0 - blockdsr0)));
+				const int azimuthadjustment = round( median_azimuth_diff * azimuth_frac[dsr] );
 
 				const float azimuth_corrected_f = azimuth_raw_f + azimuthadjustment;
 				const int azimuth_corrected = ((int)round(azimuth_corrected_f)) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
@@ -357,7 +399,7 @@ static void velodyne_scan_to_pointcloud(
 				const float horz_offset = calib.horizontalOffsetCorrection;
 				const float vert_offset = calib.verticalOffsetCorrection;
 
-				float xy_distance = distance * cos_vert_angle; 
+				float xy_distance = distance * cos_vert_angle;
 				if (vert_offset) xy_distance+= vert_offset * sin_vert_angle;
 
 				const int azimuth_corrected_for_lut = (azimuth_corrected + (CObservationVelodyneScan::ROTATION_MAX_UNITS/2))%CObservationVelodyneScan::ROTATION_MAX_UNITS;
@@ -388,42 +430,91 @@ static void velodyne_scan_to_pointcloud(
 					continue;
 
 				// Insert point:
-				out_pc.add_point(pt.x,pt.y,pt.z, raw->blocks[block].laser_returns[k].intensity,pkt_tim, azimuth_corrected_f);
-
+				out.x[out_idx] = pt.x;
+				out.y[out_idx] = pt.y;
+				out.z[out_idx] = pt.z;
+				out.intensity[out_idx] = raw->blocks[block].laser_returns[k].intensity;
+				out.azimuth[out_idx] = azimuth_corrected_f;
+				out_idx++;
 			} // end for k,dsr=[0,31]
 		} // end for each block [0,11]
-	} // end for each data packet
-}
 
+		out.count[iPkt] = static_cast<uint16_t>(out_idx-out_idx0);
+	}
 
-void CObservationVelodyneScan::generatePointCloud(const TGeneratePointCloudParameters &params)
-{
-	struct PointCloudStorageWrapper_Inner : public PointCloudStorageWrapper {
-		CObservationVelodyneScan & me_;
-		const TGeneratePointCloudParameters &params_;
-		PointCloudStorageWrapper_Inner(CObservationVelodyneScan &me, const TGeneratePointCloudParameters &p) : me_(me), params_(p) {
-			// Reset point cloud:
-			me_.point_cloud.clear();
-		}
-		void add_point(double pt_x,double pt_y, double pt_z,uint8_t pt_intensity, const mrpt::system::TTimeStamp &tim, const float azimuth) MRPT_OVERRIDE {
-			me_.point_cloud.x.push_back( pt_x );
-			me_.point_cloud.y.push_back( pt_y );
-			me_.point_cloud.z.push_back( pt_z );
-			me_.point_cloud.intensity.push_back( pt_intensity );
-			if (params_.generatePerPointTimestamp) {
-				me_.point_cloud.timestamp.push_back(tim);
-			}
-			if (params_.generatePerPointAzimuth) {
-				const int azimuth_corrected = ((int)round(azimuth)) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				me_.point_cloud.azimuth.push_back(azimuth_corrected * ROTATION_RESOLUTION);
-			}
+	struct TVelodyneDecodeTask : public mrpt::system::CWorkerThreadsPool::TRangeTask
+	{
+		TVelodyneDecodeTask(const CObservationVelodyneScan & scan_, const CObservationVelodyneScan::TGeneratePointCloudParameters &params_, const TVelodyneDecodeTables &tables_, TVelodyneDecodedPoints &out_) :
+			scan(scan_), params(params_), tables(tables_), out(out_) {}
+		const CObservationVelodyneScan & scan;
+		const CObservationVelodyneScan::TGeneratePointCloudParameters &params;
+		const TVelodyneDecodeTables &tables;
+		TVelodyneDecodedPoints &out;
+		void operator()(size_t first, size_t last) const MRPT_OVERRIDE
+		{
+			for (size_t i=first;i<last;i++)
+				velodyne_decode_packet(scan,params,tables,i,out);
 		}
 	};
+}
 
-	PointCloudStorageWrapper_Inner my_pc_wrap(*this, params);
+/** Decodes all the packets in the scan (in parallel if `params.threads` is set) into sensor-centric points */
+static void velodyne_scan_to_pointcloud(
+	const CObservationVelodyneScan & scan,
+	const CObservationVelodyneScan::TGeneratePointCloudParameters &params,
+	TVelodyneDecodedPoints & out_pc)
+{
+	const size_t nPackets = scan.scan_packets.size();
+	out_pc.resize(nPackets);
+	if (!nPackets)
+		return;
+
+	const TVelodyneDecodeTables tables(scan.calibration.laser_corrections.size());
+	const TVelodyneDecodeTask task(scan,params,tables,out_pc);
+	if (params.threads && params.threads->size()>1)
+		params.threads->parallel_for(nPackets, task, 8 /* min packets per chunk */);
+	else task(0,nPackets);
+
+	size_t nInvalidBlocks = 0;
+	for (size_t i=0;i<nPackets;i++) nInvalidBlocks+=out_pc.invalid_blocks[i];
+	if (nInvalidBlocks)
+		cerr << "[CObservationVelodyneScan] skipping " << nInvalidBlocks << " invalid packet blocks (unexpected header values)\n";
+}
 
-	velodyne_scan_to_pointcloud(*this,params, my_pc_wrap);
 
+void CObservationVelodyneScan::generatePointCloud(const TGeneratePointCloudParameters &params)
+{
+	TVelodyneDecodedPoints pts;
+	velodyne_scan_to_pointcloud(*this,params, pts);
+
+	// Reset point cloud and copy the points of all packets, in order:
+	point_cloud.clear();
+	const size_t N = pts.total_count();
+	point_cloud.x.resize(N);
+	point_cloud.y.resize(N);
+	point_cloud.z.resize(N);
+	point_cloud.intensity.resize(N);
+	if (params.generatePerPointTimestamp) point_cloud.timestamp.resize(N);
+	if (params.generatePerPointAzimuth) point_cloud.azimuth.resize(N);
+
+	for (size_t iPkt=0, j=0;iPkt<pts.count.size();iPkt++)
+	{
+		const size_t i0 = iPkt*SCANS_PER_PACKET, n = pts.count[iPkt];
+		if (!n) continue;
+		std::copy(&pts.x[i0], &pts.x[i0]+n, &point_cloud.x[j]);
+		std::copy(&pts.y[i0], &pts.y[i0]+n, &point_cloud.y[j]);
+		std::copy(&pts.z[i0], &pts.z[i0]+n, &point_cloud.z[j]);
+		std::copy(&pts.intensity[i0], &pts.intensity[i0]+n, &point_cloud.intensity[j]);
+		if (params.generatePerPointTimestamp)
+			std::fill(&point_cloud.timestamp[j], &point_cloud.timestamp[j]+n, pts.timestamp[iPkt]);
+		if (params.generatePerPointAzimuth) {
+			for (size_t i=0;i<n;i++) {
+				const int azimuth_corrected = ((int)round(pts.azimuth[i0+i])) % CObservationVelodyneScan::ROTATION_MAX_UNITS;
+				point_cloud.azimuth[j+i] = azimuth_corrected * ROTATION_RESOLUTION;
+			}
+		}
+		j+=n;
+	}
 }
 
 void CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory(
@@ -432,44 +523,41 @@ void CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory(
 	TGeneratePointCloudSE3Results          & results_stats,
 	const TGeneratePointCloudParameters &params )
 {
+	TVelodyneDecodedPoints pts;
+	velodyne_scan_to_pointcloud(*this,params, pts);
+
 	// Pre-alloc mem:
-	out_points.reserve( out_points.size() + scan_packets.size() * BLOCKS_PER_PACKET * SCANS_PER_BLOCK + 16);
-
-	struct PointCloudStorageWrapper_SE3_Interp : public PointCloudStorageWrapper {
-		CObservationVelodyneScan & me_;
-		const mrpt::poses::CPose3DInterpolator & vehicle_path_;
-		std::vector<mrpt::math::TPointXYZIu8>      & out_points_;
-		TGeneratePointCloudSE3Results &results_stats_;
-		mrpt::system::TTimeStamp last_query_tim_;
-		mrpt::poses::CPose3D last_query_;
-		bool last_query_valid_;
-
-		PointCloudStorageWrapper_SE3_Interp(CObservationVelodyneScan &me,const mrpt::poses::CPose3DInterpolator & vehicle_path,std::vector<mrpt::math::TPointXYZIu8> & out_points,TGeneratePointCloudSE3Results &results_stats) : 
-			me_(me),vehicle_path_(vehicle_path),out_points_(out_points),results_stats_(results_stats),last_query_tim_(INVALID_TIMESTAMP),last_query_valid_(false) 
-		{
-		}
-		void add_point(double pt_x,double pt_y, double pt_z,uint8_t pt_intensity, const mrpt::system::TTimeStamp &tim, const float azimuth) MRPT_OVERRIDE
-		{
-			// Use a cache since it's expected that the same timestamp is queried several times in a row:
-			if (last_query_tim_!=tim) {
-				last_query_tim_ = tim;
-				vehicle_path_.interpolate(tim,last_query_,last_query_valid_);
-			}
+	out_points.reserve( out_points.size() + pts.total_count() );
 
-			if (last_query_valid_) {
-				mrpt::poses::CPose3D  global_sensor_pose(mrpt::poses::UNINITIALIZED_POSE);
-				global_sensor_pose.composeFrom(last_query_, me_.sensorPose);
-				double gx,gy,gz;
-				global_sensor_pose.composePoint(pt_x,pt_y,pt_z, gx,gy,gz);
-				out_points_.push_back( mrpt::math::TPointXYZIu8(gx,gy,gz,pt_intensity) );
-				++results_stats_.num_correctly_inserted_points;
-			}
-			++results_stats_.num_points;
+	// All the points in one packet share the same timestamp, so the vehicle pose is interpolated (and composed with the
+	// sensor pose) once per packet. Use a cache since it's expected that the same timestamp is queried several times in a row:
+	mrpt::system::TTimeStamp last_query_tim = INVALID_TIMESTAMP;
+	mrpt::poses::CPose3D last_query, global_sensor_pose(mrpt::poses::UNINITIALIZED_POSE);
+	bool last_query_valid = false;
+
+	for (size_t iPkt=0;iPkt<pts.count.size();iPkt++)
+	{
+		const size_t i0 = iPkt*SCANS_PER_PACKET, n = pts.count[iPkt];
+		if (!n) continue;
+		results_stats.num_points += n;
+
+		if (last_query_tim!=pts.timestamp[iPkt]) {
+			last_query_tim = pts.timestamp[iPkt];
+			vehicle_path.interpolate(last_query_tim,last_query,last_query_valid);
+			if (last_query_valid)
+				global_sensor_pose.composeFrom(last_query, sensorPose);
 		}
-	};
+		if (!last_query_valid)
+			continue;
 
-	PointCloudStorageWrapper_SE3_Interp my_pc_wrap(*this,vehicle_path,out_points,results_stats);
-	velodyne_scan_to_pointcloud(*this,params, my_pc_wrap);
+		for (size_t i=i0;i<i0+n;i++)
+		{
+			double gx,gy,gz;
+			global_sensor_pose.composePoint(pts.x[i],pts.y[i],pts.z[i], gx,gy,gz);
+			out_points.push_back( mrpt::math::TPointXYZIu8(gx,gy,gz,pts.intensity[i]) );
+		}
+		results_stats.num_correctly_inserted_points += n;
+	}
 }
 
 void CObservationVelodyneScan::TPointCloud::clear()
@@ -0,0 +1,137 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CObservationVelodyneScan.h>
+#include <mrpt/poses/CPose3DInterpolator.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::utils;
+using namespace std;
+
+static const mrpt::system::TTimeStamp TEST_T0 = 131000000000000000ULL;
+
+// A synthetic scan with random ranges, and the azimuth advancing 0.2 deg per block:
+static void makeTestScan(CObservationVelodyneScan &obs, const std::string &model, uint8_t return_mode, size_t nPackets)
+{
+	mrpt::random::CRandomGenerator rnd(4321);
+	obs.timestamp = TEST_T0;
+	obs.calibration = VelodyneCalibration::LoadDefaultCalibration(model);
+	obs.setSensorPose(CPose3D(0.1,0.2,1.5, DEG2RAD(5.0),DEG2RAD(1.0),DEG2RAD(-2.0)));
+	obs.scan_packets.resize(nPackets);
+	for (size_t p=0;p<nPackets;p++)
+	{
+		CObservationVelodyneScan::TVelodyneRawPacket &pkt = obs.scan_packets[p];
+		pkt.gps_timestamp = static_cast<uint32_t>((3599950000UL + p*553) % 3600000000UL); // Wraps around the hour
+		pkt.laser_return_mode = return_mode;
+		for (int b=0;b<CObservationVelodyneScan::BLOCKS_PER_PACKET;b++)
+		{
+			const int az_step = (return_mode==CObservationVelodyneScan::RETMODE_DUAL) ? b/2 : b;
+			pkt.blocks[b].header = CObservationVelodyneScan::UPPER_BANK;
+			pkt.blocks[b].rotation = static_cast<uint16_t>(((p*CObservationVelodyneScan::BLOCKS_PER_PACKET+az_step)*20) % CObservationVelodyneScan::ROTATION_MAX_UNITS);
+			for (int k=0;k<CObservationVelodyneScan::SCANS_PER_BLOCK;k++)
+			{
+				const bool valid = (rnd.drawUniform32bit()%10)!=0;
+				pkt.blocks[b].laser_returns[k].distance = valid ? static_cast<uint16_t>(200 + rnd.drawUniform32bit()%20000) : 0;
+				pkt.blocks[b].laser_returns[k].intensity = static_cast<uint8_t>(rnd.drawUniform32bit());
+			}
+		}
+	}
+}
+
+static void checkParallelMatchesSequential(const std::string &model, uint8_t return_mode)
+{
+	CObservationVelodyneScan obs;
+	makeTestScan(obs, model, return_mode, 150);
+
+	CObservationVelodyneScan::TGeneratePointCloudParameters params;
+	params.generatePerPointTimestamp = true;
+	params.generatePerPointAzimuth = true;
+	params.filterOutIsolatedPoints = true;
+	params.isolatedPointsFilterDistance = 30.0f;
+
+	obs.generatePointCloud(params);
+	const CObservationVelodyneScan::TPointCloud seq = obs.point_cloud;
+	ASSERT_GT(seq.x.size(), 1000u);
+
+	mrpt::system::CWorkerThreadsPool pool(3);
+	params.threads = &pool;
+	obs.generatePointCloud(params);
+	const CObservationVelodyneScan::TPointCloud &par = obs.point_cloud;
+
+	EXPECT_TRUE(par.x==seq.x);
+	EXPECT_TRUE(par.y==seq.y);
+	EXPECT_TRUE(par.z==seq.z);
+	EXPECT_TRUE(par.intensity==seq.intensity);
+	EXPECT_TRUE(par.timestamp==seq.timestamp);
+	EXPECT_TRUE(par.azimuth==seq.azimuth);
+}
+
+TEST(CObservationVelodyneScan, parallelDecodeHDL32)
+{
+	checkParallelMatchesSequential("HDL32", CObservationVelodyneScan::RETMODE_STRONGEST);
+}
+
+TEST(CObservationVelodyneScan, parallelDecodeVLP16Dual)
+{
+	checkParallelMatchesSequential("VLP16", CObservationVelodyneScan::RETMODE_DUAL);
+}
+
+TEST(CObservationVelodyneScan, generatePointCloudAlongSE3Trajectory)
+{
+	CObservationVelodyneScan obs;
+	makeTestScan(obs, "HDL32", CObservationVelodyneScan::RETMODE_STRONGEST, 100);
+
+	CObservationVelodyneScan::TGeneratePointCloudParameters params;
+	params.generatePerPointTimestamp = true;
+	obs.generatePointCloud(params);
+	const size_t N = obs.point_cloud.x.size();
+	ASSERT_GT(N, 1000u);
+
+	// A path which only covers the first part of the scan:
+	CPose3DInterpolator path;
+	path.setInterpolationMethod(mrpt::poses::imLinear2Neig);
+	path.insert(TEST_T0 - 10000, CPose3D(0,0,0, 0,0,0));
+	path.insert(TEST_T0 + 200000, CPose3D(1.0,0.5,0, DEG2RAD(10.0),0,0));
+	path.setMaxTimeInterpolation(1.0);
+
+	mrpt::system::CWorkerThreadsPool pool(2);
+	params.threads = &pool;
+	std::vector<mrpt::math::TPointXYZIu8> pts(1); // Points must be appended
+	CObservationVelodyneScan::TGeneratePointCloudSE3Results stats;
+	obs.generatePointCloudAlongSE3Trajectory(path, pts, stats, params);
+
+	EXPECT_EQ(stats.num_points, N);
+	EXPECT_GT(stats.num_correctly_inserted_points, 0u);
+	EXPECT_LT(stats.num_correctly_inserted_points, N);
+	ASSERT_EQ(pts.size(), 1+stats.num_correctly_inserted_points);
+
+	// Compare against the per-point composition of the interpolated pose:
+	size_t j=1;
+	for (size_t i=0;i<N;i++)
+	{
+		CPose3D veh;
+		bool valid;
+		path.interpolate(obs.point_cloud.timestamp[i], veh, valid);
+		if (!valid) continue;
+		double gx,gy,gz;
+		(veh+obs.sensorPose).composePoint(obs.point_cloud.x[i],obs.point_cloud.y[i],obs.point_cloud.z[i], gx,gy,gz);
+		ASSERT_LT(j, pts.size());
+		EXPECT_NEAR(pts[j].pt.x, gx, 1e-4);
+		EXPECT_NEAR(pts[j].pt.y, gy, 1e-4);
+		EXPECT_NEAR(pts[j].pt.z, gz, 1e-4);
+		EXPECT_EQ(pts[j].intensity, obs.point_cloud.intensity[i]);
+		j++;
+	}
+	EXPECT_EQ(j, pts.size());
+}
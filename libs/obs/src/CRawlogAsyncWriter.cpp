@@ -0,0 +1,177 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "obs-precomp.h"   // Precompiled headers
+#include <mrpt/obs/CRawlogAsyncWriter.h>
+#include <mrpt/utils/CFileGZOutputStream.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <deque>
+#include <iostream>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::utils;
+using namespace std;
+
+namespace mrpt { namespace obs { namespace detail {
+	struct TRawlogAsyncWriterImpl
+	{
+		TRawlogAsyncWriterImpl(size_t queueLength) : max_len(std::max<size_t>(1,queueLength)), busy(false), shutdown(false) {}
+
+		CFileGZOutputStream f;
+		std::thread thread;
+		std::mutex mtx;
+		std::condition_variable cv_not_full, cv_not_empty, cv_idle;
+		std::deque<CSerializablePtr> queue;
+		const size_t max_len;
+		bool busy;     //!< The writing thread is writing an object already removed from the queue
+		bool shutdown;
+		std::exception_ptr error; //!< An error in the writing thread, to be re-thrown in the producer thread
+
+		void run()
+		{
+			for (;;)
+			{
+				CSerializablePtr obj;
+				{
+					std::unique_lock<std::mutex> lck(mtx);
+					cv_not_empty.wait(lck, [this]{ return shutdown || !queue.empty(); });
+					if (queue.empty()) return; // shutdown, and all pending objects written
+					obj = queue.front();
+					queue.pop_front();
+					busy = true;
+				}
+				cv_not_full.notify_one();
+				try
+				{
+					f << *obj;
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lck(mtx);
+					if (!error) error = std::current_exception();
+				}
+				{
+					std::lock_guard<std::mutex> lck(mtx);
+					busy = false;
+				}
+				cv_idle.notify_all();
+			}
+		}
+
+		/** Re-throws (once) the first error of the writing thread. Must be called with mtx locked */
+		void rethrowError()
+		{
+			if (!error) return;
+			std::exception_ptr e = error;
+			error = std::exception_ptr();
+			std::rethrow_exception(e);
+		}
+	};
+} } }
+
+CRawlogAsyncWriter::CRawlogAsyncWriter() : m_impl(NULL)
+{
+}
+
+CRawlogAsyncWriter::CRawlogAsyncWriter(const std::string &rawlogFile, int compress_level, size_t queueLength, unsigned int compress_threads) : m_impl(NULL)
+{
+	MRPT_START
+	if (!open(rawlogFile,compress_level,queueLength,compress_threads))
+		THROW_EXCEPTION_FMT("Error creating rawlog file: '%s'",rawlogFile.c_str())
+	MRPT_END
+}
+
+CRawlogAsyncWriter::~CRawlogAsyncWriter()
+{
+	try
+	{
+		close();
+	}
+	catch (std::exception &e)
+	{
+		std::cerr << "[CRawlogAsyncWriter] Error writing rawlog file:\n" << e.what() << std::endl;
+	}
+}
+
+bool CRawlogAsyncWriter::open(const std::string &rawlogFile, int compress_level, size_t queueLength, unsigned int compress_threads)
+{
+	close();
+	m_impl = new detail::TRawlogAsyncWriterImpl(queueLength);
+	if (!m_impl->f.open(rawlogFile,compress_level,compress_threads))
+	{
+		delete m_impl;
+		m_impl = NULL;
+		return false;
+	}
+	m_impl->thread = std::thread(&detail::TRawlogAsyncWriterImpl::run, m_impl);
+	return true;
+}
+
+void CRawlogAsyncWriter::close()
+{
+	if (!m_impl) return;
+	{
+		std::lock_guard<std::mutex> lck(m_impl->mtx);
+		m_impl->shutdown = true;
+	}
+	m_impl->cv_not_empty.notify_all();
+	m_impl->thread.join();
+	m_impl->f.close();
+
+	std::exception_ptr e = m_impl->error;
+	delete m_impl;
+	m_impl = NULL;
+	if (e) std::rethrow_exception(e);
+}
+
+bool CRawlogAsyncWriter::isOpen() const
+{
+	return m_impl!=NULL;
+}
+
+size_t CRawlogAsyncWriter::getQueueLength() const
+{
+	if (!m_impl) return 0;
+	std::lock_guard<std::mutex> lck(m_impl->mtx);
+	return m_impl->queue.size();
+}
+
+void CRawlogAsyncWriter::write(const CSerializablePtr &obj)
+{
+	MRPT_START
+	ASSERTMSG_(m_impl!=NULL, "The rawlog file is not open")
+	ASSERT_(obj.present())
+	{
+		std::unique_lock<std::mutex> lck(m_impl->mtx);
+		m_impl->rethrowError();
+		m_impl->cv_not_full.wait(lck, [this]{ return m_impl->queue.size()<m_impl->max_len; });
+		m_impl->queue.push_back(obj);
+	}
+	m_impl->cv_not_empty.notify_one();
+	MRPT_END
+}
+
+void CRawlogAsyncWriter::write(const CSerializable &obj)
+{
+	write(CSerializablePtr(static_cast<CSerializable*>(obj.duplicate())));
+}
+
+void CRawlogAsyncWriter::flush()
+{
+	MRPT_START
+	ASSERTMSG_(m_impl!=NULL, "The rawlog file is not open")
+	std::unique_lock<std::mutex> lck(m_impl->mtx);
+	m_impl->cv_idle.wait(lck, [this]{ return m_impl->queue.empty() && !m_impl->busy; });
+	m_impl->rethrowError();
+	MRPT_END
+}
@@ -0,0 +1,373 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "obs-precomp.h"   // Precompiled headers
+#include <mrpt/obs/CRawlogIndexed.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/utils/CFileInputStream.h>
+#include <mrpt/utils/CFileOutputStream.h>
+#include <mrpt/utils/CFileGZInputStream.h>
+#include <mrpt/utils/CMemoryStream.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::utils;
+using namespace mrpt::system;
+using namespace std;
+
+const size_t CRawlogIndexed::npos = static_cast<size_t>(-1);
+
+namespace
+{
+	const char     INDEX_MAGIC[] = "MRPT_RAWLOG_INDEX";
+	const uint32_t INDEX_VERSION = 0;
+
+	/** Fills the type, class name, timestamp and label of an index entry from the deserialized object */
+	void fillEntryInfo(const CSerializablePtr &obj, CRawlogIndexed::TEntry &e)
+	{
+		e.className = obj->GetRuntimeClass()->className;
+		e.timestamp = INVALID_TIMESTAMP;
+		e.sensorLabel.clear();
+		if (IS_DERIVED(obj,CObservation))
+		{
+			const CObservationPtr o = CObservationPtr(obj);
+			e.type = CRawlog::etObservation;
+			e.timestamp = o->timestamp;
+			e.sensorLabel = o->sensorLabel;
+		}
+		else if (IS_CLASS(obj,CSensoryFrame))
+		{
+			const CSensoryFramePtr sf = CSensoryFramePtr(obj);
+			e.type = CRawlog::etSensoryFrame;
+			if (sf->size()) e.timestamp = sf->getObservationByIndex(0)->timestamp;
+		}
+		else if (IS_CLASS(obj,CActionCollection))
+		{
+			CActionCollectionPtr acts = CActionCollectionPtr(obj);
+			e.type = CRawlog::etActionCollection;
+			if (acts->size()) e.timestamp = acts->get(0)->timestamp;
+		}
+		else e.type = CRawlog::etOther;
+	}
+
+	/** Returns true if the file starts with the gzip magic number */
+	bool isGZipFile(const std::string &fileName)
+	{
+		CFileInputStream f;
+		if (!f.open(fileName)) return false;
+		uint8_t magic[2];
+		return f.ReadBuffer(magic,2)==2 && magic[0]==0x1f && magic[1]==0x8b;
+	}
+
+	bool writeIndex(const CRawlogIndexed::TEntryList &entries, const std::string &rawlogFile, const std::string &indexFile)
+	{
+		CFileOutputStream f;
+		if (!f.open(indexFile)) return false;
+		f << std::string(INDEX_MAGIC) << INDEX_VERSION
+		  << static_cast<uint64_t>(getFileSize(rawlogFile))
+		  << static_cast<int64_t>(getFileModificationTime(rawlogFile))
+		  << static_cast<uint64_t>(entries.size());
+		for (size_t i=0;i<entries.size();i++)
+		{
+			const CRawlogIndexed::TEntry &e = entries[i];
+			f << e.offset << e.length << e.timestamp << static_cast<uint8_t>(e.type) << e.className << e.sensorLabel;
+		}
+		return true;
+	}
+}
+
+CRawlogIndexed::TEntry::TEntry() :
+	offset(0), length(0), timestamp(INVALID_TIMESTAMP), type(CRawlog::etOther)
+{
+}
+
+CRawlogIndexed::CRawlogIndexed() :
+	m_file(NULL),
+	m_zero_copy(false)
+{
+}
+
+CRawlogIndexed::~CRawlogIndexed()
+{
+	close();
+}
+
+/*---------------------------------------------------------------
+					open
+  ---------------------------------------------------------------*/
+bool CRawlogIndexed::open(const std::string &rawlogFile, bool buildIndexIfMissing)
+{
+	close();
+	if (isGZipFile(rawlogFile))
+	{
+		std::cerr << "[CRawlogIndexed::open] '" << rawlogFile << "' is gz-compressed: it must be converted first with CRawlogIndexed::convertToIndexed()\n";
+		return false;
+	}
+
+	const std::string indexFile = getIndexFileName(rawlogFile);
+	if (!loadIndex(rawlogFile,indexFile))
+	{
+		if (!buildIndexIfMissing || !buildIndex(rawlogFile,indexFile) || !loadIndex(rawlogFile,indexFile))
+			return false;
+	}
+
+	CMemoryMappedFile *mapped = new CMemoryMappedFile();
+	m_file_owner = TMemoryBlockOwnerPtr(mapped);
+	if (!mapped->open(rawlogFile))
+	{
+		close();
+		return false;
+	}
+	// Sanity check of the index against the mapped file:
+	if (!m_entries.empty() && m_entries.back().offset+m_entries.back().length>mapped->size())
+	{
+		close();
+		return false;
+	}
+	m_file = mapped;
+	m_fileName = rawlogFile;
+	updateTimeIndex();
+	return true;
+}
+
+void CRawlogIndexed::close()
+{
+	// Objects deserialized in zero-copy mode may still hold a reference to the mapped file:
+	m_file_owner.clear();
+	m_file = NULL;
+	m_fileName.clear();
+	m_entries.clear();
+	m_by_time.clear();
+	m_by_label_time.clear();
+}
+
+/*---------------------------------------------------------------
+					loadIndex
+  ---------------------------------------------------------------*/
+bool CRawlogIndexed::loadIndex(const std::string &rawlogFile, const std::string &indexFile)
+{
+	m_entries.clear();
+	if (!fileExists(indexFile)) return false;
+
+	try
+	{
+		CFileInputStream f(indexFile);
+		std::string magic;
+		uint32_t version;
+		uint64_t fileSize, N;
+		int64_t  fileTime;
+		f >> magic >> version >> fileSize >> fileTime >> N;
+		// Discard outdated indices:
+		if (magic!=INDEX_MAGIC || version!=INDEX_VERSION ||
+			fileSize!=getFileSize(rawlogFile) || fileTime!=static_cast<int64_t>(getFileModificationTime(rawlogFile)))
+			return false;
+
+		m_entries.resize(N);
+		for (size_t i=0;i<N;i++)
+		{
+			TEntry &e = m_entries[i];
+			uint8_t type;
+			f >> e.offset >> e.length >> e.timestamp >> type >> e.className >> e.sensorLabel;
+			e.type = static_cast<CRawlog::TEntryType>(type);
+		}
+	}
+	catch (std::exception &)
+	{
+		m_entries.clear();
+		return false;
+	}
+	return true;
+}
+
+void CRawlogIndexed::updateTimeIndex()
+{
+	m_by_time.clear();
+	m_by_time.reserve(m_entries.size());
+	bool sorted = true;
+	for (size_t i=0;i<m_entries.size();i++)
+	{
+		if (m_entries[i].timestamp==INVALID_TIMESTAMP) continue;
+		if (!m_by_time.empty() && m_entries[i].timestamp<m_entries[m_by_time.back()].timestamp)
+			sorted = false;
+		m_by_time.push_back(i);
+	}
+	if (!sorted)
+	{
+		const TEntryList &entries = m_entries;
+		std::stable_sort(m_by_time.begin(),m_by_time.end(),
+			[&entries](size_t a, size_t b) { return entries[a].timestamp<entries[b].timestamp; });
+	}
+
+	m_by_label_time.clear();
+	for (size_t i=0;i<m_by_time.size();i++)
+	{
+		const std::string &label = m_entries[m_by_time[i]].sensorLabel;
+		if (!label.empty())
+			m_by_label_time[label].push_back(m_by_time[i]);
+	}
+}
+
+const CRawlogIndexed::TEntry & CRawlogIndexed::getEntryInfo(size_t index) const
+{
+	if (index>=m_entries.size())
+		THROW_EXCEPTION("Index out of bounds")
+	return m_entries[index];
+}
+
+/*---------------------------------------------------------------
+					getAs*
+  ---------------------------------------------------------------*/
+CSerializablePtr CRawlogIndexed::getAsGeneric(size_t index) const
+{
+	MRPT_START
+	const TEntry &e = getEntryInfo(index);
+	CMemoryStream buf;
+	if (m_zero_copy)
+		buf.assignMemorySharedOwner(m_file->data()+e.offset, e.length, m_file_owner);
+	else
+		buf.assignMemoryNotOwn(m_file->data()+e.offset, e.length);
+	return buf.ReadObject();
+	MRPT_END
+}
+
+CObservationPtr CRawlogIndexed::getAsObservation(size_t index) const
+{
+	MRPT_START
+	if (getType(index)!=CRawlog::etObservation)
+		THROW_EXCEPTION_FMT("Entry #%u is not an observation",static_cast<unsigned>(index))
+	return CObservationPtr(getAsGeneric(index));
+	MRPT_END
+}
+
+CSensoryFramePtr CRawlogIndexed::getAsObservations(size_t index) const
+{
+	MRPT_START
+	if (getType(index)!=CRawlog::etSensoryFrame)
+		THROW_EXCEPTION_FMT("Entry #%u is not a CSensoryFrame",static_cast<unsigned>(index))
+	return CSensoryFramePtr(getAsGeneric(index));
+	MRPT_END
+}
+
+CActionCollectionPtr CRawlogIndexed::getAsAction(size_t index) const
+{
+	MRPT_START
+	if (getType(index)!=CRawlog::etActionCollection)
+		THROW_EXCEPTION_FMT("Entry #%u is not a CActionCollection",static_cast<unsigned>(index))
+	return CActionCollectionPtr(getAsGeneric(index));
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+					findEntryByTime
+  ---------------------------------------------------------------*/
+size_t CRawlogIndexed::findEntryByTime(const TTimeStamp t, const std::string &sensorLabel) const
+{
+	const std::vector<size_t> *by_time = &m_by_time;
+	if (!sensorLabel.empty())
+	{
+		std::map<std::string,std::vector<size_t> >::const_iterator itLabel = m_by_label_time.find(sensorLabel);
+		if (itLabel==m_by_label_time.end()) return npos;
+		by_time = &itLabel->second;
+	}
+	if (by_time->empty()) return npos;
+
+	const TEntryList &entries = m_entries;
+	const std::vector<size_t>::const_iterator it = std::lower_bound(by_time->begin(),by_time->end(),t,
+		[&entries](size_t a, TTimeStamp tt) { return entries[a].timestamp<tt; });
+
+	// Closest candidates before and after "t":
+	if (it==by_time->begin()) return *it;
+	const size_t before = *(it-1);
+	if (it==by_time->end()) return before;
+	const size_t after = *it;
+	return (t-m_entries[before].timestamp <= m_entries[after].timestamp-t) ? before : after;
+}
+
+/*---------------------------------------------------------------
+					buildIndex
+  ---------------------------------------------------------------*/
+bool CRawlogIndexed::buildIndex(const std::string &rawlogFile, const std::string &indexFile)
+{
+	if (isGZipFile(rawlogFile)) return false;
+
+	CFileInputStream f;
+	if (!f.open(rawlogFile)) return false;
+
+	TEntryList entries;
+	for (;;)
+	{
+		TEntry e;
+		e.offset = f.getPosition();
+		CSerializablePtr obj;
+		try
+		{
+			obj = f.ReadObject();
+		}
+		catch (CExceptionEOF &)
+		{
+			break;
+		}
+		catch (std::exception &ex)
+		{
+			// Truncated or corrupted file: index all the valid entries until here, as CRawlog::loadFromRawLogFile() does.
+			std::cerr << "[CRawlogIndexed::buildIndex] Stopping at entry #" << entries.size() << ": " << ex.what() << std::endl;
+			break;
+		}
+		e.length = f.getPosition()-e.offset;
+		fillEntryInfo(obj,e);
+		entries.push_back(e);
+	}
+	f.close();
+	return writeIndex(entries,rawlogFile,indexFile);
+}
+
+/*---------------------------------------------------------------
+					convertToIndexed
+  ---------------------------------------------------------------*/
+bool CRawlogIndexed::convertToIndexed(const std::string &srcRawlogFile, const std::string &dstRawlogFile)
+{
+	CFileGZInputStream in;
+	if (!in.open(srcRawlogFile, 0 /* Parallel decompression, if possible */)) return false;
+	CFileOutputStream out;
+	if (!out.open(dstRawlogFile)) return false;
+
+	TEntryList entries;
+	for (;;)
+	{
+		CSerializablePtr obj;
+		try
+		{
+			obj = in.ReadObject();
+		}
+		catch (CExceptionEOF &)
+		{
+			break;
+		}
+		catch (std::exception &ex)
+		{
+			std::cerr << "[CRawlogIndexed::convertToIndexed] Stopping at entry #" << entries.size() << ": " << ex.what() << std::endl;
+			break;
+		}
+		TEntry e;
+		e.offset = out.getPosition();
+		out << *obj;
+		e.length = out.getPosition()-e.offset;
+		fillEntryInfo(obj,e);
+		entries.push_back(e);
+	}
+	out.close();
+	return writeIndex(entries,dstRawlogFile,getIndexFileName(dstRawlogFile));
+}
+
+std::string CRawlogIndexed::getIndexFileName(const std::string &rawlogFile)
+{
+	return rawlogFile + std::string(".idx");
+}
@@ -0,0 +1,173 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CRawlogIndexed.h>
+#include <mrpt/obs/CObservationOdometry.h>
+#include <mrpt/obs/CObservationVelodyneScan.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::system;
+using namespace std;
+
+static const TTimeStamp TEST_T0 = 131000000000000000ULL;
+static const TTimeStamp TEST_DT = 1000000; // 0.1 s
+
+// A rawlog with N odometry observations, alternating two sensor labels, plus a sensory frame at the end.
+static void makeTestRawlog(CRawlog &rawlog, size_t N)
+{
+	for (size_t i=0;i<N;i++)
+	{
+		CObservationOdometryPtr obs = CObservationOdometry::Create();
+		obs->timestamp = TEST_T0 + i*TEST_DT;
+		obs->sensorLabel = (i%2)==0 ? "ODOM_EVEN" : "ODOM_ODD";
+		obs->odometry = CPose2D(i*0.1, 0.5, 0.01*i);
+		rawlog.addObservationMemoryReference(obs);
+	}
+	CSensoryFramePtr sf = CSensoryFrame::Create();
+	CObservationOdometryPtr obs = CObservationOdometry::Create();
+	obs->timestamp = TEST_T0 + N*TEST_DT;
+	sf->insert(obs);
+	rawlog.addObservationsMemoryReference(sf);
+}
+
+TEST(CRawlogIndexed, convertAndRandomAccess)
+{
+	const size_t N = 50;
+	CRawlog rawlog;
+	makeTestRawlog(rawlog,N);
+
+	const string fil_gz = getTempFileName(), fil_idx = getTempFileName();
+	ASSERT_TRUE(rawlog.saveToRawLogFile(fil_gz));
+
+	// gz-compressed rawlogs can't be opened directly:
+	{
+		CRawlogIndexed r;
+		EXPECT_FALSE(r.open(fil_gz));
+	}
+
+	ASSERT_TRUE(CRawlogIndexed::convertToIndexed(fil_gz,fil_idx));
+	CRawlogIndexed r;
+	ASSERT_TRUE(r.open(fil_idx,false /* The index must already exist */));
+	ASSERT_EQ(r.size(), rawlog.size());
+
+	for (size_t i=0;i<N;i++)
+	{
+		EXPECT_EQ(r.getType(i), CRawlog::etObservation);
+		EXPECT_EQ(r.getEntryInfo(i).timestamp, TEST_T0 + i*TEST_DT);
+		EXPECT_EQ(r.getEntryInfo(i).sensorLabel, rawlog.getAsObservation(i)->sensorLabel);
+		EXPECT_EQ(r.getEntryInfo(i).className, string("CObservationOdometry"));
+	}
+	EXPECT_EQ(r.getType(N), CRawlog::etSensoryFrame);
+	EXPECT_EQ(r.getEntryInfo(N).timestamp, TEST_T0 + N*TEST_DT);
+
+	// Random-order, lazy access:
+	for (size_t k=0;k<N;k++)
+	{
+		const size_t i = (k*7)%N;
+		const CObservationOdometryPtr o1 = CObservationOdometryPtr(rawlog.getAsObservation(i));
+		const CObservationOdometryPtr o2 = CObservationOdometryPtr(r.getAsObservation(i));
+		EXPECT_EQ(o1->timestamp, o2->timestamp);
+		EXPECT_NEAR((o1->odometry - o2->odometry).norm(), 0.0, 1e-9);
+	}
+	EXPECT_EQ(r.getAsObservations(N)->size(), 1u);
+	EXPECT_ANY_THROW(r.getAsAction(0));
+	EXPECT_ANY_THROW(r.getAsGeneric(N+1));
+
+	// Seek by time:
+	EXPECT_EQ(r.findEntryByTime(TEST_T0 + 10*TEST_DT), 10u);
+	EXPECT_EQ(r.findEntryByTime(TEST_T0 + 10*TEST_DT + TEST_DT/4), 10u);
+	EXPECT_EQ(r.findEntryByTime(TEST_T0 + 10*TEST_DT + 3*TEST_DT/4), 11u);
+	EXPECT_EQ(r.findEntryByTime(TEST_T0 + 11*TEST_DT, "ODOM_EVEN") % 2, 0u);
+	EXPECT_EQ(r.findEntryByTime(TEST_T0 + 11*TEST_DT + TEST_DT/4, "ODOM_EVEN"), 12u);
+	EXPECT_EQ(r.findEntryByTime(TEST_T0 + 10*TEST_DT, "ODOM_ODD"), 9u);
+	EXPECT_EQ(r.findEntryByTime(0, "ODOM_ODD"), 1u);
+	EXPECT_EQ(r.findEntryByTime(TEST_T0 + 1000*TEST_DT, "ODOM_ODD"), N-1);
+	EXPECT_EQ(r.findEntryByTime(0), 0u);
+	EXPECT_EQ(r.findEntryByTime(TEST_T0 + 1000*TEST_DT), N);
+	EXPECT_EQ(r.findEntryByTime(TEST_T0, "NO_SUCH_SENSOR"), CRawlogIndexed::npos);
+
+	r.close();
+	deleteFile(fil_gz);
+	deleteFile(fil_idx);
+	deleteFile(CRawlogIndexed::getIndexFileName(fil_idx));
+}
+
+TEST(CRawlogIndexed, buildIndexOnOpen)
+{
+	const size_t N = 20;
+	CRawlog rawlog;
+	makeTestRawlog(rawlog,N);
+
+	const string fil_gz = getTempFileName(), fil_idx = getTempFileName();
+	ASSERT_TRUE(rawlog.saveToRawLogFile(fil_gz));
+	ASSERT_TRUE(CRawlogIndexed::convertToIndexed(fil_gz,fil_idx));
+	deleteFile(CRawlogIndexed::getIndexFileName(fil_idx));
+
+	CRawlogIndexed r;
+	EXPECT_FALSE(r.open(fil_idx,false));
+	ASSERT_TRUE(r.open(fil_idx));  // Rebuilds the index
+	ASSERT_EQ(r.size(), N+1);
+	EXPECT_TRUE(fileExists(CRawlogIndexed::getIndexFileName(fil_idx)));
+	for (size_t i=0;i<N;i++)
+		EXPECT_EQ(r.getAsObservation(i)->timestamp, TEST_T0 + i*TEST_DT);
+
+	r.close();
+	deleteFile(fil_gz);
+	deleteFile(fil_idx);
+	deleteFile(CRawlogIndexed::getIndexFileName(fil_idx));
+}
+
+TEST(CRawlogIndexed, zeroCopyOutlivesClose)
+{
+	const size_t N = 5, NPKTS = 40;
+	CRawlog rawlog;
+	for (size_t i=0;i<N;i++)
+	{
+		CObservationVelodyneScanPtr obs = CObservationVelodyneScan::Create();
+		obs->timestamp = TEST_T0 + i*TEST_DT;
+		obs->scan_packets.resize(NPKTS);
+		uint8_t *raw = reinterpret_cast<uint8_t*>(&obs->scan_packets[0]);
+		for (size_t k=0;k<NPKTS*sizeof(obs->scan_packets[0]);k++)
+			raw[k] = static_cast<uint8_t>(k*13+i);
+		rawlog.addObservationMemoryReference(obs);
+	}
+	const string fil_gz = getTempFileName(), fil_idx = getTempFileName();
+	ASSERT_TRUE(rawlog.saveToRawLogFile(fil_gz));
+	ASSERT_TRUE(CRawlogIndexed::convertToIndexed(fil_gz,fil_idx));
+
+	std::vector<CObservationVelodyneScanPtr> loaded;
+	{
+		CRawlogIndexed r;
+		r.enableZeroCopy(true);
+		ASSERT_TRUE(r.open(fil_idx));
+		EXPECT_TRUE(r.isZeroCopyEnabled());
+		for (size_t i=0;i<N;i++)
+			loaded.push_back(CObservationVelodyneScanPtr(r.getAsObservation(i)));
+		r.close();
+		EXPECT_FALSE(r.isOpen());
+		EXPECT_TRUE(r.getFileName().empty());
+	}
+	// Objects deserialized with zero-copy remain valid after the reader has been closed and destroyed:
+	for (size_t i=0;i<N;i++)
+	{
+		const CObservationVelodyneScanPtr o1 = CObservationVelodyneScanPtr(rawlog.getAsObservation(i));
+		ASSERT_EQ(loaded[i]->scan_packets.size(), NPKTS);
+		EXPECT_EQ(loaded[i]->timestamp, o1->timestamp);
+		EXPECT_TRUE(0==memcmp(&loaded[i]->scan_packets[0], &o1->scan_packets[0], NPKTS*sizeof(o1->scan_packets[0])));
+	}
+	loaded.clear();
+
+	deleteFile(fil_gz);
+	deleteFile(fil_idx);
+	deleteFile(CRawlogIndexed::getIndexFileName(fil_idx));
+}
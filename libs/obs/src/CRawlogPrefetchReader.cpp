@@ -0,0 +1,252 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "obs-precomp.h"   // Precompiled headers
+#include <mrpt/obs/CRawlogPrefetchReader.h>
+#include <mrpt/utils/CFileGZInputStream.h>
+#include <mrpt/system/filesystem.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <deque>
+#include <iostream>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::utils;
+using namespace std;
+
+namespace mrpt { namespace obs { namespace detail {
+	struct TRawlogPrefetchReaderImpl
+	{
+		TRawlogPrefetchReaderImpl(size_t queueLength) : max_len(std::max<size_t>(1,queueLength)), eof(false), shutdown(false) {}
+
+		CFileGZInputStream f;
+		std::thread thread;
+		std::mutex mtx;
+		std::condition_variable cv_not_full, cv_not_empty;
+		std::deque<CSerializablePtr> queue;
+		const size_t max_len;
+		bool eof, shutdown;
+		std::exception_ptr error; //!< An error in the reading thread, to be re-thrown in the consumer thread
+
+		void run()
+		{
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lck(mtx);
+					cv_not_full.wait(lck, [this]{ return shutdown || queue.size()<max_len; });
+					if (shutdown) return;
+				}
+				CSerializablePtr obj;
+				try
+				{
+					f >> obj;
+				}
+				catch (CExceptionEOF &)
+				{
+					std::lock_guard<std::mutex> lck(mtx);
+					eof = true;
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lck(mtx);
+					error = std::current_exception();
+					eof = true;
+				}
+				{
+					std::lock_guard<std::mutex> lck(mtx);
+					if (!eof) queue.push_back(obj);
+				}
+				cv_not_empty.notify_one();
+				if (eof) return;
+			}
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard<std::mutex> lck(mtx);
+				shutdown = true;
+			}
+			cv_not_full.notify_all();
+			if (thread.joinable()) thread.join();
+		}
+	};
+} } }
+
+CRawlogPrefetchReader::CRawlogPrefetchReader() : m_impl(NULL)
+{
+}
+
+CRawlogPrefetchReader::CRawlogPrefetchReader(const std::string &rawlogFile, size_t queueLength) : m_impl(NULL)
+{
+	MRPT_START
+	if (!open(rawlogFile,queueLength))
+		THROW_EXCEPTION_FMT("Error opening rawlog file: '%s'",rawlogFile.c_str())
+	MRPT_END
+}
+
+CRawlogPrefetchReader::~CRawlogPrefetchReader()
+{
+	close();
+}
+
+bool CRawlogPrefetchReader::open(const std::string &rawlogFile, size_t queueLength)
+{
+	close();
+	if (!mrpt::system::fileExists(rawlogFile))
+		return false;
+	m_impl = new detail::TRawlogPrefetchReaderImpl(queueLength);
+	if (!m_impl->f.open(rawlogFile))
+	{
+		close();
+		return false;
+	}
+	m_impl->thread = std::thread(&detail::TRawlogPrefetchReaderImpl::run, m_impl);
+	return true;
+}
+
+void CRawlogPrefetchReader::close()
+{
+	if (!m_impl) return;
+	m_impl->stop();
+	delete m_impl;
+	m_impl = NULL;
+}
+
+bool CRawlogPrefetchReader::isOpen() const
+{
+	return m_impl!=NULL;
+}
+
+size_t CRawlogPrefetchReader::getQueueLength() const
+{
+	if (!m_impl) return 0;
+	std::lock_guard<std::mutex> lck(m_impl->mtx);
+	return m_impl->queue.size();
+}
+
+/*---------------------------------------------------------------
+					getNextObject
+  ---------------------------------------------------------------*/
+bool CRawlogPrefetchReader::getNextObject(CSerializablePtr &obj)
+{
+	MRPT_START
+	ASSERTMSG_(m_impl!=NULL, "The rawlog file is not open")
+
+	std::unique_lock<std::mutex> lck(m_impl->mtx);
+	m_impl->cv_not_empty.wait(lck, [this]{ return m_impl->eof || !m_impl->queue.empty(); });
+	if (m_impl->queue.empty())
+	{
+		// End of file or error:
+		obj.clear();
+		if (m_impl->error)
+		{
+			std::exception_ptr e = m_impl->error;
+			m_impl->error = std::exception_ptr();
+			std::rethrow_exception(e);
+		}
+		return false;
+	}
+	obj = m_impl->queue.front();
+	m_impl->queue.pop_front();
+	lck.unlock();
+	m_impl->cv_not_full.notify_one();
+	return true;
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+			getActionObservationPairOrObservation
+  ---------------------------------------------------------------*/
+bool CRawlogPrefetchReader::getActionObservationPairOrObservation(
+	CActionCollectionPtr &action,
+	CSensoryFramePtr     &observations,
+	CObservationPtr      &observation,
+	size_t               &rawlogEntry )
+{
+	try
+	{
+		observations.clear_unique();
+		observation.clear_unique();
+		action.clear_unique();
+		while (!action)
+		{
+			CSerializablePtr obj;
+			if (!getNextObject(obj)) return false;
+			if (IS_CLASS(obj,CActionCollection))
+			{
+				action = CActionCollectionPtr(obj);
+			}
+			else if (IS_DERIVED(obj,CObservation))
+			{
+				observation = CObservationPtr(obj);
+				rawlogEntry++;
+				return true;
+			}
+			rawlogEntry++;
+		}
+
+		while (!observations)
+		{
+			CSerializablePtr obj;
+			if (!getNextObject(obj)) return false;
+			if (IS_CLASS(obj,CSensoryFrame))
+				observations = CSensoryFramePtr(obj);
+			rawlogEntry++;
+		}
+		return true;
+	}
+	catch (std::exception &e)
+	{
+		std::cerr << "[CRawlogPrefetchReader::getActionObservationPairOrObservation] Found exception:" << std::endl << e.what() << std::endl;
+		return false;
+	}
+}
+
+/*---------------------------------------------------------------
+					readActionObservationPair
+  ---------------------------------------------------------------*/
+bool CRawlogPrefetchReader::readActionObservationPair(
+	CActionCollectionPtr &action,
+	CSensoryFramePtr     &observations,
+	size_t               &rawlogEntry )
+{
+	try
+	{
+		observations.clear_unique();
+		action.clear_unique();
+		while (!action)
+		{
+			CSerializablePtr obj;
+			if (!getNextObject(obj)) return false;
+			if (IS_CLASS(obj,CActionCollection))
+				action = CActionCollectionPtr(obj);
+			rawlogEntry++;
+		}
+
+		while (!observations)
+		{
+			CSerializablePtr obj;
+			if (!getNextObject(obj)) return false;
+			if (IS_CLASS(obj,CSensoryFrame))
+				observations = CSensoryFramePtr(obj);
+			rawlogEntry++;
+		}
+		return true;
+	}
+	catch (std::exception &e)
+	{
+		std::cerr << "[CRawlogPrefetchReader::readActionObservationPair] Found exception:" << std::endl << e.what() << std::endl;
+		return false;
+	}
+}
@@ -0,0 +1,125 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CRawlogPrefetchReader.h>
+#include <mrpt/obs/CRawlogAsyncWriter.h>
+#include <mrpt/obs/CRawlog.h>
+#include <mrpt/obs/CObservationOdometry.h>
+#include <mrpt/obs/CActionRobotMovement2D.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::poses;
+using namespace mrpt::utils;
+using namespace mrpt::system;
+using namespace std;
+
+static const TTimeStamp TEST_T0 = 131000000000000000ULL;
+
+// Writes N pairs of action / sensory frame with an async writer, reusing the objects as rawlog-grabber does.
+static void writeTestRawlog(const string &fil, size_t N, size_t queueLength)
+{
+	CRawlogAsyncWriter out(fil, 1, queueLength);
+	CSensoryFrame sf;
+	for (size_t i=0;i<N;i++)
+	{
+		CActionRobotMovement2D act;
+		act.timestamp = TEST_T0 + i;
+		act.computeFromOdometry(CPose2D(0.1,0,0), CActionRobotMovement2D::TMotionModelOptions());
+		CActionCollection acts;
+		acts.insert(act);
+		out << acts;
+
+		CObservationOdometryPtr obs = CObservationOdometry::Create();
+		obs->timestamp = TEST_T0 + i;
+		obs->odometry = CPose2D(i*0.1, 0, 0);
+		sf.insert(obs);
+		out << sf;
+		sf.clear();  // The writer must have kept its own copy
+	}
+	out.flush();
+	EXPECT_EQ(out.getQueueLength(), 0u);
+}
+
+TEST(CRawlogPrefetchReader, asyncWriteAndPrefetchRead)
+{
+	const size_t N = 100;
+	const string fil = getTempFileName();
+
+	for (size_t queueLength=1;queueLength<=16;queueLength*=4)
+	{
+		writeTestRawlog(fil, N, queueLength);
+
+		// Compare against the standard sequential reader:
+		CRawlog rawlog;
+		ASSERT_TRUE(rawlog.loadFromRawLogFile(fil));
+		ASSERT_EQ(rawlog.size(), 2*N);
+
+		CRawlogPrefetchReader in(fil, queueLength);
+		CActionCollectionPtr action;
+		CSensoryFramePtr     observations;
+		size_t rawlogEntry = 0, n = 0;
+		while (in.readActionObservationPair(action, observations, rawlogEntry))
+		{
+			ASSERT_TRUE(action.present());
+			ASSERT_TRUE(observations.present());
+			ASSERT_EQ(observations->size(), 1u);
+			EXPECT_EQ(observations->getObservationByIndex(0)->timestamp, TEST_T0 + n);
+			EXPECT_EQ(action->get(0)->timestamp, TEST_T0 + n);
+			const CObservationOdometryPtr obs = observations->getObservationByClass<CObservationOdometry>();
+			ASSERT_TRUE(obs.present());
+			EXPECT_NEAR(obs->odometry.x(), n*0.1, 1e-9);
+			n++;
+		}
+		EXPECT_EQ(n, N);
+		EXPECT_EQ(rawlogEntry, 2*N);
+
+		// At EOF:
+		CSerializablePtr obj;
+		EXPECT_FALSE(in.getNextObject(obj));
+	}
+	deleteFile(fil);
+}
+
+TEST(CRawlogPrefetchReader, observationsOnlyAndEarlyClose)
+{
+	const size_t N = 200;
+	const string fil = getTempFileName();
+	{
+		CRawlogAsyncWriter out(fil);
+		for (size_t i=0;i<N;i++)
+		{
+			CObservationOdometryPtr obs = CObservationOdometry::Create();
+			obs->timestamp = TEST_T0 + i;
+			out << CSerializablePtr(obs);
+		}
+	} // The destructor must write all pending objects
+
+	CRawlogPrefetchReader in(fil, 8);
+	CActionCollectionPtr action;
+	CSensoryFramePtr     observations;
+	CObservationPtr      observation;
+	size_t rawlogEntry = 0;
+	for (size_t i=0;i<N;i++)
+	{
+		ASSERT_TRUE(in.getActionObservationPairOrObservation(action, observations, observation, rawlogEntry));
+		ASSERT_TRUE(observation.present());
+		EXPECT_FALSE(action.present());
+		EXPECT_EQ(observation->timestamp, TEST_T0 + i);
+		if (i==N/2) break; // Closing with objects still being prefetched must not block
+	}
+	in.close();
+	EXPECT_FALSE(in.isOpen());
+
+	CRawlogPrefetchReader in_bad;
+	EXPECT_FALSE(in_bad.open(fil + string(".does_not_exist")));
+	deleteFile(fil);
+}
@@ -30,6 +30,10 @@ namespace mrpt
 		 *   - amCorrelation: "Brute-force" correlation of the two maps over a 2D+orientation grid of possible 2D poses.
 		 *   - amRobustMatch: Detection of features + RANSAC matching
 		 *   - amModifiedRANSAC: Detection of features + modified multi-hypothesis RANSAC matching as described in was reported in the paper http://www.mrpt.org/Paper%3AOccupancy_Grid_Matching
+		 *   - amBranchAndBound: Correlative matching of the occupied cells of the second map against the first one, with a branch-and-bound search
+		 *     over (x,y,phi) on a pyramid of max-pooled grids (as in Hess et al., "Real-Time Loop Closure in 2D LIDAR SLAM", ICRA 2016). It returns
+		 *     the globally best pose within a search window around the initial estimation, at the resolution of the grid, and is well suited
+		 *     to provide the initial guess for a later refinement with CICP.
 		 *
 		 * See CGridMapAligner::Align for more instructions.
 		 *
@@ -57,6 +61,15 @@ namespace mrpt
 					float					*runningTime = NULL,
 					void					*info = NULL );
 
+			/** Private member, implements the "amBranchAndBound" algorithm.
+			  */
+			mrpt::poses::CPosePDFPtr AlignPDF_branchAndBound(
+					const mrpt::maps::CMetricMap		*m1,
+					const mrpt::maps::CMetricMap		*m2,
+					const mrpt::poses::CPosePDFGaussian	&initialEstimationPDF,
+					float					*runningTime = NULL,
+					void					*info = NULL );
+
 			COccupancyGridMapFeatureExtractor	m_grid_feat_extr; //!< Grid map features extractor
 		public:
 
@@ -70,7 +83,8 @@ namespace mrpt
 			{
 				amRobustMatch = 0,
 				amCorrelation,
-				amModifiedRANSAC
+				amModifiedRANSAC,
+				amBranchAndBound  //!< (New in MRPT 1.5.0)
 			};
 
 			/** The ICP algorithm configuration data
@@ -115,6 +129,12 @@ namespace mrpt
 				double  max_ICP_mahadist;	//!< The maximum Mahalanobis distance between the initial and final poses in the ICP not to discard the hypothesis (default=10)
 				double  maxKLd_for_merge;	//!< Maximum KL-divergence for merging modes of the SOG (default=0.9)
 
+				double	bb_linear_window;	//!< [amBranchAndBound method only] Half-size of the search window in x and y (meters) around the initial estimation (default=5)
+				double	bb_angular_window;	//!< [amBranchAndBound method only] Half-size of the search window in phi (radians) around the initial estimation; use M_PI to search all orientations (default=M_PI). In degrees in config files.
+				double	bb_angular_resolution;	//!< [amBranchAndBound method only] Angular step (radians), or 0 to set it from the grid resolution and the farthest point, so that no point moves more than one cell between steps (default=0). In degrees in config files.
+				unsigned int bb_pyramid_levels;	//!< [amBranchAndBound method only] Number of levels of the max-pooled grids pyramid. Level `i` pools windows of 2^i x 2^i cells (default=7)
+				float	bb_min_score;	//!< [amBranchAndBound method only] The minimum score (0-1, the mean occupancy evidence, 2*(p_occ-0.5), at the cells hit by the occupied cells of the second map) to accept a match (default=0.5)
+
 				bool	save_feat_coors;	//!< DEBUG - Dump all feature correspondences in a directory "grid_feats"
 				bool	debug_show_corrs;	//!< DEBUG - Show graphs with the details of each feature correspondences
 				bool	debug_save_map_pairs;	//!< DEBUG - Save the pair of maps with all the pairings.
@@ -180,13 +200,14 @@ namespace mrpt
 			 *
 			 * \param m1			[IN] The first map (Must be a mrpt::maps::CMultiMetricMap class)
 			 * \param m2			[IN] The second map (Must be a mrpt::maps::CMultiMetricMap class)
-			 * \param initialEstimationPDF	[IN] (IGNORED IN THIS ALGORITHM!)
+			 * \param initialEstimationPDF	[IN] Only used by amBranchAndBound, as the center of the search window.
 			 * \param runningTime	[OUT] A pointer to a container for obtaining the algorithm running time in seconds, or NULL if you don't need it.
 			 * \param info			[OUT] A pointer to a TReturnInfo struct, or NULL if result information are not required.
 			 *
 			 * \note The returned PDF depends on the selected alignment method:
 			 *		- "amRobustMatch" --> A "poses::CPosePDFSOG" object.
 			 *		- "amCorrelation" --> A "poses::CPosePDFGrid" object.
+			 *		- "amBranchAndBound" --> A "poses::CPosePDFGaussian" object, with the grid resolution as uncertainty. TReturnInfo::goodness is the match score (0-1).
 			 *
 			 * \return A smart pointer to the output estimated pose PDF.
 			 * \sa CPointsMapAlignmentAlgorithm, options
@@ -224,6 +245,7 @@ namespace mrpt
 				m_map.insert(slam::CGridMapAligner::amRobustMatch,    "amRobustMatch");
 				m_map.insert(slam::CGridMapAligner::amCorrelation,    "amCorrelation");
 				m_map.insert(slam::CGridMapAligner::amModifiedRANSAC, "amModifiedRANSAC");
+				m_map.insert(slam::CGridMapAligner::amBranchAndBound, "amBranchAndBound");
 			}
 		};
 	} // End of namespace
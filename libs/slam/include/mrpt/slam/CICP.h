@@ -12,6 +12,7 @@
 #include <mrpt/slam/CMetricMapsAlignmentAlgorithm.h>
 #include <mrpt/utils/CLoadableOptions.h>
 #include <mrpt/utils/TEnumType.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 
 namespace mrpt
 {
@@ -20,7 +21,9 @@ namespace mrpt
 		/** The ICP algorithm selection, used in mrpt::slam::CICP::options  \ingroup mrpt_slam_grp  */
 		enum TICPAlgorithm {
 			icpClassic = 0,
-			icpLevenbergMarquardt
+			icpLevenbergMarquardt,
+			icpPointToPlane,   //!< Point-to-plane (point-to-line in 2D) ICP, using the normals of the reference map (New in MRPT 1.5.0)
+			icpGeneralized     //!< Generalized-ICP (plane-to-plane), using the local covariances of both maps (New in MRPT 1.5.0)
 		};
 
 		/** ICP covariance estimation methods, used in mrpt::slam::CICP::options  \ingroup mrpt_slam_grp  */
@@ -35,6 +38,13 @@ namespace mrpt
 		 *
 		 *  To choose among existing ICP algorithms or customizing their parameters, see CICP::TConfigParams and the member \a options.
 		 *
+		 *  The icpPointToPlane and icpGeneralized algorithms (see TICPAlgorithm) minimize, by Gauss-Newton iterations, the distance from each point to the
+		 *  plane (line, in 2D) tangent to the surface at its closest point in the reference map, or the Mahalanobis distance between both points with the
+		 *  local covariances of both maps (Generalized-ICP: A. Segal, D. Haehnel, S. Thrun, "Generalized-ICP", RSS 2009), respectively. Both maps must be
+		 *  point maps: their normals and covariances are computed with mrpt::maps::CPointsMap::getLocalGeometry2D() or getLocalGeometry3D(), which caches
+		 *  them within each map. With structured scenes, these methods usually converge in much fewer iterations than the point-to-point ones.
+		 *  Their closest-point searches are split among TConfigParams::numThreads threads.
+		 *
 		 *  There exists an extension of the original ICP algorithm that provides multihypotheses-support for the correspondences, and which generates a Sum-of-Gaussians (SOG)
 		 *    PDF as output. See mrpt::tfest::se2_l2_robust()
 		 *
@@ -114,6 +124,12 @@ namespace mrpt
 				  *  of not approximating ICP by ignoring the correspondence of some points. The speed-up comes from a decimation of the number of KD-tree queries,
 				  *  the most expensive step in ICP */
 				uint32_t        corresponding_points_decimation;
+
+				/** @name Options of the icpPointToPlane and icpGeneralized methods
+				    @{ */
+				uint32_t        normals_num_neighbors; //!< Number of nearest neighbors used to estimate the normal and covariance of each point (default=10)
+				uint32_t        numThreads; //!< Number of threads for the closest-point searches (default=0: as many as CPU cores). Results do not depend on this number.
+				/** @} */
 			};
 
 			TConfigParams  options; //!< The options employed by the ICP align.
@@ -195,6 +211,20 @@ namespace mrpt
 				const mrpt::maps::CMetricMap		*m2,
 				const mrpt::poses::CPose3DPDFGaussian &initialEstimationPDF,
 				TReturnInfo				&outInfo );
+			/** Implements both icpPointToPlane and icpGeneralized, in 2D */
+			mrpt::poses::CPosePDFPtr ICP_Method_PointToPlane(
+				const mrpt::maps::CMetricMap		*m1,
+				const mrpt::maps::CMetricMap		*m2,
+				const mrpt::poses::CPosePDFGaussian	&initialEstimationPDF,
+				TReturnInfo				&outInfo );
+			/** Implements both icpPointToPlane and icpGeneralized, in 3D */
+			mrpt::poses::CPose3DPDFPtr ICP3D_Method_PointToPlane(
+				const mrpt::maps::CMetricMap		*m1,
+				const mrpt::maps::CMetricMap		*m2,
+				const mrpt::poses::CPose3DPDFGaussian &initialEstimationPDF,
+				TReturnInfo				&outInfo );
+
+			mrpt::system::CWorkerThreadsPool  m_threads; //!< Threads for the closest-point searches, see TConfigParams::numThreads
 		};
 	} // End of namespace
 
@@ -209,6 +239,8 @@ namespace mrpt
 			{
 				m_map.insert(slam::icpClassic, "icpClassic");
 				m_map.insert(slam::icpLevenbergMarquardt, "icpLevenbergMarquardt");
+				m_map.insert(slam::icpPointToPlane, "icpPointToPlane");
+				m_map.insert(slam::icpGeneralized, "icpGeneralized");
 			}
 		};
 		template <>
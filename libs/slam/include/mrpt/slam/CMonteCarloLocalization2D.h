@@ -136,6 +136,14 @@ namespace mrpt
 				const size_t			particleIndexForMap,
 				const mrpt::obs::CSensoryFrame		&observation,
 				const mrpt::poses::CPose3D &x ) const;
+
+			/** Evaluate the observation likelihood for a batch of particles, with one call to mrpt::maps::CMetricMap::computeObservationLikelihoods() per observation if all particles share the same map */
+			void PF_SLAM_computeObservationLikelihoodForParticles(
+				const mrpt::bayes::CParticleFilter::TParticleFilterOptions	&PF_options,
+				const std::vector<size_t>			&particleIndicesForMap,
+				const mrpt::obs::CSensoryFrame		&observation,
+				const std::vector<mrpt::math::TPose3D> &x,
+				std::vector<double>					&out_log_liks ) const MRPT_OVERRIDE;
 			/** @} */
 
 
@@ -110,6 +110,67 @@ namespace mrpt
 			return true;
 		} // end of PF_SLAM_implementation_gatherActionsCheckBothActObs
 
+		namespace detail
+		{
+			/** Task used by PF_SLAM_computeObservationLikelihoodForParticlesInParallel() to process a chunk of the batch of particles */
+			template <class PF_IMPL>
+			struct TParticlesLikelihoodTask : public mrpt::system::CWorkerThreadsPool::TRangeTask
+			{
+				const PF_IMPL &pf;
+				const mrpt::bayes::CParticleFilter::TParticleFilterOptions &PF_options;
+				const std::vector<size_t> &idxs;
+				const mrpt::obs::CSensoryFrame &sf;
+				const std::vector<mrpt::math::TPose3D> &x;
+				std::vector<double> &out_log_liks;
+
+				TParticlesLikelihoodTask(const PF_IMPL &_pf, const mrpt::bayes::CParticleFilter::TParticleFilterOptions &_PF_options, const std::vector<size_t> &_idxs, const mrpt::obs::CSensoryFrame &_sf, const std::vector<mrpt::math::TPose3D> &_x, std::vector<double> &_out_log_liks) :
+					pf(_pf), PF_options(_PF_options), idxs(_idxs), sf(_sf), x(_x), out_log_liks(_out_log_liks)
+				{ }
+
+				void operator()(size_t first, size_t last) const MRPT_OVERRIDE
+				{
+					const std::vector<size_t> chunk_idxs(idxs.begin()+first, idxs.begin()+last);
+					const std::vector<mrpt::math::TPose3D> chunk_x(x.begin()+first, x.begin()+last);
+					std::vector<double> chunk_liks;
+					pf.PF_SLAM_computeObservationLikelihoodForParticles(PF_options,chunk_idxs,sf,chunk_x,chunk_liks);
+					ASSERT_EQUAL_(chunk_liks.size(), chunk_x.size())
+					std::copy(chunk_liks.begin(),chunk_liks.end(),out_log_liks.begin()+first);
+				}
+			};
+		}
+
+		template <class PARTICLE_TYPE,class MYSELF>
+		void PF_implementation<PARTICLE_TYPE,MYSELF>::PF_SLAM_computeObservationLikelihoodForParticlesInParallel(
+			const mrpt::bayes::CParticleFilter::TParticleFilterOptions	&PF_options,
+			const std::vector<size_t>			&particleIndicesForMap,
+			const mrpt::obs::CSensoryFrame		&observation,
+			const std::vector<mrpt::math::TPose3D> &x,
+			std::vector<double>					&out_log_liks ) const
+		{
+			MRPT_START
+			ASSERT_EQUAL_(particleIndicesForMap.size(), x.size())
+			const size_t N = x.size();
+			m_likelihoodWorkers.resize(PF_options.numThreads);
+			if (m_likelihoodWorkers.size()<2 || N<2)
+			{
+				PF_SLAM_computeObservationLikelihoodForParticles(PF_options,particleIndicesForMap,observation,x,out_log_liks);
+				return;
+			}
+
+			out_log_liks.resize(N);
+			// Evaluate the first pose in this thread, so any lazy data built upon the first query
+			// (e.g. cached point maps of observations) already exists before going multithread:
+			out_log_liks[0] = PF_SLAM_computeObservationLikelihoodForParticle(PF_options,particleIndicesForMap[0],observation,mrpt::poses::CPose3D(x[0]));
+
+			const std::vector<size_t> rest_idxs(particleIndicesForMap.begin()+1, particleIndicesForMap.end());
+			const std::vector<mrpt::math::TPose3D> rest_x(x.begin()+1, x.end());
+			std::vector<double> rest_liks(N-1);
+			m_likelihoodWorkers.parallel_for(N-1,
+				detail::TParticlesLikelihoodTask<PF_implementation<PARTICLE_TYPE,MYSELF> >(*this,PF_options,rest_idxs,observation,rest_x,rest_liks) );
+			std::copy(rest_liks.begin(),rest_liks.end(),out_log_liks.begin()+1);
+			MRPT_END
+		}
+
 		/** A generic implementation of the PF method "prediction_and_update_pfAuxiliaryPFOptimal" (optimal sampling with rejection sampling approximation),
 		  *  common to both localization and mapping.
 		  *
@@ -283,14 +344,20 @@ namespace mrpt
 				const size_t M = me->m_particles.size();
 				//	UPDATE STAGE
 				// ----------------------------------------------------------------------
-				// Compute all the likelihood values & update particles weight:
+				// Compute all the likelihood values (possibly in parallel):
+				std::vector<size_t> partIdxs(M);
+				std::vector<mrpt::math::TPose3D> partPoses(M);
 				for (size_t i=0;i<M;i++)
 				{
-					const mrpt::math::TPose3D  *partPose= getLastPose(i); // Take the particle data:
-					mrpt::poses::CPose3D  partPose2 = mrpt::poses::CPose3D(*partPose);
-					const double obs_log_likelihood = PF_SLAM_computeObservationLikelihoodForParticle(PF_options,i,*sf,partPose2);
-					me->m_particles[i].log_w += obs_log_likelihood * PF_options.powFactor;
-				} // for each particle "i"
+					partIdxs[i] = i;
+					partPoses[i] = *getLastPose(i); // Take the particle data
+				}
+				std::vector<double> obs_log_likelihoods;
+				PF_SLAM_computeObservationLikelihoodForParticlesInParallel(PF_options,partIdxs,*sf,partPoses,obs_log_likelihoods);
+
+				// and update particles weight, in order:
+				for (size_t i=0;i<M;i++)
+					me->m_particles[i].log_w += obs_log_likelihoods[i] * PF_options.powFactor;
 
 				// Normalization of weights is done outside of this method automatically.
 			}
@@ -349,24 +416,33 @@ namespace mrpt
 
 			const mrpt::poses::CPose3D oldPose = mrpt::poses::CPose3D(*me->getLastPose(index));
 			mrpt::math::CVectorDouble   vectLiks(N,0);		// The vector with the individual log-likelihoods.
+
+			// Draw all the samples first (in order, so results do not depend on the number of threads)...
+			std::vector<mrpt::math::TPose3D> drawnSamples(N), x_predicts(N);
 			mrpt::poses::CPose3D			drawnSample;
 			for (size_t q=0;q<N;q++)
 			{
 				me->m_movementDrawer.drawSample(drawnSample);
-				mrpt::poses::CPose3D	x_predict = oldPose + drawnSample;
+				drawnSamples[q] = mrpt::math::TPose3D(drawnSample);
+				x_predicts[q] = mrpt::math::TPose3D(oldPose + drawnSample);
+			}
 
-				// Estimate the mean...
-				indivLik = me->PF_SLAM_computeObservationLikelihoodForParticle(
-					PF_options,
-					index,
-					*static_cast<const mrpt::obs::CSensoryFrame*>(observation),
-					x_predict );
+			// ...then estimate the mean:
+			std::vector<double> liks;
+			me->PF_SLAM_computeObservationLikelihoodForParticlesInParallel(
+				PF_options,
+				std::vector<size_t>(N,index),
+				*static_cast<const mrpt::obs::CSensoryFrame*>(observation),
+				x_predicts, liks );
 
+			for (size_t q=0;q<N;q++)
+			{
+				indivLik = liks[q];
 				MRPT_CHECK_NORMAL_NUMBER(indivLik);
 				vectLiks[q] = indivLik;
 				if ( indivLik > maxLik )
 				{	// Keep the maximum value:
-					maxLikDraw	= drawnSample;
+					maxLikDraw	= mrpt::poses::CPose3D(drawnSamples[q]);
 					maxLik		= indivLik;
 				}
 			}
@@ -444,24 +520,33 @@ namespace mrpt
 				ASSERT_(N>1)
 
 				mrpt::math::CVectorDouble   vectLiks(N,0);		// The vector with the individual log-likelihoods.
+
+				// Draw all the samples first (in order, so results do not depend on the number of threads)...
+				std::vector<mrpt::math::TPose3D> drawnSamples(N), x_predicts(N);
 				mrpt::poses::CPose3D		drawnSample;
 				for (size_t q=0;q<N;q++)
 				{
 					myObj->m_movementDrawer.drawSample(drawnSample);
-					mrpt::poses::CPose3D	x_predict = oldPose + drawnSample;
+					drawnSamples[q] = mrpt::math::TPose3D(drawnSample);
+					x_predicts[q] = mrpt::math::TPose3D(oldPose + drawnSample);
+				}
 
-					// Estimate the mean...
-					indivLik = myObj->PF_SLAM_computeObservationLikelihoodForParticle(
-						PF_options,
-						index,
-						*static_cast<const mrpt::obs::CSensoryFrame*>(observation),
-						x_predict );
+				// ...then estimate the mean:
+				std::vector<double> liks;
+				myObj->PF_SLAM_computeObservationLikelihoodForParticlesInParallel(
+					PF_options,
+					std::vector<size_t>(N,index),
+					*static_cast<const mrpt::obs::CSensoryFrame*>(observation),
+					x_predicts, liks );
 
+				for (size_t q=0;q<N;q++)
+				{
+					indivLik = liks[q];
 					MRPT_CHECK_NORMAL_NUMBER(indivLik);
 					vectLiks[q] = indivLik;
 					if ( indivLik > maxLik )
 					{	// Keep the maximum value:
-						maxLikDraw	= drawnSample;
+						maxLikDraw	= mrpt::poses::CPose3D(drawnSamples[q]);
 						maxLik		= indivLik;
 					}
 				}
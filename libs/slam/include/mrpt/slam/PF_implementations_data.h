@@ -18,6 +18,7 @@
 #include <mrpt/poses/CPoseRandomSampler.h>
 #include <mrpt/slam/TKLDParams.h>
 #include <mrpt/utils/COutputLogger.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 
 #include <mrpt/slam/link_pragmas.h>
 
@@ -34,6 +35,8 @@ namespace mrpt
 			const mrpt::math::TPose3D		*newPoseToBeInserted = NULL );
 
 
+		namespace detail { template <class PF_IMPL> struct TParticlesLikelihoodTask; }
+
 		/** A set of common data shared by PF implementations for both SLAM and localization
 		  *   \ingroup mrpt_slam_grp
 		  */
@@ -41,6 +44,7 @@ namespace mrpt
 		class PF_implementation :
 			public mrpt::utils::COutputLogger
 		{
+			template <class PF_IMPL> friend struct detail::TParticlesLikelihoodTask;
 		public:
 			PF_implementation() :
 				mrpt::utils::COutputLogger("PF_implementation"),
@@ -63,6 +67,7 @@ namespace mrpt
 			mutable mrpt::math::CVectorDouble			m_pfAuxiliaryPFOptimal_maxLikelihood;						//!< Auxiliary variable used in the "pfAuxiliaryPFOptimal" algorithm.
 			mutable std::vector<mrpt::math::TPose3D>	m_pfAuxiliaryPFOptimal_maxLikDrawnMovement;		//!< Auxiliary variable used in the "pfAuxiliaryPFOptimal" algorithm.
 			std::vector<bool>				m_pfAuxiliaryPFOptimal_maxLikMovementDrawHasBeenUsed;
+			mutable mrpt::system::CWorkerThreadsPool	m_likelihoodWorkers; //!< Threads used to evaluate likelihoods if TParticleFilterOptions::numThreads!=1
 
 			/**  Compute w[i]*p(z_t | mu_t^i), with mu_t^i being
 			  *    the mean of the new robot pose
@@ -244,6 +249,32 @@ namespace mrpt
 				const mrpt::obs::CSensoryFrame		&observation,
 				const mrpt::poses::CPose3D			&x )  const = 0;
 
+			/** Evaluate the observation likelihood for a batch of particles: `out_log_liks[k]` is the likelihood of particle `particleIndicesForMap[k]` at location `x[k]`.
+			  * The default implementation calls PF_SLAM_computeObservationLikelihoodForParticle() once per pose. Override it to evaluate all poses with one call to the map(s), e.g. with mrpt::maps::CMetricMap::computeObservationLikelihoods().
+			  * \note It may be called concurrently from several threads if TParticleFilterOptions::numThreads!=1
+			  */
+			virtual void PF_SLAM_computeObservationLikelihoodForParticles(
+				const mrpt::bayes::CParticleFilter::TParticleFilterOptions	&PF_options,
+				const std::vector<size_t>			&particleIndicesForMap,
+				const mrpt::obs::CSensoryFrame		&observation,
+				const std::vector<mrpt::math::TPose3D> &x,
+				std::vector<double>					&out_log_liks ) const
+			{
+				const size_t N = x.size();
+				out_log_liks.resize(N);
+				for (size_t k=0;k<N;k++)
+					out_log_liks[k] = PF_SLAM_computeObservationLikelihoodForParticle(PF_options,particleIndicesForMap[k],observation,mrpt::poses::CPose3D(x[k]));
+			}
+
+			/** Calls PF_SLAM_computeObservationLikelihoodForParticles(), splitting the batch among TParticleFilterOptions::numThreads threads.
+			  * Each result is written to its own slot, so the output does not depend on the number of threads. */
+			void PF_SLAM_computeObservationLikelihoodForParticlesInParallel(
+				const mrpt::bayes::CParticleFilter::TParticleFilterOptions	&PF_options,
+				const std::vector<size_t>			&particleIndicesForMap,
+				const mrpt::obs::CSensoryFrame		&observation,
+				const std::vector<mrpt::math::TPose3D> &x,
+				std::vector<double>					&out_log_liks ) const;
+
 			/** @} */
 
 
@@ -80,6 +80,29 @@ struct MapComputeLikelihood
 
 }; // end of MapComputeLikelihood
 
+struct MapComputeLikelihoods
+{
+	const CObservation    * obs;
+	const std::vector<mrpt::math::TPose3D> & takenFrom;
+	std::vector<double>   & total_log_liks;
+	std::vector<double>   log_liks;
+
+	MapComputeLikelihoods(const CMultiMetricMap &m,const CObservation * _obs, const std::vector<mrpt::math::TPose3D> & _takenFrom, std::vector<double> & _total_log_liks) :
+		obs(_obs), takenFrom(_takenFrom),
+		total_log_liks(_total_log_liks)
+	{
+		total_log_liks.assign(takenFrom.size(),0);
+	}
+
+	template <typename PTR>
+	inline void operator()(PTR &ptr) {
+		ptr->computeObservationLikelihoods(obs,takenFrom,log_liks);
+		for (size_t i=0;i<log_liks.size();i++)
+			total_log_liks[i]+=log_liks[i];
+	}
+
+}; // end of MapComputeLikelihoods
+
 struct MapCanComputeLikelihood
 {
 	const CObservation    * obs;
@@ -331,6 +354,16 @@ double	 CMultiMetricMap::internal_computeObservationLikelihood(
 	return ret_log_lik;
 }
 
+// Read docs in base class
+void CMultiMetricMap::internal_computeObservationLikelihoods(
+			const CObservation		*obs,
+			const std::vector<mrpt::math::TPose3D> &takenFrom,
+			std::vector<double>     &out_log_liks )
+{
+	MapComputeLikelihoods op_likelihoods(*this,obs,takenFrom,out_log_liks);
+	MapExecutor::run(*this,op_likelihoods);
+}
+
 // Read docs in base class
 bool CMultiMetricMap::internal_canComputeObservationLikelihood( const CObservation *obs ) const
 {
@@ -71,6 +71,9 @@ CPosePDFPtr CGridMapAligner::AlignPDF(
 		// The same function has an internal switch for the specific method:
 		return AlignPDF_robustMatch(mm1,mm2,initialEstimationPDF,runningTime,info);
 
+	case CGridMapAligner::amBranchAndBound:
+		return AlignPDF_branchAndBound(mm1,mm2,initialEstimationPDF,runningTime,info);
+
 	default:
 		THROW_EXCEPTION("Wrong value found in 'options.methodSelection'!!");
 	}
@@ -1032,6 +1035,262 @@ CPosePDFPtr CGridMapAligner::AlignPDF_correlation(
 }
 
 
+namespace
+{
+	/** One level of the pyramid of max-pooled grids used by the branch-and-bound matcher: the cell (cx,cy) of level `h`
+	  * holds the maximum score of the level-0 cells in the window [cx,cx+2^h) x [cy,cy+2^h). The grid is padded with
+	  * 2^h-1 cells at the left and bottom, so candidates partially out of the map are still correctly bounded. */
+	struct TBBPyramidLevel
+	{
+		int off, sx, sy;
+		std::vector<uint8_t> data;
+
+		inline uint8_t get(int cx, int cy) const {
+			cx+=off; cy+=off;
+			if (cx<0 || cy<0 || cx>=sx || cy>=sy) return 0;
+			return data[cx+cy*sx];
+		}
+	};
+
+	/** A search node: the translation of its lowest corner (in cells, relative to the initial estimation),
+	  * the orientation index and the pyramid level, whose size is 2^level cells. */
+	struct TBBCandidate
+	{
+		int dx, dy, th_idx, level, bound;
+		bool operator <(const TBBCandidate &o) const { return bound<o.bound; }
+	};
+}
+
+/*---------------------------------------------------------------
+					AlignPDF_branchAndBound
+---------------------------------------------------------------*/
+CPosePDFPtr CGridMapAligner::AlignPDF_branchAndBound(
+    const mrpt::maps::CMetricMap		*mm1,
+    const mrpt::maps::CMetricMap		*mm2,
+    const CPosePDFGaussian	&initialEstimationPDF,
+    float					*runningTime,
+    void					*info )
+{
+	MRPT_START
+
+	CTicTac		tictac;
+	if (runningTime) tictac.Tic();
+
+	// Asserts:
+	// -----------------
+	const COccupancyGridMap2D		*m1 = NULL;
+	const COccupancyGridMap2D		*m2 = NULL;
+
+	if (IS_CLASS(mm1, CMultiMetricMap) && IS_CLASS(mm2, CMultiMetricMap) )
+	{
+		const CMultiMetricMap *multimap1 = static_cast<const CMultiMetricMap*>(mm1);
+		const CMultiMetricMap *multimap2 = static_cast<const CMultiMetricMap*>(mm2);
+
+		ASSERT_(multimap1->m_gridMaps.size() && multimap1->m_gridMaps[0].present());
+		ASSERT_(multimap2->m_gridMaps.size() && multimap2->m_gridMaps[0].present());
+
+		m1 = multimap1->m_gridMaps[0].pointer();
+		m2 = multimap2->m_gridMaps[0].pointer();
+	}
+	else if ( IS_CLASS(mm1, COccupancyGridMap2D) && IS_CLASS(mm2, COccupancyGridMap2D) )
+	{
+		m1 = static_cast<const COccupancyGridMap2D*>(mm1);
+		m2 = static_cast<const COccupancyGridMap2D*>(mm2);
+	}
+	else THROW_EXCEPTION("Metric maps must be of classes COccupancyGridMap2D or CMultiMetricMap")
+
+	ASSERT_( m1->getResolution() == m2->getResolution() );
+	ASSERT_( options.bb_linear_window>=0 && options.bb_angular_window>=0 && options.bb_angular_resolution>=0 );
+
+	const double res = m1->getResolution();
+	const int    nLevels = std::max(1, std::min<int>(options.bb_pyramid_levels, 16));
+
+	// The points to align: centers of the occupied cells of m2
+	// ----------------------------------------------------------
+	std::vector<float> pts_x, pts_y;
+	double max_dist2 = 0;
+	for (unsigned int cy=0;cy<m2->getSizeY();cy++)
+		for (unsigned int cx=0;cx<m2->getSizeX();cx++)
+			if (m2->getCell(cx,cy)<0.5f)
+			{
+				pts_x.push_back(m2->idx2x(cx));
+				pts_y.push_back(m2->idx2y(cy));
+				keep_max(max_dist2, square(pts_x.back())+square(pts_y.back()));
+			}
+	const size_t nPts = pts_x.size();
+
+	// Default output: the initial estimation, with a null goodness
+	TReturnInfo outInfo;
+	outInfo.goodness = 0;
+	CPosePDFGaussianPtr pdf = CPosePDFGaussian::Create();
+	pdf->copyFrom(initialEstimationPDF);
+
+	if (nPts)
+	{
+		// Level 0: score of each cell of m1 in the range [0,255], from its occupancy evidence
+		// ---------------------------------------------------------------------------------------
+		std::vector<TBBPyramidLevel> pyramid(nLevels);
+		{
+			TBBPyramidLevel &L0 = pyramid[0];
+			L0.off = 0;
+			L0.sx  = m1->getSizeX();
+			L0.sy  = m1->getSizeY();
+			L0.data.resize(L0.sx*L0.sy);
+			for (int cy=0;cy<L0.sy;cy++)
+				for (int cx=0;cx<L0.sx;cx++)
+				{
+					const float occ = 1.0f - m1->getCell(cx,cy);
+					L0.data[cx+cy*L0.sx] = occ>0.5f ? static_cast<uint8_t>(mrpt::utils::round(255*2*(occ-0.5f))) : 0;
+				}
+		}
+		// Level h from level h-1:
+		for (int h=1;h<nLevels;h++)
+		{
+			const TBBPyramidLevel &Lp = pyramid[h-1];
+			TBBPyramidLevel &L = pyramid[h];
+			const int s = 1<<(h-1);
+			L.off = (1<<h)-1;
+			L.sx  = pyramid[0].sx + L.off;
+			L.sy  = pyramid[0].sy + L.off;
+			L.data.resize(L.sx*L.sy);
+			for (int y=0;y<L.sy;y++)
+			{
+				const int cy = y-L.off;
+				for (int x=0;x<L.sx;x++)
+				{
+					const int cx = x-L.off;
+					L.data[x+y*L.sx] = std::max(
+						std::max(Lp.get(cx,cy),Lp.get(cx+s,cy)),
+						std::max(Lp.get(cx,cy+s),Lp.get(cx+s,cy+s)) );
+				}
+			}
+		}
+
+		// Discretization of the search space:
+		// -------------------------------------------
+		double dTh = options.bb_angular_resolution;
+		if (dTh==0)
+		{
+			// The angle so the farthest point moves (at most) one cell:
+			const double max_dist = std::max(res, std::sqrt(max_dist2));
+			dTh = std::acos( std::max(-1.0, 1.0 - square(res)/(2*square(max_dist)) ) );
+		}
+		const int nTh = static_cast<int>( std::ceil( std::min(options.bb_angular_window,M_PI) / dTh ) );
+		const int wXY = static_cast<int>( std::ceil( options.bb_linear_window / res ) );
+		const CPose2D pose0 = initialEstimationPDF.mean;
+
+		// Cells of all the points, for each orientation, with the translation of the initial estimation:
+		const int nThs = 2*nTh+1;
+		std::vector<std::vector<int> > base_cx(nThs), base_cy(nThs);
+		for (int i=0;i<nThs;i++)
+		{
+			const double th = pose0.phi() + (i-nTh)*dTh;
+			const double ccos = cos(th), csin = sin(th);
+			base_cx[i].resize(nPts);
+			base_cy[i].resize(nPts);
+			for (size_t k=0;k<nPts;k++)
+			{
+				base_cx[i][k] = m1->x2idx( pose0.x() + ccos*pts_x[k] - csin*pts_y[k] );
+				base_cy[i][k] = m1->y2idx( pose0.y() + csin*pts_x[k] + ccos*pts_y[k] );
+			}
+		}
+
+		// The score of a candidate at its level, which is an upper bound of the score of all the poses it contains:
+		struct TScorer {
+			const std::vector<TBBPyramidLevel> &pyramid;
+			const std::vector<std::vector<int> > &base_cx, &base_cy;
+			int operator()(const TBBCandidate &c) const {
+				const TBBPyramidLevel &L = pyramid[c.level];
+				const int *bx = &base_cx[c.th_idx][0], *by = &base_cy[c.th_idx][0];
+				const size_t N = base_cx[c.th_idx].size();
+				int sum = 0;
+				for (size_t k=0;k<N;k++)
+					sum+=L.get(bx[k]+c.dx, by[k]+c.dy);
+				return sum;
+			}
+		};
+		const TScorer score = { pyramid, base_cx, base_cy };
+
+		// Only solutions better than this one are accepted:
+		int bestScore = static_cast<int>( std::ceil( options.bb_min_score*255.0*nPts ) ) - 1;
+		bool found = false;
+		TBBCandidate c, best;
+		std::vector<TBBCandidate> stack;
+
+		// Top level candidates, best ones last, so they are explored first:
+		const int top = nLevels-1;
+		for (int i=0;i<nThs;i++)
+			for (int dy=-wXY;dy<=wXY;dy+=(1<<top))
+				for (int dx=-wXY;dx<=wXY;dx+=(1<<top))
+				{
+					c.dx = dx; c.dy = dy; c.th_idx = i; c.level = top;
+					c.bound = score(c);
+					if (c.bound>bestScore) stack.push_back(c);
+				}
+		std::sort(stack.begin(),stack.end());
+
+		// Depth-first branch and bound:
+		std::vector<TBBCandidate> children;
+		children.reserve(4);
+		while (!stack.empty())
+		{
+			const TBBCandidate cur = stack.back();
+			stack.pop_back();
+			if (cur.bound<=bestScore)
+				continue;  // Pruned: a better solution was found after pushing this one.
+
+			if (cur.level==0)
+			{
+				// A leaf: its score is exact.
+				bestScore = cur.bound;
+				best = cur;
+				found = true;
+				continue;
+			}
+
+			const int s = 1<<(cur.level-1);
+			children.clear();
+			for (int iy=0;iy<2;iy++)
+				for (int ix=0;ix<2;ix++)
+				{
+					c.dx = cur.dx+ix*s; c.dy = cur.dy+iy*s;
+					if (c.dx>wXY || c.dy>wXY) continue;
+					c.th_idx = cur.th_idx; c.level = cur.level-1;
+					c.bound = score(c);
+					if (c.bound>bestScore) children.push_back(c);
+				}
+			std::sort(children.begin(),children.end());
+			stack.insert(stack.end(),children.begin(),children.end());
+		}
+
+		if (found)
+		{
+			pdf->mean = CPose2D(
+				pose0.x() + best.dx*res,
+				pose0.y() + best.dy*res,
+				wrapToPi( pose0.phi() + (best.th_idx-nTh)*dTh ) );
+			pdf->cov.zeros();
+			pdf->cov(0,0) = pdf->cov(1,1) = square(res);
+			pdf->cov(2,2) = square(dTh);
+			outInfo.goodness = bestScore/(255.0f*nPts);
+		}
+	}
+
+	// Copy the output info if requested:
+	if (info)
+	{
+		TReturnInfo* info_ = static_cast<TReturnInfo*>(info);
+		*info_ = outInfo;
+	}
+
+	if (runningTime)
+		*runningTime = tictac.Tac();
+
+	return pdf;
+
+	MRPT_END
+}
+
 /*---------------------------------------------------------------
 					TConfigParams
   ---------------------------------------------------------------*/
@@ -1053,6 +1312,12 @@ CGridMapAligner::TConfigParams::TConfigParams() :
 	max_ICP_mahadist		( 10.0 ),
 	maxKLd_for_merge		( 0.9 ),
 
+	bb_linear_window		( 5.0 ),
+	bb_angular_window		( M_PI ),
+	bb_angular_resolution	( 0 ),
+	bb_pyramid_levels		( 7 ),
+	bb_min_score			( 0.5f ),
+
 	save_feat_coors			( false ),
 	debug_show_corrs		( false ),
 	debug_save_map_pairs	( false )
@@ -1078,6 +1343,11 @@ void  CGridMapAligner::TConfigParams::dumpToTextStream(mrpt::utils::CStream	&out
 	LOADABLEOPTS_DUMP_VAR(ransac_chi2_quantile,double)
 	LOADABLEOPTS_DUMP_VAR(ransac_prob_good_inliers,double)
 	LOADABLEOPTS_DUMP_VAR(ransac_SOG_sigma_m,float)
+	LOADABLEOPTS_DUMP_VAR(bb_linear_window,double)
+	LOADABLEOPTS_DUMP_VAR_DEG(bb_angular_window)
+	LOADABLEOPTS_DUMP_VAR_DEG(bb_angular_resolution)
+	LOADABLEOPTS_DUMP_VAR(bb_pyramid_levels,int)
+	LOADABLEOPTS_DUMP_VAR(bb_min_score,float)
 	LOADABLEOPTS_DUMP_VAR(save_feat_coors,bool)
 	LOADABLEOPTS_DUMP_VAR(debug_show_corrs, bool)
 	LOADABLEOPTS_DUMP_VAR(debug_save_map_pairs, bool)
@@ -1113,6 +1383,12 @@ void  CGridMapAligner::TConfigParams::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR_NO_DEFAULT(ransac_chi2_quantile, double,   iniFile, section)
 	MRPT_LOAD_CONFIG_VAR_NO_DEFAULT(ransac_prob_good_inliers, double,   iniFile, section)
 
+	MRPT_LOAD_CONFIG_VAR(bb_linear_window, double,   iniFile, section)
+	MRPT_LOAD_CONFIG_VAR_DEGREES(bb_angular_window,   iniFile, section)
+	MRPT_LOAD_CONFIG_VAR_DEGREES(bb_angular_resolution,   iniFile, section)
+	MRPT_LOAD_CONFIG_VAR(bb_pyramid_levels, int,   iniFile, section)
+	MRPT_LOAD_CONFIG_VAR(bb_min_score, float,   iniFile, section)
+
 	MRPT_LOAD_CONFIG_VAR(save_feat_coors, bool,   iniFile,section )
 	MRPT_LOAD_CONFIG_VAR(debug_show_corrs, bool,   iniFile,section )
 	MRPT_LOAD_CONFIG_VAR(debug_save_map_pairs, bool,   iniFile,section )
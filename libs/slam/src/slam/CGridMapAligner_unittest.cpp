@@ -0,0 +1,108 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include <mrpt/slam/CGridMapAligner.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CMultiMetricMap.h>
+#include <mrpt/poses/CPosePDFGaussian.h>
+#include <mrpt/math/wrap2pi.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::slam;
+using namespace mrpt::maps;
+using namespace mrpt::poses;
+using namespace mrpt::math;
+using namespace mrpt::utils;
+using namespace std;
+
+namespace
+{
+	// An asymmetric room, with some obstacles inside, as a list of segments (x0,y0,x1,y1) in meters:
+	const double ROOM_SEGMENTS[][4] = {
+		{-4,-3, 5,-3}, { 5,-3, 5, 1}, { 5, 1, 3, 1}, { 3, 1, 3, 4}, { 3, 4,-4, 4}, {-4, 4,-4,-3},
+		{ 0, 0, 1, 0}, { 1, 0, 1,0.5}, { 1,0.5, 0,0.5}, { 0,0.5, 0, 0},
+		{-2,-1,-1, 2}
+	};
+
+	// Marks as occupied the cells of all the segments, seen from the given pose:
+	void drawRoom(COccupancyGridMap2D &grid, const CPose2D &gridPose)
+	{
+		grid.setSize(-8,8,-8,8,0.05f, 0.5f);
+		for (size_t i=0;i<sizeof(ROOM_SEGMENTS)/sizeof(ROOM_SEGMENTS[0]);i++)
+		{
+			const double *s = ROOM_SEGMENTS[i];
+			const double len = std::sqrt(square(s[2]-s[0])+square(s[3]-s[1]));
+			const int nSteps = static_cast<int>(len/(0.5*grid.getResolution()));
+			for (int k=0;k<=nSteps;k++)
+			{
+				const double t = double(k)/nSteps;
+				double lx,ly;
+				gridPose.inverseComposePoint(s[0]+t*(s[2]-s[0]), s[1]+t*(s[3]-s[1]), lx,ly);
+				grid.setCell(grid.x2idx(lx),grid.y2idx(ly), 0.0f);
+			}
+		}
+	}
+}
+
+TEST(CGridMapAligner, branchAndBound)
+{
+	const CPose2D GT_POSE(1.3, -0.7, DEG2RAD(23.0));
+
+	COccupancyGridMap2D m1, m2;
+	drawRoom(m1, CPose2D(0,0,0));
+	drawRoom(m2, GT_POSE);
+
+	CGridMapAligner aligner;
+	aligner.options.methodSelection = CGridMapAligner::amBranchAndBound;
+	aligner.options.bb_linear_window = 2.0;
+	aligner.options.bb_angular_window = M_PI;
+
+	CGridMapAligner::TReturnInfo info;
+	float runTime;
+	const CPosePDFPtr pdf = aligner.AlignPDF(&m1,&m2, CPosePDFGaussian(CPose2D(0,0,0)), &runTime, &info);
+
+	ASSERT_TRUE(IS_CLASS(pdf, CPosePDFGaussian));
+	const CPose2D est = pdf->getMeanVal();
+	EXPECT_NEAR(est.x(), GT_POSE.x(), 0.1);
+	EXPECT_NEAR(est.y(), GT_POSE.y(), 0.1);
+	EXPECT_NEAR(wrapToPi(est.phi()-GT_POSE.phi()), 0, DEG2RAD(1.5));
+	EXPECT_GT(info.goodness, 0.8f);
+
+	// With a wrong initial estimation outside of the search window, there is no good match:
+	aligner.options.bb_linear_window = 0.2;
+	aligner.options.bb_angular_window = DEG2RAD(5.0);
+	const CPose2D wrongPose(-1.0, 1.0, DEG2RAD(-40.0));
+	const CPosePDFPtr pdf2 = aligner.AlignPDF(&m1,&m2, CPosePDFGaussian(wrongPose), &runTime, &info);
+	EXPECT_EQ(info.goodness, 0.0f);
+	EXPECT_NEAR(pdf2->getMeanVal().distanceTo(wrongPose), 0, 1e-6);
+}
+
+TEST(CGridMapAligner, branchAndBound_multimetricmap)
+{
+	const CPose2D GT_POSE(-0.4, 0.9, DEG2RAD(-70.0));
+
+	CMultiMetricMap mm1, mm2;
+	mm1.m_gridMaps.push_back(COccupancyGridMap2D::Create());
+	mm2.m_gridMaps.push_back(COccupancyGridMap2D::Create());
+	drawRoom(*mm1.m_gridMaps[0], CPose2D(0,0,0));
+	drawRoom(*mm2.m_gridMaps[0], GT_POSE);
+
+	CGridMapAligner aligner;
+	aligner.options.methodSelection = CGridMapAligner::amBranchAndBound;
+	aligner.options.bb_linear_window = 1.0;
+	aligner.options.bb_angular_window = DEG2RAD(90.0);
+
+	// Search around a rough initial estimation:
+	const CPosePDFPtr pdf = aligner.AlignPDF(&mm1,&mm2, CPosePDFGaussian(CPose2D(0,0.5,DEG2RAD(-45.0))));
+	const CPose2D est = pdf->getMeanVal();
+	EXPECT_NEAR(est.x(), GT_POSE.x(), 0.1);
+	EXPECT_NEAR(est.y(), GT_POSE.y(), 0.1);
+	EXPECT_NEAR(wrapToPi(est.phi()-GT_POSE.phi()), 0, DEG2RAD(1.5));
+}
@@ -72,6 +72,10 @@ CPosePDFPtr CICP::AlignPDF(
 	case icpLevenbergMarquardt:
 		resultPDF = ICP_Method_LM( m1, mm2, initialEstimationPDF, outInfo );
 		break;
+	case icpPointToPlane:
+	case icpGeneralized:
+		resultPDF = ICP_Method_PointToPlane( m1, mm2, initialEstimationPDF, outInfo );
+		break;
 	default:
 		THROW_EXCEPTION_FMT("Invalid value for ICP_algorithm: %i", static_cast<int>(options.ICP_algorithm));
 	} // end switch
@@ -123,7 +127,9 @@ CICP::TConfigParams::TConfigParams() :
 	skip_cov_calculation		(false),
 	skip_quality_calculation	(true),
 
-	corresponding_points_decimation ( 5 )
+	corresponding_points_decimation ( 5 ),
+	normals_num_neighbors		( 10 ),
+	numThreads					( 0 )
 {
 }
 
@@ -169,6 +175,8 @@ void  CICP::TConfigParams::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR( skip_quality_calculation, bool, 				iniFile, section);
 
 	MRPT_LOAD_CONFIG_VAR( corresponding_points_decimation, int, 				iniFile, section);
+	MRPT_LOAD_CONFIG_VAR( normals_num_neighbors, int, 				iniFile, section);
+	MRPT_LOAD_CONFIG_VAR( numThreads, int, 				iniFile, section);
 
 }
 
@@ -208,6 +216,8 @@ void  CICP::TConfigParams::dumpToTextStream(mrpt::utils::CStream	&out) const
 	out.printf("skip_cov_calculation                    = %c\n",skip_cov_calculation ? 'Y':'N');
 	out.printf("skip_quality_calculation                = %c\n",skip_quality_calculation ? 'Y':'N');
 	out.printf("corresponding_points_decimation         = %u\n",(unsigned int)corresponding_points_decimation);
+	out.printf("normals_num_neighbors                   = %u\n",(unsigned int)normals_num_neighbors);
+	out.printf("numThreads                              = %u\n",(unsigned int)numThreads);
 	out.printf("\n");
 }
 
@@ -911,7 +921,11 @@ CPose3DPDFPtr CICP::Align3DPDF(
 		resultPDF = ICP3D_Method_Classic( m1, mm2, initialEstimationPDF, outInfo );
 		break;
 	case icpLevenbergMarquardt:
-		THROW_EXCEPTION("Only icpClassic is implemented for ICP-3D")
+		THROW_EXCEPTION("icpLevenbergMarquardt is not implemented for ICP-3D")
+		break;
+	case icpPointToPlane:
+	case icpGeneralized:
+		resultPDF = ICP3D_Method_PointToPlane( m1, mm2, initialEstimationPDF, outInfo );
 		break;
 	default:
 		THROW_EXCEPTION_FMT("Invalid value for ICP_algorithm: %i", static_cast<int>(options.ICP_algorithm));
@@ -0,0 +1,374 @@
+/* +---------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)               |
+   |                          http://www.mrpt.org/                             |
+   |                                                                           |
+   | Copyright (c) 2005-2017, Individual contributors, see AUTHORS file        |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                   |
+   | Released under BSD License. See details in http://www.mrpt.org/License    |
+   +---------------------------------------------------------------------------+ */
+
+#include "slam-precomp.h"   // Precompiled headers
+
+#include <mrpt/slam/CICP.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/point_cloud_kernels.h>
+#include <mrpt/math/wrap2pi.h>
+#include <mrpt/poses/CPose2D.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/poses/CPosePDFGaussian.h>
+#include <mrpt/poses/CPose3DPDFGaussian.h>
+#include <Eigen/Dense>
+
+using namespace mrpt::slam;
+using namespace mrpt::maps;
+using namespace mrpt::math;
+using namespace mrpt::poses;
+using namespace mrpt::utils;
+using namespace std;
+
+namespace
+{
+	/** Finds the closest point in `m1` to each point in `pts` (already in the frame of `m1`) within `maxDist2`, or -1 if there is none */
+	struct TClosestPointsTask : public mrpt::system::CWorkerThreadsPool::TRangeTask
+	{
+		TClosestPointsTask(const CPointsMap &m1_, const TConstPointCloudSpan &pts_, bool is3D_, float maxDist2_, int *out_idx_) :
+			m1(m1_), pts(pts_), is3D(is3D_), maxDist2(maxDist2_), out_idx(out_idx_)
+		{ }
+
+		const CPointsMap &m1;
+		const TConstPointCloudSpan pts;
+		const bool is3D;
+		const float maxDist2;
+		int *out_idx;
+
+		void operator()(size_t first, size_t last) const MRPT_OVERRIDE
+		{
+			for (size_t i=first;i<last;i++)
+			{
+				float dist2;
+				const size_t idx = is3D ?
+					m1.kdTreeClosestPoint3D(pts.x[i],pts.y[i],pts.z[i],dist2) :
+					m1.kdTreeClosestPoint2D(pts.x[i],pts.y[i],dist2);
+				out_idx[i] = dist2<=maxDist2 ? static_cast<int>(idx) : -1;
+			}
+		}
+	};
+
+	/** Copies one every `decimation` points of `m` */
+	void decimatePoints(const CPointsMap &m, size_t decimation, std::vector<float> &xs, std::vector<float> &ys, std::vector<float> &zs, std::vector<size_t> &idxs)
+	{
+		const TConstPointCloudSpan pts = m.getPointsSpan();
+		idxs.clear();
+		for (size_t i=0;i<pts.size;i+=decimation)
+			idxs.push_back(i);
+		const size_t N = idxs.size();
+		xs.resize(N); ys.resize(N); zs.resize(N);
+		for (size_t k=0;k<N;k++)
+		{
+			xs[k] = pts.x[idxs[k]];
+			ys[k] = pts.y[idxs[k]];
+			zs[k] = pts.z[idxs[k]];
+		}
+	}
+
+	/** Reads the symmetric matrix stored as its upper triangle by CPointsMap::TLocalGeometry */
+	template <int DIM>
+	Eigen::Matrix<double,DIM,DIM> unpackCov(const float *c)
+	{
+		Eigen::Matrix<double,DIM,DIM> C;
+		for (int r=0;r<DIM;r++)
+			for (int k=r;k<DIM;k++)
+				C(r,k) = C(k,r) = *c++;
+		return C;
+	}
+}
+
+/*---------------------------------------------------------------
+					ICP_Method_PointToPlane
+  ---------------------------------------------------------------*/
+CPosePDFPtr CICP::ICP_Method_PointToPlane(
+		const mrpt::maps::CMetricMap		*mm1,
+		const mrpt::maps::CMetricMap		*mm2,
+		const CPosePDFGaussian	&initialEstimationPDF,
+		TReturnInfo				&outInfo )
+{
+	MRPT_START
+
+	ASSERTMSG_(IS_DERIVED(mm1,CPointsMap) && IS_DERIVED(mm2,CPointsMap), "icpPointToPlane and icpGeneralized require two point maps")
+	ASSERT_( options.ALFA>=0 && options.ALFA<1 );
+	ASSERT_( options.corresponding_points_decimation>0 );
+	const CPointsMap *m1 = static_cast<const CPointsMap*>(mm1);
+	const CPointsMap *m2 = static_cast<const CPointsMap*>(mm2);
+	const bool isGICP = options.ICP_algorithm==icpGeneralized;
+
+	typedef Eigen::Matrix<double,3,3> mat3_t;
+	typedef Eigen::Matrix<double,2,2> mat2_t;
+	typedef Eigen::Matrix<double,2,1> vec2_t;
+
+	outInfo.nIterations = 0;
+	outInfo.goodness    = 0;
+	outInfo.quality     = 0;
+
+	CPosePDFGaussianPtr gaussPdf = CPosePDFGaussian::Create();
+	gaussPdf->mean = initialEstimationPDF.mean;
+
+	if (m1->isEmpty() || m2->isEmpty())
+		return gaussPdf;
+
+	m_threads.resize(options.numThreads);
+	const CPointsMap::TLocalGeometry &geom1 = m1->getLocalGeometry2D(options.normals_num_neighbors, &m_threads);
+	const CPointsMap::TLocalGeometry *geom2 = isGICP ? &m2->getLocalGeometry2D(options.normals_num_neighbors, &m_threads) : NULL;
+	m1->kdTreeEnsureIndexBuilt2D();
+
+	std::vector<float> lx,ly,lz, gx,gy,gz;
+	std::vector<size_t> srcIdxs;
+	decimatePoints(*m2, options.corresponding_points_decimation, lx,ly,lz, srcIdxs);
+	const size_t N = srcIdxs.size();
+	gx.resize(N); gy.resize(N); gz.resize(N);
+	std::vector<int> corrIdx(N);
+
+	const TConstPointCloudSpan pts1 = m1->getPointsSpan();
+	const TConstPointCloudSpan localPts(&lx[0],&ly[0],&lz[0],N);
+	const TPointCloudSpan globalPts(&gx[0],&gy[0],&gz[0],N);
+	const double rho2 = square(options.kernel_rho);
+
+	CPose2D &pose = gaussPdf->mean;
+	Eigen::Matrix3d H;
+	double maxDist = options.thresholdDist;
+	size_t nCorrs = 0;
+
+	while (outInfo.nIterations<options.maxIterations)
+	{
+		outInfo.nIterations++;
+
+		// Closest points, in parallel:
+		transformPoints(pose, localPts, globalPts);
+		m_threads.parallel_for(N, TClosestPointsTask(*m1, globalPts, false, static_cast<float>(square(maxDist)), &corrIdx[0]), 64);
+
+		// Gauss-Newton normal equations, for an increment (vx,vy,dphi) such that new_pose = (vx,vy,dphi) (+) pose:
+		H.setZero();
+		Eigen::Vector3d g = Eigen::Vector3d::Zero();
+		nCorrs = 0;
+		mat2_t R;
+		if (isGICP) R << pose.phi_cos(), -pose.phi_sin(), pose.phi_sin(), pose.phi_cos();
+
+		for (size_t i=0;i<N;i++)
+		{
+			const int j = corrIdx[i];
+			if (j<0) continue;
+			nCorrs++;
+			const vec2_t p(gx[i],gy[i]);
+			const vec2_t e = p - vec2_t(pts1.x[j],pts1.y[j]);
+			Eigen::Matrix<double,2,3> J;
+			J << 1, 0, -p[1],
+			     0, 1,  p[0];
+			const double w = options.use_kernel ? rho2/(rho2+e.squaredNorm()) : 1.0;
+			if (!isGICP)
+			{
+				const vec2_t n(geom1.normals[2*j],geom1.normals[2*j+1]);
+				const Eigen::Matrix<double,1,3> Jr = n.transpose()*J;
+				H.noalias() += w*Jr.transpose()*Jr;
+				g.noalias() += (w*n.dot(e))*Jr.transpose();
+			}
+			else
+			{
+				const mat2_t C = unpackCov<2>(&geom1.cov[3*j]) + R*unpackCov<2>(&geom2->cov[3*srcIdxs[i]])*R.transpose();
+				const mat2_t M = C.inverse();
+				H.noalias() += w*J.transpose()*M*J;
+				g.noalias() += w*J.transpose()*(M*e);
+			}
+		}
+
+		if (nCorrs<3)
+			break;  // Not enough constraints
+
+		const Eigen::Vector3d delta = -H.ldlt().solve(g);
+		pose = CPose2D(delta[0],delta[1],delta[2]) + pose;
+
+		// Converged at this threshold? Then, refine it:
+		if (std::abs(delta[0])<=options.minAbsStep_trans && std::abs(delta[1])<=options.minAbsStep_trans && std::abs(delta[2])<=options.minAbsStep_rot)
+		{
+			maxDist *= options.ALFA;
+			if (maxDist<options.smallestThresholdDist)
+				break;
+		}
+	}
+
+	outInfo.goodness = N ? static_cast<float>(nCorrs)/N : 0;
+
+	if (!options.skip_cov_calculation && nCorrs>=3)
+	{
+		// Covariance of the increment, then of (x,y,phi), from: x' = cos(dphi)*x - sin(dphi)*y + vx, etc.
+		const mat3_t cov_delta = H.inverse() * options.covariance_varPoints;
+		mat3_t J = mat3_t::Identity();
+		J(0,2) = -pose.y();
+		J(1,2) =  pose.x();
+		const mat3_t cov = J*cov_delta*J.transpose();
+		for (int r=0;r<3;r++)
+			for (int c=0;c<3;c++)
+				gaussPdf->cov(r,c) = cov(r,c);
+	}
+
+	return gaussPdf;
+
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+					ICP3D_Method_PointToPlane
+  ---------------------------------------------------------------*/
+CPose3DPDFPtr CICP::ICP3D_Method_PointToPlane(
+		const mrpt::maps::CMetricMap		*mm1,
+		const mrpt::maps::CMetricMap		*mm2,
+		const CPose3DPDFGaussian &initialEstimationPDF,
+		TReturnInfo				&outInfo )
+{
+	MRPT_START
+
+	ASSERTMSG_(IS_DERIVED(mm1,CPointsMap) && IS_DERIVED(mm2,CPointsMap), "icpPointToPlane and icpGeneralized require two point maps")
+	ASSERT_( options.ALFA>=0 && options.ALFA<1 );
+	ASSERT_( options.corresponding_points_decimation>0 );
+	const CPointsMap *m1 = static_cast<const CPointsMap*>(mm1);
+	const CPointsMap *m2 = static_cast<const CPointsMap*>(mm2);
+	const bool isGICP = options.ICP_algorithm==icpGeneralized;
+
+	typedef Eigen::Matrix<double,3,3> mat3_t;
+	typedef Eigen::Matrix<double,3,1> vec3_t;
+	typedef Eigen::Matrix<double,6,6> mat6_t;
+	typedef Eigen::Matrix<double,6,1> vec6_t;
+
+	outInfo.nIterations = 0;
+	outInfo.goodness    = 0;
+	outInfo.quality     = 0;
+
+	CPose3DPDFGaussianPtr gaussPdf = CPose3DPDFGaussian::Create();
+	gaussPdf->mean = initialEstimationPDF.mean;
+
+	if (m1->isEmpty() || m2->isEmpty())
+		return gaussPdf;
+
+	m_threads.resize(options.numThreads);
+	const CPointsMap::TLocalGeometry &geom1 = m1->getLocalGeometry3D(options.normals_num_neighbors, &m_threads);
+	const CPointsMap::TLocalGeometry *geom2 = isGICP ? &m2->getLocalGeometry3D(options.normals_num_neighbors, &m_threads) : NULL;
+	m1->kdTreeEnsureIndexBuilt3D();
+
+	std::vector<float> lx,ly,lz, gx,gy,gz;
+	std::vector<size_t> srcIdxs;
+	decimatePoints(*m2, options.corresponding_points_decimation, lx,ly,lz, srcIdxs);
+	const size_t N = srcIdxs.size();
+	gx.resize(N); gy.resize(N); gz.resize(N);
+	std::vector<int> corrIdx(N);
+
+	const TConstPointCloudSpan pts1 = m1->getPointsSpan();
+	const TConstPointCloudSpan localPts(&lx[0],&ly[0],&lz[0],N);
+	const TPointCloudSpan globalPts(&gx[0],&gy[0],&gz[0],N);
+	const double rho2 = square(options.kernel_rho);
+
+	CPose3D &pose = gaussPdf->mean;
+	mat6_t H;
+	double maxDist = options.thresholdDist;
+	size_t nCorrs = 0;
+
+	while (outInfo.nIterations<options.maxIterations)
+	{
+		outInfo.nIterations++;
+
+		// Closest points, in parallel:
+		transformPoints(pose, localPts, globalPts);
+		m_threads.parallel_for(N, TClosestPointsTask(*m1, globalPts, true, static_cast<float>(square(maxDist)), &corrIdx[0]), 64);
+
+		// Gauss-Newton normal equations, for an increment (v,w) such that new_pose = pseudo_exp(v,w) (+) pose,
+		// hence: new_point ~= point + w x point + v
+		H.setZero();
+		vec6_t g = vec6_t::Zero();
+		nCorrs = 0;
+		mat3_t R;
+		if (isGICP)
+		{
+			CMatrixDouble33 rot;
+			pose.getRotationMatrix(rot);
+			for (int r=0;r<3;r++) for (int c=0;c<3;c++) R(r,c)=rot(r,c);
+		}
+
+		for (size_t i=0;i<N;i++)
+		{
+			const int j = corrIdx[i];
+			if (j<0) continue;
+			nCorrs++;
+			const vec3_t p(gx[i],gy[i],gz[i]);
+			const vec3_t e = p - vec3_t(pts1.x[j],pts1.y[j],pts1.z[j]);
+			const double w = options.use_kernel ? rho2/(rho2+e.squaredNorm()) : 1.0;
+			if (!isGICP)
+			{
+				const vec3_t n(geom1.normals[3*j],geom1.normals[3*j+1],geom1.normals[3*j+2]);
+				vec6_t Jr;
+				Jr.head<3>() = n;
+				Jr.tail<3>() = p.cross(n);
+				H.noalias() += w*Jr*Jr.transpose();
+				g.noalias() += (w*n.dot(e))*Jr;
+			}
+			else
+			{
+				Eigen::Matrix<double,3,6> J;
+				J.block<3,3>(0,0).setIdentity();
+				J.block<3,3>(0,3) <<     0,  p[2], -p[1],
+				                     -p[2],     0,  p[0],
+				                      p[1], -p[0],     0;
+				const mat3_t C = unpackCov<3>(&geom1.cov[6*j]) + R*unpackCov<3>(&geom2->cov[6*srcIdxs[i]])*R.transpose();
+				const mat3_t M = C.inverse();
+				const Eigen::Matrix<double,6,3> JtM = J.transpose()*M;
+				H.noalias() += w*JtM*J;
+				g.noalias() += w*JtM*e;
+			}
+		}
+
+		if (nCorrs<6)
+			break;  // Not enough constraints
+
+		const vec6_t delta = -H.ldlt().solve(g);
+		CArrayDouble<6> mu;
+		for (int k=0;k<6;k++) mu[k]=delta[k];
+		pose = CPose3D::exp(mu, true /*pseudo-exponential*/) + pose;
+
+		// Converged at this threshold? Then, refine it:
+		if (delta.head<3>().cwiseAbs().maxCoeff()<=options.minAbsStep_trans && delta.tail<3>().cwiseAbs().maxCoeff()<=options.minAbsStep_rot)
+		{
+			maxDist *= options.ALFA;
+			if (maxDist<options.smallestThresholdDist)
+				break;
+		}
+	}
+
+	outInfo.goodness = N ? static_cast<float>(nCorrs)/N : 0;
+
+	if (!options.skip_cov_calculation && nCorrs>=6)
+	{
+		// Covariance of the increment, then of (x,y,z,yaw,pitch,roll) with a numerical Jacobian of the increment composition:
+		const mat6_t cov_delta = H.inverse() * options.covariance_varPoints;
+		Eigen::Matrix<double,6,6> J;
+		const double eps = 1e-6;
+		for (int k=0;k<6;k++)
+		{
+			CArrayDouble<6> mu;
+			mu.setZero();
+			mu[k] = eps;
+			const CPose3D pPlus = CPose3D::exp(mu,true) + pose;
+			mu[k] = -eps;
+			const CPose3D pMinus = CPose3D::exp(mu,true) + pose;
+			J(0,k) = (pPlus.x()-pMinus.x())/(2*eps);
+			J(1,k) = (pPlus.y()-pMinus.y())/(2*eps);
+			J(2,k) = (pPlus.z()-pMinus.z())/(2*eps);
+			J(3,k) = wrapToPi(pPlus.yaw()-pMinus.yaw())/(2*eps);
+			J(4,k) = wrapToPi(pPlus.pitch()-pMinus.pitch())/(2*eps);
+			J(5,k) = wrapToPi(pPlus.roll()-pMinus.roll())/(2*eps);
+		}
+		const mat6_t cov = J*cov_delta*J.transpose();
+		for (int r=0;r<6;r++)
+			for (int c=0;c<6;c++)
+				gaussPdf->cov(r,c) = cov(r,c);
+	}
+
+	return gaussPdf;
+
+	MRPT_END
+}
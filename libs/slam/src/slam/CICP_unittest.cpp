@@ -13,6 +13,7 @@
 #include <mrpt/opengl/CAngularObservationMesh.h>
 #include <mrpt/poses/CPosePDF.h>
 #include <mrpt/poses/CPose3DPDF.h>
+#include <mrpt/poses/CPose3DPDFGaussian.h>
 
 #include <mrpt/opengl/COpenGLScene.h>
 #include <mrpt/opengl/CGridPlaneXY.h>
@@ -142,6 +143,60 @@ TEST_F(ICPTests, AlignScans_icpLevenbergMarquardt)
 	align2scans(icpLevenbergMarquardt);
 }
 
+TEST_F(ICPTests, AlignScans_icpPointToPlane)
+{
+	align2scans(icpPointToPlane);
+}
+
+TEST_F(ICPTests, AlignScans_icpGeneralized)
+{
+	align2scans(icpGeneralized);
+}
+
+// Points sampled over the floor and walls of a room corner, plus a slanted plane, in 3D:
+static void buildRoomCorner3D(CSimplePointsMap &m)
+{
+	m.clear();
+	for (double a=0;a<=3.0;a+=0.1)
+		for (double b=0;b<=2.0;b+=0.1)
+		{
+			m.insertPoint(a, b+0.5*a, 0);  // floor
+			m.insertPoint(a, 0, b);        // wall 1
+			m.insertPoint(0, a, b);        // wall 2
+			m.insertPoint(1+0.3*b, 1+a*0.5, 0.5+0.8*b+0.1*a); // slanted plane
+		}
+}
+
+TEST_F(ICPTests, AlignRoom3D_pointToPlaneAndGICP)
+{
+	const CPose3D GT_POSE(0.12,-0.08,0.05, DEG2RAD(4.0),DEG2RAD(-2.0),DEG2RAD(3.0));
+
+	CSimplePointsMap M1, M2;
+	buildRoomCorner3D(M1);
+	buildRoomCorner3D(M2);
+	M2.changeCoordinatesReference( -GT_POSE ); // So GT_POSE is the pose of M2 wrt M1
+
+	const TICPAlgorithm methods[] = { icpPointToPlane, icpGeneralized };
+	for (int m=0;m<2;m++)
+	{
+		CICP icp;
+		icp.options.ICP_algorithm = methods[m];
+		icp.options.thresholdDist = 0.5f;
+		icp.options.smallestThresholdDist = 0.05f;
+		icp.options.corresponding_points_decimation = 1;
+		icp.options.numThreads = 2;
+		CICP::TReturnInfo info;
+
+		CPose3DPDFPtr pdf = icp.Align3DPDF(&M1, &M2, CPose3DPDFGaussian(CPose3D()), NULL, &info);
+		const CPose3D mean = pdf->getMeanVal();
+		EXPECT_NEAR(0, (mean.getAsVectorVal()-GT_POSE.getAsVectorVal()).array().abs().maxCoeff(), 1e-3)
+			<< "Method: " << TEnumType<TICPAlgorithm>::value2name(methods[m]) << endl
+			<< "ICP output: mean= " << mean << endl
+			<< "Real displacement: " << GT_POSE << endl;
+		EXPECT_GT(info.goodness, 0.9f);
+	}
+}
+
 TEST_F(ICPTests, RayTracingICP3D)
 {
 	//Increase this values to get more precision. It will also increase run time.
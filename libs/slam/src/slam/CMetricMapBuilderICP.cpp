@@ -456,6 +456,10 @@ void  CMetricMapBuilderICP::initialize(
 	// Create metric maps:
 	metricMap.setListOfMaps( &ICP_options.mapInitializers );
 
+	// Points are mostly appended to the map as it grows, so update the KD-trees incrementally:
+	for (size_t i=0;i<metricMap.m_pointsMaps.size();i++)
+		metricMap.m_pointsMaps[i]->kdtree_search_params.incremental = true;
+
 	// copy map:
 	SF_Poses_seq = initialMap;
 
@@ -38,7 +38,7 @@ namespace mrpt { namespace utils {
 }
 
 
-void run_test_pf_localization(CPose2D &meanPose, CMatrixDouble33 &cov)
+void run_test_pf_localization(CPose2D &meanPose, CMatrixDouble33 &cov, unsigned int numThreads)
 {
 // ------------------------------------------------------
 // The code below is a simplification of the program "pf-localization"
@@ -75,6 +75,7 @@ void run_test_pf_localization(CPose2D &meanPose, CMatrixDouble33 &cov)
 	// ---------------------------
 	CParticleFilter::TParticleFilterOptions		pfOptions;
 	pfOptions.loadFromConfigFile( iniFile, "PF_options" );
+	pfOptions.numThreads = numThreads;
 
 	// PDF Options:
 	// ------------------
@@ -137,6 +138,11 @@ void run_test_pf_localization(CPose2D &meanPose, CMatrixDouble33 &cov)
 
 	}
 
+	// Concurrent likelihood evaluation requires the gridmap lazy cache to be disabled:
+	if (numThreads!=1)
+		for (size_t i=0;i<metricMap.m_gridMaps.size();i++)
+			metricMap.m_gridMaps[i]->likelihoodOptions.enableLikelihoodCache = false;
+
 	// --------------------------
 	// Load the rawlog:
 	// --------------------------
@@ -259,8 +265,7 @@ void run_test_pf_localization(CPose2D &meanPose, CMatrixDouble33 &cov)
 
 }
 
-// TEST =================
-TEST(MonteCarlo2D, RunSampleDataset)
+void test_pf_localization_converges(unsigned int numThreads)
 {
 #if MRPT_IS_BIG_ENDIAN
 	MRPT_TODO("Debug this issue in big endian platforms")
@@ -278,7 +283,7 @@ TEST(MonteCarlo2D, RunSampleDataset)
 	// Give it 3 opportunities, since it might fail once for bad luck, or even twice in an extreme bad luck:
 	for (int op=0;op<3;op++)
 	{
-		run_test_pf_localization(meanPose,cov);
+		run_test_pf_localization(meanPose,cov,numThreads);
 
 		const double  final_pf_cov_trace = cov.trace();
 		const CPose2D final_pf_pose      = meanPose;
@@ -296,3 +301,13 @@ TEST(MonteCarlo2D, RunSampleDataset)
 	FAIL() << "Failed to converge after 3 opportunities!!" << endl;
 }
 
+// TEST =================
+TEST(MonteCarlo2D, RunSampleDataset)
+{
+	test_pf_localization_converges(1);
+}
+
+TEST(MonteCarlo2D, RunSampleDatasetMultiThreaded)
+{
+	test_pf_localization_converges(4);
+}
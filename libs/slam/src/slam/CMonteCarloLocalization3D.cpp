@@ -235,5 +235,29 @@ void CMonteCarloLocalization3D::PF_SLAM_implementation_replaceByNewParticleSet(
 	}
 }
 
+/*---------------------------------------------------------------
+			PF_SLAM_computeObservationLikelihoodForParticles
+ ---------------------------------------------------------------*/
+void CMonteCarloLocalization3D::PF_SLAM_computeObservationLikelihoodForParticles(
+	const CParticleFilter::TParticleFilterOptions	&PF_options,
+	const std::vector<size_t>	&particleIndicesForMap,
+	const CSensoryFrame		&observation,
+	const std::vector<TPose3D>	&x,
+	std::vector<double>		&out_log_liks ) const
+{
+	if (!options.metricMap)
+	{	// One map per particle: evaluate them one by one
+		PF_implementation<mrpt::poses::CPose3D,CMonteCarloLocalization3D>::PF_SLAM_computeObservationLikelihoodForParticles(PF_options,particleIndicesForMap,observation,x,out_log_liks);
+		return;
+	}
 
-
+	// All particles, one map. Same initial value than in PF_SLAM_computeObservationLikelihoodForParticle():
+	out_log_liks.assign(x.size(), 1);
+	std::vector<double> liks;
+	for (CSensoryFrame::const_iterator it=observation.begin();it!=observation.end();++it)
+	{
+		options.metricMap->computeObservationLikelihoods( it->pointer(), x, liks );
+		for (size_t k=0;k<liks.size();k++)
+			out_log_liks[k] += liks[k];
+	}
+}